@@ -0,0 +1,8 @@
+include (CheckSymbolExists)
+
+check_symbol_exists (epoll_create1 sys/epoll.h HAVE_EPOLL_CREATE1)
+if (HAVE_EPOLL_CREATE1)
+   set (MONGOC_HAVE_EPOLL 1)
+else ()
+   set (MONGOC_HAVE_EPOLL 0)
+endif ()
@@ -0,0 +1,14 @@
+include (CheckSymbolExists)
+
+# The io_uring socket stream issues the system calls itself, it needs only the
+# kernel headers: linked timeouts and socket send and receive operations.
+if (CMAKE_SYSTEM_NAME STREQUAL "Linux")
+   check_symbol_exists (__NR_io_uring_setup sys/syscall.h HAVE_NR_IO_URING_SETUP)
+   check_symbol_exists (IORING_FEAT_FAST_POLL linux/io_uring.h HAVE_IORING_FEAT_FAST_POLL)
+endif ()
+
+if (HAVE_NR_IO_URING_SETUP AND HAVE_IORING_FEAT_FAST_POLL)
+   set (MONGOC_HAVE_IO_URING 1)
+else ()
+   set (MONGOC_HAVE_IO_URING 0)
+endif ()
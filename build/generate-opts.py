@@ -344,12 +344,16 @@ opts_structs = OrderedDict([
     ('mongoc_gridfs_bucket_opts_t', Struct([
         ('bucketName', {'type': 'utf8', 'help': 'A UTF-8 string used as the prefix to the GridFS "chunks" and "files" collections. Defaults to "fs". The bucket name, together with the database and suffix collections must not exceed 120 characters. See the manual for `the max namespace length <https://www.mongodb.com/docs/manual/reference/limits/#Namespace-Length>`_.'}),
         ('chunkSizeBytes', {'type': 'int32_t', 'convert': '_mongoc_convert_int32_positive', 'help': 'An ``int32`` representing the chunk size. Defaults to 255KB.'}),
+        ('chunkBatchSize', {'type': 'int32_t', 'convert': '_mongoc_convert_int32_positive', 'help': 'An ``int32`` number of chunks to send in each insert when uploading, and to request in each batch when downloading. Defaults to 1, which inserts each chunk individually and uses the server\'s default batch size for downloads.'}),
+        ('chunkCompressor', {'type': 'utf8', 'help': 'A UTF-8 string naming a compressor, one of "zlib", "zstd", or "snappy", used to compress the data of each chunk uploaded through the bucket. The compressor must be enabled in this build of the driver. Chunks that do not shrink are stored uncompressed. Defaults to no compression. Downloads decompress chunks regardless of this option.'}),
+        ('chunkCacheSize', {'type': 'int32_t', 'convert': '_mongoc_convert_int32_positive', 'help': 'An ``int32`` number of recently downloaded chunks to cache. The cache is shared by all download streams opened from the bucket, so repeated reads of the same range of a file are served without a round trip. Defaults to 0, which disables the cache.'}),
         write_concern_option,
         read_concern_option
-    ], bucketName="fs", chunkSizeBytes=(255 * 1024))),
+    ], bucketName="fs", chunkSizeBytes=(255 * 1024), chunkBatchSize=1)),
 
     ('mongoc_gridfs_bucket_upload_opts_t', Struct([
         ('chunkSizeBytes', {'type': 'int32_t', 'convert': '_mongoc_convert_int32_positive', 'help': 'An ``int32`` chunk size to use for this file. Overrides the ``chunkSizeBytes`` set on ``bucket``.'}),
+        ('chunkBatchSize', {'type': 'int32_t', 'convert': '_mongoc_convert_int32_positive', 'help': 'An ``int32`` number of chunks to send in each insert for this file. Overrides the ``chunkBatchSize`` set on ``bucket``.'}),
         ('metadata', {'type': 'document', 'help': 'A :symbol:`bson_t` representing metadata to include with the file.'})
     ])),
 
@@ -386,6 +390,10 @@ opts_structs = OrderedDict([
         hint_option
     ])),
 
+    ('mongoc_parallel_scan_opts_t', Struct([
+        ('partitions', {'type': 'int32_t', 'convert': '_mongoc_convert_int32_positive', 'help': 'An ``int32`` number of ``_id`` ranges to split the collection into. Each range is scanned by its own thread with its own client from ``pool``. Defaults to 4.'}),
+    ], partitions=4)),
+
 ])
 
 header_comment = """/**************************************************
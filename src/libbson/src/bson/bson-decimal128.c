@@ -53,7 +53,27 @@ typedef struct {
    uint32_t parts[4]; /* 32-bit words stored high to low. */
 } _bson_uint128_t;
 
+#if defined(__SIZEOF_INT128__)
+#define BSON_DECIMAL128_HAVE_INT128
+__extension__ typedef unsigned __int128 _bson_native_uint128_t;
+#endif
+
+/* 10^19, the largest power of ten that fits in a uint64_t. */
+#define BSON_DECIMAL128_TEN_19 10000000000000000000ull
+
+static const char gDigitPairs[] = "00010203040506070809"
+                                  "10111213141516171819"
+                                  "20212223242526272829"
+                                  "30313233343536373839"
+                                  "40414243444546474849"
+                                  "50515253545556575859"
+                                  "60616263646566676869"
+                                  "70717273747576777879"
+                                  "80818283848586878889"
+                                  "90919293949596979899";
+
 
+#ifndef BSON_DECIMAL128_HAVE_INT128
 /**
  *------------------------------------------------------------------------------
  *
@@ -102,6 +122,114 @@ _bson_uint128_divide1B (_bson_uint128_t value,     /* IN */
    *quotient = value;
    *rem = (uint32_t) _rem;
 }
+#endif
+
+
+/**
+ *------------------------------------------------------------------------------
+ *
+ * _bson_decimal128_write_digits --
+ *
+ *    Writes the decimal digits of @value backwards, two at a time, so that
+ *    the last digit is stored just before @end. The digits are padded with
+ *    leading zeros to at least @min_digits.
+ *
+ * Returns:
+ *    A pointer to the first digit written.
+ *
+ *------------------------------------------------------------------------------
+ */
+static char *
+_bson_decimal128_write_digits (uint64_t value, /* IN */
+                               char *end,      /* IN */
+                               int min_digits) /* IN */
+{
+   char *p = end;
+
+   while (value >= 100u) {
+      const uint64_t pair = value % 100u;
+
+      value /= 100u;
+      p -= 2;
+      memcpy (p, gDigitPairs + pair * 2u, 2u);
+   }
+
+   if (value >= 10u) {
+      p -= 2;
+      memcpy (p, gDigitPairs + value * 2u, 2u);
+   } else {
+      *--p = (char) ('0' + value);
+   }
+
+   while (end - p < min_digits) {
+      *--p = '0';
+   }
+
+   return p;
+}
+
+
+/**
+ *------------------------------------------------------------------------------
+ *
+ * _bson_decimal128_significand_to_digits --
+ *
+ *    Converts the non-zero significand (@high, @low) to ASCII decimal digits
+ *    with no leading zeros. Significands that fit in 64 bits are converted
+ *    directly; larger ones are split into chunks of 19 digits with native
+ *    128-bit division when the compiler provides it, and of 9 digits with
+ *    _bson_uint128_divide1B otherwise.
+ *
+ * Returns:
+ *    The number of digits written to @digits.
+ *
+ *------------------------------------------------------------------------------
+ */
+static uint32_t
+_bson_decimal128_significand_to_digits (uint64_t high,   /* IN */
+                                        uint64_t low,    /* IN */
+                                        char digits[40]) /* OUT */
+{
+   char buf[40];
+   char *const end = buf + sizeof buf;
+   char *p;
+
+   if (!high) {
+      p = _bson_decimal128_write_digits (low, end, 1);
+   } else {
+#ifdef BSON_DECIMAL128_HAVE_INT128
+      const _bson_native_uint128_t value = ((_bson_native_uint128_t) high << 64) | low;
+
+      p = _bson_decimal128_write_digits ((uint64_t) (value % BSON_DECIMAL128_TEN_19), end, 19);
+      p = _bson_decimal128_write_digits ((uint64_t) (value / BSON_DECIMAL128_TEN_19), p, 1);
+#else
+      _bson_uint128_t value;
+
+      value.parts[0] = (uint32_t) (high >> 32);
+      value.parts[1] = (uint32_t) high;
+      value.parts[2] = (uint32_t) (low >> 32);
+      value.parts[3] = (uint32_t) low;
+      p = end;
+
+      for (;;) {
+         uint32_t least_digits;
+
+         _bson_uint128_divide1B (value, &value, &least_digits);
+
+         if (!value.parts[0] && !value.parts[1] && !value.parts[2] && !value.parts[3]) {
+            p = _bson_decimal128_write_digits (least_digits, p, 1);
+            break;
+         }
+
+         p = _bson_decimal128_write_digits (least_digits, p, 9);
+      }
+#endif
+   }
+
+   memcpy (digits, p, (size_t) (end - p));
+
+   return (uint32_t) (end - p);
+}
 
 
 /**
@@ -134,38 +262,28 @@ bson_decimal128_to_string (const bson_decimal128_t *dec, /* IN  */
    uint32_t COMBINATION_NAN = 31;      /* Value of combination field for NaN */
    uint32_t EXPONENT_BIAS = 6176;      /* decimal128 exponent bias */
 
-   char *str_out = str;      /* output pointer in string */
-   char significand_str[35]; /* decoded significand digits */
-
+   char *str_out = str; /* output pointer in string */
 
    /* Note: bits in this routine are referred to starting at 0, */
    /* from the sign bit, towards the coefficient. */
-   uint32_t high;                            /* bits 0 - 31 */
-   uint32_t midh;                            /* bits 32 - 63 */
-   uint32_t midl;                            /* bits 64 - 95 */
-   uint32_t low;                             /* bits 96 - 127 */
-   uint32_t combination;                     /* bits 1 - 5 */
-   uint32_t biased_exponent;                 /* decoded biased exponent (14 bits) */
-   uint32_t significand_digits = 0;          /* the number of significand digits */
-   uint32_t significand[36] = {0};           /* the base-10 digits in the significand */
-   uint32_t *significand_read = significand; /* read pointer into significand */
-   int32_t exponent;                         /* unbiased exponent */
-   int32_t scientific_exponent;              /* the exponent if scientific notation is
-                                              * used */
-   bool is_zero = false;                     /* true if the number is zero */
-
-   uint8_t significand_msb;        /* the most signifcant significand bits (50-46) */
-   _bson_uint128_t significand128; /* temporary storage for significand decoding */
-
-   memset (significand_str, 0, sizeof (significand_str));
+   uint32_t high;                              /* bits 0 - 31 */
+   uint32_t combination;                       /* bits 1 - 5 */
+   uint32_t biased_exponent;                   /* decoded biased exponent (14 bits) */
+   uint32_t significand_digits = 0;            /* the number of significand digits */
+   char significand[40];                       /* the base-10 digits in the significand */
+   const char *significand_read = significand; /* read pointer into significand */
+   int32_t exponent;                           /* unbiased exponent */
+   int32_t scientific_exponent;                /* the exponent if scientific notation is
+                                                * used */
+   size_t n;
+
+   uint8_t significand_msb;   /* the most signifcant significand bits (50-46) */
+   uint64_t significand_high; /* the significand above its low 64 bits */
 
    if ((int64_t) dec->high < 0) { /* negative */
       *(str_out++) = '-';
    }
 
-   low = (uint32_t) dec->low;
-   midl = (uint32_t) (dec->low >> 32);
-   midh = (uint32_t) dec->high;
    high = (uint32_t) (dec->high >> 32);
 
    /* Decode combination field and exponent */
@@ -191,58 +309,29 @@ bson_decimal128_to_string (const bson_decimal128_t *dec, /* IN  */
    }
 
    exponent = biased_exponent - EXPONENT_BIAS;
+
    /* Create string of significand digits */
+   significand_high = ((uint64_t) ((high & 0x3fff) + ((significand_msb & 0xf) << 14)) << 32) | (uint32_t) dec->high;
 
-   /* Convert the 114-bit binary number represented by */
-   /* (high, midh, midl, low) to at most 34 decimal */
-   /* digits through modulo and division. */
-   significand128.parts[0] = (high & 0x3fff) + ((significand_msb & 0xf) << 14);
-   significand128.parts[1] = midh;
-   significand128.parts[2] = midl;
-   significand128.parts[3] = low;
-
-   if (significand128.parts[0] == 0 && significand128.parts[1] == 0 && significand128.parts[2] == 0 &&
-       significand128.parts[3] == 0) {
-      is_zero = true;
-   } else if (significand128.parts[0] >= (1 << 17)) {
+   if (significand_high >= (1ull << 49)) {
       /* The significand is non-canonical or zero.
        * In order to preserve compatibility with the densely packed decimal
        * format, the maximum value for the significand of decimal128 is
        * 1e34 - 1.  If the value is greater than 1e34 - 1, the IEEE 754
        * standard dictates that the significand is interpreted as zero.
        */
-      is_zero = true;
-   } else {
-      for (int k = 3; k >= 0; k--) {
-         uint32_t least_digits = 0;
-         _bson_uint128_divide1B (significand128, &significand128, &least_digits);
-
-         /* We now have the 9 least significant digits (in base 2). */
-         /* Convert and output to string. */
-         if (!least_digits) {
-            continue;
-         }
-
-         for (int j = 8; j >= 0; j--) {
-            significand[k * 9 + j] = least_digits % 10;
-            least_digits /= 10;
-         }
-      }
+      significand_digits = 0;
+   } else if (significand_high || dec->low) {
+      significand_digits = _bson_decimal128_significand_to_digits (significand_high, dec->low, significand);
    }
 
    /* Output format options: */
    /* Scientific - [-]d.dddE(+/-)dd or [-]dE(+/-)dd */
    /* Regular    - ddd.ddd */
 
-   if (is_zero) {
+   if (!significand_digits) {
       significand_digits = 1;
-      *significand_read = 0;
-   } else {
-      significand_digits = 36;
-      while (!(*significand_read)) {
-         significand_digits--;
-         significand_read++;
-      }
+      significand[0] = '0';
    }
 
    scientific_exponent = significand_digits - 1 + exponent;
@@ -256,34 +345,48 @@ bson_decimal128_to_string (const bson_decimal128_t *dec, /* IN  */
     * change stored data if the string converted number is round tripped.
     */
    if (scientific_exponent < -6 || exponent > 0) {
+      char exponent_digits[8];
+      char *exponent_end = exponent_digits + sizeof exponent_digits;
+      const char *exponent_start;
+
       /* Scientific format */
-      *(str_out++) = *(significand_read++) + '0';
+      *(str_out++) = *(significand_read++);
       significand_digits--;
 
       if (significand_digits) {
          *(str_out++) = '.';
       }
 
-      for (uint32_t i = 0; i < significand_digits && (str_out - str) < 36; i++) {
-         *(str_out++) = *(significand_read++) + '0';
-      }
+      n = BSON_MIN (significand_digits, (size_t) (36 - (str_out - str)));
+      memcpy (str_out, significand_read, n);
+      str_out += n;
+
       /* Exponent */
       *(str_out++) = 'E';
-      bson_snprintf (str_out, 6, "%+d", scientific_exponent);
+      *(str_out++) = scientific_exponent < 0 ? '-' : '+';
+      exponent_start = _bson_decimal128_write_digits (
+         scientific_exponent < 0 ? (uint64_t) -(int64_t) scientific_exponent : (uint64_t) scientific_exponent,
+         exponent_end,
+         1);
+      memcpy (str_out, exponent_start, (size_t) (exponent_end - exponent_start));
+      str_out += exponent_end - exponent_start;
+      *str_out = '\0';
    } else {
       /* Regular format with no decimal place */
       if (exponent >= 0) {
-         for (uint32_t i = 0; i < significand_digits && (str_out - str) < 36; i++) {
-            *(str_out++) = *(significand_read++) + '0';
-         }
+         n = BSON_MIN (significand_digits, (size_t) (36 - (str_out - str)));
+         memcpy (str_out, significand_read, n);
+         str_out += n;
          *str_out = '\0';
       } else {
          int32_t radix_position = significand_digits + exponent;
+         size_t remaining;
 
          if (radix_position > 0) { /* non-zero digits before radix */
-            for (int32_t i = 0; i < radix_position && (str_out - str) < BSON_DECIMAL128_STRING; i++) {
-               *(str_out++) = *(significand_read++) + '0';
-            }
+            n = BSON_MIN ((size_t) radix_position, (size_t) (BSON_DECIMAL128_STRING - (str_out - str)));
+            memcpy (str_out, significand_read, n);
+            str_out += n;
+            significand_read += n;
          } else { /* leading zero before radix point */
             *(str_out++) = '0';
          }
@@ -293,11 +396,12 @@ bson_decimal128_to_string (const bson_decimal128_t *dec, /* IN  */
             *(str_out++) = '0';
          }
 
-         for (uint32_t i = 0; bson_cmp_greater_us (significand_digits - i, BSON_MAX (radix_position - 1, 0)) &&
-                              (str_out - str) < BSON_DECIMAL128_STRING;
-              i++) {
-            *(str_out++) = *(significand_read++) + '0';
-         }
+         remaining = bson_cmp_greater_us (significand_digits, BSON_MAX (radix_position - 1, 0))
+                        ? significand_digits - (size_t) BSON_MAX (radix_position - 1, 0)
+                        : 0u;
+         n = BSON_MIN (remaining, (size_t) (BSON_DECIMAL128_STRING - (str_out - str)));
+         memcpy (str_out, significand_read, n);
+         str_out += n;
          *str_out = '\0';
       }
    }
@@ -308,6 +412,7 @@ typedef struct {
 } _bson_uint128_6464_t;
 
 
+#ifndef BSON_DECIMAL128_HAVE_INT128
 /**
  *-------------------------------------------------------------------------
  *
@@ -356,6 +461,24 @@ _mul_64x64 (uint64_t left,                 /* IN */
    rt.low = product_low;
    *product = rt;
 }
+#endif
+
+/**
+ *------------------------------------------------------------------------------
+ *
+ * _dec128_isdigit --
+ *
+ *    This function checks whether @c is an ASCII decimal digit.  It is locale
+ *    insensitive (unlike the stdlib isdigit).
+ *
+ * Returns:
+ *    true if @c is a digit, false otherwise.
+ */
+static BSON_INLINE bool
+_dec128_isdigit (char c)
+{
+   return c >= '0' && c <= '9';
+}
 
 /**
  *------------------------------------------------------------------------------
@@ -496,8 +619,8 @@ bson_decimal128_from_string_w_len (const char *string,     /* IN */
    size_t last_digit = 0;            /* The index of the last digit */
 
    int32_t exponent = 0;
-   uint64_t significand_high = 0; /* The high 17 digits of the significand */
-   uint64_t significand_low = 0;  /* The low 17 digits of the significand */
+   uint64_t significand_high = 0; /* The digits of the significand above the low 19 */
+   uint64_t significand_low = 0;  /* The low 19 digits of the significand */
    uint16_t biased_exponent = 0;  /* The biased exponent */
 
    BSON_ASSERT (dec);
@@ -509,8 +632,48 @@ bson_decimal128_from_string_w_len (const char *string,     /* IN */
       includes_sign = true;
    }
 
+   /* Fast path: up to 19 digits with an optional radix point and no exponent
+    * are exactly representable with a 64-bit significand. Anything else is
+    * left to the general parser below. */
+   {
+      const char *fast_read = str_read;
+      const char *radix = NULL;
+      uint64_t value = 0;
+      int fast_digits = 0;
+
+      while (len == -1 || fast_read < string + len) {
+         if (_dec128_isdigit (*fast_read)) {
+            if (++fast_digits > 19) {
+               break;
+            }
+
+            value = value * 10u + (uint64_t) (*fast_read - '0');
+         } else if (*fast_read != '.' || radix) {
+            break;
+         } else {
+            radix = fast_read;
+         }
+
+         fast_read++;
+      }
+
+      if (fast_digits > 0 && fast_digits <= 19 &&
+          (!*fast_read || (len != -1 && fast_read == string + len && *fast_read != 'e' && *fast_read != 'E'))) {
+         const int32_t radix_digits = radix ? (int32_t) (fast_read - radix - 1) : 0;
+
+         dec->high = (uint64_t) (BSON_DECIMAL128_EXPONENT_BIAS - radix_digits) << 49;
+         dec->low = value;
+
+         if (is_negative) {
+            dec->high |= 0x8000000000000000ull;
+         }
+
+         return true;
+      }
+   }
+
    /* Check for Infinity or NaN */
-   if (!isdigit (*str_read) && *str_read != '.') {
+   if (!_dec128_isdigit (*str_read) && *str_read != '.') {
       if (_dec128_istreq (str_read, "inf") || _dec128_istreq (str_read, "infinity")) {
          BSON_DECIMAL128_SET_INF (*dec, is_negative);
          return true;
@@ -524,7 +687,7 @@ bson_decimal128_from_string_w_len (const char *string,     /* IN */
    }
 
    /* Read digits */
-   while (((isdigit (*str_read) || *str_read == '.')) && (len == -1 || str_read < string + len)) {
+   while (((_dec128_isdigit (*str_read) || *str_read == '.')) && (len == -1 || str_read < string + len)) {
       if (*str_read == '.') {
          if (saw_radix) {
             BSON_DECIMAL128_SET_NAN (*dec);
@@ -567,23 +730,48 @@ bson_decimal128_from_string_w_len (const char *string,     /* IN */
 
    /* Read exponent if exists */
    if (*str_read == 'e' || *str_read == 'E') {
-      int nread = 0;
-#ifdef _MSC_VER
-#define SSCANF sscanf_s
-#else
-#define SSCANF sscanf
-#endif
+      /* Accepts what sscanf's %d would: optional leading whitespace, an
+       * optional sign, and at least one digit. */
+      bool exponent_is_negative = false;
+      bool exponent_overflow = false;
       int64_t temp_exponent = 0;
-      int read_exponent = SSCANF (++str_read, "%" SCNd64 "%n", &temp_exponent, &nread);
-      str_read += nread;
+      const char *exponent_digits;
+
+      str_read++;
+      while (isspace ((unsigned char) *str_read)) {
+         str_read++;
+      }
 
-      if (!read_exponent || nread == 0 || !bson_in_range_int32_t_signed (temp_exponent)) {
+      if (*str_read == '+' || *str_read == '-') {
+         exponent_is_negative = *(str_read++) == '-';
+      }
+
+      exponent_digits = str_read;
+      while (_dec128_isdigit (*str_read)) {
+         if (temp_exponent <= INT32_MAX) {
+            temp_exponent = temp_exponent * 10 + (*str_read - '0');
+         } else {
+            exponent_overflow = true;
+         }
+
+         str_read++;
+      }
+
+      if (str_read == exponent_digits) {
+         BSON_DECIMAL128_SET_NAN (*dec);
+         return false;
+      }
+
+      if (exponent_is_negative) {
+         temp_exponent = -temp_exponent;
+      }
+
+      if (exponent_overflow || !bson_in_range_int32_t_signed (temp_exponent)) {
          BSON_DECIMAL128_SET_NAN (*dec);
          return false;
       }
 
       exponent = (int32_t) temp_exponent;
-#undef SSCANF
    }
 
    if ((len == -1 || str_read < string + len) && *str_read) {
@@ -705,41 +893,50 @@ bson_decimal128_from_string_w_len (const char *string,     /* IN */
    /* Encode significand */
 
    if (significant_digits == 0) { /* read a zero */
-      significand_high = 0;
-      significand_low = 0;
-   } else if (last_digit - first_digit < 17) {
+      significand.high = 0;
+      significand.low = 0;
+   } else if (last_digit - first_digit < 19) {
+      /* Up to 19 digits fit in the low 64 bits. */
       size_t d_idx = first_digit;
-      significand_low = digits[d_idx++];
+
+      significand.low = digits[d_idx++];
 
       for (; d_idx <= last_digit; d_idx++) {
-         significand_low *= 10;
-         significand_low += digits[d_idx];
-         significand_high = 0;
+         significand.low = significand.low * 10u + digits[d_idx];
       }
    } else {
+      /* The low 19 digits, and at most 15 more above them. */
       size_t d_idx = first_digit;
+
       significand_high = digits[d_idx++];
 
-      for (; d_idx <= last_digit - 17; d_idx++) {
-         significand_high *= 10;
-         significand_high += digits[d_idx];
+      for (; d_idx <= last_digit - 19; d_idx++) {
+         significand_high = significand_high * 10u + digits[d_idx];
       }
 
       significand_low = digits[d_idx++];
 
       for (; d_idx <= last_digit; d_idx++) {
-         significand_low *= 10;
-         significand_low += digits[d_idx];
+         significand_low = significand_low * 10u + digits[d_idx];
       }
-   }
 
-   _mul_64x64 (significand_high, 100000000000000000ull, &significand);
-   significand.low += significand_low;
+#ifdef BSON_DECIMAL128_HAVE_INT128
+      {
+         const _bson_native_uint128_t value =
+            (_bson_native_uint128_t) significand_high * BSON_DECIMAL128_TEN_19 + significand_low;
 
-   if (significand.low < significand_low) {
-      significand.high += 1;
-   }
+         significand.high = (uint64_t) (value >> 64);
+         significand.low = (uint64_t) value;
+      }
+#else
+      _mul_64x64 (significand_high, BSON_DECIMAL128_TEN_19, &significand);
+      significand.low += significand_low;
 
+      if (significand.low < significand_low) {
+         significand.high += 1;
+      }
+#endif
+   }
 
    biased_exponent = (exponent + (int16_t) BSON_DECIMAL128_EXPONENT_BIAS);
 
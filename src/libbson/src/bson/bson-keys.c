@@ -16,6 +16,7 @@
 
 
 #include <stdio.h>
+#include <string.h>
 
 #include <bson/bson-keys.h>
 #include <bson/bson-string.h>
@@ -86,6 +87,18 @@ static const char *gUint32Strs[] = {
    "976", "977", "978", "979", "980", "981", "982", "983", "984", "985", "986", "987", "988", "989", "990", "991",
    "992", "993", "994", "995", "996", "997", "998", "999"};
 
+/* "00" through "99", for writing two digits per division. */
+static const char gDigitPairs[] = "00010203040506070809"
+                                  "10111213141516171819"
+                                  "20212223242526272829"
+                                  "30313233343536373839"
+                                  "40414243444546474849"
+                                  "50515253545556575859"
+                                  "60616263646566676869"
+                                  "70717273747576777879"
+                                  "80818283848586878889"
+                                  "90919293949596979899";
+
 
 /*
  *--------------------------------------------------------------------------
@@ -97,8 +110,8 @@ static const char *gUint32Strs[] = {
  *       If @value is from 0 to 1000, it will use a constant string in the
  *       data section of the library.
  *
- *       If not, a string will be formatted using @str and snprintf(). This
- *       is much slower, of course and therefore we try to optimize it out.
+ *       If not, the digits are written to @str two at a time, from a table
+ *       of digit pairs.
  *
  *       @strptr will always be set. It will either point to @str or a
  *       constant string. You will want to use this as your key.
@@ -127,6 +140,12 @@ bson_uint32_to_string (uint32_t value,      /* IN */
                        char *str,           /* OUT */
                        size_t size)         /* IN */
 {
+   /* UINT32_MAX has 10 digits. */
+   char digits[10];
+   char *const end = digits + sizeof digits;
+   char *p = end;
+   size_t len;
+
    if (value < 1000) {
       *strptr = gUint32Strs[value];
 
@@ -139,7 +158,31 @@ bson_uint32_to_string (uint32_t value,      /* IN */
       }
    }
 
+   while (value >= 100u) {
+      const uint32_t pair = value % 100u;
+
+      value /= 100u;
+      p -= 2;
+      memcpy (p, gDigitPairs + pair * 2u, 2u);
+   }
+
+   if (value >= 10u) {
+      p -= 2;
+      memcpy (p, gDigitPairs + value * 2u, 2u);
+   } else {
+      *--p = (char) ('0' + value);
+   }
+
+   len = (size_t) (end - p);
    *strptr = str;
 
-   return bson_snprintf (str, size, "%u", value);
+   /* like bson_snprintf, truncate and NULL terminate if @str is too small. */
+   if (size > 0u) {
+      const size_t n = len < size ? len : size - 1u;
+
+      memcpy (str, p, n);
+      str[n] = '\0';
+   }
+
+   return len;
 }
@@ -25,6 +25,12 @@
 #include <bson/bson-oid.h>
 #include <bson/bson-string.h>
 
+/* SSE2 is part of the x86-64 baseline, so it needs no runtime detection. */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BSON_OID_HAVE_SSE2
+#endif
+
 
 /*
  * This table contains an array of two character pairs for every possible
@@ -75,6 +81,107 @@ BSON_MAYBE_UNUSED static const uint16_t gHexCharPairs[] = {
 };
 
 
+/* The value of each hexadecimal character, or zero for other characters, like
+ * bson_oid_parse_hex_char. */
+BSON_MAYBE_UNUSED static const uint8_t gHexCharValues[256] = {
+   ['0'] = 0x0, ['1'] = 0x1, ['2'] = 0x2, ['3'] = 0x3, ['4'] = 0x4, ['5'] = 0x5, ['6'] = 0x6, ['7'] = 0x7,
+   ['8'] = 0x8, ['9'] = 0x9, ['a'] = 0xa, ['b'] = 0xb, ['c'] = 0xc, ['d'] = 0xd, ['e'] = 0xe, ['f'] = 0xf,
+   ['A'] = 0xa, ['B'] = 0xb, ['C'] = 0xc, ['D'] = 0xd, ['E'] = 0xe, ['F'] = 0xf,
+};
+
+
+#ifdef BSON_OID_HAVE_SSE2
+/* Convert each byte of @nibbles, 0 through 15, to its lowercase hexadecimal
+ * character. */
+static BSON_INLINE __m128i
+_bson_oid_nibbles_to_hex (__m128i nibbles)
+{
+   const __m128i letters = _mm_and_si128 (_mm_cmpgt_epi8 (nibbles, _mm_set1_epi8 (9)), _mm_set1_epi8 ('a' - '0' - 10));
+
+   return _mm_add_epi8 (_mm_add_epi8 (nibbles, _mm_set1_epi8 ('0')), letters);
+}
+
+
+/* Convert each byte of @chars to the value of its hexadecimal character, or
+ * zero if it is not one. Bytes above 0x7f are negative and match no range. */
+static BSON_INLINE __m128i
+_bson_oid_hex_to_nibbles (__m128i chars)
+{
+   const __m128i lower = _mm_or_si128 (chars, _mm_set1_epi8 (0x20));
+   const __m128i is_digit =
+      _mm_and_si128 (_mm_cmpgt_epi8 (chars, _mm_set1_epi8 ('0' - 1)), _mm_cmpgt_epi8 (_mm_set1_epi8 ('9' + 1), chars));
+   const __m128i is_letter =
+      _mm_and_si128 (_mm_cmpgt_epi8 (lower, _mm_set1_epi8 ('a' - 1)), _mm_cmpgt_epi8 (_mm_set1_epi8 ('f' + 1), lower));
+
+   return _mm_or_si128 (_mm_and_si128 (is_digit, _mm_sub_epi8 (chars, _mm_set1_epi8 ('0'))),
+                        _mm_and_si128 (is_letter, _mm_sub_epi8 (lower, _mm_set1_epi8 ('a' - 10))));
+}
+
+
+/* Combine each pair of nibbles, high nibble first, into a byte in the low half
+ * of each 16-bit lane. */
+static BSON_INLINE __m128i
+_bson_oid_combine_nibbles (__m128i nibbles)
+{
+   return _mm_or_si128 (_mm_slli_epi16 (_mm_and_si128 (nibbles, _mm_set1_epi16 (0x00ff)), 4),
+                        _mm_srli_epi16 (nibbles, 8));
+}
+#endif
+
+
+/* Write the 24 hexadecimal characters of @oid to @str, without a NULL
+ * terminator. */
+static BSON_INLINE void
+_bson_oid_encode_hex (const bson_oid_t *oid, char *str)
+{
+#ifdef BSON_OID_HAVE_SSE2
+   uint8_t bytes[16] = {0};
+   __m128i v;
+   __m128i high;
+   __m128i low;
+
+   memcpy (bytes, oid->bytes, sizeof oid->bytes);
+   v = _mm_loadu_si128 ((const __m128i *) bytes);
+   high = _mm_and_si128 (_mm_srli_epi16 (v, 4), _mm_set1_epi8 (0x0f));
+   low = _mm_and_si128 (v, _mm_set1_epi8 (0x0f));
+
+   /* interleave to high, low nibble order: 16 characters, then 8. */
+   _mm_storeu_si128 ((__m128i *) str, _bson_oid_nibbles_to_hex (_mm_unpacklo_epi8 (high, low)));
+   _mm_storel_epi64 ((__m128i *) (str + 16), _bson_oid_nibbles_to_hex (_mm_unpackhi_epi8 (high, low)));
+#else
+   for (size_t i = 0u; i < sizeof oid->bytes; i++) {
+      memcpy (str + 2u * i, &gHexCharPairs[oid->bytes[i]], 2u);
+   }
+#endif
+}
+
+
+/* Parse 24 hexadecimal characters from @str into @oid. Characters that are not
+ * hexadecimal are read as zero, like bson_oid_init_from_string_unsafe. */
+static BSON_INLINE void
+_bson_oid_decode_hex (const char *str, bson_oid_t *oid)
+{
+#ifdef BSON_OID_HAVE_SSE2
+   uint8_t bytes[16];
+   const __m128i first = _mm_loadu_si128 ((const __m128i *) str);
+   const __m128i rest = _mm_loadl_epi64 ((const __m128i *) (str + 16));
+
+   /* 8 bytes from the first 16 characters, then 4 from the last 8. */
+   _mm_storeu_si128 ((__m128i *) bytes,
+                     _mm_packus_epi16 (_bson_oid_combine_nibbles (_bson_oid_hex_to_nibbles (first)),
+                                       _bson_oid_combine_nibbles (_bson_oid_hex_to_nibbles (rest))));
+   memcpy (oid->bytes, bytes, sizeof oid->bytes);
+#else
+   for (size_t i = 0u; i < sizeof oid->bytes; i++) {
+      const uint8_t high = gHexCharValues[(uint8_t) str[2u * i]];
+      const uint8_t low = gHexCharValues[(uint8_t) str[2u * i + 1u]];
+
+      oid->bytes[i] = (uint8_t) ((high << 4) | low);
+   }
+#endif
+}
+
+
 void
 bson_oid_init_sequence (bson_oid_t *oid,         /* OUT */
                         bson_context_t *context) /* IN */
@@ -128,7 +235,22 @@ bson_oid_init_from_string (bson_oid_t *oid, /* OUT */
    BSON_ASSERT (oid);
    BSON_ASSERT (str);
 
-   bson_oid_init_from_string_unsafe (oid, str);
+   _bson_oid_decode_hex (str, oid);
+}
+
+
+void
+bson_oid_init_from_strings (bson_oid_t *oids,        /* OUT */
+                            const char *const *strs, /* IN */
+                            size_t n_oids)           /* IN */
+{
+   BSON_ASSERT (oids || n_oids == 0u);
+   BSON_ASSERT (strs || n_oids == 0u);
+
+   for (size_t i = 0u; i < n_oids; i++) {
+      BSON_ASSERT (strs[i]);
+      _bson_oid_decode_hex (strs[i], &oids[i]);
+   }
 }
 
 
@@ -145,47 +267,26 @@ void
 bson_oid_to_string (const bson_oid_t *oid,                       /* IN */
                     char str[BSON_ENSURE_ARRAY_PARAM_SIZE (25)]) /* OUT */
 {
-#if !defined(__i386__) && !defined(__x86_64__) && !defined(_M_IX86) && !defined(_M_X64)
    BSON_ASSERT (oid);
    BSON_ASSERT (str);
 
-   bson_snprintf (str,
-                  25,
-                  "%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x",
-                  oid->bytes[0],
-                  oid->bytes[1],
-                  oid->bytes[2],
-                  oid->bytes[3],
-                  oid->bytes[4],
-                  oid->bytes[5],
-                  oid->bytes[6],
-                  oid->bytes[7],
-                  oid->bytes[8],
-                  oid->bytes[9],
-                  oid->bytes[10],
-                  oid->bytes[11]);
-#else
-   uint16_t *dst;
-   uint8_t *id = (uint8_t *) oid;
+   _bson_oid_encode_hex (oid, str);
+   str[24] = '\0';
+}
 
-   BSON_ASSERT (oid);
-   BSON_ASSERT (str);
 
-   dst = (uint16_t *) (void *) str;
-   dst[0] = gHexCharPairs[id[0]];
-   dst[1] = gHexCharPairs[id[1]];
-   dst[2] = gHexCharPairs[id[2]];
-   dst[3] = gHexCharPairs[id[3]];
-   dst[4] = gHexCharPairs[id[4]];
-   dst[5] = gHexCharPairs[id[5]];
-   dst[6] = gHexCharPairs[id[6]];
-   dst[7] = gHexCharPairs[id[7]];
-   dst[8] = gHexCharPairs[id[8]];
-   dst[9] = gHexCharPairs[id[9]];
-   dst[10] = gHexCharPairs[id[10]];
-   dst[11] = gHexCharPairs[id[11]];
-   str[24] = '\0';
-#endif
+void
+bson_oid_to_strings (const bson_oid_t *oids, /* IN */
+                     size_t n_oids,          /* IN */
+                     char *strs)             /* OUT */
+{
+   BSON_ASSERT (oids || n_oids == 0u);
+   BSON_ASSERT (strs || n_oids == 0u);
+
+   for (size_t i = 0u; i < n_oids; i++) {
+      _bson_oid_encode_hex (&oids[i], strs + 25u * i);
+      strs[25u * i + 24u] = '\0';
+   }
 }
 
 
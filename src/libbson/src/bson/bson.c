@@ -3332,53 +3332,76 @@ bson_concat (bson_t *dst, const bson_t *src)
 
 struct _bson_array_builder_t {
    uint32_t index;
+   // The decimal string of `index`, which is incremented in place rather than
+   // formatted for each element. UINT32_MAX is 10 digits.
+   char key[16];
+   uint32_t key_length;
    bson_t bson;
 };
 
+static void
+_bson_array_builder_reset_key (bson_array_builder_t *bab)
+{
+   bab->index = 0;
+   bab->key[0] = '0';
+   bab->key[1] = '\0';
+   bab->key_length = 1;
+}
+
+// Advance `bab->key` to the string of `bab->index + 1`.
+static void
+_bson_array_builder_next_key (bson_array_builder_t *bab)
+{
+   uint32_t i = bab->key_length;
+
+   bab->index += 1;
+
+   while (i > 0) {
+      i--;
+      if (bab->key[i] != '9') {
+         bab->key[i]++;
+         return;
+      }
+      bab->key[i] = '0';
+   }
+
+   // Every digit was a nine: prepend a one, e.g. "999" becomes "1000".
+   memmove (bab->key + 1, bab->key, bab->key_length + 1u);
+   bab->key[0] = '1';
+   bab->key_length += 1;
+}
+
 bson_array_builder_t *
 bson_array_builder_new (void)
 {
    bson_array_builder_t *bab = BSON_ALIGNED_ALLOC0 (bson_array_builder_t);
    bson_init (&bab->bson);
+   _bson_array_builder_reset_key (bab);
    return bab;
 }
 
-// `bson_array_builder_append_impl` generates the next key index, calls
-// `append_fn`, and may update the tracked next index.
-#define bson_array_builder_append_impl(append_fn, ...)                               \
-   if (1) {                                                                          \
-      BSON_ASSERT_PARAM (bab);                                                       \
-      const char *key;                                                               \
-      char buf[16];                                                                  \
-      size_t key_length = bson_uint32_to_string (bab->index, &key, buf, sizeof buf); \
-      /* Expect enough room in `buf` for key string. UINT32_MAX is 10 digits.        \
-       * With the NULL terminator, 11 is expected maximum number of                  \
-       * characters.  */                                                             \
-      BSON_ASSERT (key_length < sizeof buf);                                         \
-      bool ok = append_fn (&bab->bson, key, (int) key_length, __VA_ARGS__);          \
-      if (ok) {                                                                      \
-         bab->index += 1;                                                            \
-      }                                                                              \
-      return ok;                                                                     \
-   } else                                                                            \
+// `bson_array_builder_append_impl` calls `append_fn` with the current key, and
+// advances the key and index if the append succeeds.
+#define bson_array_builder_append_impl(append_fn, ...)                                \
+   if (1) {                                                                           \
+      BSON_ASSERT_PARAM (bab);                                                        \
+      bool ok = append_fn (&bab->bson, bab->key, (int) bab->key_length, __VA_ARGS__); \
+      if (ok) {                                                                       \
+         _bson_array_builder_next_key (bab);                                          \
+      }                                                                               \
+      return ok;                                                                      \
+   } else                                                                             \
       (void) 0
 
-#define bson_array_builder_append_impl_noargs(append_fn)                             \
-   if (1) {                                                                          \
-      BSON_ASSERT_PARAM (bab);                                                       \
-      const char *key;                                                               \
-      char buf[16];                                                                  \
-      size_t key_length = bson_uint32_to_string (bab->index, &key, buf, sizeof buf); \
-      /* Expect enough room in `buf` for key string. UINT32_MAX is 10 digits.        \
-       * With the NULL terminator, 11 is expected maximum number of                  \
-       * characters.  */                                                             \
-      BSON_ASSERT (key_length < sizeof buf);                                         \
-      bool ok = append_fn (&bab->bson, key, (int) key_length);                       \
-      if (ok) {                                                                      \
-         bab->index += 1;                                                            \
-      }                                                                              \
-      return ok;                                                                     \
-   } else                                                                            \
+#define bson_array_builder_append_impl_noargs(append_fn)                              \
+   if (1) {                                                                           \
+      BSON_ASSERT_PARAM (bab);                                                        \
+      bool ok = append_fn (&bab->bson, bab->key, (int) bab->key_length);              \
+      if (ok) {                                                                       \
+         _bson_array_builder_next_key (bab);                                          \
+      }                                                                               \
+      return ok;                                                                      \
+   } else                                                                             \
       (void) 0
 
 bool
@@ -3611,7 +3634,7 @@ bson_array_builder_build (bson_array_builder_t *bab, bson_t *out)
       return false;
    }
    bson_init (&bab->bson);
-   bab->index = 0;
+   _bson_array_builder_reset_key (bab);
    return true;
 }
 
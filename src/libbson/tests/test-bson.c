@@ -2785,6 +2785,33 @@ test_bson_uint32_to_string (void)
       // Expect the input buffer is used.
       ASSERT_CMPSTR (buf, "100");
    }
+
+   // Test values across the range, including every change in the number of
+   // digits, against snprintf.
+   {
+      const uint32_t values[] = {999u,       1000u,       9999u,       10000u,      99999u,      100000u,
+                                 999999u,    1000000u,    9999999u,    10000000u,   99999999u,   100000000u,
+                                 999999999u, 1000000000u, 1234567890u, 4000000000u, 4294967294u, UINT32_MAX};
+      for (size_t i = 0; i < sizeof values / sizeof values[0]; i++) {
+         char buf[16];
+         char expect[16];
+         const char *strptr;
+         size_t got = bson_uint32_to_string (values[i], &strptr, buf, sizeof buf);
+         int expect_len = bson_snprintf (expect, sizeof expect, "%" PRIu32, values[i]);
+         ASSERT_CMPSIZE_T (got, ==, (size_t) expect_len);
+         ASSERT_CMPSTR (strptr, expect);
+      }
+
+      for (uint32_t value = 1000u; value < 100000000u; value = value * 3u + 7u) {
+         char buf[16];
+         char expect[16];
+         const char *strptr;
+         size_t got = bson_uint32_to_string (value, &strptr, buf, sizeof buf);
+         int expect_len = bson_snprintf (expect, sizeof expect, "%" PRIu32, value);
+         ASSERT_CMPSIZE_T (got, ==, (size_t) expect_len);
+         ASSERT_CMPSTR (strptr, expect);
+      }
+   }
 }
 
 static void
@@ -2853,6 +2880,37 @@ test_bson_array_builder (void)
       bson_array_builder_destroy (bab);
    }
 
+   // Keys are incremented across every change in the number of digits.
+   {
+      const uint32_t n = 100001u;
+      bson_array_builder_t *bab = bson_array_builder_new ();
+      for (uint32_t i = 0; i < n; i++) {
+         ASSERT (bson_array_builder_append_int32 (bab, (int32_t) i));
+      }
+      bson_t b;
+      ASSERT (bson_array_builder_build (bab, &b));
+      bson_iter_t iter;
+      ASSERT (bson_iter_init (&iter, &b));
+      uint32_t i = 0;
+      while (bson_iter_next (&iter)) {
+         char buf[16];
+         const char *key;
+         bson_uint32_to_string (i, &key, buf, sizeof buf);
+         ASSERT_CMPSTR (bson_iter_key (&iter), key);
+         ASSERT_CMPINT32 (bson_iter_int32 (&iter), ==, (int32_t) i);
+         i++;
+      }
+      ASSERT_CMPUINT32 (i, ==, n);
+      bson_destroy (&b);
+
+      // Building resets the key.
+      ASSERT (bson_array_builder_append_int32 (bab, 1));
+      ASSERT (bson_array_builder_build (bab, &b));
+      ASSERT_BSON_EQUAL (b, [1]);
+      bson_destroy (&b);
+      bson_array_builder_destroy (bab);
+   }
+
    // Test each bson_array_builder_append_* function.
    {
       {
@@ -3187,6 +3245,62 @@ test_bson_array_builder (void)
    }
 }
 
+
+/* times building a 1M-element array with snprintf keys and with the array
+ * builder. Run with -d to print the results. */
+static void
+test_bson_array_builder_benchmark (void *ctx)
+{
+   const uint32_t n = 1000u * 1000u;
+   int64_t start;
+   int64_t formatted;
+   int64_t incremented;
+   bson_t formatted_array = BSON_INITIALIZER;
+   bson_t incremented_array;
+
+   BSON_UNUSED (ctx);
+
+   // Format keys from 1000 up with snprintf, as bson_uint32_to_string did
+   // before it wrote digit pairs.
+   start = bson_get_monotonic_time ();
+   for (uint32_t i = 0; i < n; i++) {
+      char buf[16];
+      const char *key = buf;
+      size_t key_length;
+      if (i < 1000u) {
+         key_length = bson_uint32_to_string (i, &key, buf, sizeof buf);
+      } else {
+         key_length = (size_t) bson_snprintf (buf, sizeof buf, "%" PRIu32, i);
+      }
+      ASSERT (bson_append_int32 (&formatted_array, key, (int) key_length, (int32_t) i));
+   }
+   formatted = bson_get_monotonic_time () - start;
+
+   start = bson_get_monotonic_time ();
+   {
+      bson_array_builder_t *bab = bson_array_builder_new ();
+      for (uint32_t i = 0; i < n; i++) {
+         ASSERT (bson_array_builder_append_int32 (bab, (int32_t) i));
+      }
+      ASSERT (bson_array_builder_build (bab, &incremented_array));
+      bson_array_builder_destroy (bab);
+   }
+   incremented = bson_get_monotonic_time () - start;
+
+   ASSERT (bson_equal (&formatted_array, &incremented_array));
+
+   if (test_suite_debug_output ()) {
+      printf ("      array of %" PRIu32 " elements: snprintf keys %.1f ms, array builder %.1f ms\n",
+              n,
+              (double) formatted / 1000.0,
+              (double) incremented / 1000.0);
+      fflush (stdout);
+   }
+
+   bson_destroy (&formatted_array);
+   bson_destroy (&incremented_array);
+}
+
 void
 test_bson_install (TestSuite *suite)
 {
@@ -3269,4 +3383,6 @@ test_bson_install (TestSuite *suite)
    TestSuite_Add (suite, "/bson/with_duplicate_keys", test_bson_with_duplicate_keys);
    TestSuite_Add (suite, "/bson/uint32_to_string", test_bson_uint32_to_string);
    TestSuite_Add (suite, "/bson/array_builder", test_bson_array_builder);
+   TestSuite_AddFull (
+      suite, "/bson/array_builder/benchmark", test_bson_array_builder_benchmark, NULL, NULL, TestSuite_CheckSlow);
 }
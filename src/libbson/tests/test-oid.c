@@ -203,6 +203,116 @@ test_bson_oid_init (void)
 }
 
 
+static void
+_oid_to_string_reference (const bson_oid_t *oid, char str[25])
+{
+   for (size_t i = 0; i < sizeof oid->bytes; i++) {
+      bson_snprintf (&str[2 * i], 3, "%02x", oid->bytes[i]);
+   }
+}
+
+
+static void
+test_bson_oid_hex_round_trip (void)
+{
+   bson_oid_t oid;
+   bson_oid_t parsed;
+   char str[25];
+   char expected[25];
+
+   /* every byte value in every position. */
+   for (int value = 0; value < 256; value++) {
+      for (size_t pos = 0; pos < sizeof oid.bytes; pos++) {
+         memset (&oid, 0x5a, sizeof oid);
+         oid.bytes[pos] = (uint8_t) value;
+
+         memset (str, 'x', sizeof str);
+         bson_oid_to_string (&oid, str);
+         _oid_to_string_reference (&oid, expected);
+         ASSERT_CMPSTR (str, expected);
+
+         bson_oid_init_from_string (&parsed, str);
+         BSON_ASSERT (bson_oid_equal (&oid, &parsed));
+      }
+   }
+
+   for (int i = 0; i < 10000; i++) {
+      for (size_t j = 0; j < sizeof oid.bytes; j++) {
+         oid.bytes[j] = (uint8_t) rand ();
+      }
+
+      bson_oid_to_string (&oid, str);
+      _oid_to_string_reference (&oid, expected);
+      ASSERT_CMPSTR (str, expected);
+
+      bson_oid_init_from_string (&parsed, str);
+      BSON_ASSERT (bson_oid_equal (&oid, &parsed));
+   }
+}
+
+
+static void
+test_bson_oid_hex_decode_any_char (void)
+{
+   bson_oid_t oid;
+   bson_oid_t expected;
+   char str[25];
+
+   /* decoding every character, including invalid ones, matches the inline
+    * bson_oid_init_from_string_unsafe. */
+   for (int c = 1; c < 256; c++) {
+      for (size_t pos = 0; pos < 24; pos++) {
+         memcpy (str, "0123456789abcdefABCDEF01", sizeof str);
+         str[pos] = (char) c;
+
+         bson_oid_init_from_string (&oid, str);
+         bson_oid_init_from_string_unsafe (&expected, str);
+         BSON_ASSERT (bson_oid_equal (&oid, &expected));
+      }
+   }
+}
+
+
+static void
+test_bson_oid_strings (void)
+{
+   enum { n_oids = 37 };
+   bson_oid_t oids[n_oids];
+   bson_oid_t parsed[n_oids];
+   const char *ptrs[n_oids];
+   char strs[n_oids * 25];
+   bson_context_t *context;
+
+   context = bson_context_new (BSON_CONTEXT_NONE);
+
+   for (size_t i = 0; i < n_oids; i++) {
+      bson_oid_init (&oids[i], context);
+   }
+
+   memset (strs, 'x', sizeof strs);
+   bson_oid_to_strings (oids, n_oids, strs);
+
+   for (size_t i = 0; i < n_oids; i++) {
+      char expected[25];
+
+      bson_oid_to_string (&oids[i], expected);
+      ASSERT_CMPSTR (&strs[i * 25], expected);
+      ptrs[i] = &strs[i * 25];
+   }
+
+   bson_oid_init_from_strings (parsed, ptrs, n_oids);
+   for (size_t i = 0; i < n_oids; i++) {
+      BSON_ASSERT (bson_oid_equal (&oids[i], &parsed[i]));
+   }
+
+   /* zero OIDs writes nothing. */
+   bson_oid_to_strings (oids, 0, NULL);
+   bson_oid_init_from_strings (NULL, NULL, 0);
+
+   bson_context_destroy (context);
+}
+
+
 static void
 test_bson_oid_init_sequence (void)
 {
@@ -473,6 +583,9 @@ test_oid_install (TestSuite *suite)
 {
    TestSuite_Add (suite, "/bson/oid/init", test_bson_oid_init);
    TestSuite_Add (suite, "/bson/oid/init_from_string", test_bson_oid_init_from_string);
+   TestSuite_Add (suite, "/bson/oid/hex_round_trip", test_bson_oid_hex_round_trip);
+   TestSuite_Add (suite, "/bson/oid/hex_decode_any_char", test_bson_oid_hex_decode_any_char);
+   TestSuite_Add (suite, "/bson/oid/strings", test_bson_oid_strings);
    TestSuite_Add (suite, "/bson/oid/init_sequence", test_bson_oid_init_sequence);
    TestSuite_Add (suite, "/bson/oid/init_with_threads", test_bson_oid_init_with_threads);
    TestSuite_Add (suite, "/bson/oid/hash", test_bson_oid_hash);
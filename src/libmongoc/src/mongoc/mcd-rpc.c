@@ -68,6 +68,7 @@ struct _mcd_rpc_op_msg {
    uint32_t flag_bits;
    mcd_rpc_op_msg_section *sections; // Owning.
    size_t sections_count;            // Not part of actual message.
+   size_t sections_capacity;         // Not part of actual message.
    uint32_t checksum;                // Optional, ignored by Drivers.
    bool checksum_set;                // Not part of actual message.
 };
@@ -437,6 +438,7 @@ _consume_op_msg_section (
    if (op_msg->sections_count >= *capacity) {
       *capacity *= 2u;
       op_msg->sections = bson_realloc (op_msg->sections, *capacity * sizeof (mcd_rpc_op_msg_section));
+      op_msg->sections_capacity = *capacity;
    }
 
    // Append the valid section.
@@ -476,6 +478,7 @@ _consume_op_msg (mcd_rpc_message *rpc, const uint8_t **ptr, size_t *remaining_by
    size_t capacity = 2u;
    op_msg->sections = bson_malloc (capacity * sizeof (mcd_rpc_op_msg_section));
    op_msg->sections_count = 0u;
+   op_msg->sections_capacity = capacity;
 
    // A fully constructed OP_MSG MUST contain exactly one Payload Type 0, and
    // optionally any number of Payload Type 1 where each identifier MUST be
@@ -952,18 +955,27 @@ static void
 _append_iovec_reserve_space_for (mongoc_iovec_t **iovecs,
                                  size_t *capacity,
                                  const mongoc_iovec_t *header_iovecs,
+                                 size_t *allocated,
                                  size_t additional_capacity)
 {
    BSON_ASSERT_PARAM (iovecs);
    BSON_ASSERT_PARAM (capacity);
    BSON_ASSERT_PARAM (header_iovecs);
+   BSON_ASSERT_PARAM (allocated);
 
    // Expect this function to be invoked only once after initializing the
    // `header_iovecs` array.
    BSON_ASSERT (*capacity == 4u);
 
    *capacity += additional_capacity;
-   *iovecs = bson_malloc (*capacity * sizeof (mongoc_iovec_t));
+
+   // `*iovecs` may be an array reused from a previous conversion with space for
+   // `*allocated` iovec objects.
+   if (*allocated < *capacity) {
+      *iovecs = bson_realloc (*iovecs, *capacity * sizeof (mongoc_iovec_t));
+      *allocated = *capacity;
+   }
+
    memcpy (*iovecs, header_iovecs, 4u * sizeof (mongoc_iovec_t));
 }
 
@@ -1041,7 +1053,8 @@ _append_iovec_op_compressed (mongoc_iovec_t **iovecs,
                              size_t *capacity,
                              size_t *count,
                              mcd_rpc_op_compressed *op_compressed,
-                             const mongoc_iovec_t *header_iovecs)
+                             const mongoc_iovec_t *header_iovecs,
+                             size_t *allocated)
 {
    BSON_ASSERT_PARAM (iovecs);
    BSON_ASSERT_PARAM (capacity);
@@ -1049,7 +1062,7 @@ _append_iovec_op_compressed (mongoc_iovec_t **iovecs,
    BSON_ASSERT_PARAM (op_compressed);
    BSON_ASSERT_PARAM (header_iovecs);
 
-   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, 4u);
+   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, allocated, 4u);
 
    if (!_append_iovec_int32_t (*iovecs, capacity, count, &op_compressed->original_opcode)) {
       return false;
@@ -1102,7 +1115,8 @@ _append_iovec_op_msg (mongoc_iovec_t **iovecs,
                       size_t *capacity,
                       size_t *count,
                       mcd_rpc_op_msg *op_msg,
-                      const mongoc_iovec_t *header_iovecs)
+                      const mongoc_iovec_t *header_iovecs,
+                      size_t *allocated)
 {
    BSON_ASSERT_PARAM (iovecs);
    BSON_ASSERT_PARAM (capacity);
@@ -1115,7 +1129,7 @@ _append_iovec_op_msg (mongoc_iovec_t **iovecs,
       return false;
    }
 
-   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, 2u + section_iovecs);
+   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, allocated, 2u + section_iovecs);
 
    if (!_append_iovec_uint32_t (*iovecs, capacity, count, &op_msg->flag_bits)) {
       return false;
@@ -1182,7 +1196,8 @@ _append_iovec_op_reply (mongoc_iovec_t **iovecs,
                         size_t *capacity,
                         size_t *count,
                         mcd_rpc_op_reply *op_reply,
-                        const mongoc_iovec_t *header_iovecs)
+                        const mongoc_iovec_t *header_iovecs,
+                        size_t *allocated)
 {
    BSON_ASSERT_PARAM (iovecs);
    BSON_ASSERT_PARAM (capacity);
@@ -1190,7 +1205,7 @@ _append_iovec_op_reply (mongoc_iovec_t **iovecs,
    BSON_ASSERT_PARAM (op_reply);
    BSON_ASSERT_PARAM (header_iovecs);
 
-   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, 5u);
+   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, allocated, 5u);
 
    if (!_append_iovec_int32_t (*iovecs, capacity, count, &op_reply->response_flags)) {
       return false;
@@ -1221,7 +1236,8 @@ _append_iovec_op_update (mongoc_iovec_t **iovecs,
                          size_t *capacity,
                          size_t *count,
                          mcd_rpc_op_update *op_update,
-                         const mongoc_iovec_t *header_iovecs)
+                         const mongoc_iovec_t *header_iovecs,
+                         size_t *allocated)
 {
    BSON_ASSERT_PARAM (iovecs);
    BSON_ASSERT_PARAM (capacity);
@@ -1229,7 +1245,7 @@ _append_iovec_op_update (mongoc_iovec_t **iovecs,
    BSON_ASSERT_PARAM (op_update);
    BSON_ASSERT_PARAM (header_iovecs);
 
-   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, 5u);
+   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, allocated, 5u);
 
    if (!_append_iovec_reserved_zero (*iovecs, capacity, count)) {
       return false;
@@ -1261,7 +1277,8 @@ _append_iovec_op_insert (mongoc_iovec_t **iovecs,
                          size_t *capacity,
                          size_t *count,
                          mcd_rpc_op_insert *op_insert,
-                         const mongoc_iovec_t *header_iovecs)
+                         const mongoc_iovec_t *header_iovecs,
+                         size_t *allocated)
 {
    BSON_ASSERT_PARAM (iovecs);
    BSON_ASSERT_PARAM (capacity);
@@ -1269,7 +1286,7 @@ _append_iovec_op_insert (mongoc_iovec_t **iovecs,
    BSON_ASSERT_PARAM (op_insert);
    BSON_ASSERT_PARAM (header_iovecs);
 
-   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, 3u);
+   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, allocated, 3u);
 
    if (!_append_iovec_int32_t (*iovecs, capacity, count, &op_insert->flags)) {
       return false;
@@ -1293,7 +1310,8 @@ _append_iovec_op_query (mongoc_iovec_t **iovecs,
                         size_t *capacity,
                         size_t *count,
                         mcd_rpc_op_query *op_query,
-                        const mongoc_iovec_t *header_iovecs)
+                        const mongoc_iovec_t *header_iovecs,
+                        size_t *allocated)
 {
    BSON_ASSERT_PARAM (iovecs);
    BSON_ASSERT_PARAM (capacity);
@@ -1302,7 +1320,7 @@ _append_iovec_op_query (mongoc_iovec_t **iovecs,
    BSON_ASSERT_PARAM (header_iovecs);
 
    _append_iovec_reserve_space_for (
-      iovecs, capacity, header_iovecs, 5u + (size_t) (!!op_query->return_fields_selector));
+      iovecs, capacity, header_iovecs, allocated, 5u + (size_t) (!!op_query->return_fields_selector));
 
    if (!_append_iovec_int32_t (*iovecs, capacity, count, &op_query->flags)) {
       return false;
@@ -1343,7 +1361,8 @@ _append_iovec_op_get_more (mongoc_iovec_t **iovecs,
                            size_t *capacity,
                            size_t *count,
                            mcd_rpc_op_get_more *op_get_more,
-                           const mongoc_iovec_t *header_iovecs)
+                           const mongoc_iovec_t *header_iovecs,
+                           size_t *allocated)
 {
    BSON_ASSERT_PARAM (iovecs);
    BSON_ASSERT_PARAM (count);
@@ -1351,7 +1370,7 @@ _append_iovec_op_get_more (mongoc_iovec_t **iovecs,
    BSON_ASSERT_PARAM (op_get_more);
    BSON_ASSERT_PARAM (header_iovecs);
 
-   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, 4u);
+   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, allocated, 4u);
 
    if (!_append_iovec_reserved_zero (*iovecs, capacity, count)) {
       return false;
@@ -1378,7 +1397,8 @@ _append_iovec_op_delete (mongoc_iovec_t **iovecs,
                          size_t *capacity,
                          size_t *count,
                          mcd_rpc_op_delete *op_delete,
-                         const mongoc_iovec_t *header_iovecs)
+                         const mongoc_iovec_t *header_iovecs,
+                         size_t *allocated)
 {
    BSON_ASSERT_PARAM (iovecs);
    BSON_ASSERT_PARAM (capacity);
@@ -1386,7 +1406,7 @@ _append_iovec_op_delete (mongoc_iovec_t **iovecs,
    BSON_ASSERT_PARAM (op_delete);
    BSON_ASSERT_PARAM (header_iovecs);
 
-   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, 4u);
+   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, allocated, 4u);
 
    if (!_append_iovec_reserved_zero (*iovecs, capacity, count)) {
       return false;
@@ -1414,7 +1434,8 @@ _append_iovec_op_kill_cursors (mongoc_iovec_t **iovecs,
                                size_t *capacity,
                                size_t *count,
                                mcd_rpc_op_kill_cursors *op_kill_cursors,
-                               const mongoc_iovec_t *header_iovecs)
+                               const mongoc_iovec_t *header_iovecs,
+                               size_t *allocated)
 {
    BSON_ASSERT_PARAM (iovecs);
    BSON_ASSERT_PARAM (capacity);
@@ -1425,7 +1446,7 @@ _append_iovec_op_kill_cursors (mongoc_iovec_t **iovecs,
    // Store value before conversion to little endian.
    const int32_t number_of_cursor_ids = op_kill_cursors->number_of_cursor_ids;
 
-   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, 3u);
+   _append_iovec_reserve_space_for (iovecs, capacity, header_iovecs, allocated, 3u);
 
    if (!_append_iovec_reserved_zero (*iovecs, capacity, count)) {
       return false;
@@ -1454,10 +1475,12 @@ _append_iovec_op_kill_cursors (mongoc_iovec_t **iovecs,
 }
 
 
-void *
-mcd_rpc_message_to_iovecs (mcd_rpc_message *rpc, size_t *count)
+static bool
+_mcd_rpc_message_to_iovecs (mcd_rpc_message *rpc, mongoc_iovec_t **iovecs, size_t *allocated, size_t *count)
 {
    ASSERT_MCD_RPC_ACCESSOR_PRECONDITIONS;
+   BSON_ASSERT_PARAM (iovecs);
+   BSON_ASSERT_PARAM (allocated);
    BSON_ASSERT_PARAM (count);
 
    const int32_t op_code = rpc->msg_header.op_code;
@@ -1472,9 +1495,6 @@ mcd_rpc_message_to_iovecs (mcd_rpc_message *rpc, size_t *count)
    (void) _append_iovec_int32_t (header_iovecs, &capacity, count, &rpc->msg_header.response_to);
    (void) _append_iovec_int32_t (header_iovecs, &capacity, count, &rpc->msg_header.op_code);
 
-   mongoc_iovec_t *iovecs = NULL;
-   mongoc_iovec_t *ret = NULL;
-
    // Fields may be converted to little endian even on failure, so consider the
    // RPC object to be in an iovecs state from this point forward regardless of
    // success or failure.
@@ -1482,69 +1502,89 @@ mcd_rpc_message_to_iovecs (mcd_rpc_message *rpc, size_t *count)
 
    switch (op_code) {
    case MONGOC_OP_CODE_COMPRESSED:
-      if (!_append_iovec_op_compressed (&iovecs, &capacity, count, &rpc->op_compressed, header_iovecs)) {
-         goto fail;
+      if (!_append_iovec_op_compressed (iovecs, &capacity, count, &rpc->op_compressed, header_iovecs, allocated)) {
+         return false;
       }
       break;
 
    case MONGOC_OP_CODE_MSG: {
-      if (!_append_iovec_op_msg (&iovecs, &capacity, count, &rpc->op_msg, header_iovecs)) {
-         goto fail;
+      if (!_append_iovec_op_msg (iovecs, &capacity, count, &rpc->op_msg, header_iovecs, allocated)) {
+         return false;
       }
       break;
    }
 
    case MONGOC_OP_CODE_REPLY:
-      if (!_append_iovec_op_reply (&iovecs, &capacity, count, &rpc->op_reply, header_iovecs)) {
-         goto fail;
+      if (!_append_iovec_op_reply (iovecs, &capacity, count, &rpc->op_reply, header_iovecs, allocated)) {
+         return false;
       }
       break;
 
    case MONGOC_OP_CODE_UPDATE:
-      if (!_append_iovec_op_update (&iovecs, &capacity, count, &rpc->op_update, header_iovecs)) {
-         goto fail;
+      if (!_append_iovec_op_update (iovecs, &capacity, count, &rpc->op_update, header_iovecs, allocated)) {
+         return false;
       }
       break;
 
    case MONGOC_OP_CODE_INSERT:
-      if (!_append_iovec_op_insert (&iovecs, &capacity, count, &rpc->op_insert, header_iovecs)) {
-         goto fail;
+      if (!_append_iovec_op_insert (iovecs, &capacity, count, &rpc->op_insert, header_iovecs, allocated)) {
+         return false;
       }
       break;
 
    case MONGOC_OP_CODE_QUERY:
-      if (!_append_iovec_op_query (&iovecs, &capacity, count, &rpc->op_query, header_iovecs)) {
-         goto fail;
+      if (!_append_iovec_op_query (iovecs, &capacity, count, &rpc->op_query, header_iovecs, allocated)) {
+         return false;
       }
       break;
 
    case MONGOC_OP_CODE_GET_MORE:
-      if (!_append_iovec_op_get_more (&iovecs, &capacity, count, &rpc->op_get_more, header_iovecs)) {
-         goto fail;
+      if (!_append_iovec_op_get_more (iovecs, &capacity, count, &rpc->op_get_more, header_iovecs, allocated)) {
+         return false;
       }
       break;
 
    case MONGOC_OP_CODE_DELETE:
-      if (!_append_iovec_op_delete (&iovecs, &capacity, count, &rpc->op_delete, header_iovecs)) {
-         goto fail;
+      if (!_append_iovec_op_delete (iovecs, &capacity, count, &rpc->op_delete, header_iovecs, allocated)) {
+         return false;
       }
       break;
 
    case MONGOC_OP_CODE_KILL_CURSORS:
-      if (!_append_iovec_op_kill_cursors (&iovecs, &capacity, count, &rpc->op_kill_cursors, header_iovecs)) {
-         goto fail;
+      if (!_append_iovec_op_kill_cursors (iovecs, &capacity, count, &rpc->op_kill_cursors, header_iovecs, allocated)) {
+         return false;
       }
       break;
 
    default:
-      goto fail;
+      return false;
    }
 
-   ret = iovecs;
-   iovecs = NULL;
+   return true;
+}
 
-fail:
-   bson_free (iovecs);
+void *
+mcd_rpc_message_to_iovecs (mcd_rpc_message *rpc, size_t *count)
+{
+   mongoc_iovec_t *iovecs = NULL;
+   size_t allocated = 0u;
+
+   if (!_mcd_rpc_message_to_iovecs (rpc, &iovecs, &allocated, count)) {
+      bson_free (iovecs);
+      return NULL;
+   }
+
+   return iovecs;
+}
+
+bool
+mcd_rpc_message_to_iovecs_reuse (mcd_rpc_message *rpc, void **iovecs, size_t *capacity, size_t *count)
+{
+   BSON_ASSERT_PARAM (iovecs);
+
+   mongoc_iovec_t *storage = *iovecs;
+   const bool ret = _mcd_rpc_message_to_iovecs (rpc, &storage, capacity, count);
+   *iovecs = storage;
 
    return ret;
 }
@@ -1652,6 +1692,29 @@ mcd_rpc_message_reset (mcd_rpc_message *rpc)
    *rpc = (mcd_rpc_message){.msg_header = {0}};
 }
 
+void
+mcd_rpc_message_recycle (mcd_rpc_message *rpc)
+{
+   BSON_ASSERT_PARAM (rpc);
+
+   if (_mcd_rpc_header_get_op_code_maybe_le (rpc) != MONGOC_OP_CODE_MSG || !rpc->op_msg.sections) {
+      mcd_rpc_message_reset (rpc);
+      return;
+   }
+
+   mcd_rpc_op_msg_section *const sections = rpc->op_msg.sections;
+   const size_t sections_capacity = rpc->op_msg.sections_capacity;
+
+   *rpc = (mcd_rpc_message){.msg_header = {0}};
+
+   // The op code stays set so that the sections array remains owned by the
+   // object and is freed once the object is reset, destroyed, or given another
+   // op code.
+   rpc->msg_header.op_code = MONGOC_OP_CODE_MSG;
+   rpc->op_msg.sections = sections;
+   rpc->op_msg.sections_capacity = sections_capacity;
+}
+
 void
 mcd_rpc_message_set_length (mcd_rpc_message *rpc, int32_t value)
 {
@@ -1717,7 +1780,10 @@ mcd_rpc_header_set_op_code (mcd_rpc_message *rpc, int32_t op_code)
 {
    ASSERT_MCD_RPC_ACCESSOR_PRECONDITIONS;
 
-   _mcd_rpc_message_free_owners (rpc);
+   // Keep the sections array of a recycled OP_MSG message for the next one.
+   if (op_code != MONGOC_OP_CODE_MSG || rpc->msg_header.op_code != MONGOC_OP_CODE_MSG) {
+      _mcd_rpc_message_free_owners (rpc);
+   }
 
    rpc->msg_header.op_code = op_code;
    return sizeof (op_code);
@@ -2000,7 +2066,11 @@ mcd_rpc_op_msg_set_sections_count (mcd_rpc_message *rpc, size_t section_count)
    ASSERT_MCD_RPC_ACCESSOR_PRECONDITIONS;
    BSON_ASSERT (rpc->msg_header.op_code == MONGOC_OP_CODE_MSG);
 
-   rpc->op_msg.sections = bson_realloc (rpc->op_msg.sections, section_count * sizeof (mcd_rpc_op_msg_section));
+   if (section_count > rpc->op_msg.sections_capacity) {
+      rpc->op_msg.sections = bson_realloc (rpc->op_msg.sections, section_count * sizeof (mcd_rpc_op_msg_section));
+      rpc->op_msg.sections_capacity = section_count;
+   }
+
    rpc->op_msg.sections_count = section_count;
 }
 
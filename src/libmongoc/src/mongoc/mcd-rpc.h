@@ -123,6 +123,15 @@ mcd_rpc_message_from_data_in_place (mcd_rpc_message *rpc, const void *data, size
 void *
 mcd_rpc_message_to_iovecs (mcd_rpc_message *rpc, size_t *count);
 
+// Equivalent to `mcd_rpc_message_to_iovecs`, but stores the iovec structures in
+// `*iovecs`, an array with space for `*capacity` iovec structures that is only
+// reallocated when it is too small. `*iovecs` may be `NULL` when `*capacity`
+// is `0`, and must be freed by `bson_free` once it is no longer reused.
+//
+// Returns `true` on success. Returns `false` on failure.
+bool
+mcd_rpc_message_to_iovecs_reuse (mcd_rpc_message *rpc, void **iovecs, size_t *capacity, size_t *count);
+
 // Return an RPC message object in an initialized state whose fields will be set
 // manually. The return value must be freed by `mcd_rpc_message_destroy`.
 mcd_rpc_message *
@@ -136,6 +145,12 @@ mcd_rpc_message_destroy (mcd_rpc_message *rpc);
 void
 mcd_rpc_message_reset (mcd_rpc_message *rpc);
 
+// Equivalent to `mcd_rpc_message_reset`, but if the given RPC message object is
+// an OP_MSG message, the op code remains set to OP_MSG and its sections array
+// is kept for the next OP_MSG message instead of being freed.
+void
+mcd_rpc_message_recycle (mcd_rpc_message *rpc);
+
 // Set the message length for the given RPC message object. Expected to be used
 // in conjunction with the return values of setters.
 void
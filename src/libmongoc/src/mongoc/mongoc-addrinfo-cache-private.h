@@ -0,0 +1,80 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mongoc-prelude.h"
+
+#ifndef MONGOC_ADDRINFO_CACHE_PRIVATE_H
+#define MONGOC_ADDRINFO_CACHE_PRIVATE_H
+
+#include <bson/bson.h>
+
+#include "mongoc-host-list.h"
+#include "mongoc-socket.h"
+
+
+BSON_BEGIN_DECLS
+
+
+/* How long a getaddrinfo () result is reused by connections to the same host,
+ * port, and address family. */
+#define MONGOC_ADDRINFO_CACHE_TIMEOUT_MS (10 * 60 * 1000)
+
+
+/* A reference to a getaddrinfo () result shared by the topology scanner and
+ * the connections of every client in the process. It also remembers the
+ * address the last successful connection used, so the next connection can try
+ * it first instead of racing every address family again. */
+typedef struct _mongoc_addrinfo_t mongoc_addrinfo_t;
+
+
+void
+_mongoc_addrinfo_cache_init (void);
+void
+_mongoc_addrinfo_cache_cleanup (void);
+
+/* Returns a new reference to the addresses of @host, calling getaddrinfo () if
+ * there is no result younger than @max_age_ms. Returns NULL if resolution
+ * fails. Release the reference with _mongoc_addrinfo_release. */
+mongoc_addrinfo_t *
+_mongoc_addrinfo_cache_get (const mongoc_host_list_t *host, int64_t max_age_ms);
+
+/* Forget the cached addresses of @host, e.g. after connecting to every one of
+ * them failed. References that are still held stay valid. */
+void
+_mongoc_addrinfo_cache_invalidate (const mongoc_host_list_t *host);
+
+void
+_mongoc_addrinfo_cache_clear (void);
+
+struct addrinfo *
+_mongoc_addrinfo_results (const mongoc_addrinfo_t *addrinfo);
+
+/* The address the last successful connection used, or NULL. */
+struct addrinfo *
+_mongoc_addrinfo_preferred (mongoc_addrinfo_t *addrinfo);
+
+/* @preferred must be one of _mongoc_addrinfo_results (). */
+void
+_mongoc_addrinfo_set_preferred (mongoc_addrinfo_t *addrinfo, struct addrinfo *preferred);
+
+void
+_mongoc_addrinfo_release (mongoc_addrinfo_t *addrinfo);
+
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_ADDRINFO_CACHE_PRIVATE_H */
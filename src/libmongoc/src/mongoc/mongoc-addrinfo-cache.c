@@ -0,0 +1,275 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "mongoc-addrinfo-cache-private.h"
+
+#include "mongoc-counters-private.h"
+#include "mongoc-trace-private.h"
+#include "utlist.h"
+
+#include <common-thread-private.h>
+
+#undef MONGOC_LOG_DOMAIN
+#define MONGOC_LOG_DOMAIN "addrinfo-cache"
+
+
+struct _mongoc_addrinfo_t {
+   struct _mongoc_addrinfo_t *next;
+   char host[BSON_HOST_NAME_MAX + 1];
+   uint16_t port;
+   int family;
+   struct addrinfo *results;
+   struct addrinfo *preferred;
+   int64_t resolved_at; /* monotonic microseconds */
+   int refs;            /* one is held by the cache while the entry is listed */
+};
+
+static mongoc_addrinfo_t *addrinfo_cache;
+static bson_mutex_t addrinfo_cache_mutex;
+
+
+static bool
+_addrinfo_matches (const mongoc_addrinfo_t *entry, const mongoc_host_list_t *host)
+{
+   return entry->port == host->port && entry->family == host->family && strcasecmp (entry->host, host->host) == 0;
+}
+
+
+/* requires addrinfo_cache_mutex. returns true if the last reference was
+ * dropped and the caller must destroy @entry. */
+static bool
+_addrinfo_unref (mongoc_addrinfo_t *entry)
+{
+   BSON_ASSERT (entry->refs > 0);
+   return --entry->refs == 0;
+}
+
+
+static void
+_addrinfo_destroy (mongoc_addrinfo_t *entry)
+{
+   freeaddrinfo (entry->results);
+   bson_free (entry);
+}
+
+
+/* requires addrinfo_cache_mutex. returns the unlisted entry if it must be
+ * destroyed. */
+static mongoc_addrinfo_t *
+_addrinfo_cache_remove (const mongoc_host_list_t *host)
+{
+   mongoc_addrinfo_t *entry;
+
+   LL_FOREACH (addrinfo_cache, entry)
+   {
+      if (_addrinfo_matches (entry, host)) {
+         LL_DELETE (addrinfo_cache, entry);
+         return _addrinfo_unref (entry) ? entry : NULL;
+      }
+   }
+
+   return NULL;
+}
+
+
+void
+_mongoc_addrinfo_cache_init (void)
+{
+   bson_mutex_init (&addrinfo_cache_mutex);
+}
+
+
+void
+_mongoc_addrinfo_cache_cleanup (void)
+{
+   _mongoc_addrinfo_cache_clear ();
+   bson_mutex_destroy (&addrinfo_cache_mutex);
+}
+
+
+mongoc_addrinfo_t *
+_mongoc_addrinfo_cache_get (const mongoc_host_list_t *host, int64_t max_age_ms)
+{
+   mongoc_addrinfo_t *entry;
+   mongoc_addrinfo_t *expired = NULL;
+   struct addrinfo hints;
+   struct addrinfo *results;
+   char portstr[8];
+   int64_t now;
+
+   ENTRY;
+
+   BSON_ASSERT_PARAM (host);
+
+   bson_mutex_lock (&addrinfo_cache_mutex);
+   now = bson_get_monotonic_time ();
+   LL_FOREACH (addrinfo_cache, entry)
+   {
+      if (_addrinfo_matches (entry, host)) {
+         break;
+      }
+   }
+
+   if (entry) {
+      if (now - entry->resolved_at <= max_age_ms * 1000) {
+         entry->refs++;
+         bson_mutex_unlock (&addrinfo_cache_mutex);
+         TRACE ("cached addresses for %s", host->host_and_port);
+         RETURN (entry);
+      }
+
+      expired = _addrinfo_cache_remove (host);
+   }
+   bson_mutex_unlock (&addrinfo_cache_mutex);
+
+   if (expired) {
+      _addrinfo_destroy (expired);
+   }
+
+   bson_snprintf (portstr, sizeof portstr, "%hu", host->port);
+
+   memset (&hints, 0, sizeof hints);
+   hints.ai_family = host->family;
+   hints.ai_socktype = SOCK_STREAM;
+   hints.ai_flags = 0;
+   hints.ai_protocol = 0;
+
+   TRACE ("DNS lookup for %s", host->host);
+   if (getaddrinfo (host->host, portstr, &hints, &results) != 0) {
+      mongoc_counter_dns_failure_inc ();
+      TRACE ("Failed to resolve %s", host->host);
+      RETURN (NULL);
+   }
+
+   mongoc_counter_dns_success_inc ();
+
+   entry = (mongoc_addrinfo_t *) bson_malloc0 (sizeof *entry);
+   bson_strncpy (entry->host, host->host, sizeof entry->host);
+   entry->port = host->port;
+   entry->family = host->family;
+   entry->results = results;
+   entry->resolved_at = bson_get_monotonic_time ();
+   entry->refs = 2;
+
+   /* a concurrent lookup of the same host may have finished first; the newer
+    * result replaces it. */
+   bson_mutex_lock (&addrinfo_cache_mutex);
+   expired = _addrinfo_cache_remove (host);
+   LL_PREPEND (addrinfo_cache, entry);
+   bson_mutex_unlock (&addrinfo_cache_mutex);
+
+   if (expired) {
+      _addrinfo_destroy (expired);
+   }
+
+   RETURN (entry);
+}
+
+
+void
+_mongoc_addrinfo_cache_invalidate (const mongoc_host_list_t *host)
+{
+   mongoc_addrinfo_t *removed;
+
+   BSON_ASSERT_PARAM (host);
+
+   bson_mutex_lock (&addrinfo_cache_mutex);
+   removed = _addrinfo_cache_remove (host);
+   bson_mutex_unlock (&addrinfo_cache_mutex);
+
+   if (removed) {
+      _addrinfo_destroy (removed);
+   }
+}
+
+
+void
+_mongoc_addrinfo_cache_clear (void)
+{
+   mongoc_addrinfo_t *iter;
+   mongoc_addrinfo_t *tmp;
+   mongoc_addrinfo_t *removed = NULL;
+
+   bson_mutex_lock (&addrinfo_cache_mutex);
+   LL_FOREACH_SAFE (addrinfo_cache, iter, tmp)
+   {
+      LL_DELETE (addrinfo_cache, iter);
+      if (_addrinfo_unref (iter)) {
+         LL_PREPEND (removed, iter);
+      }
+   }
+   bson_mutex_unlock (&addrinfo_cache_mutex);
+
+   LL_FOREACH_SAFE (removed, iter, tmp)
+   {
+      _addrinfo_destroy (iter);
+   }
+}
+
+
+struct addrinfo *
+_mongoc_addrinfo_results (const mongoc_addrinfo_t *addrinfo)
+{
+   BSON_ASSERT_PARAM (addrinfo);
+
+   return addrinfo->results;
+}
+
+
+struct addrinfo *
+_mongoc_addrinfo_preferred (mongoc_addrinfo_t *addrinfo)
+{
+   struct addrinfo *preferred;
+
+   BSON_ASSERT_PARAM (addrinfo);
+
+   bson_mutex_lock (&addrinfo_cache_mutex);
+   preferred = addrinfo->preferred;
+   bson_mutex_unlock (&addrinfo_cache_mutex);
+
+   return preferred;
+}
+
+
+void
+_mongoc_addrinfo_set_preferred (mongoc_addrinfo_t *addrinfo, struct addrinfo *preferred)
+{
+   BSON_ASSERT_PARAM (addrinfo);
+
+   bson_mutex_lock (&addrinfo_cache_mutex);
+   addrinfo->preferred = preferred;
+   bson_mutex_unlock (&addrinfo_cache_mutex);
+}
+
+
+void
+_mongoc_addrinfo_release (mongoc_addrinfo_t *addrinfo)
+{
+   bool destroy;
+
+   if (!addrinfo) {
+      return;
+   }
+
+   bson_mutex_lock (&addrinfo_cache_mutex);
+   destroy = _addrinfo_unref (addrinfo);
+   bson_mutex_unlock (&addrinfo_cache_mutex);
+
+   if (destroy) {
+      _addrinfo_destroy (addrinfo);
+   }
+}
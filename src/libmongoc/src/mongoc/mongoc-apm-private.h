@@ -46,9 +46,17 @@ struct _mongoc_apm_callbacks_t {
  * command monitoring events
  */
 
+/* The command and reply documents are materialized from their sources by the
+ * first call to the event's getter, so callbacks that only read metrics never
+ * copy, redact, or re-assemble them. Events only live for the duration of the
+ * callback, so the sources remain valid. */
+
 struct _mongoc_apm_command_started_t {
-   bson_t *command;
+   bson_t *command; /* NULL until materialized */
    bool command_owned;
+   const bson_t *source;
+   const struct _mongoc_cmd_t *cmd; /* for its document sequences, or NULL */
+   bool is_redacted;
    const char *database_name;
    const char *command_name;
    int64_t request_id;
@@ -62,8 +70,10 @@ struct _mongoc_apm_command_started_t {
 
 struct _mongoc_apm_command_succeeded_t {
    int64_t duration;
-   bson_t *reply;
+   bson_t *reply; /* NULL until materialized */
    bool reply_owned;
+   const bson_t *source;
+   bool redact;
    const char *command_name;
    const char *database_name;
    int64_t request_id;
@@ -80,8 +90,10 @@ struct _mongoc_apm_command_failed_t {
    const char *command_name;
    const char *database_name;
    const bson_error_t *error;
-   bson_t *reply;
+   bson_t *reply; /* NULL until materialized */
    bool reply_owned;
+   const bson_t *source;
+   bool redact;
    int64_t request_id;
    int64_t operation_id;
    const mongoc_host_list_t *host;
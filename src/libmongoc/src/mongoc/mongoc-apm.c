@@ -59,7 +59,8 @@ mongoc_apm_redact_reply (bson_t *reply);
  *
  * mongoc_apm_command_started_init --
  *
- *       Initialises the command started event.
+ *       Initialises the command started event. @command is not copied;
+ *       it must remain valid until the event is cleaned up.
  *
  * Side effects:
  *       If provided, is_redacted indicates whether the command document was
@@ -81,48 +82,14 @@ mongoc_apm_command_started_init (mongoc_apm_command_started_t *event,
                                  bool *is_redacted, /* out */
                                  void *context)
 {
-   bson_iter_t iter;
-   uint32_t len;
-   const uint8_t *data;
-
-   /* Command Monitoring Spec:
-    *
-    * In cases where queries or commands are embedded in a $query parameter
-    * when a read preference is provided, they MUST be unwrapped and the value
-    * of the $query attribute becomes the filter or the command in the started
-    * event. The read preference will subsequently be dropped as it is
-    * considered metadata and metadata is not currently provided in the command
-    * events.
-    */
-   if (bson_has_field (command, "$readPreference")) {
-      if (bson_iter_init_find (&iter, command, "$query") && BSON_ITER_HOLDS_DOCUMENT (&iter)) {
-         bson_iter_document (&iter, &len, &data);
-         event->command = bson_new_from_data (data, len);
-         event->command_owned = true;
-      } else {
-         /* Got $readPreference without $query, probably OP_MSG */
-         event->command = (bson_t *) command;
-         event->command_owned = false;
-      }
-   } else {
-      /* discard "const", we promise not to modify "command" */
-      event->command = (bson_t *) command;
-      event->command_owned = false;
-   }
-
-   if (mongoc_apm_is_sensitive_command_message (command_name, command)) {
-      if (!event->command_owned) {
-         event->command = bson_copy (event->command);
-         event->command_owned = true;
-      }
-
-      if (is_redacted) {
-         *is_redacted = true;
-      }
+   event->command = NULL;
+   event->command_owned = false;
+   event->source = command;
+   event->cmd = NULL;
+   event->is_redacted = mongoc_apm_is_sensitive_command_message (command_name, command);
 
-      mongoc_apm_redact_command (event->command);
-   } else if (is_redacted) {
-      *is_redacted = false;
+   if (is_redacted) {
+      *is_redacted = event->is_redacted;
    }
 
    event->database_name = database_name;
@@ -142,7 +109,8 @@ mongoc_apm_command_started_init (mongoc_apm_command_started_t *event,
  *
  * mongoc_apm_command_started_init_with_cmd --
  *
- *       Initialises the command started event from a mongoc_cmd_t.
+ *       Initialises the command started event from a mongoc_cmd_t, which
+ *       must remain valid until the event is cleaned up.
  *
  * Side effects:
  *       If provided, is_redacted indicates whether the command document was
@@ -171,7 +139,54 @@ mongoc_apm_command_started_init_with_cmd (mongoc_apm_command_started_t *event,
                                     context);
 
    /* OP_MSG document sequence for insert, update, or delete? */
-   append_documents_from_cmd (cmd, event);
+   event->cmd = cmd;
+}
+
+
+/* build the command document the first time a callback asks for it. */
+static void
+_mongoc_apm_command_started_materialize (mongoc_apm_command_started_t *event)
+{
+   bson_iter_t iter;
+   uint32_t len;
+   const uint8_t *data;
+
+   if (event->command) {
+      return;
+   }
+
+   /* Command Monitoring Spec:
+    *
+    * In cases where queries or commands are embedded in a $query parameter
+    * when a read preference is provided, they MUST be unwrapped and the value
+    * of the $query attribute becomes the filter or the command in the started
+    * event. The read preference will subsequently be dropped as it is
+    * considered metadata and metadata is not currently provided in the command
+    * events.
+    */
+   if (bson_has_field (event->source, "$readPreference") && bson_iter_init_find (&iter, event->source, "$query") &&
+       BSON_ITER_HOLDS_DOCUMENT (&iter)) {
+      bson_iter_document (&iter, &len, &data);
+      event->command = bson_new_from_data (data, len);
+      event->command_owned = true;
+   } else {
+      /* discard "const", we promise not to modify "command" */
+      event->command = (bson_t *) event->source;
+      event->command_owned = false;
+   }
+
+   if (event->is_redacted) {
+      if (!event->command_owned) {
+         event->command = bson_copy (event->command);
+         event->command_owned = true;
+      }
+
+      mongoc_apm_redact_command (event->command);
+   }
+
+   if (event->cmd) {
+      append_documents_from_cmd (event->cmd, event);
+   }
 }
 
 
@@ -184,11 +199,35 @@ mongoc_apm_command_started_cleanup (mongoc_apm_command_started_t *event)
 }
 
 
+/* build the reply document the first time a callback asks for it. */
+static bson_t *
+_mongoc_apm_materialize_reply (const bson_t *source, bool redact, bson_t **reply, bool *reply_owned)
+{
+   if (*reply) {
+      return *reply;
+   }
+
+   if (redact) {
+      *reply = bson_copy (source);
+      *reply_owned = true;
+
+      mongoc_apm_redact_reply (*reply);
+   } else {
+      /* discard "const", we promise not to modify "reply" */
+      *reply = (bson_t *) source;
+      *reply_owned = false;
+   }
+
+   return *reply;
+}
+
+
 /*--------------------------------------------------------------------------
  *
  * mongoc_apm_command_succeeded_init --
  *
- *       Initialises the command succeeded event.
+ *       Initialises the command succeeded event. @reply is not copied; it
+ *       must remain valid until the event is cleaned up.
  *
  * Parameters:
  *       @force_redaction: If true, the reply document is always redacted,
@@ -213,16 +252,10 @@ mongoc_apm_command_succeeded_init (mongoc_apm_command_succeeded_t *event,
 {
    BSON_ASSERT (reply);
 
-   if (force_redaction || mongoc_apm_is_sensitive_command_message (command_name, reply)) {
-      event->reply = bson_copy (reply);
-      event->reply_owned = true;
-
-      mongoc_apm_redact_reply (event->reply);
-   } else {
-      /* discard "const", we promise not to modify "reply" */
-      event->reply = (bson_t *) reply;
-      event->reply_owned = false;
-   }
+   event->reply = NULL;
+   event->reply_owned = false;
+   event->source = reply;
+   event->redact = force_redaction || mongoc_apm_is_sensitive_command_message (command_name, reply);
 
    event->duration = duration;
    event->command_name = command_name;
@@ -251,7 +284,8 @@ mongoc_apm_command_succeeded_cleanup (mongoc_apm_command_succeeded_t *event)
  *
  * mongoc_apm_command_failed_init --
  *
- *       Initialises the command failed event.
+ *       Initialises the command failed event. @reply is not copied; it
+ *       must remain valid until the event is cleaned up.
  *
  * Parameters:
  *       @force_redaction: If true, the reply document is always redacted,
@@ -277,16 +311,10 @@ mongoc_apm_command_failed_init (mongoc_apm_command_failed_t *event,
 {
    BSON_ASSERT (reply);
 
-   if (force_redaction || mongoc_apm_is_sensitive_command_message (command_name, reply)) {
-      event->reply = bson_copy (reply);
-      event->reply_owned = true;
-
-      mongoc_apm_redact_reply (event->reply);
-   } else {
-      /* discard "const", we promise not to modify "reply" */
-      event->reply = (bson_t *) reply;
-      event->reply_owned = false;
-   }
+   event->reply = NULL;
+   event->reply_owned = false;
+   event->source = reply;
+   event->redact = force_redaction || mongoc_apm_is_sensitive_command_message (command_name, reply);
 
    event->duration = duration;
    event->command_name = command_name;
@@ -321,10 +349,29 @@ mongoc_apm_command_failed_cleanup (mongoc_apm_command_failed_t *event)
 const bson_t *
 mongoc_apm_command_started_get_command (const mongoc_apm_command_started_t *event)
 {
+   /* discard "const", materializing does not change the event's contents */
+   _mongoc_apm_command_started_materialize ((mongoc_apm_command_started_t *) event);
+
    return event->command;
 }
 
 
+size_t
+mongoc_apm_command_started_get_command_size (const mongoc_apm_command_started_t *event)
+{
+   size_t size = event->source->len;
+   size_t i;
+
+   if (event->cmd) {
+      for (i = 0; i < event->cmd->payloads_count; i++) {
+         size += (size_t) event->cmd->payloads[i].size;
+      }
+   }
+
+   return size;
+}
+
+
 const char *
 mongoc_apm_command_started_get_database_name (const mongoc_apm_command_started_t *event)
 {
@@ -419,7 +466,17 @@ mongoc_apm_command_succeeded_get_duration (const mongoc_apm_command_succeeded_t
 const bson_t *
 mongoc_apm_command_succeeded_get_reply (const mongoc_apm_command_succeeded_t *event)
 {
-   return event->reply;
+   /* discard "const", materializing does not change the event's contents */
+   mongoc_apm_command_succeeded_t *e = (mongoc_apm_command_succeeded_t *) event;
+
+   return _mongoc_apm_materialize_reply (e->source, e->redact, &e->reply, &e->reply_owned);
+}
+
+
+size_t
+mongoc_apm_command_succeeded_get_reply_size (const mongoc_apm_command_succeeded_t *event)
+{
+   return event->source->len;
 }
 
 
@@ -528,7 +585,17 @@ mongoc_apm_command_failed_get_error (const mongoc_apm_command_failed_t *event, b
 const bson_t *
 mongoc_apm_command_failed_get_reply (const mongoc_apm_command_failed_t *event)
 {
-   return event->reply;
+   /* discard "const", materializing does not change the event's contents */
+   mongoc_apm_command_failed_t *e = (mongoc_apm_command_failed_t *) event;
+
+   return _mongoc_apm_materialize_reply (e->source, e->redact, &e->reply, &e->reply_owned);
+}
+
+
+size_t
+mongoc_apm_command_failed_get_reply_size (const mongoc_apm_command_failed_t *event)
+{
+   return event->source->len;
 }
 
 int64_t
@@ -78,6 +78,8 @@ typedef struct _mongoc_apm_server_heartbeat_failed_t mongoc_apm_server_heartbeat
 
 MONGOC_EXPORT (const bson_t *)
 mongoc_apm_command_started_get_command (const mongoc_apm_command_started_t *event);
+MONGOC_EXPORT (size_t)
+mongoc_apm_command_started_get_command_size (const mongoc_apm_command_started_t *event);
 MONGOC_EXPORT (const char *)
 mongoc_apm_command_started_get_database_name (const mongoc_apm_command_started_t *event);
 MONGOC_EXPORT (const char *)
@@ -106,6 +108,8 @@ MONGOC_EXPORT (int64_t)
 mongoc_apm_command_succeeded_get_duration (const mongoc_apm_command_succeeded_t *event);
 MONGOC_EXPORT (const bson_t *)
 mongoc_apm_command_succeeded_get_reply (const mongoc_apm_command_succeeded_t *event);
+MONGOC_EXPORT (size_t)
+mongoc_apm_command_succeeded_get_reply_size (const mongoc_apm_command_succeeded_t *event);
 MONGOC_EXPORT (const char *)
 mongoc_apm_command_succeeded_get_command_name (const mongoc_apm_command_succeeded_t *event);
 MONGOC_EXPORT (const char *)
@@ -141,6 +145,8 @@ MONGOC_EXPORT (void)
 mongoc_apm_command_failed_get_error (const mongoc_apm_command_failed_t *event, bson_error_t *error);
 MONGOC_EXPORT (const bson_t *)
 mongoc_apm_command_failed_get_reply (const mongoc_apm_command_failed_t *event);
+MONGOC_EXPORT (size_t)
+mongoc_apm_command_failed_get_reply_size (const mongoc_apm_command_failed_t *event);
 MONGOC_EXPORT (int64_t)
 mongoc_apm_command_failed_get_request_id (const mongoc_apm_command_failed_t *event);
 MONGOC_EXPORT (int64_t)
@@ -47,6 +47,8 @@ typedef struct _mongoc_async_cmd {
    mongoc_async_t *async;
    mongoc_async_cmd_state_t state;
    int events;
+   bool in_poller;
+   size_t poller_slot;
    mongoc_async_cmd_initiate_t initiator;
    mongoc_async_cmd_setup_t setup;
    void *setup_ctx;
@@ -95,6 +97,9 @@ mongoc_async_cmd_destroy (mongoc_async_cmd_t *acmd);
 bool
 mongoc_async_cmd_run (mongoc_async_cmd_t *acmd);
 
+void
+_mongoc_async_cmd_poller_remove (mongoc_async_cmd_t *acmd);
+
 #ifdef MONGOC_ENABLE_SSL
 int
 mongoc_async_cmd_tls_setup (mongoc_stream_t *stream, int *events, void *ctx, int32_t timeout_msec, bson_error_t *error);
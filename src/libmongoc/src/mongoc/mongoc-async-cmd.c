@@ -116,6 +116,9 @@ mongoc_async_cmd_run (mongoc_async_cmd_t *acmd)
 
    duration_usec = bson_get_monotonic_time () - acmd->cmd_started;
 
+   /* the callback may close the stream. */
+   _mongoc_async_cmd_poller_remove (acmd);
+
    if (result == MONGOC_ASYNC_CMD_SUCCESS) {
       acmd->cb (acmd, result, &acmd->reply, duration_usec);
    } else {
@@ -229,11 +232,24 @@ mongoc_async_cmd_new (mongoc_async_t *async,
 }
 
 
+void
+_mongoc_async_cmd_poller_remove (mongoc_async_cmd_t *acmd)
+{
+   BSON_ASSERT (acmd);
+
+   if (acmd->in_poller) {
+      _mongoc_poller_remove (acmd->async->poller, acmd->poller_slot);
+      acmd->in_poller = false;
+   }
+}
+
+
 void
 mongoc_async_cmd_destroy (mongoc_async_cmd_t *acmd)
 {
    BSON_ASSERT (acmd);
 
+   _mongoc_async_cmd_poller_remove (acmd);
    DL_DELETE (acmd->async->cmds, acmd);
    acmd->async->ncmds--;
 
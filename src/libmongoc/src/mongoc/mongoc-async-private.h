@@ -20,6 +20,7 @@
 #define MONGOC_ASYNC_PRIVATE_H
 
 #include <bson/bson.h>
+#include "mongoc-poller-private.h"
 #include "mongoc-stream.h"
 
 BSON_BEGIN_DECLS
@@ -30,6 +31,7 @@ typedef struct _mongoc_async {
    struct _mongoc_async_cmd *cmds;
    size_t ncmds;
    uint32_t request_id;
+   mongoc_poller_t *poller;
 } mongoc_async_t;
 
 typedef enum {
@@ -33,6 +33,8 @@ mongoc_async_new (void)
 {
    mongoc_async_t *async = (mongoc_async_t *) bson_malloc0 (sizeof (*async));
 
+   async->poller = _mongoc_poller_new ();
+
    return async;
 }
 
@@ -46,6 +48,7 @@ mongoc_async_destroy (mongoc_async_t *async)
       mongoc_async_cmd_destroy (acmd);
    }
 
+   _mongoc_poller_destroy (async->poller);
    bson_free (async);
 }
 
@@ -53,9 +56,8 @@ void
 mongoc_async_run (mongoc_async_t *async)
 {
    mongoc_async_cmd_t *acmd, *tmp;
-   mongoc_async_cmd_t **acmds_polled = NULL;
-   mongoc_stream_poll_t *poller = NULL;
-   int nstreams, i;
+   mongoc_poller_event_t *ready = NULL;
+   size_t nstreams;
    ssize_t nactive = 0;
    int64_t now;
    int64_t expire_at;
@@ -74,8 +76,7 @@ mongoc_async_run (mongoc_async_t *async)
    while (async->ncmds) {
       /* ncmds grows if we discover a replica & start calling hello on it */
       if (poll_size < async->ncmds) {
-         poller = (mongoc_stream_poll_t *) bson_realloc (poller, sizeof (*poller) * async->ncmds);
-         acmds_polled = (mongoc_async_cmd_t **) bson_realloc (acmds_polled, sizeof (*acmds_polled) * async->ncmds);
+         ready = (mongoc_poller_event_t *) bson_realloc (ready, sizeof (*ready) * async->ncmds);
          poll_size = async->ncmds;
       }
 
@@ -102,10 +103,15 @@ mongoc_async_run (mongoc_async_t *async)
          }
 
          if (acmd->stream) {
-            acmds_polled[nstreams] = acmd;
-            poller[nstreams].stream = acmd->stream;
-            poller[nstreams].events = acmd->events;
-            poller[nstreams].revents = 0;
+            /* streams stay registered until their cmd completes, only a
+             * change of state updates the events waited for. */
+            if (!acmd->in_poller) {
+               acmd->poller_slot = _mongoc_poller_add (async->poller, acmd->stream, acmd->events, acmd);
+               acmd->in_poller = true;
+            } else {
+               _mongoc_poller_modify (async->poller, acmd->poller_slot, acmd->events);
+            }
+
             expire_at = BSON_MIN (expire_at, acmd->connect_started + acmd->timeout_msec * 1000);
             ++nstreams;
          }
@@ -121,41 +127,37 @@ mongoc_async_run (mongoc_async_t *async)
 
       if (nstreams > 0) {
          /* we need at least one stream to poll. */
-         nactive = mongoc_stream_poll (poller, nstreams, (int32_t) poll_timeout_msec);
+         nactive = _mongoc_poller_wait (async->poller, ready, nstreams, (int32_t) poll_timeout_msec);
       } else {
          /* currently this does not get hit. we always have at least one command
           * initialized with a stream. */
          _mongoc_usleep (poll_timeout_msec * 1000);
+         nactive = 0;
       }
 
-      if (nactive > 0) {
-         for (i = 0; i < nstreams; i++) {
-            mongoc_async_cmd_t *iter = acmds_polled[i];
-            if (poller[i].revents & (POLLERR | POLLHUP)) {
-               int hup = poller[i].revents & POLLHUP;
-               if (iter->state == MONGOC_ASYNC_CMD_SEND) {
-                  bson_set_error (&iter->error,
-                                  MONGOC_ERROR_STREAM,
-                                  MONGOC_ERROR_STREAM_CONNECT,
-                                  hup ? "connection refused" : "unknown connection error");
-               } else {
-                  bson_set_error (&iter->error,
-                                  MONGOC_ERROR_STREAM,
-                                  MONGOC_ERROR_STREAM_SOCKET,
-                                  hup ? "connection closed" : "unknown socket error");
-               }
-
-               iter->state = MONGOC_ASYNC_CMD_ERROR_STATE;
+      for (ssize_t i = 0; i < nactive; i++) {
+         mongoc_async_cmd_t *iter = (mongoc_async_cmd_t *) ready[i].ctx;
+         const int revents = ready[i].revents;
+
+         if (revents & (POLLERR | POLLHUP)) {
+            int hup = revents & POLLHUP;
+            if (iter->state == MONGOC_ASYNC_CMD_SEND) {
+               bson_set_error (&iter->error,
+                               MONGOC_ERROR_STREAM,
+                               MONGOC_ERROR_STREAM_CONNECT,
+                               hup ? "connection refused" : "unknown connection error");
+            } else {
+               bson_set_error (&iter->error,
+                               MONGOC_ERROR_STREAM,
+                               MONGOC_ERROR_STREAM_SOCKET,
+                               hup ? "connection closed" : "unknown socket error");
             }
 
-            if ((poller[i].revents & poller[i].events) || iter->state == MONGOC_ASYNC_CMD_ERROR_STATE) {
-               (void) mongoc_async_cmd_run (iter);
-               nactive--;
-            }
+            iter->state = MONGOC_ASYNC_CMD_ERROR_STATE;
+         }
 
-            if (!nactive) {
-               break;
-            }
+         if ((revents & iter->events) || iter->state == MONGOC_ASYNC_CMD_ERROR_STATE) {
+            (void) mongoc_async_cmd_run (iter);
          }
       }
 
@@ -168,11 +170,13 @@ mongoc_async_run (mongoc_async_t *async)
                             MONGOC_ERROR_STREAM_CONNECT,
                             acmd->state == MONGOC_ASYNC_CMD_SEND ? "connection timeout" : "socket timeout");
 
+            _mongoc_async_cmd_poller_remove (acmd);
             acmd->cb (acmd, MONGOC_ASYNC_CMD_TIMEOUT, NULL, (now - acmd->connect_started) / 1000);
 
             /* Remove acmd from the async->cmds doubly-linked list */
             mongoc_async_cmd_destroy (acmd);
          } else if (acmd->state == MONGOC_ASYNC_CMD_CANCELED_STATE) {
+            _mongoc_async_cmd_poller_remove (acmd);
             acmd->cb (acmd, MONGOC_ASYNC_CMD_ERROR, NULL, (now - acmd->connect_started) / 1000);
 
             /* Remove acmd from the async->cmds doubly-linked list */
@@ -183,6 +187,5 @@ mongoc_async_run (mongoc_async_t *async)
       now = bson_get_monotonic_time ();
    }
 
-   bson_free (poller);
-   bson_free (acmds_polled);
+   bson_free (ready);
 }
@@ -83,6 +83,27 @@ _mongoc_buffer_init (
 }
 
 
+/**
+ * _mongoc_buffer_reserve:
+ * @buffer: A mongoc_buffer_t.
+ * @size: The number of bytes to make room for.
+ *
+ * Ensures @buffer can hold @size more bytes without reallocating. Unlike the
+ * append functions, which grow @buffer to a power of two, @buffer is grown
+ * to exactly the size needed, for callers that know the final length.
+ */
+void
+_mongoc_buffer_reserve (mongoc_buffer_t *buffer, size_t size)
+{
+   BSON_ASSERT_PARAM (buffer);
+
+   if (buffer->len + size > buffer->datalen) {
+      buffer->datalen = buffer->len + size;
+      buffer->data = (uint8_t *) buffer->realloc_func (buffer->data, buffer->datalen, buffer->realloc_data);
+   }
+}
+
+
 /**
  * _mongoc_buffer_destroy:
  * @buffer: A mongoc_buffer_t.
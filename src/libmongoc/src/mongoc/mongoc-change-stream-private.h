@@ -37,6 +37,16 @@ struct _mongoc_change_stream_t {
    mongoc_timestamp_t operation_time;
    bson_t pipeline_to_append;
    bson_t resume_token;
+
+   /* the _id of the last event returned, not yet copied to resume_token. It
+    * points into the current batch, so it is copied at the end of the batch
+    * at the latest, or sooner if the resume token is requested. */
+   bson_t resume_token_view;
+   bool resume_token_pending;
+
+   /* views of the events returned by mongoc_change_stream_next_batch. */
+   bson_t *batch;
+   size_t batch_capacity;
    bson_t *full_document;
    bson_t *full_document_before_change;
    bool show_expanded_events;
@@ -86,6 +86,18 @@ _set_resume_token (mongoc_change_stream_t *stream, const bson_t *resume_token)
 
    bson_destroy (&stream->resume_token);
    bson_copy_to (resume_token, &stream->resume_token);
+   stream->resume_token_pending = false;
+}
+
+
+/* copy the _id of the last event returned into the cached resume token. Must
+ * be called before the cursor moves past the batch the event belongs to. */
+static void
+_flush_resume_token (mongoc_change_stream_t *stream)
+{
+   if (stream->resume_token_pending) {
+      _set_resume_token (stream, &stream->resume_token_view);
+   }
 }
 
 
@@ -225,6 +237,8 @@ _make_cursor (mongoc_change_stream_t *stream)
 
    BSON_ASSERT (stream);
    BSON_ASSERT (!stream->cursor);
+   /* the event the pending token points into was freed with the cursor. */
+   BSON_ASSERT (!stream->resume_token_pending);
    bson_init (&command);
    bson_copy_to (&(stream->opts.extra), &command_opts);
 
@@ -460,6 +474,8 @@ _mongoc_change_stream_new_from_client (mongoc_client_t *client, const bson_t *pi
 const bson_t *
 mongoc_change_stream_get_resume_token (mongoc_change_stream_t *stream)
 {
+   _flush_resume_token (stream);
+
    if (!bson_empty (&stream->resume_token)) {
       return &stream->resume_token;
    }
@@ -468,11 +484,10 @@ mongoc_change_stream_get_resume_token (mongoc_change_stream_t *stream)
 }
 
 
-bool
-mongoc_change_stream_next (mongoc_change_stream_t *stream, const bson_t **bson)
+static bool
+_change_stream_next (mongoc_change_stream_t *stream, const bson_t **bson)
 {
    bson_iter_t iter;
-   bson_t doc_resume_token;
    uint32_t len;
    const uint8_t *data;
    bool ret = false;
@@ -538,10 +553,10 @@ mongoc_change_stream_next (mongoc_change_stream_t *stream, const bson_t **bson)
       goto end;
    }
 
-   /* copy the resume token. */
+   /* cache the resume token, copying it at the end of the batch. */
    bson_iter_document (&iter, &len, &data);
-   BSON_ASSERT (bson_init_static (&doc_resume_token, data, len));
-   _set_resume_token (stream, &doc_resume_token);
+   BSON_ASSERT (bson_init_static (&stream->resume_token_view, data, len));
+   stream->resume_token_pending = true;
 
    /* clear out the operation time, since we no longer need it to resume. */
    _mongoc_timestamp_clear (&stream->operation_time);
@@ -553,6 +568,8 @@ end:
        _mongoc_cursor_change_stream_end_of_batch (stream->cursor) &&
        _mongoc_cursor_change_stream_has_post_batch_resume_token (stream->cursor)) {
       _set_resume_token (stream, _mongoc_cursor_change_stream_get_post_batch_resume_token (stream->cursor));
+   } else if (stream->cursor && _mongoc_cursor_change_stream_end_of_batch (stream->cursor)) {
+      _flush_resume_token (stream);
    }
 
 
@@ -570,6 +587,50 @@ end:
    return ret;
 }
 
+bool
+mongoc_change_stream_next (mongoc_change_stream_t *stream, const bson_t **bson)
+{
+   return _change_stream_next (stream, bson);
+}
+
+bool
+mongoc_change_stream_next_batch (mongoc_change_stream_t *stream, const bson_t **docs, size_t *n_docs)
+{
+   const bson_t *doc;
+   size_t n = 0;
+
+   BSON_ASSERT (stream);
+   BSON_ASSERT (docs);
+   BSON_ASSERT (n_docs);
+
+   /* return the rest of the current batch, fetching a new one if it is done.
+    * the events stay in the cursor's reply, so only views are kept. */
+   while (_change_stream_next (stream, &doc)) {
+      if (n == stream->batch_capacity) {
+         bson_t *batch;
+
+         stream->batch_capacity = BSON_MAX (stream->batch_capacity * 2u, 16u);
+         batch = bson_aligned_alloc (BSON_ALIGNOF (bson_t), stream->batch_capacity * sizeof (bson_t));
+         if (n) {
+            memcpy (batch, stream->batch, n * sizeof (bson_t));
+         }
+         bson_free (stream->batch);
+         stream->batch = batch;
+      }
+
+      BSON_ASSERT (bson_init_static (&stream->batch[n++], bson_get_data (doc), doc->len));
+
+      if (_mongoc_cursor_change_stream_end_of_batch (stream->cursor)) {
+         break;
+      }
+   }
+
+   *docs = n ? stream->batch : NULL;
+   *n_docs = n;
+
+   return n > 0;
+}
+
 bool
 mongoc_change_stream_error_document (const mongoc_change_stream_t *stream, bson_error_t *err, const bson_t **bson)
 {
@@ -600,6 +661,7 @@ mongoc_change_stream_destroy (mongoc_change_stream_t *stream)
 
    bson_destroy (&stream->pipeline_to_append);
    bson_destroy (&stream->resume_token);
+   bson_free (stream->batch);
    bson_destroy (stream->full_document);
    bson_destroy (stream->full_document_before_change);
    bson_destroy (&stream->err_doc);
@@ -36,6 +36,9 @@ mongoc_change_stream_get_resume_token (mongoc_change_stream_t *);
 MONGOC_EXPORT (bool)
 mongoc_change_stream_next (mongoc_change_stream_t *, const bson_t **);
 
+MONGOC_EXPORT (bool)
+mongoc_change_stream_next_batch (mongoc_change_stream_t *, const bson_t **, size_t *);
+
 MONGOC_EXPORT (bool)
 mongoc_change_stream_error_document (const mongoc_change_stream_t *, bson_error_t *, const bson_t **);
 
@@ -40,6 +40,7 @@ struct _mongoc_client_pool_t {
    mongoc_uri_t *uri;
    uint32_t min_pool_size;
    uint32_t max_pool_size;
+   uint32_t min_ready_size;
    uint32_t size;
 #ifdef MONGOC_ENABLE_SSL
    bool ssl_opts_set;
@@ -207,6 +208,9 @@ mongoc_client_pool_destroy (mongoc_client_pool_t *pool)
       EXIT;
    }
 
+   /* Stop establishing connections before clients are destroyed. */
+   _mongoc_topology_background_monitoring_set_establisher (pool->topology, NULL, NULL);
+
    if (!mongoc_server_session_pool_is_empty (pool->topology->session_pool)) {
       client = mongoc_client_pool_pop (pool);
       _mongoc_client_end_sessions (client);
@@ -277,6 +281,52 @@ _initialize_new_client (mongoc_client_pool_t *pool, mongoc_client_t *client)
 #endif
 }
 
+/* Called by the topology's connection establisher thread. Grows the pool to
+ * have min_ready_size idle clients and establishes connections for idle clients. Each
+ * client is taken out of the queue only while its connections are being
+ * established, and is then returned to the head of the queue so it is the
+ * next one popped. */
+static void
+_mongoc_client_pool_establish (void *pool_void)
+{
+   mongoc_client_pool_t *pool = pool_void;
+   mongoc_client_t *client;
+   uint32_t n_to_establish;
+
+   ENTRY;
+
+   bson_mutex_lock (&pool->mutex);
+   while (_mongoc_queue_get_length (&pool->queue) < pool->min_ready_size && pool->size < pool->max_pool_size) {
+      client = _mongoc_client_new_from_topology (pool->topology);
+      BSON_ASSERT (client);
+      _initialize_new_client (pool, client);
+      _mongoc_queue_push_tail (&pool->queue, client);
+      pool->size++;
+   }
+   n_to_establish = BSON_MIN (pool->min_ready_size, _mongoc_queue_get_length (&pool->queue));
+   bson_mutex_unlock (&pool->mutex);
+
+   for (uint32_t i = 0u; i < n_to_establish; i++) {
+      bson_mutex_lock (&pool->mutex);
+      client = (mongoc_client_t *) _mongoc_queue_pop_tail (&pool->queue);
+      bson_mutex_unlock (&pool->mutex);
+
+      if (!client) {
+         /* All idle clients were popped by the application. */
+         break;
+      }
+
+      _mongoc_cluster_establish_connections (&client->cluster);
+
+      bson_mutex_lock (&pool->mutex);
+      _mongoc_queue_push_head (&pool->queue, client);
+      mongoc_cond_signal (&pool->cond);
+      bson_mutex_unlock (&pool->mutex);
+   }
+
+   EXIT;
+}
+
 mongoc_client_t *
 mongoc_client_pool_pop (mongoc_client_pool_t *pool)
 {
@@ -284,12 +334,14 @@ mongoc_client_pool_pop (mongoc_client_pool_t *pool)
    int32_t wait_queue_timeout_ms;
    int64_t expire_at_ms = -1;
    int64_t now_ms;
+   int64_t started;
    int r;
 
    ENTRY;
 
    BSON_ASSERT_PARAM (pool);
 
+   started = bson_get_monotonic_time ();
    wait_queue_timeout_ms = mongoc_uri_get_option_as_int32 (pool->uri, MONGOC_URI_WAITQUEUETIMEOUTMS, -1);
    if (wait_queue_timeout_ms > 0) {
       expire_at_ms = (bson_get_monotonic_time () / 1000) + wait_queue_timeout_ms;
@@ -325,6 +377,8 @@ again:
 done:
    bson_mutex_unlock (&pool->mutex);
 
+   mongoc_histogram_client_pool_pop_record (bson_get_monotonic_time () - started);
+
    RETURN (client);
 }
 
@@ -467,6 +521,22 @@ mongoc_client_pool_min_size (mongoc_client_pool_t *pool, uint32_t min_pool_size)
    EXIT;
 }
 
+void
+mongoc_client_pool_set_min_ready_size (mongoc_client_pool_t *pool, uint32_t min_ready_size)
+{
+   ENTRY;
+   BSON_ASSERT_PARAM (pool);
+
+   bson_mutex_lock (&pool->mutex);
+   pool->min_ready_size = min_ready_size;
+   bson_mutex_unlock (&pool->mutex);
+
+   _mongoc_topology_background_monitoring_set_establisher (
+      pool->topology, min_ready_size ? _mongoc_client_pool_establish : NULL, pool);
+
+   EXIT;
+}
+
 bool
 mongoc_client_pool_set_apm_callbacks (mongoc_client_pool_t *pool, mongoc_apm_callbacks_t *callbacks, void *context)
 {
@@ -53,6 +53,8 @@ MONGOC_EXPORT (void)
 mongoc_client_pool_max_size (mongoc_client_pool_t *pool, uint32_t max_pool_size);
 MONGOC_EXPORT (void)
 mongoc_client_pool_min_size (mongoc_client_pool_t *pool, uint32_t min_pool_size) BSON_GNUC_DEPRECATED;
+MONGOC_EXPORT (void)
+mongoc_client_pool_set_min_ready_size (mongoc_client_pool_t *pool, uint32_t min_ready_size);
 #ifdef MONGOC_ENABLE_SSL
 MONGOC_EXPORT (void)
 mongoc_client_pool_set_ssl_opts (mongoc_client_pool_t *pool, const mongoc_ssl_opt_t *opts);
@@ -94,6 +94,9 @@ struct _mongoc_client_t {
    bool in_exhaust;
    bool is_pooled;
 
+   /* the cursor with a prefetched getMore in flight, if any. */
+   struct _mongoc_cursor_t *prefetch_cursor;
+
    mongoc_stream_initiator_t initiator;
    void *initiator_data;
 
@@ -170,6 +173,10 @@ _mongoc_client_recv (mongoc_client_t *client,
                      mongoc_server_stream_t *server_stream,
                      bson_error_t *error);
 
+/* receive the reply to a prefetched getMore before using the connection. */
+void
+_mongoc_client_finish_prefetch (mongoc_client_t *client);
+
 void
 _mongoc_client_kill_cursor (mongoc_client_t *client,
                             uint32_t server_id,
@@ -35,6 +35,7 @@
 #endif
 #endif
 
+#include "mongoc-addrinfo-cache-private.h"
 #include "mongoc-client-private.h"
 #include "mongoc-client-side-encryption-private.h"
 #include "mongoc-collection-private.h"
@@ -46,7 +47,9 @@
 #include "mongoc-log.h"
 #include "mongoc-queue-private.h"
 #include "mongoc-socket.h"
+#include "mongoc-socket-private.h"
 #include "mongoc-stream-buffered.h"
+#include "mongoc-stream-private.h"
 #include "mongoc-stream-socket.h"
 #include "mongoc-thread-private.h"
 #include "mongoc-trace-private.h"
@@ -597,57 +600,53 @@ mongoc_stream_t *
 mongoc_client_connect_tcp (int32_t connecttimeoutms, const mongoc_host_list_t *host, bson_error_t *error)
 {
    mongoc_socket_t *sock = NULL;
-   struct addrinfo hints;
-   struct addrinfo *result, *rp;
+   mongoc_addrinfo_t *addrinfo;
+   struct addrinfo *preferred, *rp;
    int64_t expire_at;
-   char portstr[8];
-   int s;
 
    ENTRY;
 
    BSON_ASSERT (connecttimeoutms);
    BSON_ASSERT (host);
 
-   bson_snprintf (portstr, sizeof portstr, "%hu", host->port);
-
-   memset (&hints, 0, sizeof hints);
-   hints.ai_family = host->family;
-   hints.ai_socktype = SOCK_STREAM;
-   hints.ai_flags = 0;
-   hints.ai_protocol = 0;
-
-   TRACE ("DNS lookup for %s", host->host);
-   s = getaddrinfo (host->host, portstr, &hints, &result);
-
-   if (s != 0) {
-      mongoc_counter_dns_failure_inc ();
-      TRACE ("Failed to resolve %s", host->host);
+   addrinfo = _mongoc_addrinfo_cache_get (host, MONGOC_ADDRINFO_CACHE_TIMEOUT_MS);
+   if (!addrinfo) {
       bson_set_error (
          error, MONGOC_ERROR_STREAM, MONGOC_ERROR_STREAM_NAME_RESOLUTION, "Failed to resolve %s", host->host);
       RETURN (NULL);
    }
 
-   mongoc_counter_dns_success_inc ();
+   /* try the address the last connection to this host used first. */
+   preferred = _mongoc_addrinfo_preferred (addrinfo);
+   rp = preferred ? preferred : _mongoc_addrinfo_results (addrinfo);
 
-   for (rp = result; rp; rp = rp->ai_next) {
+   while (rp) {
       /*
        * Create a new non-blocking socket.
        */
-      if (!(sock = mongoc_socket_new (rp->ai_family, rp->ai_socktype, rp->ai_protocol))) {
-         continue;
-      }
+      if ((sock = mongoc_socket_new (rp->ai_family, rp->ai_socktype, rp->ai_protocol))) {
+         /*
+          * Try to connect to the peer.
+          */
+         expire_at = bson_get_monotonic_time () + (connecttimeoutms * 1000L);
+         if (0 == mongoc_socket_connect (sock, rp->ai_addr, (mongoc_socklen_t) rp->ai_addrlen, expire_at)) {
+            break;
+         }
 
-      /*
-       * Try to connect to the peer.
-       */
-      expire_at = bson_get_monotonic_time () + (connecttimeoutms * 1000L);
-      if (0 != mongoc_socket_connect (sock, rp->ai_addr, (mongoc_socklen_t) rp->ai_addrlen, expire_at)) {
          mongoc_socket_destroy (sock);
          sock = NULL;
-         continue;
       }
 
-      break;
+      if (rp == preferred) {
+         /* fall back to every other address, in order. */
+         rp = _mongoc_addrinfo_results (addrinfo);
+      } else {
+         rp = rp->ai_next;
+      }
+
+      if (rp && rp == preferred) {
+         rp = rp->ai_next;
+      }
    }
 
    if (!sock) {
@@ -656,11 +655,13 @@ mongoc_client_connect_tcp (int32_t connecttimeoutms, const mongoc_host_list_t *h
                       MONGOC_ERROR_STREAM_CONNECT,
                       "Failed to connect to target host: %s",
                       host->host_and_port);
-      freeaddrinfo (result);
+      _mongoc_addrinfo_cache_invalidate (host);
+      _mongoc_addrinfo_release (addrinfo);
       RETURN (NULL);
    }
 
-   freeaddrinfo (result);
+   _mongoc_addrinfo_set_preferred (addrinfo, rp);
+   _mongoc_addrinfo_release (addrinfo);
 
    return mongoc_stream_socket_new (sock);
 }
@@ -768,6 +769,21 @@ mongoc_client_connect (bool buffered,
       break;
    }
 
+   if (base_stream && mongoc_uri_get_option_as_bool (uri, MONGOC_URI_IOURING, false)) {
+      if (!_mongoc_stream_socket_use_uring (base_stream)) {
+         MONGOC_DEBUG ("io_uring is unavailable, using poll() for %s", host->host_and_port);
+      }
+   }
+
+   if (base_stream && host->family != AF_UNIX) {
+      const int32_t zerocopy_threshold = mongoc_uri_get_option_as_int32 (uri, MONGOC_URI_ZEROCOPYTHRESHOLD, 0);
+      mongoc_socket_t *const sock = mongoc_stream_socket_get_socket ((mongoc_stream_socket_t *) base_stream);
+
+      if (zerocopy_threshold > 0 && !_mongoc_socket_set_zerocopy (sock, (size_t) zerocopy_threshold)) {
+         MONGOC_DEBUG ("MSG_ZEROCOPY is unavailable, copying sends to %s", host->host_and_port);
+      }
+   }
+
 #ifdef MONGOC_ENABLE_SSL
    if (base_stream) {
       mongoc_ssl_opt_t *ssl_opts;
@@ -2059,6 +2075,17 @@ _mongoc_client_prepare_killcursors_command (int64_t cursor_id, const char *colle
 }
 
 
+void
+_mongoc_client_finish_prefetch (mongoc_client_t *client)
+{
+   BSON_ASSERT_PARAM (client);
+
+   if (client->prefetch_cursor) {
+      _mongoc_cursor_prefetch_finish (client->prefetch_cursor);
+   }
+}
+
+
 void
 _mongoc_client_kill_cursor (mongoc_client_t *client,
                             uint32_t server_id,
@@ -2620,6 +2647,10 @@ mongoc_client_select_server (mongoc_client_t *client,
       return NULL;
    }
 
+   /* selection may scan or check the connection, which must not have a
+    * prefetched getMore reply pending. */
+   _mongoc_client_finish_prefetch (client);
+
    sd = mongoc_topology_select (client->topology, optype, prefs, NULL /* chosen read mode */, error);
    if (!sd) {
       return NULL;
@@ -2830,6 +2861,10 @@ mongoc_client_reset (mongoc_client_t *client)
 
    client->generation++;
 
+   /* A prefetched getMore reply is on a connection now shared with the parent
+    * process. The cursor reports an error instead of receiving it. */
+   client->prefetch_cursor = NULL;
+
    /* Client sessions are owned and destroyed by the user, but we keep
       local pointers to them for reference. On reset, clear our local
       set without destroying the sessions or calling endSessions.
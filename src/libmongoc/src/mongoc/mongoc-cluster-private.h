@@ -63,6 +63,19 @@ typedef struct _mongoc_cluster_t {
 
    mongoc_set_t *nodes;
    mongoc_array_t iov;
+
+   /* OP_MSG replies are read into, and decompressed into, these buffers,
+    * which are reused from one command to the next. */
+   mongoc_buffer_t recv_buffer;
+   mongoc_buffer_t decompress_buffer;
+
+   /* OP_MSG requests and replies are held in these RPC message objects and
+    * requests are converted into the send_iovecs array, all reused from one
+    * command to the next. An object is NULL while a command has taken it. */
+   mcd_rpc_message *send_rpc;
+   mcd_rpc_message *recv_rpc;
+   void *send_iovecs;
+   size_t send_iovecs_capacity;
 } mongoc_cluster_t;
 
 
@@ -81,6 +94,9 @@ mongoc_cluster_reset_sockettimeoutms (mongoc_cluster_t *cluster);
 void
 mongoc_cluster_disconnect_node (mongoc_cluster_t *cluster, uint32_t id);
 
+uint32_t
+_mongoc_cluster_establish_connections (mongoc_cluster_t *cluster);
+
 int32_t
 mongoc_cluster_get_max_bson_obj_size (mongoc_cluster_t *cluster);
 
@@ -192,6 +208,33 @@ mongoc_cluster_stream_valid (mongoc_cluster_t *cluster, mongoc_server_stream_t *
 bool
 mongoc_cluster_run_command_monitored (mongoc_cluster_t *cluster, mongoc_cmd_t *cmd, bson_t *reply, bson_error_t *error);
 
+/* A command sent with mongoc_cluster_run_command_monitored_send whose reply
+ * has not been received yet. */
+typedef struct _mongoc_cluster_pending_cmd_t {
+   int32_t request_id;
+   int64_t started;
+   bool is_redacted;
+} mongoc_cluster_pending_cmd_t;
+
+/* Split mongoc_cluster_run_command_monitored into sending the command and
+ * receiving its reply, so that the caller can do other work while the server
+ * processes the command. Nothing else may be sent or received on
+ * cmd->server_stream in between. Requires OP_MSG and does not support
+ * automatic encryption. @reply is always initialized. */
+bool
+mongoc_cluster_run_command_monitored_send (mongoc_cluster_t *cluster,
+                                           mongoc_cmd_t *cmd,
+                                           mongoc_cluster_pending_cmd_t *pending,
+                                           bson_t *reply,
+                                           bson_error_t *error);
+
+bool
+mongoc_cluster_run_command_monitored_recv (mongoc_cluster_t *cluster,
+                                           mongoc_cmd_t *cmd,
+                                           const mongoc_cluster_pending_cmd_t *pending,
+                                           bson_t *reply,
+                                           bson_error_t *error);
+
 // `mongoc_cluster_run_retryable_write` executes a write command and may apply retryable writes behavior.
 // `cmd->server_stream` is set to `*retry_server_stream` on retry. Otherwise, it is unmodified.
 // `*retry_server_stream` is set to a new stream on retry. The caller must call `mongoc_server_stream_cleanup`.
@@ -271,6 +314,9 @@ mcd_rpc_message_decompress (mcd_rpc_message *rpc, void **data, size_t *data_len)
 bool
 mcd_rpc_message_decompress_if_necessary (mcd_rpc_message *rpc, void **data, size_t *data_len);
 
+bool
+mcd_rpc_message_decompress_to_buffer (mcd_rpc_message *rpc, mongoc_buffer_t *buffer);
+
 BSON_END_DECLS
 
 
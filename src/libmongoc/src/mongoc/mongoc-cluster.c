@@ -67,6 +67,13 @@
 
 #define CHECK_CLOSED_DURATION_MSEC 1000
 
+/* the first read of a reply asks for this many bytes, more once larger
+ * replies have been received. */
+#define MONGOC_CLUSTER_RECV_BUFFER_SIZE 16384
+
+/* buffers grown past this size for a large reply are released afterward. */
+#define MONGOC_CLUSTER_RECV_BUFFER_MAX (4 * 1024 * 1024)
+
 #define IS_NOT_COMMAND(_name) (!!strcasecmp (cmd->command_name, _name))
 
 static mongoc_server_stream_t *
@@ -471,6 +478,99 @@ _handle_txn_error_labels (bool cmd_ret, const bson_error_t *cmd_err, const mongo
    _mongoc_write_error_handle_labels (cmd_ret, cmd_err, reply, cmd->server_stream->sd);
 }
 
+/* Publishes the command succeeded or failed event for a command. */
+static void
+_mongoc_cluster_monitor_reply (mongoc_cluster_t *cluster,
+                               const mongoc_cmd_t *cmd,
+                               int32_t request_id,
+                               int64_t started,
+                               bool is_redacted,
+                               bool retval,
+                               const bson_t *reply,
+                               const bson_error_t *error)
+{
+   const mongoc_apm_callbacks_t *callbacks = &cluster->client->apm_callbacks;
+   const mongoc_server_stream_t *server_stream = cmd->server_stream;
+   const uint32_t server_id = server_stream->sd->id;
+   const int64_t duration = bson_get_monotonic_time () - started;
+   mongoc_apm_command_succeeded_t succeeded_event;
+   mongoc_apm_command_failed_t failed_event;
+
+   _mongoc_histogram_command_record (cmd->command_name, duration);
+
+   if (retval && callbacks->succeeded) {
+      bson_t fake_reply = BSON_INITIALIZER;
+      /*
+       * Unacknowledged writes must provide a CommandSucceededEvent with an
+       * {ok: 1} reply.
+       * https://github.com/mongodb/specifications/blob/master/source/command-logging-and-monitoring/command-logging-and-monitoring.rst#unacknowledged-acknowledged-writes
+       */
+      if (!cmd->is_acknowledged) {
+         bson_append_int32 (&fake_reply, "ok", 2, 1);
+      }
+      mongoc_apm_command_succeeded_init (&succeeded_event,
+                                         duration,
+                                         cmd->is_acknowledged ? reply : &fake_reply,
+                                         cmd->command_name,
+                                         cmd->db_name,
+                                         request_id,
+                                         cmd->operation_id,
+                                         &server_stream->sd->host,
+                                         server_id,
+                                         &server_stream->sd->service_id,
+                                         server_stream->sd->server_connection_id,
+                                         is_redacted,
+                                         cluster->client->apm_context);
+
+      callbacks->succeeded (&succeeded_event);
+      mongoc_apm_command_succeeded_cleanup (&succeeded_event);
+      bson_destroy (&fake_reply);
+   }
+   if (!retval && callbacks->failed) {
+      mongoc_apm_command_failed_init (&failed_event,
+                                      duration,
+                                      cmd->command_name,
+                                      cmd->db_name,
+                                      error,
+                                      reply,
+                                      request_id,
+                                      cmd->operation_id,
+                                      &server_stream->sd->host,
+                                      server_id,
+                                      &server_stream->sd->service_id,
+                                      server_stream->sd->server_connection_id,
+                                      is_redacted,
+                                      cluster->client->apm_context);
+
+      callbacks->failed (&failed_event);
+      mongoc_apm_command_failed_cleanup (&failed_event);
+   }
+}
+
+/* Applies the SDAM and transaction side effects of a command reply. */
+static void
+_mongoc_cluster_handle_reply (
+   mongoc_cluster_t *cluster, mongoc_cmd_t *cmd, bool retval, bson_t *reply, const bson_error_t *error)
+{
+   bson_iter_t iter;
+
+   _handle_not_primary_error (cluster, cmd->server_stream, reply);
+
+   _handle_txn_error_labels (retval, error, cmd, reply);
+
+   if (retval && _in_sharded_or_loadbalanced_txn (cmd->session) &&
+       bson_iter_init_find (&iter, reply, "recoveryToken")) {
+      bson_destroy (cmd->session->recovery_token);
+      if (BSON_ITER_HOLDS_DOCUMENT (&iter)) {
+         cmd->session->recovery_token = bson_new_from_data (bson_iter_value (&iter)->value.v_doc.data,
+                                                            bson_iter_value (&iter)->value.v_doc.data_len);
+      } else {
+         MONGOC_ERROR ("Malformed recovery token from server");
+         cmd->session->recovery_token = NULL;
+      }
+   }
+}
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -497,13 +597,10 @@ mongoc_cluster_run_command_monitored (mongoc_cluster_t *cluster, mongoc_cmd_t *c
    uint32_t server_id;
    mongoc_apm_callbacks_t *callbacks;
    mongoc_apm_command_started_t started_event;
-   mongoc_apm_command_succeeded_t succeeded_event;
-   mongoc_apm_command_failed_t failed_event;
    int64_t started = bson_get_monotonic_time ();
    const mongoc_server_stream_t *server_stream;
    bson_t reply_local;
    bson_error_t error_local;
-   bson_iter_t iter;
    bson_t encrypted = BSON_INITIALIZER;
    bson_t decrypted = BSON_INITIALIZER;
    mongoc_cmd_t encrypted_cmd;
@@ -541,53 +638,7 @@ mongoc_cluster_run_command_monitored (mongoc_cluster_t *cluster, mongoc_cmd_t *c
 
    retval = mongoc_cluster_run_opmsg (cluster, cmd, reply, error);
 
-   if (retval && callbacks->succeeded) {
-      bson_t fake_reply = BSON_INITIALIZER;
-      /*
-       * Unacknowledged writes must provide a CommandSucceededEvent with an
-       * {ok: 1} reply.
-       * https://github.com/mongodb/specifications/blob/master/source/command-logging-and-monitoring/command-logging-and-monitoring.rst#unacknowledged-acknowledged-writes
-       */
-      if (!cmd->is_acknowledged) {
-         bson_append_int32 (&fake_reply, "ok", 2, 1);
-      }
-      mongoc_apm_command_succeeded_init (&succeeded_event,
-                                         bson_get_monotonic_time () - started,
-                                         cmd->is_acknowledged ? reply : &fake_reply,
-                                         cmd->command_name,
-                                         cmd->db_name,
-                                         request_id,
-                                         cmd->operation_id,
-                                         &server_stream->sd->host,
-                                         server_id,
-                                         &server_stream->sd->service_id,
-                                         server_stream->sd->server_connection_id,
-                                         is_redacted,
-                                         cluster->client->apm_context);
-
-      callbacks->succeeded (&succeeded_event);
-      mongoc_apm_command_succeeded_cleanup (&succeeded_event);
-      bson_destroy (&fake_reply);
-   }
-   if (!retval && callbacks->failed) {
-      mongoc_apm_command_failed_init (&failed_event,
-                                      bson_get_monotonic_time () - started,
-                                      cmd->command_name,
-                                      cmd->db_name,
-                                      error,
-                                      reply,
-                                      request_id,
-                                      cmd->operation_id,
-                                      &server_stream->sd->host,
-                                      server_id,
-                                      &server_stream->sd->service_id,
-                                      server_stream->sd->server_connection_id,
-                                      is_redacted,
-                                      cluster->client->apm_context);
-
-      callbacks->failed (&failed_event);
-      mongoc_apm_command_failed_cleanup (&failed_event);
-   }
+   _mongoc_cluster_monitor_reply (cluster, cmd, request_id, started, is_redacted, retval, reply, error);
 
    if (retval && _mongoc_cse_is_enabled (cluster->client)) {
       bson_destroy (&decrypted);
@@ -600,21 +651,7 @@ mongoc_cluster_run_command_monitored (mongoc_cluster_t *cluster, mongoc_cmd_t *c
       }
    }
 
-   _handle_not_primary_error (cluster, server_stream, reply);
-
-   _handle_txn_error_labels (retval, error, cmd, reply);
-
-   if (retval && _in_sharded_or_loadbalanced_txn (cmd->session) &&
-       bson_iter_init_find (&iter, reply, "recoveryToken")) {
-      bson_destroy (cmd->session->recovery_token);
-      if (BSON_ITER_HOLDS_DOCUMENT (&iter)) {
-         cmd->session->recovery_token = bson_new_from_data (bson_iter_value (&iter)->value.v_doc.data,
-                                                            bson_iter_value (&iter)->value.v_doc.data_len);
-      } else {
-         MONGOC_ERROR ("Malformed recovery token from server");
-         cmd->session->recovery_token = NULL;
-      }
-   }
+   _mongoc_cluster_handle_reply (cluster, cmd, retval, reply, error);
 
 fail_no_events:
    if (reply == &reply_local) {
@@ -1831,6 +1868,8 @@ mongoc_cluster_disconnect_node (mongoc_cluster_t *cluster, uint32_t server_id)
 
    ENTRY;
 
+   _mongoc_client_finish_prefetch (cluster->client);
+
    if (topology->single_threaded) {
       mongoc_topology_scanner_node_t *scanner_node;
 
@@ -2231,6 +2270,9 @@ mongoc_cluster_stream_for_server (mongoc_cluster_t *cluster,
 
    BSON_ASSERT (cluster);
 
+   /* the connection must not have a prefetched getMore reply pending. */
+   _mongoc_client_finish_prefetch (cluster->client);
+
    if (cs && cs->server_id && cs->server_id != server_id) {
       _mongoc_bson_init_if_set (reply);
       bson_set_error (error,
@@ -2480,6 +2522,89 @@ _cluster_fetch_stream_pooled (mongoc_cluster_t *cluster,
    }
 }
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_cluster_establish_connections --
+ *
+ *       Connect, handshake, and authenticate to each data-bearing server in
+ *       the topology that @cluster does not already have a current
+ *       connection to. Existing connections from an earlier connection pool
+ *       generation are replaced. Used to pre-warm pooled clients, so errors
+ *       are not returned; they are handled by SDAM like any other failed
+ *       connection attempt.
+ *
+ * Returns:
+ *       The number of servers with an established connection.
+ *
+ * Side effects:
+ *       May add or replace cluster nodes, and may update the topology.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+uint32_t
+_mongoc_cluster_establish_connections (mongoc_cluster_t *cluster)
+{
+   mongoc_topology_t *const topology = BSON_ASSERT_PTR_INLINE (cluster)->client->topology;
+   mc_shared_tpld td;
+   const mongoc_set_t *servers;
+   uint32_t *server_ids;
+   size_t n_server_ids = 0u;
+   uint32_t n_established = 0u;
+
+   ENTRY;
+
+   BSON_ASSERT (!topology->single_threaded);
+
+   /* Collect server IDs first. Fetching a stream takes its own reference to
+    * the topology description and may modify it. */
+   td = mc_tpld_take_ref (topology);
+   servers = mc_tpld_servers_const (td.ptr);
+   server_ids = bson_malloc0 (sizeof (uint32_t) * (servers->items_len + 1u));
+   for (size_t i = 0u; i < servers->items_len; i++) {
+      uint32_t id;
+      const mongoc_server_description_t *sd = mongoc_set_get_item_and_id_const (servers, i, &id);
+
+      switch (sd->type) {
+      case MONGOC_SERVER_STANDALONE:
+      case MONGOC_SERVER_MONGOS:
+      case MONGOC_SERVER_RS_PRIMARY:
+      case MONGOC_SERVER_RS_SECONDARY:
+      case MONGOC_SERVER_LOAD_BALANCER:
+         server_ids[n_server_ids++] = id;
+         break;
+      case MONGOC_SERVER_UNKNOWN:
+      case MONGOC_SERVER_POSSIBLE_PRIMARY:
+      case MONGOC_SERVER_RS_ARBITER:
+      case MONGOC_SERVER_RS_OTHER:
+      case MONGOC_SERVER_RS_GHOST:
+      case MONGOC_SERVER_DESCRIPTION_TYPES:
+      default:
+         break;
+      }
+   }
+   mc_tpld_drop_ref (&td);
+
+   for (size_t i = 0u; i < n_server_ids; i++) {
+      bson_error_t error;
+      mongoc_server_stream_t *server_stream;
+
+      server_stream = mongoc_cluster_stream_for_server (cluster, server_ids[i], true, NULL, NULL, &error);
+      if (!server_stream) {
+         TRACE ("failed to establish connection to server %" PRIu32 ": %s", server_ids[i], error.message);
+         continue;
+      }
+
+      mongoc_server_stream_cleanup (server_stream);
+      n_established++;
+   }
+
+   bson_free (server_ids);
+
+   RETURN (n_established);
+}
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -2522,6 +2647,8 @@ mongoc_cluster_init (mongoc_cluster_t *cluster, const mongoc_uri_t *uri, void *c
    cluster->nodes = mongoc_set_new (8, _mongoc_cluster_node_dtor, NULL);
 
    _mongoc_array_init (&cluster->iov, sizeof (mongoc_iovec_t));
+   _mongoc_buffer_init (&cluster->recv_buffer, NULL, MONGOC_CLUSTER_RECV_BUFFER_SIZE, NULL, NULL);
+   _mongoc_buffer_init (&cluster->decompress_buffer, NULL, 0, NULL, NULL);
 
    cluster->operation_id = rand ();
 
@@ -2557,6 +2684,11 @@ mongoc_cluster_destroy (mongoc_cluster_t *cluster) /* INOUT */
    mongoc_set_destroy (cluster->nodes);
 
    _mongoc_array_destroy (&cluster->iov);
+   _mongoc_buffer_destroy (&cluster->recv_buffer);
+   _mongoc_buffer_destroy (&cluster->decompress_buffer);
+   mcd_rpc_message_destroy (cluster->send_rpc);
+   mcd_rpc_message_destroy (cluster->recv_rpc);
+   bson_free (cluster->send_iovecs);
 
    EXIT;
 }
@@ -2657,6 +2789,9 @@ _mongoc_cluster_stream_for_optype (mongoc_cluster_t *cluster,
 
    BSON_ASSERT (cluster);
 
+   /* the connection must not have a prefetched getMore reply pending. */
+   _mongoc_client_finish_prefetch (cluster->client);
+
    server_id = _mongoc_cluster_select_server_id (cs, topology, optype, read_prefs, &must_use_primary, ds, error);
 
    if (!server_id) {
@@ -2952,6 +3087,9 @@ mongoc_cluster_check_interval (mongoc_cluster_t *cluster, uint32_t server_id)
       return true;
    }
 
+   /* the ping must not be sent while a prefetched getMore reply is unread. */
+   _mongoc_client_finish_prefetch (cluster->client);
+
    scanner_node = mongoc_topology_scanner_get_node (topology->scanner, server_id);
 
    if (!scanner_node) {
@@ -3218,6 +3356,42 @@ network_error_reply (bson_t *reply, mongoc_cmd_t *cmd)
 }
 
 
+/* Takes the RPC message object cached in @cached, or a new one if a command
+ * that is still in progress holds it. */
+static mcd_rpc_message *
+_mongoc_cluster_rpc_take (mcd_rpc_message **cached)
+{
+   mcd_rpc_message *rpc = *cached;
+
+   if (!rpc) {
+      return mcd_rpc_message_new ();
+   }
+
+   *cached = NULL;
+
+   return rpc;
+}
+
+/* Returns @rpc to @cached for the next command, keeping the OP_MSG sections
+ * array if @keep_sections is true. */
+static void
+_mongoc_cluster_rpc_give_back (mcd_rpc_message **cached, mcd_rpc_message *rpc, bool keep_sections)
+{
+   if (*cached) {
+      mcd_rpc_message_destroy (rpc);
+      return;
+   }
+
+   if (keep_sections) {
+      mcd_rpc_message_recycle (rpc);
+   } else {
+      mcd_rpc_message_reset (rpc);
+   }
+
+   *cached = rpc;
+}
+
+
 static bool
 _mongoc_cluster_run_opmsg_send (
    mongoc_cluster_t *cluster, mongoc_cmd_t *cmd, mcd_rpc_message *rpc, bson_t *reply, bson_error_t *error)
@@ -3291,12 +3465,14 @@ _mongoc_cluster_run_opmsg_send (
    }
 
    size_t num_iovecs = 0u;
-   mongoc_iovec_t *const iovecs = mcd_rpc_message_to_iovecs (rpc, &num_iovecs);
-   BSON_ASSERT (iovecs);
+   BSON_ASSERT (
+      mcd_rpc_message_to_iovecs_reuse (rpc, &cluster->send_iovecs, &cluster->send_iovecs_capacity, &num_iovecs));
 
    mcd_rpc_message_egress (rpc);
-   const bool res =
-      _mongoc_stream_writev_full (server_stream->stream, iovecs, num_iovecs, cluster->sockettimeoutms, error);
+   const int64_t started = bson_get_monotonic_time ();
+   const bool res = _mongoc_stream_writev_full (
+      server_stream->stream, cluster->send_iovecs, num_iovecs, cluster->sockettimeoutms, error);
+   mongoc_histogram_op_msg_send_record (bson_get_monotonic_time () - started);
 
    if (!res) {
       RUN_CMD_ERR_DECORATE;
@@ -3305,12 +3481,89 @@ _mongoc_cluster_run_opmsg_send (
       network_error_reply (reply, cmd);
    }
 
-   bson_free (iovecs);
    bson_free (compressed_data);
 
    return res;
 }
 
+/* Reads one message from @server_stream into @buffer, replacing its contents.
+ * If no other message can follow the reply, the first read asks for as many
+ * bytes as @buffer holds so that most replies take a single read; otherwise
+ * only the length prefix is read first. @buffer then grows to exactly the
+ * message length if it is too small. */
+static bool
+_mongoc_cluster_recv_message (mongoc_cluster_t *cluster,
+                              mongoc_server_stream_t *server_stream,
+                              mongoc_buffer_t *buffer,
+                              bool read_ahead,
+                              bson_error_t *error)
+{
+   _mongoc_buffer_clear (buffer, false);
+
+   if (read_ahead) {
+      if (_mongoc_buffer_fill (buffer, server_stream->stream, sizeof (int32_t), cluster->sockettimeoutms, error) <= 0) {
+         MONGOC_DEBUG ("could not read message length, stream probably closed or timed out");
+         /* same error as the exact read below. */
+         bson_set_error (error,
+                         MONGOC_ERROR_STREAM,
+                         MONGOC_ERROR_STREAM_SOCKET,
+                         "Failed to read %zu bytes: socket error or timeout",
+                         sizeof (int32_t));
+         return false;
+      }
+   } else if (!_mongoc_buffer_append_from_stream (
+                 buffer, server_stream->stream, sizeof (int32_t), cluster->sockettimeoutms, error)) {
+      MONGOC_DEBUG ("could not read message length, stream probably closed or timed out");
+      return false;
+   }
+
+   const int32_t message_length = _int32_from_le (buffer->data);
+
+   if (message_length < message_header_length || message_length > server_stream->sd->max_msg_size) {
+      bson_set_error (error,
+                      MONGOC_ERROR_PROTOCOL,
+                      MONGOC_ERROR_PROTOCOL_INVALID_REPLY,
+                      "message length %" PRId32 " is not within valid range of %" PRId32 "-%" PRId32 " bytes",
+                      message_header_length,
+                      message_length,
+                      server_stream->sd->max_msg_size);
+      return false;
+   }
+
+   if (buffer->len > (size_t) message_length) {
+      bson_set_error (error,
+                      MONGOC_ERROR_PROTOCOL,
+                      MONGOC_ERROR_PROTOCOL_INVALID_REPLY,
+                      "received %zu bytes after a reply of %" PRId32 " bytes",
+                      buffer->len - (size_t) message_length,
+                      message_length);
+      return false;
+   }
+
+   const size_t remaining_bytes = (size_t) message_length - buffer->len;
+
+   if (remaining_bytes > 0u) {
+      _mongoc_buffer_reserve (buffer, remaining_bytes);
+
+      if (!_mongoc_buffer_append_from_stream (
+             buffer, server_stream->stream, remaining_bytes, cluster->sockettimeoutms, error)) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+/* a buffer that grew for an unusually large reply is not kept. */
+static void
+_mongoc_cluster_release_large_buffer (mongoc_buffer_t *buffer, size_t initial_size)
+{
+   if (buffer->datalen > MONGOC_CLUSTER_RECV_BUFFER_MAX) {
+      _mongoc_buffer_destroy (buffer);
+      _mongoc_buffer_init (buffer, NULL, initial_size, NULL, NULL);
+   }
+}
+
 static bool
 _mongoc_cluster_run_opmsg_recv (
    mongoc_cluster_t *cluster, mongoc_cmd_t *cmd, mcd_rpc_message *rpc, bson_t *reply, bson_error_t *error)
@@ -3322,41 +3575,18 @@ _mongoc_cluster_run_opmsg_recv (
    BSON_ASSERT_PARAM (error);
 
    bool ret = false;
+   const int64_t started = bson_get_monotonic_time ();
 
    mongoc_server_stream_t *const server_stream = cmd->server_stream;
 
-   mongoc_buffer_t buffer;
-   _mongoc_buffer_init (&buffer, NULL, 0, NULL, NULL);
-
-   if (!_mongoc_buffer_append_from_stream (
-          &buffer, server_stream->stream, sizeof (int32_t), cluster->sockettimeoutms, error)) {
-      MONGOC_DEBUG ("could not read message length, stream probably closed or timed out");
-      RUN_CMD_ERR_DECORATE;
-      _handle_network_error (cluster, server_stream, error);
-      server_stream->stream = NULL;
-      network_error_reply (reply, cmd);
-      goto done;
-   }
-
-   const int32_t message_length = _int32_from_le (buffer.data);
-
-   if (message_length < message_header_length || message_length > server_stream->sd->max_msg_size) {
-      RUN_CMD_ERR (MONGOC_ERROR_PROTOCOL,
-                   MONGOC_ERROR_PROTOCOL_INVALID_REPLY,
-                   "message length %" PRId32 " is not within valid range of %" PRId32 "-%" PRId32 " bytes",
-                   message_header_length,
-                   message_length,
-                   server_stream->sd->max_msg_size);
-      _handle_network_error (cluster, server_stream, error);
-      server_stream->stream = NULL;
-      network_error_reply (reply, cmd);
-      goto done;
-   }
-
-   const size_t remaining_bytes = (size_t) message_length - sizeof (int32_t);
+   /* an exhaust reply may be followed by another before the next request.
+    * Other streams, such as the buffered stream, may wait to fill the whole
+    * read instead of returning once the length prefix has arrived. */
+   const mongoc_stream_t *const stream = server_stream->stream;
+   const bool read_ahead = !cmd->op_msg_is_exhaust && !cluster->client->in_exhaust &&
+                           (stream->type == MONGOC_STREAM_SOCKET || stream->type == MONGOC_STREAM_TLS);
 
-   if (!_mongoc_buffer_append_from_stream (
-          &buffer, server_stream->stream, remaining_bytes, cluster->sockettimeoutms, error)) {
+   if (!_mongoc_cluster_recv_message (cluster, server_stream, &cluster->recv_buffer, read_ahead, error)) {
       RUN_CMD_ERR_DECORATE;
       _handle_network_error (cluster, server_stream, error);
       server_stream->stream = NULL;
@@ -3364,7 +3594,7 @@ _mongoc_cluster_run_opmsg_recv (
       goto done;
    }
 
-   if (!mcd_rpc_message_from_data_in_place (rpc, buffer.data, buffer.len, NULL)) {
+   if (!mcd_rpc_message_from_data_in_place (rpc, cluster->recv_buffer.data, cluster->recv_buffer.len, NULL)) {
       RUN_CMD_ERR (MONGOC_ERROR_PROTOCOL, MONGOC_ERROR_PROTOCOL_INVALID_REPLY, "malformed server message");
       _handle_network_error (cluster, server_stream, error);
       server_stream->stream = NULL;
@@ -3373,10 +3603,8 @@ _mongoc_cluster_run_opmsg_recv (
    }
    mcd_rpc_message_ingress (rpc);
 
-   void *decompressed_data = NULL;
-   size_t decompressed_data_len = 0u;
-
-   if (!mcd_rpc_message_decompress_if_necessary (rpc, &decompressed_data, &decompressed_data_len)) {
+   if (mcd_rpc_header_get_op_code (rpc) == MONGOC_OP_CODE_COMPRESSED &&
+       !mcd_rpc_message_decompress_to_buffer (rpc, &cluster->decompress_buffer)) {
       bson_set_error (
          error, MONGOC_ERROR_PROTOCOL, MONGOC_ERROR_PROTOCOL_INVALID_REPLY, "could not decompress message from server");
       _handle_network_error (cluster, server_stream, error);
@@ -3385,11 +3613,6 @@ _mongoc_cluster_run_opmsg_recv (
       GOTO (done);
    }
 
-   if (decompressed_data) {
-      _mongoc_buffer_destroy (&buffer);
-      _mongoc_buffer_init (&buffer, decompressed_data, decompressed_data_len, NULL, NULL);
-   }
-
    bson_t body;
 
    uint32_t op_msg_flags = mcd_rpc_op_msg_get_flag_bits (rpc);
@@ -3415,7 +3638,9 @@ _mongoc_cluster_run_opmsg_recv (
    bson_destroy (&body);
 
 done:
-   _mongoc_buffer_destroy (&buffer);
+   _mongoc_cluster_release_large_buffer (&cluster->recv_buffer, MONGOC_CLUSTER_RECV_BUFFER_SIZE);
+   _mongoc_cluster_release_large_buffer (&cluster->decompress_buffer, 0u);
+   mongoc_histogram_op_msg_recv_record (bson_get_monotonic_time () - started);
 
    return ret;
 }
@@ -3443,36 +3668,110 @@ mongoc_cluster_run_opmsg (mongoc_cluster_t *cluster, mongoc_cmd_t *cmd, bson_t *
       return false;
    }
 
-   bool ret = false;
-
-   mcd_rpc_message *const rpc = mcd_rpc_message_new ();
+   if (!cluster->client->in_exhaust) {
+      mcd_rpc_message *const rpc = _mongoc_cluster_rpc_take (&cluster->send_rpc);
+      const bool sent = _mongoc_cluster_run_opmsg_send (cluster, cmd, rpc, reply, error);
+      _mongoc_cluster_rpc_give_back (&cluster->send_rpc, rpc, true);
 
-   if (!cluster->client->in_exhaust && !_mongoc_cluster_run_opmsg_send (cluster, cmd, rpc, reply, error)) {
-      goto done;
+      if (!sent) {
+         return false;
+      }
    }
 
    if (!cmd->is_acknowledged) {
       // Nothing more to do.
       bson_init (reply);
-      ret = true;
-      goto done;
+      return true;
    }
 
-   mcd_rpc_message_reset (rpc);
+   mcd_rpc_message *const rpc = _mongoc_cluster_rpc_take (&cluster->recv_rpc);
+   const bool ret = _mongoc_cluster_run_opmsg_recv (cluster, cmd, rpc, reply, error);
+   _mongoc_cluster_rpc_give_back (&cluster->recv_rpc, rpc, false);
 
-   if (!_mongoc_cluster_run_opmsg_recv (cluster, cmd, rpc, reply, error)) {
-      goto done;
+   return ret;
+}
+
+
+bool
+mongoc_cluster_run_command_monitored_send (mongoc_cluster_t *cluster,
+                                           mongoc_cmd_t *cmd,
+                                           mongoc_cluster_pending_cmd_t *pending,
+                                           bson_t *reply,
+                                           bson_error_t *error)
+{
+   mongoc_apm_callbacks_t *callbacks;
+   mongoc_apm_command_started_t started_event;
+   mcd_rpc_message *rpc;
+   bool ret;
+
+   BSON_ASSERT_PARAM (cluster);
+   BSON_ASSERT_PARAM (cmd);
+   BSON_ASSERT_PARAM (pending);
+   BSON_ASSERT_PARAM (reply);
+   BSON_ASSERT_PARAM (error);
+   BSON_ASSERT (!_mongoc_cse_is_enabled (cluster->client));
+   BSON_ASSERT (!cluster->client->in_exhaust);
+   BSON_ASSERT (cmd->is_acknowledged);
+
+   pending->request_id = ++cluster->request_id;
+   pending->started = bson_get_monotonic_time ();
+   pending->is_redacted = false;
+
+   callbacks = &cluster->client->apm_callbacks;
+   if (callbacks->started) {
+      mongoc_apm_command_started_init_with_cmd (
+         &started_event, cmd, pending->request_id, &pending->is_redacted, cluster->client->apm_context);
+
+      callbacks->started (&started_event);
+      mongoc_apm_command_started_cleanup (&started_event);
    }
 
-   ret = true;
+   rpc = _mongoc_cluster_rpc_take (&cluster->send_rpc);
+   ret = _mongoc_cluster_run_opmsg_send (cluster, cmd, rpc, reply, error);
+   _mongoc_cluster_rpc_give_back (&cluster->send_rpc, rpc, true);
 
-done:
-   mcd_rpc_message_destroy (rpc);
+   if (!ret) {
+      /* reply was initialized by network_error_reply */
+      _mongoc_cluster_monitor_reply (
+         cluster, cmd, pending->request_id, pending->started, pending->is_redacted, false, reply, error);
+      _mongoc_cluster_handle_reply (cluster, cmd, false, reply, error);
+      _mongoc_topology_update_last_used (cluster->client->topology, cmd->server_stream->sd->id);
+      return false;
+   }
 
-   return ret;
+   bson_init (reply);
+   return true;
 }
 
 
+bool
+mongoc_cluster_run_command_monitored_recv (mongoc_cluster_t *cluster,
+                                           mongoc_cmd_t *cmd,
+                                           const mongoc_cluster_pending_cmd_t *pending,
+                                           bson_t *reply,
+                                           bson_error_t *error)
+{
+   mcd_rpc_message *rpc;
+   bool ret;
+
+   BSON_ASSERT_PARAM (cluster);
+   BSON_ASSERT_PARAM (cmd);
+   BSON_ASSERT_PARAM (pending);
+   BSON_ASSERT_PARAM (reply);
+   BSON_ASSERT_PARAM (error);
+
+   rpc = _mongoc_cluster_rpc_take (&cluster->recv_rpc);
+   ret = _mongoc_cluster_run_opmsg_recv (cluster, cmd, rpc, reply, error);
+   _mongoc_cluster_rpc_give_back (&cluster->recv_rpc, rpc, false);
+
+   _mongoc_cluster_monitor_reply (
+      cluster, cmd, pending->request_id, pending->started, pending->is_redacted, ret, reply, error);
+   _mongoc_cluster_handle_reply (cluster, cmd, ret, reply, error);
+   _mongoc_topology_update_last_used (cluster->client->topology, cmd->server_stream->sd->id);
+
+   return ret;
+}
+
 bool
 mcd_rpc_message_compress (mcd_rpc_message *rpc,
                           int32_t compressor_id,
@@ -3572,23 +3871,15 @@ fail:
    return ret;
 }
 
-bool
-mcd_rpc_message_decompress (mcd_rpc_message *rpc, void **data, size_t *data_len)
+// Writes the uncompressed form of @rpc, an OP_COMPRESSED message, to @ptr,
+// which has room for @original_message_length bytes.
+static bool
+_mcd_rpc_message_decompress_to (mcd_rpc_message *rpc, uint8_t *ptr, size_t original_message_length)
 {
-   BSON_ASSERT_PARAM (rpc);
-   BSON_ASSERT_PARAM (data);
-   BSON_ASSERT_PARAM (data_len);
-
-   BSON_ASSERT (mcd_rpc_header_get_op_code (rpc) == MONGOC_OP_CODE_COMPRESSED);
-
    // msgHeader consists of four int32 fields.
    const size_t message_header_length = 4u * sizeof (int32_t);
 
-   const size_t uncompressed_size = (size_t) mcd_rpc_op_compressed_get_uncompressed_size (rpc);
-
-   // uncompressedSize does not include msgHeader fields.
-   const size_t original_message_length = message_header_length + uncompressed_size;
-   uint8_t *const ptr = bson_malloc (original_message_length);
+   const size_t uncompressed_size = original_message_length - message_header_length;
 
    const int32_t message_length = original_message_length;
    const int32_t request_id = mcd_rpc_header_get_request_id (rpc);
@@ -3626,12 +3917,38 @@ mcd_rpc_message_decompress (mcd_rpc_message *rpc, void **data, size_t *data_len)
                            mcd_rpc_op_compressed_get_compressed_message_length (rpc),
                            ptr + message_header_length,
                            &actual_uncompressed_size)) {
-      bson_free (ptr);
       return false;
    }
 
    BSON_ASSERT (uncompressed_size == actual_uncompressed_size);
 
+   return true;
+}
+
+static size_t
+_mcd_rpc_message_original_length (const mcd_rpc_message *rpc)
+{
+   BSON_ASSERT (mcd_rpc_header_get_op_code (rpc) == MONGOC_OP_CODE_COMPRESSED);
+
+   // uncompressedSize does not include msgHeader fields.
+   return (size_t) message_header_length + (size_t) mcd_rpc_op_compressed_get_uncompressed_size (rpc);
+}
+
+bool
+mcd_rpc_message_decompress (mcd_rpc_message *rpc, void **data, size_t *data_len)
+{
+   BSON_ASSERT_PARAM (rpc);
+   BSON_ASSERT_PARAM (data);
+   BSON_ASSERT_PARAM (data_len);
+
+   const size_t original_message_length = _mcd_rpc_message_original_length (rpc);
+   uint8_t *const ptr = bson_malloc (original_message_length);
+
+   if (!_mcd_rpc_message_decompress_to (rpc, ptr, original_message_length)) {
+      bson_free (ptr);
+      return false;
+   }
+
    *data_len = original_message_length;
    *data = ptr; // Ownership transfer.
 
@@ -3640,6 +3957,31 @@ mcd_rpc_message_decompress (mcd_rpc_message *rpc, void **data, size_t *data_len)
    return mcd_rpc_message_from_data_in_place (rpc, *data, *data_len, NULL);
 }
 
+// Like mcd_rpc_message_decompress, but decompresses into @buffer, which is
+// cleared first and grown only if it is too small. @rpc refers to the contents
+// of @buffer afterwards.
+bool
+mcd_rpc_message_decompress_to_buffer (mcd_rpc_message *rpc, mongoc_buffer_t *buffer)
+{
+   BSON_ASSERT_PARAM (rpc);
+   BSON_ASSERT_PARAM (buffer);
+
+   const size_t original_message_length = _mcd_rpc_message_original_length (rpc);
+
+   _mongoc_buffer_clear (buffer, false);
+   _mongoc_buffer_reserve (buffer, original_message_length);
+
+   if (!_mcd_rpc_message_decompress_to (rpc, buffer->data, original_message_length)) {
+      return false;
+   }
+
+   buffer->len = original_message_length;
+
+   mcd_rpc_message_reset (rpc);
+
+   return mcd_rpc_message_from_data_in_place (rpc, buffer->data, buffer->len, NULL);
+}
+
 bool
 mcd_rpc_message_decompress_if_necessary (mcd_rpc_message *rpc, void **data, size_t *data_len)
 {
@@ -157,7 +157,8 @@ mongoc_cmd_parts_append_opts (mongoc_cmd_parts_t *parts, bson_iter_t *iter, bson
          parts->assembled.session = cs;
          continue;
       } else if (BSON_ITER_IS_KEY (iter, "serverId") || BSON_ITER_IS_KEY (iter, "maxAwaitTimeMS") ||
-                 BSON_ITER_IS_KEY (iter, "exhaust")) {
+                 BSON_ITER_IS_KEY (iter, "exhaust") || BSON_ITER_IS_KEY (iter, "prefetch") ||
+                 BSON_ITER_IS_KEY (iter, "adaptiveBatchSize")) {
          continue;
       }
 
@@ -21,6 +21,7 @@
 #include "mongoc-bulk-operation.h"
 #include "mongoc-bulk-operation-private.h"
 #include "mongoc-change-stream-private.h"
+#include "mongoc-client-pool.h"
 #include "mongoc-client-private.h"
 #include "mongoc-find-and-modify-private.h"
 #include "mongoc-find-and-modify.h"
@@ -43,6 +44,8 @@
 
 #include <bson-dsl.h>
 
+#include "common-thread-private.h"
+
 #undef MONGOC_LOG_DOMAIN
 #define MONGOC_LOG_DOMAIN "collection"
 
@@ -3524,3 +3527,352 @@ fail:
    bson_destroy (&reply_local);
    return ok;
 }
+
+
+typedef struct {
+   mongoc_client_pool_t *pool;
+   const mongoc_collection_t *collection;
+   const bson_t *find_opts;
+   mongoc_collection_parallel_scan_cb_t cb;
+   void *ctx;
+   int stop;
+   bson_mutex_t mutex;
+   bool failed;
+   bson_error_t error;
+} parallel_scan_t;
+
+typedef struct {
+   parallel_scan_t *scan;
+   uint32_t n;
+   bson_t filter;
+   bson_thread_t thread;
+} parallel_scan_partition_t;
+
+
+static void
+_parallel_scan_fail (parallel_scan_t *scan, const bson_error_t *error)
+{
+   bson_mutex_lock (&scan->mutex);
+   if (!scan->failed) {
+      scan->failed = true;
+      memcpy (&scan->error, error, sizeof (bson_error_t));
+   }
+   bson_mutex_unlock (&scan->mutex);
+
+   bson_atomic_int_exchange (&scan->stop, 1, bson_memory_order_relaxed);
+}
+
+
+static BSON_THREAD_FUN (_parallel_scan_partition_thread, partition_void)
+{
+   parallel_scan_partition_t *partition = partition_void;
+   parallel_scan_t *scan = partition->scan;
+   mongoc_client_t *client;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   bson_error_t error;
+
+   client = mongoc_client_pool_pop (scan->pool);
+   cursor = _mongoc_cursor_find_new (client,
+                                     scan->collection->ns,
+                                     &partition->filter,
+                                     scan->find_opts,
+                                     NULL /* user_prefs */,
+                                     scan->collection->read_prefs,
+                                     scan->collection->read_concern);
+
+   while (!bson_atomic_int_fetch (&scan->stop, bson_memory_order_relaxed) && mongoc_cursor_next (cursor, &doc)) {
+      if (!scan->cb (partition->n, doc, scan->ctx)) {
+         bson_atomic_int_exchange (&scan->stop, 1, bson_memory_order_relaxed);
+      }
+   }
+
+   if (mongoc_cursor_error (cursor, &error)) {
+      _parallel_scan_fail (scan, &error);
+   }
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_client_pool_push (scan->pool, client);
+
+   BSON_THREAD_RETURN;
+}
+
+
+/* appends {$op: ["$_id", {$literal: bound}]} to @and. */
+static void
+_parallel_scan_append_bound (bson_array_builder_t *and, const char *op, const bson_value_t *bound)
+{
+   bson_t cmp;
+   bson_array_builder_t *args;
+   bson_t literal;
+
+   bson_array_builder_append_document_begin (and, &cmp);
+   BSON_APPEND_ARRAY_BUILDER_BEGIN (&cmp, op, &args);
+   bson_array_builder_append_utf8 (args, "$_id", -1);
+   bson_array_builder_append_document_begin (args, &literal);
+   BSON_APPEND_VALUE (&literal, "$literal", bound);
+   bson_array_builder_append_document_end (args, &literal);
+   bson_append_array_builder_end (&cmp, args);
+   bson_array_builder_append_document_end (and, &cmp);
+}
+
+
+/* appends the filter for _id values in [lower, upper) to @filter. Either bound
+ * may be NULL for a partition at one end of the collection.
+ *
+ * Query operators like {_id: {$lt: upper}} only match values of the bound's
+ * BSON type, which would skip documents whose _id has another type. The
+ * aggregation comparisons in $expr use the BSON order across all types, as
+ * $bucketAuto does, so the ranges cover every _id. */
+static void
+_parallel_scan_partition_filter (bson_t *filter,
+                                 const bson_t *user_filter,
+                                 const bson_value_t *lower,
+                                 const bson_value_t *upper)
+{
+   bson_t range;
+   bson_t expr;
+   bson_array_builder_t *and;
+
+   bson_init (&range);
+
+   if (lower || upper) {
+      BSON_APPEND_DOCUMENT_BEGIN (&range, "$expr", &expr);
+      BSON_APPEND_ARRAY_BUILDER_BEGIN (&expr, "$and", &and);
+      if (lower) {
+         _parallel_scan_append_bound (and, "$gte", lower);
+      }
+      if (upper) {
+         _parallel_scan_append_bound (and, "$lt", upper);
+      }
+      bson_append_array_builder_end (&expr, and);
+      bson_append_document_end (&range, &expr);
+   }
+
+   if (bson_empty (user_filter)) {
+      bson_copy_to (&range, filter);
+   } else if (bson_empty (&range)) {
+      bson_copy_to (user_filter, filter);
+   } else {
+      bson_init (filter);
+      BSON_APPEND_ARRAY_BUILDER_BEGIN (filter, "$and", &and);
+      bson_array_builder_append_document (and, user_filter);
+      bson_array_builder_append_document (and, &range);
+      bson_append_array_builder_end (filter, and);
+   }
+
+   bson_destroy (&range);
+}
+
+
+/* splits the documents matching @filter into at most @n ranges of _id. The
+ * split points are the lower bounds of $bucketAuto buckets over a sample of
+ * the matching documents, excluding the first bucket. */
+static bool
+_parallel_scan_split_points (mongoc_collection_t *collection,
+                             const bson_t *filter,
+                             int32_t n,
+                             bson_t *split_points,
+                             bson_error_t *error)
+{
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   bson_array_builder_t *points;
+   bson_iter_t iter;
+   bool first = true;
+   bool ret = true;
+   bson_t *pipeline;
+   /* in 64 bits: n * 100 overflows an int32_t for large n. */
+   const int64_t sample_size = (int64_t) n * 100;
+
+   /* oversample so that the buckets are roughly equal in size. */
+   pipeline = BCON_NEW ("pipeline",
+                        "[",
+                        "{",
+                        "$match",
+                        BCON_DOCUMENT (filter),
+                        "}",
+                        "{",
+                        "$sample",
+                        "{",
+                        "size",
+                        BCON_INT64 (sample_size),
+                        "}",
+                        "}",
+                        "{",
+                        "$bucketAuto",
+                        "{",
+                        "groupBy",
+                        BCON_UTF8 ("$_id"),
+                        "buckets",
+                        BCON_INT32 (n),
+                        "}",
+                        "}",
+                        "]");
+
+   cursor = mongoc_collection_aggregate (collection, MONGOC_QUERY_NONE, pipeline, NULL, NULL);
+
+   bson_init (split_points);
+   BSON_APPEND_ARRAY_BUILDER_BEGIN (split_points, "points", &points);
+
+   while (mongoc_cursor_next (cursor, &doc)) {
+      if (!bson_iter_init (&iter, doc) || !bson_iter_find_descendant (&iter, "_id.min", &iter)) {
+         bson_set_error (error,
+                         MONGOC_ERROR_CURSOR,
+                         MONGOC_ERROR_CURSOR_INVALID_CURSOR,
+                         "Invalid $bucketAuto result while computing partitions");
+         ret = false;
+         break;
+      }
+
+      if (first) {
+         first = false;
+         continue;
+      }
+
+      bson_array_builder_append_value (points, bson_iter_value (&iter));
+   }
+
+   bson_append_array_builder_end (split_points, points);
+
+   if (ret && mongoc_cursor_error (cursor, error)) {
+      ret = false;
+   }
+
+   mongoc_cursor_destroy (cursor);
+   bson_destroy (pipeline);
+
+   return ret;
+}
+
+
+bool
+mongoc_collection_parallel_scan (mongoc_collection_t *collection,
+                                 mongoc_client_pool_t *pool,
+                                 const bson_t *filter,
+                                 const bson_t *opts,
+                                 mongoc_collection_parallel_scan_cb_t cb,
+                                 void *ctx,
+                                 bson_error_t *error)
+{
+   mongoc_parallel_scan_opts_t scan_opts;
+   parallel_scan_t scan = {0};
+   parallel_scan_partition_t *partitions = NULL;
+   bson_t empty = BSON_INITIALIZER;
+   bson_t split_points = BSON_INITIALIZER;
+   const bson_value_t *lower = NULL;
+   bson_iter_t lower_iter;
+   bson_iter_t iter;
+   uint32_t n_partitions;
+   uint32_t n_started = 0;
+   uint32_t i;
+   bool ret = false;
+
+   ENTRY;
+
+   BSON_ASSERT_PARAM (collection);
+   BSON_ASSERT_PARAM (pool);
+   BSON_ASSERT_PARAM (cb);
+
+   if (!filter) {
+      filter = &empty;
+   }
+
+   if (!_mongoc_parallel_scan_opts_parse (collection->client, opts, &scan_opts, error)) {
+      _mongoc_parallel_scan_opts_cleanup (&scan_opts);
+      bson_destroy (&split_points);
+      RETURN (false);
+   }
+
+   /* each partition runs on a different client. */
+   if (bson_has_field (&scan_opts.extra, "sessionId")) {
+      bson_set_error (error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "Cannot use a session with mongoc_collection_parallel_scan");
+      GOTO (done);
+   }
+
+   bson_destroy (&split_points);
+   if (!_parallel_scan_split_points (collection, filter, scan_opts.partitions, &split_points, error)) {
+      GOTO (done);
+   }
+
+   BSON_ASSERT (bson_iter_init_find (&iter, &split_points, "points") && bson_iter_recurse (&iter, &iter));
+   {
+      bson_iter_t count_iter = iter;
+
+      n_partitions = 1u;
+      while (bson_iter_next (&count_iter)) {
+         n_partitions++;
+      }
+   }
+   partitions = bson_malloc0 (n_partitions * sizeof (parallel_scan_partition_t));
+
+   scan.pool = pool;
+   scan.collection = collection;
+   scan.find_opts = &scan_opts.extra;
+   scan.cb = cb;
+   scan.ctx = ctx;
+   bson_mutex_init (&scan.mutex);
+
+   for (i = 0; i < n_partitions; i++) {
+      /* each split point is the upper bound of one partition and the lower
+       * bound of the next. */
+      const bson_value_t *upper = NULL;
+      bson_iter_t upper_iter = iter;
+
+      if (bson_iter_next (&iter)) {
+         upper_iter = iter;
+         upper = bson_iter_value (&upper_iter);
+      }
+
+      partitions[i].scan = &scan;
+      partitions[i].n = i;
+      _parallel_scan_partition_filter (&partitions[i].filter, filter, lower, upper);
+
+      lower_iter = upper_iter;
+      lower = upper ? bson_iter_value (&lower_iter) : NULL;
+   }
+
+   for (i = 0; i < n_partitions; i++) {
+      if (mcommon_thread_create (&partitions[i].thread, _parallel_scan_partition_thread, &partitions[i]) != 0) {
+         bson_error_t thread_error;
+
+         bson_set_error (&thread_error,
+                         MONGOC_ERROR_CLIENT,
+                         MONGOC_ERROR_CLIENT_NOT_READY,
+                         "Failed to start a thread for partition %" PRIu32,
+                         i);
+         _parallel_scan_fail (&scan, &thread_error);
+         break;
+      }
+      n_started++;
+   }
+
+   for (i = 0; i < n_started; i++) {
+      mcommon_thread_join (partitions[i].thread);
+   }
+
+   for (i = 0; i < n_partitions; i++) {
+      bson_destroy (&partitions[i].filter);
+   }
+
+   bson_mutex_destroy (&scan.mutex);
+
+   if (scan.failed) {
+      if (error) {
+         memcpy (error, &scan.error, sizeof (bson_error_t));
+      }
+      GOTO (done);
+   }
+
+   ret = true;
+
+done:
+   bson_free (partitions);
+   bson_destroy (&split_points);
+   _mongoc_parallel_scan_opts_cleanup (&scan_opts);
+
+   RETURN (ret);
+}
@@ -327,6 +327,19 @@ mongoc_collection_estimated_document_count (mongoc_collection_t *coll,
                                             bson_t *reply,
                                             bson_error_t *error);
 
+struct _mongoc_client_pool_t;
+
+typedef bool (*mongoc_collection_parallel_scan_cb_t) (uint32_t partition, const bson_t *doc, void *ctx);
+
+MONGOC_EXPORT (bool)
+mongoc_collection_parallel_scan (mongoc_collection_t *collection,
+                                 struct _mongoc_client_pool_t *pool,
+                                 const bson_t *filter,
+                                 const bson_t *opts,
+                                 mongoc_collection_parallel_scan_cb_t cb,
+                                 void *ctx,
+                                 bson_error_t *error);
+
 BSON_END_DECLS
 
 
@@ -43,6 +43,8 @@ void
 _mongoc_counters_init (void);
 void
 _mongoc_counters_cleanup (void);
+void
+_mongoc_histogram_command_record (const char *command_name, int64_t usec);
 
 
 static BSON_INLINE unsigned
@@ -149,13 +151,66 @@ enum {
 };
 
 #ifdef MONGOC_ENABLE_SHM_COUNTERS
+#ifdef MONGOC_ENABLE_THREAD_LOCAL_COUNTERS
+/*
+ * Each thread claims a column of counter slots after the per-CPU columns the
+ * first time it updates a counter. Only that thread writes to its column, so
+ * updates need no atomic read-modify-write and no cache line is shared with
+ * another core. Readers sum every column, as they do the per-CPU ones.
+ * Columns of exited threads are handed to new threads, keeping their values.
+ * Threads that find every column taken use the per-CPU slots.
+ */
+#ifndef MONGOC_COUNTERS_THREAD_COLUMNS
+#define MONGOC_COUNTERS_THREAD_COLUMNS 128
+#endif
+
+#define MONGOC_COUNTERS_THREAD_LOCAL BSON_IF_GNU_LIKE (__thread) BSON_IF_MSVC (__declspec (thread))
+
+/* one more than the thread's column, 0 if unclaimed, or -1 if none is free. */
+extern MONGOC_COUNTERS_THREAD_LOCAL int32_t _mongoc_counters_thread_column;
+
+int32_t
+_mongoc_counters_thread_column_claim (void);
+#else
+#define MONGOC_COUNTERS_THREAD_COLUMNS 0
+#endif
+
+
+/* the number of columns of counter slots: one per CPU, then one per thread. */
+static BSON_INLINE uint32_t
+_mongoc_counters_columns (void)
+{
+   return _mongoc_get_cpu_count () + MONGOC_COUNTERS_THREAD_COLUMNS;
+}
+
+
+static BSON_INLINE void
+_mongoc_counter_add (mongoc_counter_slots_t *cpus, uint32_t slot, int64_t val)
+{
+#ifdef MONGOC_ENABLE_THREAD_LOCAL_COUNTERS
+   int32_t column = _mongoc_counters_thread_column;
+
+   if (BSON_UNLIKELY (column == 0)) {
+      column = _mongoc_counters_thread_column_claim ();
+   }
+
+   if (BSON_LIKELY (column > 0)) {
+      int64_t *counter = &cpus[column - 1].slots[slot];
+
+      /* this thread is the only writer, a plain store is enough. */
+      *(volatile int64_t *) counter = bson_atomic_int64_fetch (counter, bson_memory_order_relaxed) + val;
+      return;
+   }
+#endif
+
+   bson_atomic_int64_fetch_add (&cpus[_mongoc_sched_getcpu ()].slots[slot], val, bson_memory_order_seq_cst);
+}
+
+
 #define COUNTER(ident, Category, Name, Description)                                                         \
    static BSON_INLINE void mongoc_counter_##ident##_add (int64_t val)                                       \
    {                                                                                                        \
-      int64_t *counter = &BSON_CONCAT (__mongoc_counter_, ident)                                            \
-                             .cpus[_mongoc_sched_getcpu ()]                                                 \
-                             .slots[BSON_CONCAT (COUNTER_, ident) % SLOTS_PER_CACHELINE];                   \
-      bson_atomic_int64_fetch_add (counter, val, bson_memory_order_seq_cst);                                \
+      _mongoc_counter_add (__mongoc_counter_##ident.cpus, COUNTER_##ident % SLOTS_PER_CACHELINE, val);      \
    }                                                                                                        \
    static BSON_INLINE void mongoc_counter_##ident##_inc (void)                                              \
    {                                                                                                        \
@@ -168,7 +223,7 @@ enum {
    static BSON_INLINE void mongoc_counter_##ident##_reset (void)                                            \
    {                                                                                                        \
       uint32_t i;                                                                                           \
-      for (i = 0; i < _mongoc_get_cpu_count (); i++) {                                                      \
+      for (i = 0; i < _mongoc_counters_columns (); i++) {                                                   \
          int64_t *counter = &__mongoc_counter_##ident.cpus[i].slots[COUNTER_##ident % SLOTS_PER_CACHELINE]; \
          bson_atomic_int64_exchange (counter, 0, bson_memory_order_seq_cst);                                \
       }                                                                                                     \
@@ -178,7 +233,7 @@ enum {
    {                                                                                                        \
       int32_t _sum = 0;                                                                                     \
       uint32_t _i;                                                                                          \
-      for (_i = 0; _i < _mongoc_get_cpu_count (); _i++) {                                                   \
+      for (_i = 0; _i < _mongoc_counters_columns (); _i++) {                                                \
          const int64_t *counter = &BSON_CONCAT (__mongoc_counter_, ident)                                   \
                                       .cpus[_i]                                                             \
                                       .slots[BSON_CONCAT (COUNTER_, ident) % SLOTS_PER_CACHELINE];          \
@@ -211,6 +266,141 @@ enum {
 #undef COUNTER
 #endif
 
+/*
+ * Latency histograms, in microseconds. Like HdrHistogram, values below
+ * MONGOC_HISTOGRAM_SUB_BUCKETS have a bucket each, and every power of two
+ * above that is split into MONGOC_HISTOGRAM_SUB_BUCKETS buckets, so each
+ * bucket is within 1/8 of the values it holds. Values past the last bucket,
+ * about 67 seconds, are counted in it.
+ */
+
+#define MONGOC_HISTOGRAM_SUB_BUCKETS 8
+#define MONGOC_HISTOGRAM_BUCKETS 192
+
+
+typedef struct {
+   int64_t buckets[MONGOC_HISTOGRAM_BUCKETS];
+   int64_t sum;
+   int64_t padding[SLOTS_PER_CACHELINE - 1];
+} mongoc_histogram_slots_t;
+
+
+BSON_STATIC_ASSERT2 (histogram_slots_t, sizeof (mongoc_histogram_slots_t) % 64 == 0);
+
+
+typedef struct {
+   mongoc_histogram_slots_t *cpus;
+} mongoc_histogram_t;
+
+
+static BSON_INLINE uint32_t
+_mongoc_histogram_bucket (int64_t usec)
+{
+   uint64_t value = usec > 0 ? (uint64_t) usec : 0u;
+   uint32_t shift = 0;
+
+   if (value < MONGOC_HISTOGRAM_SUB_BUCKETS) {
+      return (uint32_t) value;
+   }
+
+   while ((value >> shift) >= 2u * MONGOC_HISTOGRAM_SUB_BUCKETS) {
+      shift++;
+   }
+
+   if (shift >= MONGOC_HISTOGRAM_BUCKETS / MONGOC_HISTOGRAM_SUB_BUCKETS - 1u) {
+      return MONGOC_HISTOGRAM_BUCKETS - 1u;
+   }
+
+   return (shift + 1u) * MONGOC_HISTOGRAM_SUB_BUCKETS + (uint32_t) (value >> shift) - MONGOC_HISTOGRAM_SUB_BUCKETS;
+}
+
+
+/* the largest value counted in @bucket. */
+static BSON_INLINE int64_t
+_mongoc_histogram_bucket_max (uint32_t bucket)
+{
+   uint32_t shift;
+   uint32_t sub;
+
+   if (bucket < MONGOC_HISTOGRAM_SUB_BUCKETS) {
+      return (int64_t) bucket;
+   }
+
+   shift = bucket / MONGOC_HISTOGRAM_SUB_BUCKETS - 1u;
+   sub = bucket % MONGOC_HISTOGRAM_SUB_BUCKETS;
+
+   return (int64_t) ((((uint64_t) MONGOC_HISTOGRAM_SUB_BUCKETS + sub + 1u) << shift) - 1u);
+}
+
+
+#define HISTOGRAM(ident, Category, Name, Description) extern mongoc_histogram_t __mongoc_histogram_##ident;
+#include "mongoc-histograms.defs"
+#undef HISTOGRAM
+
+
+enum {
+#define HISTOGRAM(ident, Category, Name, Description) HISTOGRAM_##ident,
+#include "mongoc-histograms.defs"
+#undef HISTOGRAM
+   LAST_HISTOGRAM
+};
+
+#ifdef MONGOC_ENABLE_SHM_COUNTERS
+#define HISTOGRAM(ident, Category, Name, Description)                                                        \
+   static BSON_INLINE void mongoc_histogram_##ident##_record (int64_t usec)                                  \
+   {                                                                                                         \
+      mongoc_histogram_slots_t *slots = &__mongoc_histogram_##ident.cpus[_mongoc_sched_getcpu ()];           \
+      bson_atomic_int64_fetch_add (                                                                          \
+         &slots->buckets[_mongoc_histogram_bucket (usec)], 1, bson_memory_order_relaxed);                    \
+      bson_atomic_int64_fetch_add (&slots->sum, usec, bson_memory_order_relaxed);                            \
+   }                                                                                                         \
+   static BSON_INLINE void mongoc_histogram_##ident##_reset (void)                                           \
+   {                                                                                                         \
+      uint32_t _i;                                                                                           \
+      uint32_t _b;                                                                                           \
+      for (_i = 0; _i < _mongoc_get_cpu_count (); _i++) {                                                    \
+         mongoc_histogram_slots_t *slots = &__mongoc_histogram_##ident.cpus[_i];                             \
+         for (_b = 0; _b < MONGOC_HISTOGRAM_BUCKETS; _b++) {                                                 \
+            bson_atomic_int64_exchange (&slots->buckets[_b], 0, bson_memory_order_seq_cst);                  \
+         }                                                                                                   \
+         bson_atomic_int64_exchange (&slots->sum, 0, bson_memory_order_seq_cst);                             \
+      }                                                                                                      \
+      bson_atomic_thread_fence ();                                                                           \
+   }                                                                                                         \
+   static BSON_INLINE int64_t mongoc_histogram_##ident##_count (void)                                        \
+   {                                                                                                         \
+      int64_t _sum = 0;                                                                                      \
+      uint32_t _i;                                                                                           \
+      uint32_t _b;                                                                                           \
+      for (_i = 0; _i < _mongoc_get_cpu_count (); _i++) {                                                    \
+         for (_b = 0; _b < MONGOC_HISTOGRAM_BUCKETS; _b++) {                                                 \
+            _sum += bson_atomic_int64_fetch (&__mongoc_histogram_##ident.cpus[_i].buckets[_b],               \
+                                             bson_memory_order_seq_cst);                                     \
+         }                                                                                                   \
+      }                                                                                                      \
+      return _sum;                                                                                           \
+   }
+#include "mongoc-histograms.defs"
+#undef HISTOGRAM
+
+#else
+/* when counters are disabled, these functions are no-ops */
+#define HISTOGRAM(ident, Category, Name, Description)                       \
+   static BSON_INLINE void mongoc_histogram_##ident##_record (int64_t usec) \
+   {                                                                        \
+      BSON_UNUSED (usec);                                                   \
+   }                                                                        \
+   static BSON_INLINE void mongoc_histogram_##ident##_reset (void)          \
+   {                                                                        \
+   }                                                                        \
+   static BSON_INLINE int64_t mongoc_histogram_##ident##_count (void)       \
+   {                                                                        \
+      return 0;                                                             \
+   }
+#include "mongoc-histograms.defs"
+#undef HISTOGRAM
+#endif
+
 BSON_END_DECLS
 
 
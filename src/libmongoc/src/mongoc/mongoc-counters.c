@@ -34,6 +34,8 @@
 #include "mongoc-counters-private.h"
 #include "mongoc-log.h"
 
+#include "common-thread-private.h"
+
 
 #pragma pack(1)
 typedef struct {
@@ -52,11 +54,15 @@ BSON_STATIC_ASSERT2 (counter_info_t, sizeof (mongoc_counter_info_t) == 128);
 #pragma pack(1)
 typedef struct {
    uint32_t size;
-   uint32_t n_cpu;
+   uint32_t n_cpu; /* columns of counter slots, including per-thread ones */
    uint32_t n_counters;
    uint32_t infos_offset;
    uint32_t values_offset;
-   uint8_t padding[44];
+   uint32_t n_histograms;
+   uint32_t histogram_infos_offset;
+   uint32_t histograms_offset;
+   uint32_t n_histogram_cpu;
+   uint8_t padding[28];
 } mongoc_counters_t;
 #pragma pack()
 
@@ -75,6 +81,23 @@ static void *gCounterFallback = NULL;
 #include "mongoc-counters.defs"
 #undef COUNTER
 
+#define HISTOGRAM(ident, Category, Name, Description) mongoc_histogram_t __mongoc_histogram_##ident;
+#include "mongoc-histograms.defs"
+#undef HISTOGRAM
+
+#ifdef MONGOC_ENABLE_THREAD_LOCAL_COUNTERS
+MONGOC_COUNTERS_THREAD_LOCAL int32_t _mongoc_counters_thread_column = 0;
+
+/* Thread columns are never reset, so a thread that is still running after
+ * mongoc_cleanup() and mongoc_init() keeps its column to itself. */
+static bson_once_t gThreadColumnsOnce = BSON_ONCE_INIT;
+static bson_mutex_t gThreadColumnsMutex;
+static pthread_key_t gThreadColumnsKey;
+static int32_t gThreadColumnsClaimed;
+static int32_t gThreadColumnsFree[MONGOC_COUNTERS_THREAD_COLUMNS];
+static int32_t gThreadColumnsNumFree;
+#endif
+
 /**
  * mongoc_counters_use_shm:
  *
@@ -88,12 +111,27 @@ mongoc_counters_use_shm (void)
    return !getenv ("MONGOC_DISABLE_SHM");
 }
 
+/**
+ * mongoc_counters_calc_values_size:
+ *
+ * Returns the number of bytes of the counter values.
+ */
+static size_t
+mongoc_counters_calc_values_size (void)
+{
+   size_t n_groups;
+
+   n_groups = (LAST_COUNTER / SLOTS_PER_CACHELINE) + 1;
+
+   return _mongoc_counters_columns () * n_groups * sizeof (mongoc_counter_slots_t);
+}
+
 /**
  * mongoc_counters_calc_size:
  *
  * Returns the number of bytes required for the shared memory segment of
  * the process. This segment contains the various statistical counters for
- * the process.
+ * the process, followed by its latency histograms.
  *
  * Returns: The number of bytes required.
  */
@@ -101,13 +139,12 @@ static size_t
 mongoc_counters_calc_size (void)
 {
    size_t n_cpu;
-   size_t n_groups;
    size_t size;
 
    n_cpu = _mongoc_get_cpu_count ();
-   n_groups = (LAST_COUNTER / SLOTS_PER_CACHELINE) + 1;
    size = (sizeof (mongoc_counters_t) + (LAST_COUNTER * sizeof (mongoc_counter_info_t)) +
-           (n_cpu * n_groups * sizeof (mongoc_counter_slots_t)));
+           mongoc_counters_calc_values_size () + (LAST_HISTOGRAM * sizeof (mongoc_counter_info_t)) +
+           (LAST_HISTOGRAM * n_cpu * sizeof (mongoc_histogram_slots_t)));
 
 #ifdef BSON_OS_UNIX
    return BSON_MAX (sysconf (_SC_PAGESIZE), size);
@@ -235,7 +272,7 @@ mongoc_counters_register (
 {
    mongoc_counter_info_t *infos;
    char *segment;
-   int n_cpu;
+   int n_columns;
 
    BSON_ASSERT (counters);
    BSON_ASSERT (category);
@@ -250,13 +287,14 @@ mongoc_counters_register (
     * only knows about the counter after we have initialized it.
     */
 
-   n_cpu = _mongoc_get_cpu_count ();
+   n_columns = _mongoc_counters_columns ();
    segment = (char *) counters;
 
    infos = (mongoc_counter_info_t *) (segment + counters->infos_offset);
    infos = &infos[counters->n_counters];
    infos->slot = num % SLOTS_PER_CACHELINE;
-   infos->offset = (counters->values_offset + ((num / SLOTS_PER_CACHELINE) * n_cpu * sizeof (mongoc_counter_slots_t)));
+   infos->offset =
+      (counters->values_offset + ((num / SLOTS_PER_CACHELINE) * n_columns * sizeof (mongoc_counter_slots_t)));
 
    bson_strncpy (infos->category, category, sizeof infos->category);
    bson_strncpy (infos->name, name, sizeof infos->name);
@@ -268,6 +306,52 @@ mongoc_counters_register (
 
    return infos->offset;
 }
+
+
+/**
+ * mongoc_histograms_register:
+ * @counters: A mongoc_counter_t.
+ * @num: The histogram number.
+ * @category: The histogram category.
+ * @name: The histogram name.
+ * @description The histogram description.
+ *
+ * Registers a new histogram in the memory segment for counters, like
+ * mongoc_counters_register(). Each CPU has a mongoc_histogram_slots_t for it.
+ *
+ * Returns: The offset to the data for the histogram's buckets.
+ */
+static size_t
+mongoc_histograms_register (
+   mongoc_counters_t *counters, uint32_t num, const char *category, const char *name, const char *description)
+{
+   mongoc_counter_info_t *infos;
+   char *segment;
+   size_t n_cpu;
+
+   BSON_ASSERT (counters);
+   BSON_ASSERT (category);
+   BSON_ASSERT (name);
+   BSON_ASSERT (description);
+
+   n_cpu = _mongoc_get_cpu_count ();
+   segment = (char *) counters;
+
+   infos = (mongoc_counter_info_t *) (segment + counters->histogram_infos_offset);
+   infos = &infos[counters->n_histograms];
+   infos->slot = 0;
+   infos->offset = (uint32_t) (counters->histograms_offset + (num * n_cpu * sizeof (mongoc_histogram_slots_t)));
+
+   bson_strncpy (infos->category, category, sizeof infos->category);
+   bson_strncpy (infos->name, name, sizeof infos->name);
+   bson_strncpy (infos->description, description, sizeof infos->description);
+
+   bson_atomic_thread_fence ();
+
+   counters->n_histograms++;
+
+   return infos->offset;
+}
 #endif
 
 /**
@@ -292,12 +376,19 @@ _mongoc_counters_init (void)
    infos_size = LAST_COUNTER * sizeof *info;
 
    counters = (mongoc_counters_t *) segment;
-   counters->n_cpu = _mongoc_get_cpu_count ();
+   counters->n_cpu = _mongoc_counters_columns ();
    counters->n_counters = 0;
    counters->infos_offset = sizeof *counters;
    counters->values_offset = (uint32_t) (counters->infos_offset + infos_size);
 
+   counters->n_histograms = 0;
+   counters->n_histogram_cpu = _mongoc_get_cpu_count ();
+   counters->histogram_infos_offset = (uint32_t) (counters->values_offset + mongoc_counters_calc_values_size ());
+   counters->histograms_offset =
+      (uint32_t) (counters->histogram_infos_offset + LAST_HISTOGRAM * sizeof (mongoc_counter_info_t));
+
    BSON_ASSERT ((counters->values_offset % 64) == 0);
+   BSON_ASSERT ((counters->histograms_offset % 64) == 0);
 
 #define COUNTER(ident, Category, Name, Desc)                                         \
    off = mongoc_counters_register (counters, COUNTER_##ident, Category, Name, Desc); \
@@ -305,6 +396,12 @@ _mongoc_counters_init (void)
 #include "mongoc-counters.defs"
 #undef COUNTER
 
+#define HISTOGRAM(ident, Category, Name, Desc)                                           \
+   off = mongoc_histograms_register (counters, HISTOGRAM_##ident, Category, Name, Desc); \
+   __mongoc_histogram_##ident.cpus = (mongoc_histogram_slots_t *) (segment + off);
+#include "mongoc-histograms.defs"
+#undef HISTOGRAM
+
    /*
     * NOTE:
     *
@@ -316,3 +413,103 @@ _mongoc_counters_init (void)
    counters->size = (uint32_t) size;
 #endif
 }
+
+
+#ifdef MONGOC_ENABLE_THREAD_LOCAL_COUNTERS
+/* Called when a thread that claimed a column exits. */
+static void
+_mongoc_counters_thread_column_release (void *value)
+{
+   int32_t column = (int32_t) (intptr_t) value;
+
+   /* counters updated later in this thread's exit use the per-CPU slots. */
+   _mongoc_counters_thread_column = -1;
+
+   bson_mutex_lock (&gThreadColumnsMutex);
+   BSON_ASSERT (gThreadColumnsNumFree < MONGOC_COUNTERS_THREAD_COLUMNS);
+   gThreadColumnsFree[gThreadColumnsNumFree++] = column;
+   bson_mutex_unlock (&gThreadColumnsMutex);
+}
+
+
+static BSON_ONCE_FUN (_mongoc_counters_thread_columns_init)
+{
+   bson_mutex_init (&gThreadColumnsMutex);
+   BSON_ASSERT (0 == pthread_key_create (&gThreadColumnsKey, _mongoc_counters_thread_column_release));
+   BSON_ONCE_RETURN;
+}
+
+
+/**
+ * _mongoc_counters_thread_column_claim:
+ *
+ * Claims a column of counter slots for the calling thread, preferring one
+ * left by a thread that exited.
+ *
+ * Returns: One more than the column, or -1 if every column is taken.
+ */
+int32_t
+_mongoc_counters_thread_column_claim (void)
+{
+   int32_t column = -1;
+
+   bson_once (&gThreadColumnsOnce, _mongoc_counters_thread_columns_init);
+
+   bson_mutex_lock (&gThreadColumnsMutex);
+   if (gThreadColumnsNumFree > 0) {
+      column = gThreadColumnsFree[--gThreadColumnsNumFree];
+   } else if (gThreadColumnsClaimed < MONGOC_COUNTERS_THREAD_COLUMNS) {
+      column = (int32_t) _mongoc_get_cpu_count () + gThreadColumnsClaimed++ + 1;
+   }
+   bson_mutex_unlock (&gThreadColumnsMutex);
+
+   if (column > 0 && 0 != pthread_setspecific (gThreadColumnsKey, (void *) (intptr_t) column)) {
+      /* without the key, the column could not be handed on when this thread
+       * exits; keep it for good rather than risk two writers. */
+      MONGOC_WARNING ("Failed to register thread-local counters, the column is never reused.");
+   }
+
+   _mongoc_counters_thread_column = column;
+
+   return column;
+}
+#endif
+
+
+/**
+ * _mongoc_histogram_command_record:
+ * @command_name: The name of a command.
+ * @usec: Its round-trip time in microseconds.
+ *
+ * Records the round-trip time of a command in the histogram for its name.
+ * Without counters this is a no-op, like the histogram functions, and skips
+ * comparing the name.
+ */
+void
+_mongoc_histogram_command_record (const char *command_name, int64_t usec)
+{
+#ifndef MONGOC_ENABLE_SHM_COUNTERS
+   BSON_UNUSED (command_name);
+   BSON_UNUSED (usec);
+#else
+   if (!command_name) {
+      mongoc_histogram_command_other_record (usec);
+   } else if (0 == strcmp (command_name, "find")) {
+      mongoc_histogram_command_find_record (usec);
+   } else if (0 == strcmp (command_name, "getMore")) {
+      mongoc_histogram_command_getmore_record (usec);
+   } else if (0 == strcmp (command_name, "aggregate")) {
+      mongoc_histogram_command_aggregate_record (usec);
+   } else if (0 == strcmp (command_name, "insert")) {
+      mongoc_histogram_command_insert_record (usec);
+   } else if (0 == strcmp (command_name, "update")) {
+      mongoc_histogram_command_update_record (usec);
+   } else if (0 == strcmp (command_name, "delete")) {
+      mongoc_histogram_command_delete_record (usec);
+   } else if (0 == strcmp (command_name, "findAndModify")) {
+      mongoc_histogram_command_find_and_modify_record (usec);
+   } else {
+      mongoc_histogram_command_other_record (usec);
+   }
+#endif
+}
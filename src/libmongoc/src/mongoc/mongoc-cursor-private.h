@@ -30,6 +30,8 @@
 
 BSON_BEGIN_DECLS
 
+#define MONGOC_CURSOR_ADAPTIVE_BATCH_SIZE "adaptiveBatchSize"
+#define MONGOC_CURSOR_ADAPTIVE_BATCH_SIZE_LEN 17
 #define MONGOC_CURSOR_ALLOW_PARTIAL_RESULTS "allowPartialResults"
 #define MONGOC_CURSOR_ALLOW_PARTIAL_RESULTS_LEN 19
 #define MONGOC_CURSOR_AWAIT_DATA "awaitData"
@@ -66,6 +68,8 @@ BSON_BEGIN_DECLS
 #define MONGOC_CURSOR_OPLOG_REPLAY_LEN 11
 #define MONGOC_CURSOR_ORDERBY "orderby"
 #define MONGOC_CURSOR_ORDERBY_LEN 7
+#define MONGOC_CURSOR_PREFETCH "prefetch"
+#define MONGOC_CURSOR_PREFETCH_LEN 8
 #define MONGOC_CURSOR_PROJECTION "projection"
 #define MONGOC_CURSOR_PROJECTION_LEN 10
 #define MONGOC_CURSOR_QUERY "query"
@@ -89,6 +93,12 @@ BSON_BEGIN_DECLS
 #define MONGOC_CURSOR_TAILABLE "tailable"
 #define MONGOC_CURSOR_TAILABLE_LEN 8
 
+/* with "adaptiveBatchSize", each getMore requests about this many bytes, or
+ * as many documents as the application consumes in this many microseconds,
+ * whichever is fewer. */
+#define MONGOC_CURSOR_ADAPTIVE_TARGET_BYTES (4 * 1024 * 1024)
+#define MONGOC_CURSOR_ADAPTIVE_TARGET_USEC (100 * 1000)
+
 typedef struct _mongoc_cursor_impl_t mongoc_cursor_impl_t;
 typedef enum { UNPRIMED, IN_BATCH, END_OF_BATCH, DONE } mongoc_cursor_state_t;
 typedef mongoc_cursor_state_t (*_mongoc_cursor_impl_transition_t) (mongoc_cursor_t *cursor);
@@ -113,6 +123,9 @@ typedef struct _mongoc_cursor_response_t {
    bson_t reply;           /* the entire command reply */
    bson_iter_t batch_iter; /* iterates over the batch array */
    bson_t current_doc;     /* the current doc inside the batch array */
+   uint32_t batch_len;     /* number of documents in the batch array */
+   uint32_t batch_read;    /* number of documents read from the batch array */
+   int64_t received;       /* when the reply was received, in microseconds */
 } mongoc_cursor_response_t;
 
 struct _mongoc_cursor_t {
@@ -159,6 +172,18 @@ struct _mongoc_cursor_t {
 
    int64_t operation_id;
    int64_t cursor_id;
+
+   /* a getMore sent ahead of time with the "prefetch" option. */
+   struct _mongoc_cursor_prefetch_t *prefetch;
+
+   /* the getMore reused to receive each batch of an OP_MSG exhaust cursor. */
+   struct _mongoc_cursor_getmore_t *exhaust;
+
+   /* moving averages for the "adaptiveBatchSize" option, and the batch size
+    * of the next getMore chosen from them, or 0. */
+   double avg_doc_size;
+   double avg_doc_usec;
+   uint32_t adaptive_batch_size;
 };
 
 int32_t
@@ -224,6 +249,10 @@ void
 _mongoc_cursor_response_read (mongoc_cursor_t *cursor, mongoc_cursor_response_t *response, const bson_t **bson);
 void
 _mongoc_cursor_prepare_getmore_command (mongoc_cursor_t *cursor, bson_t *command);
+/* receive the reply to the cursor's prefetched getMore, if one is in flight,
+ * so that the connection may be used for another command. */
+void
+_mongoc_cursor_prefetch_finish (mongoc_cursor_t *cursor);
 void
 _mongoc_cursor_set_empty (mongoc_cursor_t *cursor);
 bool
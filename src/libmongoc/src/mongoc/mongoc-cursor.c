@@ -29,6 +29,8 @@
 #include "mongoc-write-concern-private.h"
 #include "mongoc-read-prefs-private.h"
 #include "mongoc-aggregate-private.h"
+#include "mongoc-client-side-encryption-private.h"
+#include "mongoc-cmd-private.h"
 
 #include <bson-dsl.h>
 
@@ -42,6 +44,32 @@ static bool
 _translate_query_opt (const char *query_field, const char **cmd_field, int *len);
 
 
+/* A getMore assembled once and kept for later use, pinned to its stream. */
+typedef struct _mongoc_cursor_getmore_t {
+   bson_t command;
+   mongoc_cmd_parts_t parts;
+   mongoc_server_stream_t *server_stream;
+   char *db;
+} mongoc_cursor_getmore_t;
+
+/* A getMore sent before the current batch is exhausted, so that the server
+ * produces the next batch while the application consumes this one. */
+typedef struct _mongoc_cursor_prefetch_t {
+   mongoc_cursor_getmore_t getmore;
+   mongoc_cluster_pending_cmd_t pending;
+   bool reply_pending; /* true until the reply is received. */
+   bool ok;
+   bson_t reply;
+   bson_error_t error;
+} mongoc_cursor_prefetch_t;
+
+static void
+_mongoc_cursor_prefetch_destroy (mongoc_cursor_t *cursor);
+
+static void
+_mongoc_cursor_exhaust_destroy (mongoc_cursor_t *cursor);
+
+
 bool
 _mongoc_cursor_set_opt_int64 (mongoc_cursor_t *cursor, const char *option, int64_t value)
 {
@@ -117,6 +145,11 @@ _mongoc_n_return (mongoc_cursor_t *cursor)
    limit = mongoc_cursor_get_limit (cursor);
    batch_size = mongoc_cursor_get_batch_size (cursor);
 
+   /* the user's batchSize is an upper bound for "adaptiveBatchSize". */
+   if (cursor->adaptive_batch_size && (!batch_size || cursor->adaptive_batch_size < batch_size)) {
+      batch_size = cursor->adaptive_batch_size;
+   }
+
    if (limit < 0) {
       n_return = limit;
    } else if (limit == 0) {
@@ -532,6 +565,24 @@ mongoc_cursor_destroy (mongoc_cursor_t *cursor)
       EXIT;
    }
 
+   if (cursor->prefetch) {
+      bson_iter_t iter;
+
+      /* receive the getMore reply so the connection can be reused, and learn
+       * whether the server cursor is still open. */
+      _mongoc_cursor_prefetch_finish (cursor);
+      if (cursor->prefetch->ok && bson_iter_init (&iter, &cursor->prefetch->reply) &&
+          bson_iter_find_descendant (&iter, "cursor.id", &iter) && bson_iter_as_int64 (&iter) == 0) {
+         cursor->cursor_id = 0;
+      }
+
+      _mongoc_cursor_prefetch_destroy (cursor);
+   }
+
+   if (cursor->exhaust) {
+      _mongoc_cursor_exhaust_destroy (cursor);
+   }
+
    if (cursor->impl.destroy) {
       cursor->impl.destroy (&cursor->impl);
    }
@@ -1541,6 +1592,311 @@ mongoc_cursor_new_from_command_reply_with_opts (mongoc_client_t *client, bson_t
 }
 
 
+/* assemble a getMore for @cursor as if @pending more documents had already
+ * been returned. Sets cursor->error on failure. */
+static bool
+_mongoc_cursor_getmore_assemble (mongoc_cursor_t *cursor, uint32_t pending, mongoc_cursor_getmore_t *getmore)
+{
+   uint32_t count;
+   int32_t flags;
+
+   count = cursor->count;
+   cursor->count += pending;
+   _mongoc_cursor_prepare_getmore_command (cursor, &getmore->command);
+   cursor->count = count;
+
+   mongoc_cmd_parts_init (&getmore->parts, cursor->client, NULL, MONGOC_QUERY_NONE, &getmore->command);
+   getmore->parts.is_read_command = true;
+   getmore->parts.read_prefs = cursor->read_prefs;
+   getmore->parts.assembled.operation_id = cursor->operation_id;
+
+   getmore->server_stream = _mongoc_cursor_fetch_stream (cursor);
+   if (!getmore->server_stream) {
+      return false;
+   }
+
+   if (cursor->client_session) {
+      mongoc_cmd_parts_set_session (&getmore->parts, cursor->client_session);
+   }
+
+   if (!mongoc_cmd_parts_set_read_concern (&getmore->parts, cursor->read_concern, &cursor->error)) {
+      return false;
+   }
+
+   getmore->db = bson_strndup (cursor->ns, cursor->dblen);
+   getmore->parts.assembled.db_name = getmore->db;
+
+   if (!_mongoc_cursor_opts_to_flags (cursor, getmore->server_stream, &flags)) {
+      return false;
+   }
+   getmore->parts.user_query_flags = (mongoc_query_flags_t) flags;
+
+   return mongoc_cmd_parts_assemble (&getmore->parts, getmore->server_stream, &cursor->error);
+}
+
+
+static void
+_mongoc_cursor_getmore_cleanup (mongoc_cursor_getmore_t *getmore)
+{
+   mongoc_server_stream_cleanup (getmore->server_stream);
+   mongoc_cmd_parts_cleanup (&getmore->parts);
+   bson_destroy (&getmore->command);
+   bson_free (getmore->db);
+}
+
+
+static void
+_mongoc_cursor_prefetch_destroy (mongoc_cursor_t *cursor)
+{
+   mongoc_cursor_prefetch_t *prefetch = cursor->prefetch;
+
+   BSON_ASSERT (!prefetch->reply_pending);
+
+   _mongoc_cursor_getmore_cleanup (&prefetch->getmore);
+   bson_destroy (&prefetch->reply);
+   bson_free (prefetch);
+
+   cursor->prefetch = NULL;
+}
+
+
+static void
+_mongoc_cursor_exhaust_destroy (mongoc_cursor_t *cursor)
+{
+   _mongoc_cursor_getmore_cleanup (cursor->exhaust);
+   bson_free (cursor->exhaust);
+   cursor->exhaust = NULL;
+}
+
+
+/* whether to send the next getMore now, halfway through reading @response. */
+static bool
+_mongoc_cursor_should_prefetch (mongoc_cursor_t *cursor, const mongoc_cursor_response_t *response)
+{
+   if (response->batch_read != (response->batch_len + 1u) / 2u) {
+      return false;
+   }
+
+   /* batch_len is also counted for "adaptiveBatchSize" alone. */
+   if (!_mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_PREFETCH)) {
+      return false;
+   }
+
+   if (cursor->prefetch || !cursor->cursor_id || CURSOR_FAILED (cursor) || cursor->in_exhaust) {
+      return false;
+   }
+
+   if (cursor->client_generation != cursor->client->generation || cursor->client->in_exhaust) {
+      return false;
+   }
+
+   /* a tailable cursor's getMore may block waiting for data, and write
+    * concern errors must be reported with the batch that caused them. */
+   if (_mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_TAILABLE) ||
+       _mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_EXHAUST) || cursor->write_concern ||
+       cursor->is_aggr_with_write_stage) {
+      return false;
+   }
+
+   /* replies must be decrypted, and commands in a transaction are ordered. */
+   if (_mongoc_cse_is_enabled (cursor->client) || _mongoc_client_session_in_txn (cursor->client_session)) {
+      return false;
+   }
+
+   return true;
+}
+
+
+/* with the "adaptiveBatchSize" option, choose the batch size of the next
+ * getMore from the size of the documents in @response and how fast the
+ * application has read them. The user's batchSize option is not changed. */
+static void
+_mongoc_cursor_adapt_batch_size (mongoc_cursor_t *cursor, const mongoc_cursor_response_t *response)
+{
+   double doc_size;
+   double doc_usec;
+   double n;
+   double max;
+
+   if (!response->batch_read || _mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_TAILABLE) ||
+       !_mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_ADAPTIVE_BATCH_SIZE)) {
+      return;
+   }
+
+   doc_size = (double) response->reply.len / (double) response->batch_len;
+   doc_usec = (double) (bson_get_monotonic_time () - response->received) / (double) response->batch_read;
+
+   /* weigh the latest batch more, so the size follows a consumer that slows
+    * down or speeds up. */
+   if (cursor->avg_doc_size > 0) {
+      cursor->avg_doc_size = 0.25 * cursor->avg_doc_size + 0.75 * doc_size;
+      cursor->avg_doc_usec = 0.25 * cursor->avg_doc_usec + 0.75 * doc_usec;
+   } else {
+      cursor->avg_doc_size = doc_size;
+      cursor->avg_doc_usec = doc_usec;
+   }
+
+   n = MONGOC_CURSOR_ADAPTIVE_TARGET_BYTES / cursor->avg_doc_size;
+   if (cursor->avg_doc_usec > 0 && MONGOC_CURSOR_ADAPTIVE_TARGET_USEC / cursor->avg_doc_usec < n) {
+      n = MONGOC_CURSOR_ADAPTIVE_TARGET_USEC / cursor->avg_doc_usec;
+   }
+
+   /* a batch must fit in one reply. */
+   max = mongoc_cluster_get_max_msg_size (&cursor->client->cluster) / cursor->avg_doc_size;
+   if (n > max) {
+      n = max;
+   }
+   if (n > INT32_MAX) {
+      n = INT32_MAX;
+   }
+   if (n < 1) {
+      n = 1;
+   }
+
+   cursor->adaptive_batch_size = (uint32_t) n;
+}
+
+
+/* send the next getMore without waiting for its reply. If it cannot be
+ * assembled, the cursor sends it normally once the batch is exhausted. */
+static void
+_mongoc_cursor_prefetch_send (mongoc_cursor_t *cursor, const mongoc_cursor_response_t *response)
+{
+   mongoc_cursor_prefetch_t *prefetch;
+
+   ENTRY;
+
+   prefetch = BSON_ALIGNED_ALLOC0 (mongoc_cursor_prefetch_t);
+   bson_init (&prefetch->reply);
+   cursor->prefetch = prefetch;
+
+   _mongoc_cursor_adapt_batch_size (cursor, response);
+
+   /* the getMore's batchSize accounts for the rest of this batch. */
+   if (!_mongoc_cursor_getmore_assemble (cursor, response->batch_len - response->batch_read + 1u, &prefetch->getmore)) {
+      GOTO (fail);
+   }
+
+   bson_destroy (&prefetch->reply);
+   if (mongoc_cluster_run_command_monitored_send (&cursor->client->cluster,
+                                                  &prefetch->getmore.parts.assembled,
+                                                  &prefetch->pending,
+                                                  &prefetch->reply,
+                                                  &prefetch->error)) {
+      prefetch->reply_pending = true;
+      cursor->client->prefetch_cursor = cursor;
+   } else {
+      /* report the network error when the application reaches this batch. */
+      prefetch->ok = false;
+   }
+
+   EXIT;
+
+fail:
+   memset (&cursor->error, 0, sizeof (bson_error_t));
+   bson_reinit (&cursor->error_doc);
+   _mongoc_cursor_prefetch_destroy (cursor);
+   EXIT;
+}
+
+
+void
+_mongoc_cursor_prefetch_finish (mongoc_cursor_t *cursor)
+{
+   mongoc_cursor_prefetch_t *prefetch = cursor->prefetch;
+
+   ENTRY;
+
+   if (!prefetch || !prefetch->reply_pending) {
+      EXIT;
+   }
+
+   prefetch->reply_pending = false;
+   if (cursor->client->prefetch_cursor == cursor) {
+      cursor->client->prefetch_cursor = NULL;
+   }
+
+   bson_destroy (&prefetch->reply);
+
+   if (cursor->client_generation != cursor->client->generation) {
+      /* after mongoc_client_reset the connection belongs to another process. */
+      bson_init (&prefetch->reply);
+      bson_set_error (&prefetch->error,
+                      MONGOC_ERROR_CURSOR,
+                      MONGOC_ERROR_CURSOR_INVALID_CURSOR,
+                      "Cannot receive prefetched getMore reply after client reset");
+      prefetch->ok = false;
+      EXIT;
+   }
+
+   prefetch->ok = mongoc_cluster_run_command_monitored_recv (&cursor->client->cluster,
+                                                             &prefetch->getmore.parts.assembled,
+                                                             &prefetch->pending,
+                                                             &prefetch->reply,
+                                                             &prefetch->error);
+   EXIT;
+}
+
+
+/* take the reply to the prefetched getMore as if it had been run now. */
+static bool
+_mongoc_cursor_prefetch_take (mongoc_cursor_t *cursor, bson_t *reply)
+{
+   mongoc_cursor_prefetch_t *prefetch = cursor->prefetch;
+   bool ok;
+
+   _mongoc_cursor_prefetch_finish (cursor);
+
+   ok = prefetch->ok;
+   bson_steal (reply, &prefetch->reply);
+   bson_init (&prefetch->reply);
+
+   if (ok) {
+      memset (&cursor->error, 0, sizeof (bson_error_t));
+   } else {
+      memcpy (&cursor->error, &prefetch->error, sizeof (bson_error_t));
+      bson_destroy (&cursor->error_doc);
+      bson_copy_to (reply, &cursor->error_doc);
+   }
+
+   _mongoc_cursor_prefetch_destroy (cursor);
+
+   return ok;
+}
+
+
+/* receive the next batch the server streams to an OP_MSG exhaust cursor. The
+ * getMore is assembled once and reused for monitoring; nothing is sent. */
+static bool
+_mongoc_cursor_exhaust_recv (mongoc_cursor_t *cursor, bson_t *reply)
+{
+   bool ret;
+
+   ENTRY;
+
+   if (!cursor->exhaust) {
+      cursor->exhaust = BSON_ALIGNED_ALLOC0 (mongoc_cursor_getmore_t);
+      if (!_mongoc_cursor_getmore_assemble (cursor, 0, cursor->exhaust)) {
+         bson_init (reply);
+         RETURN (false);
+      }
+      cursor->exhaust->parts.assembled.op_msg_is_exhaust = true;
+   }
+
+   ret = mongoc_cluster_run_command_monitored (
+      &cursor->client->cluster, &cursor->exhaust->parts.assembled, reply, &cursor->error);
+
+   if (ret) {
+      memset (&cursor->error, 0, sizeof (bson_error_t));
+   } else {
+      bson_destroy (&cursor->error_doc);
+      bson_copy_to (reply, &cursor->error_doc);
+   }
+
+   RETURN (ret);
+}
+
+
 bool
 _mongoc_cursor_start_reading_response (mongoc_cursor_t *cursor, mongoc_cursor_response_t *response)
 {
@@ -1566,6 +1922,19 @@ _mongoc_cursor_start_reading_response (mongoc_cursor_t *cursor, mongoc_cursor_re
       }
    }
 
+   response->batch_len = 0;
+   response->batch_read = 0;
+   response->received = bson_get_monotonic_time ();
+
+   if (in_batch && (_mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_PREFETCH) ||
+                    _mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_ADAPTIVE_BATCH_SIZE))) {
+      bson_iter_t batch_iter = response->batch_iter;
+
+      while (bson_iter_next (&batch_iter)) {
+         response->batch_len++;
+      }
+   }
+
    /* Driver Sessions Spec: "When an implicit session is associated with a
     * cursor for use with getMore operations, the session MUST be returned to
     * the pool immediately following a getMore operation that indicates that the
@@ -1587,14 +1956,24 @@ _mongoc_cursor_response_read (mongoc_cursor_t *cursor, mongoc_cursor_response_t
 
    ENTRY;
 
-   BSON_UNUSED (cursor);
-
    if (bson_iter_next (&response->batch_iter) && BSON_ITER_HOLDS_DOCUMENT (&response->batch_iter)) {
       bson_iter_document (&response->batch_iter, &data_len, &data);
 
       /* bson_iter_next guarantees valid BSON, so this must succeed */
       BSON_ASSERT (bson_init_static (&response->current_doc, data, data_len));
       *bson = &response->current_doc;
+
+      /* batch_len is only counted if "prefetch" or "adaptiveBatchSize" is set. */
+      if (response->batch_len) {
+         response->batch_read++;
+         if (_mongoc_cursor_should_prefetch (cursor, response)) {
+            _mongoc_cursor_prefetch_send (cursor, response);
+         }
+      }
+   } else if (response->batch_len && response->batch_read == response->batch_len) {
+      /* the application has consumed the whole batch. */
+      _mongoc_cursor_adapt_batch_size (cursor, response);
+      response->batch_len = 0;
    }
 }
 
@@ -1605,15 +1984,31 @@ _mongoc_cursor_response_refresh (mongoc_cursor_t *cursor,
                                  const bson_t *opts,
                                  mongoc_cursor_response_t *response)
 {
+   bool ok;
+
    ENTRY;
 
    bson_destroy (&response->reply);
 
    /* server replies to find / aggregate with {cursor: {id: N, firstBatch: []}},
     * to getMore command with {cursor: {id: N, nextBatch: []}}. */
-   if (_mongoc_cursor_run_command (cursor, command, opts, &response->reply, false)) {
+   if (cursor->prefetch) {
+      BSON_ASSERT (!strcmp (_mongoc_get_command_name (command), "getMore"));
+      ok = _mongoc_cursor_prefetch_take (cursor, &response->reply);
+   } else if (cursor->in_exhaust && cursor->client->in_exhaust) {
+      /* the server sends each batch with moreToCome until the last one. */
+      BSON_ASSERT (!strcmp (_mongoc_get_command_name (command), "getMore"));
+      ok = _mongoc_cursor_exhaust_recv (cursor, &response->reply);
+   } else {
+      ok = _mongoc_cursor_run_command (cursor, command, opts, &response->reply, false);
+   }
+
+   if (ok) {
       if (_mongoc_cursor_start_reading_response (cursor, response)) {
          cursor->in_exhaust = cursor->client->in_exhaust;
+         if (!cursor->in_exhaust && cursor->exhaust) {
+            _mongoc_cursor_exhaust_destroy (cursor);
+         }
          return;
       }
    }
@@ -1647,7 +2042,7 @@ _mongoc_cursor_prepare_getmore_command (mongoc_cursor_t *cursor, bson_t *command
    batch_size = mongoc_cursor_get_batch_size (cursor);
 
    /* See find, getMore, and killCursors Spec for batchSize rules */
-   if (batch_size) {
+   if (batch_size || cursor->adaptive_batch_size) {
       bson_append_int64 (
          command, MONGOC_CURSOR_BATCH_SIZE, MONGOC_CURSOR_BATCH_SIZE_LEN, abs (_mongoc_n_return (cursor)));
    }
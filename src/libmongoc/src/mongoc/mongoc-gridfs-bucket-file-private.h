@@ -35,6 +35,10 @@ typedef struct {
    bson_t *metadata;
    int32_t chunk_size;
    int64_t length;
+   int64_t upload_date; /* when reading */
+
+   /* number of chunks per insert when writing, or per batch when reading */
+   int32_t chunk_batch_size;
 
    /* fields for reading and writing */
    uint8_t *buffer;
@@ -43,8 +47,13 @@ typedef struct {
 
    /* for writing */
    bool saved;
+   int32_t chunk_compressor_id;
+   uint8_t *compress_buffer;
+   size_t compress_buffer_len;
 
-   /* for reading */
+   /* for reading, the byte range [range_start, range_end) of the file */
+   int64_t range_start;
+   int64_t range_end;
    mongoc_cursor_t *cursor;
    size_t bytes_read;
    bool finished;
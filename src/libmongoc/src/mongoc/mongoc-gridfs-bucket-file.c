@@ -21,6 +21,7 @@
 #include "mongoc-stream-gridfs-download-private.h"
 #include "mongoc-stream-gridfs-upload-private.h"
 #include "mongoc-collection-private.h"
+#include "mongoc-compression-private.h"
 #include "mongoc-util-private.h"
 
 /* Returns the minimum of two numbers */
@@ -112,38 +113,167 @@ _mongoc_gridfs_bucket_create_indexes (mongoc_gridfs_bucket_t *bucket, bson_error
 
 /*--------------------------------------------------------------------------
  *
- * _mongoc_gridfs_bucket_write_chunk --
+ * _mongoc_gridfs_bucket_append_compressed_data --
  *
- *       Writes a chunk from the buffer into the chunks collection.
+ *       Compresses the data of a chunk with the file's compressor and
+ *       appends it to the chunk document, along with the compressor name
+ *       and the uncompressed size.
  *
  * Return:
- *       Returns true if the chunk was successfully written. Otherwise,
+ *       True if the compressed data was appended. False if the file is not
+ *       compressed or the data did not shrink, in which case the caller
+ *       appends the data uncompressed.
+ *
+ *--------------------------------------------------------------------------
+ */
+static bool
+_mongoc_gridfs_bucket_append_compressed_data (mongoc_gridfs_bucket_file_t *file,
+                                              bson_t *chunk,
+                                              const uint8_t *data,
+                                              size_t len)
+{
+   size_t compressed_len;
+
+   if (file->chunk_compressor_id == MONGOC_COMPRESSOR_NOOP_ID) {
+      return false;
+   }
+
+   compressed_len = file->compress_buffer_len;
+   if (!mongoc_compress (file->chunk_compressor_id,
+                         -1 /* default compression level */,
+                         (char *) data,
+                         len,
+                         (char *) file->compress_buffer,
+                         &compressed_len) ||
+       compressed_len >= len) {
+      return false;
+   }
+
+   BSON_APPEND_BINARY (chunk, "data", BSON_SUBTYPE_BINARY, file->compress_buffer, (uint32_t) compressed_len);
+   BSON_APPEND_UTF8 (chunk, "compressor", mongoc_compressor_id_to_name (file->chunk_compressor_id));
+   BSON_APPEND_INT32 (chunk, "uncompressedSize", (int32_t) len);
+   return true;
+}
+
+/*--------------------------------------------------------------------------
+ *
+ * _mongoc_gridfs_bucket_uncompress_chunk --
+ *
+ *       Decompresses the data of a compressed chunk into the file's buffer.
+ *
+ * Return:
+ *       True and points data at the file's buffer if successful. Otherwise,
+ *       false and sets the error on the bucket file.
+ *
+ *--------------------------------------------------------------------------
+ */
+static bool
+_mongoc_gridfs_bucket_uncompress_chunk (mongoc_gridfs_bucket_file_t *file,
+                                        const bson_t *chunk,
+                                        const uint8_t **data,
+                                        uint32_t *data_len)
+{
+   bson_iter_t iter;
+   const char *compressor = NULL;
+   int32_t compressor_id = -1;
+   size_t uncompressed_len = 0u;
+
+   if (bson_iter_init_find (&iter, chunk, "compressor") && BSON_ITER_HOLDS_UTF8 (&iter)) {
+      compressor = bson_iter_utf8 (&iter, NULL);
+      compressor_id = mongoc_compressor_name_to_id (compressor);
+   }
+
+   if (bson_iter_init_find (&iter, chunk, "uncompressedSize") && BSON_ITER_HOLDS_INT32 (&iter) &&
+       bson_iter_int32 (&iter) >= 0 && bson_iter_int32 (&iter) <= file->chunk_size) {
+      uncompressed_len = (size_t) bson_iter_int32 (&iter);
+   } else {
+      compressor_id = -1;
+   }
+
+   if (compressor_id <= 0 ||
+       !mongoc_uncompress (compressor_id, *data, *data_len, file->buffer, &uncompressed_len)) {
+      bson_set_error (&file->err,
+                      MONGOC_ERROR_GRIDFS,
+                      MONGOC_ERROR_GRIDFS_CORRUPT,
+                      "Chunk %d could not be decompressed with compressor \"%s\".",
+                      file->curr_chunk,
+                      compressor ? compressor : "");
+      return false;
+   }
+
+   *data = file->buffer;
+   *data_len = (uint32_t) uncompressed_len;
+   return true;
+}
+
+/*--------------------------------------------------------------------------
+ *
+ * _mongoc_gridfs_bucket_write_chunks --
+ *
+ *       Writes the chunks in the buffer into the chunks collection. Every
+ *       chunk but the last is full; all of them are sent in a single
+ *       insert so that a batch of chunks costs one round trip.
+ *
+ * Return:
+ *       Returns true if the chunks were successfully written. Otherwise,
  *       returns false and sets an error on the bucket file.
  *
  *--------------------------------------------------------------------------
  */
 static bool
-_mongoc_gridfs_bucket_write_chunk (mongoc_gridfs_bucket_file_t *file)
+_mongoc_gridfs_bucket_write_chunks (mongoc_gridfs_bucket_file_t *file)
 {
-   bson_t chunk;
+   bson_t *chunks;
+   const bson_t **chunk_ptrs;
+   size_t n_chunks;
+   size_t chunk_size;
+   size_t offset;
+   size_t i;
    bool r;
 
    BSON_ASSERT (file);
 
-   bson_init (&chunk);
+   if (file->in_buffer == 0) {
+      return true;
+   }
+
+   chunk_size = (size_t) file->chunk_size;
+   n_chunks = (file->in_buffer + chunk_size - 1u) / chunk_size;
+   BSON_ASSERT (n_chunks <= (size_t) file->chunk_batch_size);
+
+   chunks = bson_malloc (n_chunks * sizeof (bson_t));
+   chunk_ptrs = bson_malloc (n_chunks * sizeof (bson_t *));
+
+   for (i = 0u, offset = 0u; i < n_chunks; i++, offset += chunk_size) {
+      const size_t len = _mongoc_min (chunk_size, file->in_buffer - offset);
 
-   BSON_APPEND_INT32 (&chunk, "n", file->curr_chunk);
-   BSON_APPEND_VALUE (&chunk, "files_id", file->file_id);
-   BSON_APPEND_BINARY (&chunk, "data", BSON_SUBTYPE_BINARY, file->buffer, (uint32_t) file->in_buffer);
+      bson_init (&chunks[i]);
+      BSON_APPEND_INT32 (&chunks[i], "n", file->curr_chunk + (int32_t) i);
+      BSON_APPEND_VALUE (&chunks[i], "files_id", file->file_id);
+      if (!_mongoc_gridfs_bucket_append_compressed_data (file, &chunks[i], file->buffer + offset, len)) {
+         BSON_APPEND_BINARY (&chunks[i], "data", BSON_SUBTYPE_BINARY, file->buffer + offset, (uint32_t) len);
+      }
+      chunk_ptrs[i] = &chunks[i];
+   }
 
+   if (n_chunks == 1u) {
+      r = mongoc_collection_insert_one (file->bucket->chunks, chunk_ptrs[0], NULL /* opts */, NULL /* reply */, &file->err);
+   } else {
+      r = mongoc_collection_insert_many (
+         file->bucket->chunks, chunk_ptrs, n_chunks, NULL /* opts */, NULL /* reply */, &file->err);
+   }
+
+   for (i = 0u; i < n_chunks; i++) {
+      bson_destroy (&chunks[i]);
+   }
+   bson_free (chunk_ptrs);
+   bson_free (chunks);
 
-   r = mongoc_collection_insert_one (file->bucket->chunks, &chunk, NULL /* opts */, NULL /* reply */, &file->err);
-   bson_destroy (&chunk);
    if (!r) {
       return false;
    }
 
-   file->curr_chunk++;
+   file->curr_chunk += (int32_t) n_chunks;
    file->in_buffer = 0;
    return true;
 }
@@ -152,16 +282,18 @@ _mongoc_gridfs_bucket_write_chunk (mongoc_gridfs_bucket_file_t *file)
  *
  * _mongoc_gridfs_bucket_init_cursor --
  *
- *       Initializes the cursor at file->cursor for the given file.
+ *       Initializes the cursor at file->cursor for the chunks from
+ *       file->curr_chunk through last_chunk of the given file.
  *
  *--------------------------------------------------------------------------
  */
 static void
-_mongoc_gridfs_bucket_init_cursor (mongoc_gridfs_bucket_file_t *file)
+_mongoc_gridfs_bucket_init_cursor (mongoc_gridfs_bucket_file_t *file, int64_t last_chunk, int64_t total_chunks)
 {
    bson_t filter;
    bson_t opts;
    bson_t sort;
+   bson_t range;
 
    BSON_ASSERT (file);
 
@@ -173,6 +305,24 @@ _mongoc_gridfs_bucket_init_cursor (mongoc_gridfs_bucket_file_t *file)
    BSON_APPEND_INT32 (&sort, "n", 1);
    BSON_APPEND_DOCUMENT (&opts, "sort", &sort);
 
+   if (file->curr_chunk > 0 || last_chunk < total_chunks - 1) {
+      /* Only part of the file is needed: select its chunks by index and fetch
+       * all of them in a single batch. */
+      const int64_t n_chunks = last_chunk - file->curr_chunk + 1;
+
+      BSON_APPEND_DOCUMENT_BEGIN (&filter, "n", &range);
+      BSON_APPEND_INT32 (&range, "$gte", file->curr_chunk);
+      BSON_APPEND_INT32 (&range, "$lte", (int32_t) last_chunk);
+      bson_append_document_end (&filter, &range);
+
+      BSON_APPEND_INT64 (&opts, "limit", n_chunks);
+      BSON_APPEND_INT64 (&opts, "batchSize", n_chunks);
+   } else if (file->chunk_batch_size > 1) {
+      /* request whole batches of chunks so that each getMore round trip
+       * prefetches the chunks the following reads will consume. */
+      BSON_APPEND_INT32 (&opts, "batchSize", file->chunk_batch_size);
+   }
+
    file->cursor = mongoc_collection_find_with_opts (file->bucket->chunks, &filter, &opts, NULL);
 
    bson_destroy (&filter);
@@ -180,11 +330,72 @@ _mongoc_gridfs_bucket_init_cursor (mongoc_gridfs_bucket_file_t *file)
    bson_destroy (&sort);
 }
 
+/*--------------------------------------------------------------------------
+ *
+ * _mongoc_gridfs_bucket_set_chunk --
+ *
+ *       Checks the data of the current chunk and places the part of it
+ *       inside the file's read range into the file's buffer.
+ *
+ * Return:
+ *       True if the chunk has the expected size. Otherwise, false and sets
+ *       the error on the bucket file.
+ *
+ *--------------------------------------------------------------------------
+ */
+static bool
+_mongoc_gridfs_bucket_set_chunk (mongoc_gridfs_bucket_file_t *file,
+                                 const uint8_t *data,
+                                 uint32_t data_len,
+                                 int64_t total_chunks)
+{
+   int64_t expected_size;
+   int64_t chunk_start;
+
+   /* Assert that the data is the correct length */
+   if (file->curr_chunk != total_chunks - 1) {
+      expected_size = file->chunk_size;
+   } else {
+      expected_size = file->length - ((total_chunks - 1) * file->chunk_size);
+   }
+
+   if (data_len != expected_size) {
+      bson_set_error (&file->err,
+                      MONGOC_ERROR_GRIDFS,
+                      MONGOC_ERROR_GRIDFS_CORRUPT,
+                      "Chunk %d expected to have size %" PRId64 " but is size %d.",
+                      file->curr_chunk,
+                      expected_size,
+                      data_len);
+      return false;
+   }
+
+   if (data != file->buffer) {
+      memcpy (file->buffer, data, data_len);
+   }
+   file->in_buffer = data_len;
+   file->bytes_read = 0u;
+
+   /* Trim the first and last chunks of the range */
+   chunk_start = ((int64_t) file->curr_chunk) * file->chunk_size;
+   if (file->range_end < chunk_start + data_len) {
+      file->in_buffer = (size_t) (file->range_end - chunk_start);
+   }
+   if (file->range_start > chunk_start) {
+      file->bytes_read = (size_t) (file->range_start - chunk_start);
+   }
+
+   file->curr_chunk++;
+
+   return true;
+}
+
 /*--------------------------------------------------------------------------
  *
  * _mongoc_gridfs_bucket_read_chunk --
  *
- *       Reads a chunk from the server and places it into the file's buffer
+ *       Reads a chunk from the bucket's chunk cache or from the server and
+ *       places it into the file's buffer
  *
  * Return:
  *       True if the buffer has been filled with any available data.
@@ -202,12 +413,12 @@ _mongoc_gridfs_bucket_read_chunk (mongoc_gridfs_bucket_file_t *file)
    const uint8_t *data;
    uint32_t data_len;
    int64_t total_chunks;
-   int64_t expected_size;
+   int64_t last_chunk;
 
    BSON_ASSERT (file);
 
-   if (file->length == 0) {
-      /* This file has zero length */
+   if (file->range_end == file->range_start) {
+      /* Nothing to read */
       file->in_buffer = 0;
       file->finished = true;
       return true;
@@ -219,7 +430,9 @@ _mongoc_gridfs_bucket_read_chunk (mongoc_gridfs_bucket_file_t *file)
       total_chunks++;
    }
 
-   if (file->curr_chunk == total_chunks) {
+   last_chunk = (file->range_end - 1) / file->chunk_size;
+
+   if (file->curr_chunk > last_chunk) {
       /* All chunks have been read! */
       file->in_buffer = 0;
       file->finished = true;
@@ -227,7 +440,14 @@ _mongoc_gridfs_bucket_read_chunk (mongoc_gridfs_bucket_file_t *file)
    }
 
    if (file->cursor == NULL) {
-      _mongoc_gridfs_bucket_init_cursor (file);
+      /* Chunks are read from the cache until the first miss, which opens a
+       * cursor over the rest of the range. */
+      if (_mongoc_gridfs_bucket_cache_get (
+             file->bucket, file->file_id, file->length, file->upload_date, file->curr_chunk, &data, &data_len)) {
+         return _mongoc_gridfs_bucket_set_chunk (file, data, data_len, total_chunks);
+      }
+
+      _mongoc_gridfs_bucket_init_cursor (file, last_chunk, total_chunks);
    }
 
    r = mongoc_cursor_next (file->cursor, &next);
@@ -272,28 +492,15 @@ _mongoc_gridfs_bucket_read_chunk (mongoc_gridfs_bucket_file_t *file)
 
    bson_iter_binary (&iter, NULL, &data_len, &data);
 
-   /* Assert that the data is the correct length */
-   if (file->curr_chunk != total_chunks - 1) {
-      expected_size = file->chunk_size;
-   } else {
-      expected_size = file->length - ((total_chunks - 1) * file->chunk_size);
+   if (bson_has_field (next, "compressor") && !_mongoc_gridfs_bucket_uncompress_chunk (file, next, &data, &data_len)) {
+      return false;
    }
 
-   if (data_len != expected_size) {
-      bson_set_error (&file->err,
-                      MONGOC_ERROR_GRIDFS,
-                      MONGOC_ERROR_GRIDFS_CORRUPT,
-                      "Chunk %d expected to have size %" PRId64 " but is size %d.",
-                      file->curr_chunk,
-                      expected_size,
-                      data_len);
+   if (!_mongoc_gridfs_bucket_set_chunk (file, data, data_len, total_chunks)) {
       return false;
    }
 
-   memcpy (file->buffer, data, data_len);
-   file->in_buffer = data_len;
-   file->bytes_read = 0u;
-   file->curr_chunk++;
+   _mongoc_gridfs_bucket_cache_put (file->bucket, file->file_id, file->length, file->upload_date, n, data, data_len);
 
    return true;
 }
@@ -329,14 +536,15 @@ _mongoc_gridfs_bucket_file_writev (mongoc_gridfs_bucket_file_t *file, const mong
    }
 
    BSON_ASSERT (bson_in_range_signed (size_t, file->chunk_size));
-   const size_t chunk_size = (size_t) file->chunk_size;
+   BSON_ASSERT (bson_in_range_signed (size_t, file->chunk_batch_size));
+   const size_t buffer_size = (size_t) file->chunk_size * (size_t) file->chunk_batch_size;
 
    for (size_t i = 0u; i < iovcnt; i++) {
       size_t written_this_iov = 0u;
 
       while (written_this_iov < iov[i].iov_len) {
          const size_t bytes_available = iov[i].iov_len - written_this_iov;
-         const size_t space_available = chunk_size - file->in_buffer;
+         const size_t space_available = buffer_size - file->in_buffer;
          const size_t to_write = _mongoc_min (bytes_available, space_available);
 
          memcpy (file->buffer + file->in_buffer, ((char *) iov[i].iov_base) + written_this_iov, to_write);
@@ -345,9 +553,9 @@ _mongoc_gridfs_bucket_file_writev (mongoc_gridfs_bucket_file_t *file, const mong
          written_this_iov += to_write;
          total += to_write;
 
-         if (file->in_buffer == chunk_size) {
-            /* Buffer is filled, write the chunk */
-            _mongoc_gridfs_bucket_write_chunk (file);
+         if (file->in_buffer == buffer_size) {
+            /* Buffer is filled, write the batch of chunks */
+            _mongoc_gridfs_bucket_write_chunks (file);
          }
       }
    }
@@ -442,7 +650,7 @@ _mongoc_gridfs_bucket_file_save (mongoc_gridfs_bucket_file_t *file)
 
    if (file->in_buffer != 0) {
       length += file->in_buffer;
-      _mongoc_gridfs_bucket_write_chunk (file);
+      _mongoc_gridfs_bucket_write_chunks (file);
    }
 
    file->length = length;
@@ -456,6 +664,9 @@ _mongoc_gridfs_bucket_file_save (mongoc_gridfs_bucket_file_t *file)
    if (file->metadata) {
       BSON_APPEND_DOCUMENT (&new_doc, "metadata", file->metadata);
    }
+   if (file->chunk_compressor_id != MONGOC_COMPRESSOR_NOOP_ID) {
+      BSON_APPEND_UTF8 (&new_doc, "compressor", mongoc_compressor_id_to_name (file->chunk_compressor_id));
+   }
 
    r = mongoc_collection_insert_one (file->bucket->files, &new_doc, NULL, NULL, &file->err);
    bson_destroy (&new_doc);
@@ -472,6 +683,7 @@ _mongoc_gridfs_bucket_file_destroy (mongoc_gridfs_bucket_file_t *file)
       bson_destroy (file->metadata);
       mongoc_cursor_destroy (file->cursor);
       bson_free (file->buffer);
+      bson_free (file->compress_buffer);
       bson_free (file->filename);
       bson_free (file);
    }
@@ -22,14 +22,56 @@
 
 BSON_BEGIN_DECLS
 
+typedef struct {
+   bson_t *file_key; /* { files_id: <id> } */
+   int32_t n;
+   /* from the files document the chunk was read for; a file deleted and
+    * uploaded again under the same id does not match. */
+   int64_t length;
+   int64_t upload_date;
+   uint8_t *data;
+   uint32_t data_len;
+   uint64_t last_used;
+} mongoc_gridfs_bucket_cached_chunk_t;
+
 struct _mongoc_gridfs_bucket_t {
    mongoc_collection_t *chunks;
    mongoc_collection_t *files;
    int32_t chunk_size;
+   int32_t chunk_batch_size;
+   int32_t chunk_compressor_id; /* MONGOC_COMPRESSOR_NOOP_ID if not compressing */
    char *bucket_name;
    bool indexed;
+
+   /* LRU cache of recently downloaded chunks, shared by all download
+    * streams of the bucket. Empty if chunk_cache_size is 0. */
+   mongoc_gridfs_bucket_cached_chunk_t *chunk_cache;
+   int32_t chunk_cache_size;
+   int32_t chunk_cache_len;
+   uint64_t chunk_cache_clock;
 };
 
+bool
+_mongoc_gridfs_bucket_cache_get (mongoc_gridfs_bucket_t *bucket,
+                                 const bson_value_t *file_id,
+                                 int64_t length,
+                                 int64_t upload_date,
+                                 int32_t n,
+                                 const uint8_t **data,
+                                 uint32_t *data_len);
+
+void
+_mongoc_gridfs_bucket_cache_put (mongoc_gridfs_bucket_t *bucket,
+                                 const bson_value_t *file_id,
+                                 int64_t length,
+                                 int64_t upload_date,
+                                 int32_t n,
+                                 const uint8_t *data,
+                                 uint32_t data_len);
+
+void
+_mongoc_gridfs_bucket_cache_remove_file (mongoc_gridfs_bucket_t *bucket, const bson_value_t *file_id);
+
 BSON_END_DECLS
 
 #endif /* MONGOC_GRIDFS_BUCKET_PRIVATE_H */
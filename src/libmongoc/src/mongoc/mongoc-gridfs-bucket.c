@@ -16,6 +16,7 @@
 
 #include "bson/bson.h"
 #include "mongoc.h"
+#include "mongoc-compression-private.h"
 #include "mongoc-cursor-private.h"
 #include "mongoc-database-private.h"
 #include "mongoc-gridfs-bucket-private.h"
@@ -86,6 +87,7 @@ mongoc_gridfs_bucket_new (mongoc_database_t *db,
    mongoc_gridfs_bucket_t *bucket;
    char buf[128];
    mongoc_gridfs_bucket_opts_t gridfs_opts;
+   int32_t chunk_compressor_id = MONGOC_COMPRESSOR_NOOP_ID;
 
    BSON_ASSERT (db);
 
@@ -104,6 +106,19 @@ mongoc_gridfs_bucket_new (mongoc_database_t *db,
                       (int) (sizeof (buf) - (strlen (".chunks") + 1)));
    }
 
+   if (*gridfs_opts.chunkCompressor != '\0') {
+      chunk_compressor_id = mongoc_compressor_name_to_id (gridfs_opts.chunkCompressor);
+      if (chunk_compressor_id <= 0 || !mongoc_compressor_supported (gridfs_opts.chunkCompressor)) {
+         bson_set_error (error,
+                         MONGOC_ERROR_COMMAND,
+                         MONGOC_ERROR_COMMAND_INVALID_ARG,
+                         "Unsupported chunkCompressor \"%s\"",
+                         gridfs_opts.chunkCompressor);
+         _mongoc_gridfs_bucket_opts_cleanup (&gridfs_opts);
+         return NULL;
+      }
+   }
+
    bucket = (mongoc_gridfs_bucket_t *) bson_malloc0 (sizeof *bucket);
 
    bson_snprintf (buf, sizeof (buf), "%s.chunks", gridfs_opts.bucketName);
@@ -128,6 +143,12 @@ mongoc_gridfs_bucket_new (mongoc_database_t *db,
    }
 
    bucket->chunk_size = gridfs_opts.chunkSizeBytes;
+   bucket->chunk_batch_size = gridfs_opts.chunkBatchSize;
+   bucket->chunk_compressor_id = chunk_compressor_id;
+   bucket->chunk_cache_size = gridfs_opts.chunkCacheSize;
+   if (bucket->chunk_cache_size > 0) {
+      bucket->chunk_cache = bson_malloc0 ((size_t) bucket->chunk_cache_size * sizeof (*bucket->chunk_cache));
+   }
    bucket->bucket_name = bson_strdup (gridfs_opts.bucketName);
 
    _mongoc_gridfs_bucket_opts_cleanup (&gridfs_opts);
@@ -161,6 +182,27 @@ mongoc_gridfs_bucket_open_upload_stream_with_id (mongoc_gridfs_bucket_t *bucket,
       gridfs_opts.chunkSizeBytes = bucket->chunk_size;
    }
 
+   /* default to bucket's chunk batch size. */
+   if (!gridfs_opts.chunkBatchSize) {
+      gridfs_opts.chunkBatchSize = bucket->chunk_batch_size;
+   }
+
+   /* the upload buffer holds a full batch of chunks. */
+   if ((size_t) gridfs_opts.chunkBatchSize > SIZE_MAX / (size_t) gridfs_opts.chunkSizeBytes) {
+      bson_set_error (error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "chunkBatchSize %" PRId32 " is too large for chunkSizeBytes %" PRId32,
+                      gridfs_opts.chunkBatchSize,
+                      gridfs_opts.chunkSizeBytes);
+      _mongoc_gridfs_bucket_upload_opts_cleanup (&gridfs_opts);
+      return NULL;
+   }
+
+   /* chunks cached for an earlier file with this id must not be served for
+    * the new one. */
+   _mongoc_gridfs_bucket_cache_remove_file (bucket, file_id);
+
    /* Initialize the file's fields */
    len = strlen (filename);
 
@@ -174,8 +216,15 @@ mongoc_gridfs_bucket_open_upload_stream_with_id (mongoc_gridfs_bucket_t *bucket,
 
    file->bucket = bucket;
    file->chunk_size = gridfs_opts.chunkSizeBytes;
+   file->chunk_batch_size = gridfs_opts.chunkBatchSize;
    file->metadata = bson_copy (&gridfs_opts.metadata);
-   file->buffer = bson_malloc ((size_t) gridfs_opts.chunkSizeBytes);
+   file->buffer = bson_malloc ((size_t) gridfs_opts.chunkSizeBytes * (size_t) gridfs_opts.chunkBatchSize);
+   file->chunk_compressor_id = bucket->chunk_compressor_id;
+   if (file->chunk_compressor_id != MONGOC_COMPRESSOR_NOOP_ID) {
+      file->compress_buffer_len =
+         mongoc_compressor_max_compressed_length (file->chunk_compressor_id, (size_t) gridfs_opts.chunkSizeBytes);
+      file->compress_buffer = bson_malloc (file->compress_buffer_len);
+   }
    file->in_buffer = 0;
 
    _mongoc_gridfs_bucket_upload_opts_cleanup (&gridfs_opts);
@@ -295,10 +344,12 @@ mongoc_gridfs_bucket_upload_from_stream (mongoc_gridfs_bucket_t *bucket,
 }
 
 
-mongoc_stream_t *
-mongoc_gridfs_bucket_open_download_stream (mongoc_gridfs_bucket_t *bucket,
-                                           const bson_value_t *file_id,
-                                           bson_error_t *error)
+/* Fetches the files document for file_id and returns a file set up to read
+ * all of it, or NULL on error. */
+static mongoc_gridfs_bucket_file_t *
+_mongoc_gridfs_bucket_open_download_file (mongoc_gridfs_bucket_t *bucket,
+                                          const bson_value_t *file_id,
+                                          bson_error_t *error)
 {
    mongoc_gridfs_bucket_file_t *file;
    bson_t file_doc;
@@ -330,6 +381,8 @@ mongoc_gridfs_bucket_open_download_stream (mongoc_gridfs_bucket_t *bucket,
          file->length = bson_iter_as_int64 (&iter);
       } else if (strcmp (key, "chunkSize") == 0) {
          file->chunk_size = bson_iter_int32 (&iter);
+      } else if (strcmp (key, "uploadDate") == 0 && BSON_ITER_HOLDS_DATE_TIME (&iter)) {
+         file->upload_date = bson_iter_date_time (&iter);
       } else if (strcmp (key, "filename") == 0) {
          file->filename = bson_strdup (bson_iter_utf8 (&iter, NULL));
       } else if (strcmp (key, "metadata") == 0) {
@@ -343,13 +396,92 @@ mongoc_gridfs_bucket_open_download_stream (mongoc_gridfs_bucket_t *bucket,
    file->file_id = (bson_value_t *) bson_malloc0 (sizeof *(file->file_id));
    bson_value_copy (file_id, file->file_id);
    file->bucket = bucket;
+   file->chunk_batch_size = bucket->chunk_batch_size;
    file->buffer = bson_malloc0 ((size_t) file->chunk_size);
+   file->range_start = 0;
+   file->range_end = file->length;
 
    BSON_ASSERT (file->file_id);
 
+   return file;
+}
+
+mongoc_stream_t *
+mongoc_gridfs_bucket_open_download_stream (mongoc_gridfs_bucket_t *bucket,
+                                           const bson_value_t *file_id,
+                                           bson_error_t *error)
+{
+   mongoc_gridfs_bucket_file_t *file;
+
+   BSON_ASSERT (bucket);
+   BSON_ASSERT (file_id);
+
+   file = _mongoc_gridfs_bucket_open_download_file (bucket, file_id, error);
+   if (!file) {
+      return NULL;
+   }
+
+   return _mongoc_download_stream_gridfs_new (file);
+}
+
+mongoc_stream_t *
+mongoc_gridfs_bucket_open_download_stream_range (mongoc_gridfs_bucket_t *bucket,
+                                                 const bson_value_t *file_id,
+                                                 int64_t offset,
+                                                 int64_t length,
+                                                 bson_error_t *error)
+{
+   mongoc_gridfs_bucket_file_t *file;
+
+   BSON_ASSERT (bucket);
+   BSON_ASSERT (file_id);
+
+   if (offset < 0 || length < 0) {
+      bson_set_error (error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "offset and length must not be negative, got offset %" PRId64 " and length %" PRId64,
+                      offset,
+                      length);
+      return NULL;
+   }
+
+   file = _mongoc_gridfs_bucket_open_download_file (bucket, file_id, error);
+   if (!file) {
+      return NULL;
+   }
+
+   if (offset > file->length) {
+      bson_set_error (error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "offset %" PRId64 " is past the end of the file of length %" PRId64,
+                      offset,
+                      file->length);
+      _mongoc_gridfs_bucket_file_destroy (file);
+      return NULL;
+   }
+
+   if (file->chunk_size <= 0) {
+      bson_set_error (error,
+                      MONGOC_ERROR_GRIDFS,
+                      MONGOC_ERROR_GRIDFS_CORRUPT,
+                      "File has an invalid chunk size %" PRId32,
+                      file->chunk_size);
+      _mongoc_gridfs_bucket_file_destroy (file);
+      return NULL;
+   }
+
+   /* a range running past the end of the file is truncated. */
+   file->range_start = offset;
+   file->range_end = offset + BSON_MIN (length, file->length - offset);
+   file->curr_chunk = (int32_t) (offset / file->chunk_size);
+
    return _mongoc_download_stream_gridfs_new (file);
 }
 
+
+
 bool
 mongoc_gridfs_bucket_download_to_stream (mongoc_gridfs_bucket_t *bucket,
                                          const bson_value_t *file_id,
@@ -398,6 +530,8 @@ mongoc_gridfs_bucket_delete_by_id (mongoc_gridfs_bucket_t *bucket, const bson_va
 
    BSON_APPEND_VALUE (&files_selector, "_id", file_id);
 
+   _mongoc_gridfs_bucket_cache_remove_file (bucket, file_id);
+
    r = mongoc_collection_delete_one (bucket->files, &files_selector, NULL, &reply, error);
    bson_destroy (&files_selector);
    if (!r) {
@@ -471,6 +605,11 @@ void
 mongoc_gridfs_bucket_destroy (mongoc_gridfs_bucket_t *bucket)
 {
    if (bucket) {
+      for (int32_t i = 0; i < bucket->chunk_cache_len; i++) {
+         bson_destroy (bucket->chunk_cache[i].file_key);
+         bson_free (bucket->chunk_cache[i].data);
+      }
+      bson_free (bucket->chunk_cache);
       mongoc_collection_destroy (bucket->chunks);
       mongoc_collection_destroy (bucket->files);
       bson_free (bucket->bucket_name);
@@ -494,6 +633,8 @@ mongoc_gridfs_bucket_abort_upload (mongoc_stream_t *stream)
     * collection when the stream is closed */
    file->saved = true;
 
+   _mongoc_gridfs_bucket_cache_remove_file (file->bucket, file->file_id);
+
    bson_init (&chunks_selector);
    BSON_APPEND_VALUE (&chunks_selector, "files_id", file->file_id);
 
@@ -501,3 +642,142 @@ mongoc_gridfs_bucket_abort_upload (mongoc_stream_t *stream)
    bson_destroy (&chunks_selector);
    return r;
 }
+
+static bool
+_mongoc_gridfs_bucket_cache_find (mongoc_gridfs_bucket_t *bucket,
+                                  const bson_value_t *file_id,
+                                  int32_t n,
+                                  mongoc_gridfs_bucket_cached_chunk_t **entry)
+{
+   bson_t file_key;
+   bool found = false;
+
+   bson_init (&file_key);
+   BSON_APPEND_VALUE (&file_key, "files_id", file_id);
+
+   for (int32_t i = 0; i < bucket->chunk_cache_len; i++) {
+      if (bucket->chunk_cache[i].n == n && bson_equal (bucket->chunk_cache[i].file_key, &file_key)) {
+         *entry = &bucket->chunk_cache[i];
+         found = true;
+         break;
+      }
+   }
+
+   bson_destroy (&file_key);
+   return found;
+}
+
+bool
+_mongoc_gridfs_bucket_cache_get (mongoc_gridfs_bucket_t *bucket,
+                                 const bson_value_t *file_id,
+                                 int64_t length,
+                                 int64_t upload_date,
+                                 int32_t n,
+                                 const uint8_t **data,
+                                 uint32_t *data_len)
+{
+   mongoc_gridfs_bucket_cached_chunk_t *entry;
+
+   BSON_ASSERT_PARAM (bucket);
+   BSON_ASSERT_PARAM (file_id);
+   BSON_ASSERT_PARAM (data);
+   BSON_ASSERT_PARAM (data_len);
+
+   if (!_mongoc_gridfs_bucket_cache_find (bucket, file_id, n, &entry)) {
+      return false;
+   }
+
+   if (entry->length != length || entry->upload_date != upload_date) {
+      /* the file was replaced since its chunks were cached. */
+      _mongoc_gridfs_bucket_cache_remove_file (bucket, file_id);
+      return false;
+   }
+
+   entry->last_used = ++bucket->chunk_cache_clock;
+   *data = entry->data;
+   *data_len = entry->data_len;
+   return true;
+}
+
+void
+_mongoc_gridfs_bucket_cache_put (mongoc_gridfs_bucket_t *bucket,
+                                 const bson_value_t *file_id,
+                                 int64_t length,
+                                 int64_t upload_date,
+                                 int32_t n,
+                                 const uint8_t *data,
+                                 uint32_t data_len)
+{
+   mongoc_gridfs_bucket_cached_chunk_t *entry;
+
+   BSON_ASSERT_PARAM (bucket);
+   BSON_ASSERT_PARAM (file_id);
+   BSON_ASSERT_PARAM (data);
+
+   if (bucket->chunk_cache_size == 0) {
+      return;
+   }
+
+   if (_mongoc_gridfs_bucket_cache_find (bucket, file_id, n, &entry)) {
+      if (entry->length == length && entry->upload_date == upload_date) {
+         return;
+      }
+
+      /* drop the chunks of the file this one replaced. */
+      _mongoc_gridfs_bucket_cache_remove_file (bucket, file_id);
+   }
+
+   if (bucket->chunk_cache_len < bucket->chunk_cache_size) {
+      entry = &bucket->chunk_cache[bucket->chunk_cache_len++];
+   } else {
+      /* evict the least recently used chunk. */
+      entry = &bucket->chunk_cache[0];
+      for (int32_t i = 1; i < bucket->chunk_cache_len; i++) {
+         if (bucket->chunk_cache[i].last_used < entry->last_used) {
+            entry = &bucket->chunk_cache[i];
+         }
+      }
+      bson_destroy (entry->file_key);
+      bson_free (entry->data);
+   }
+
+   entry->file_key = bson_new ();
+   BSON_APPEND_VALUE (entry->file_key, "files_id", file_id);
+   entry->n = n;
+   entry->length = length;
+   entry->upload_date = upload_date;
+   entry->data = bson_malloc (data_len > 0u ? data_len : 1u);
+   memcpy (entry->data, data, data_len);
+   entry->data_len = data_len;
+   entry->last_used = ++bucket->chunk_cache_clock;
+}
+
+void
+_mongoc_gridfs_bucket_cache_remove_file (mongoc_gridfs_bucket_t *bucket, const bson_value_t *file_id)
+{
+   bson_t file_key;
+   int32_t i = 0;
+
+   BSON_ASSERT_PARAM (bucket);
+   BSON_ASSERT_PARAM (file_id);
+
+   bson_init (&file_key);
+   BSON_APPEND_VALUE (&file_key, "files_id", file_id);
+
+   while (i < bucket->chunk_cache_len) {
+      mongoc_gridfs_bucket_cached_chunk_t *entry = &bucket->chunk_cache[i];
+
+      if (!bson_equal (entry->file_key, &file_key)) {
+         i++;
+         continue;
+      }
+
+      /* move the last entry into the hole. */
+      bson_destroy (entry->file_key);
+      bson_free (entry->data);
+      bucket->chunk_cache_len--;
+      *entry = bucket->chunk_cache[bucket->chunk_cache_len];
+   }
+
+   bson_destroy (&file_key);
+}
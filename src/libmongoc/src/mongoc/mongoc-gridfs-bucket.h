@@ -69,6 +69,13 @@ mongoc_gridfs_bucket_open_download_stream (mongoc_gridfs_bucket_t *bucket,
                                            const bson_value_t *file_id,
                                            bson_error_t *error) BSON_GNUC_WARN_UNUSED_RESULT;
 
+MONGOC_EXPORT (mongoc_stream_t *)
+mongoc_gridfs_bucket_open_download_stream_range (mongoc_gridfs_bucket_t *bucket,
+                                                 const bson_value_t *file_id,
+                                                 int64_t offset,
+                                                 int64_t length,
+                                                 bson_error_t *error) BSON_GNUC_WARN_UNUSED_RESULT;
+
 MONGOC_EXPORT (bool)
 mongoc_gridfs_bucket_download_to_stream (mongoc_gridfs_bucket_t *bucket,
                                          const bson_value_t *file_id,
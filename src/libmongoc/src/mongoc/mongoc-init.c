@@ -21,7 +21,9 @@
 #include "mongoc-counters-private.h"
 #include "mongoc-init.h"
 
+#include "mongoc-addrinfo-cache-private.h"
 #include "mongoc-handshake-private.h"
+#include "mongoc-rr-cache-private.h"
 
 #include "mongoc-cluster-aws-private.h"
 
@@ -143,6 +145,9 @@ static BSON_ONCE_FUN (_mongoc_do_init)
 
    _mongoc_handshake_init ();
 
+   _mongoc_rr_cache_init ();
+   _mongoc_addrinfo_cache_init ();
+
 #if defined(MONGOC_ENABLE_MONGODB_AWS_AUTH)
    kms_message_init ();
    _mongoc_aws_credentials_cache_init ();
@@ -189,6 +194,9 @@ static BSON_ONCE_FUN (_mongoc_do_cleanup)
 
    _mongoc_handshake_cleanup ();
 
+   _mongoc_rr_cache_cleanup ();
+   _mongoc_addrinfo_cache_cleanup ();
+
 #if defined(MONGOC_ENABLE_MONGODB_AWS_AUTH)
    kms_message_cleanup ();
    _mongoc_aws_credentials_cache_cleanup ();
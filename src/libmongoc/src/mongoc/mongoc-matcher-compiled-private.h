@@ -0,0 +1,52 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mongoc-prelude.h"
+
+#ifndef MONGOC_MATCHER_COMPILED_PRIVATE_H
+#define MONGOC_MATCHER_COMPILED_PRIVATE_H
+
+#include <bson/bson.h>
+
+#include "mongoc-matcher-op-private.h"
+
+
+BSON_BEGIN_DECLS
+
+
+/* A matcher optree compiled for repeated evaluation: every path used by the
+ * query is resolved in a single pass over the document, and comparisons are
+ * specialized on the type of the query value. */
+typedef struct _mongoc_matcher_compiled_t mongoc_matcher_compiled_t;
+
+
+mongoc_matcher_compiled_t *
+_mongoc_matcher_compiled_new (mongoc_matcher_op_t *optree);
+bool
+_mongoc_matcher_compiled_match (const mongoc_matcher_compiled_t *compiled, const bson_t *bson);
+size_t
+_mongoc_matcher_compiled_match_many (const mongoc_matcher_compiled_t *compiled,
+                                     const bson_t *const *documents,
+                                     size_t n_documents,
+                                     uint8_t *bitmap);
+void
+_mongoc_matcher_compiled_destroy (mongoc_matcher_compiled_t *compiled);
+
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_MATCHER_COMPILED_PRIVATE_H */
@@ -0,0 +1,1151 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "mongoc-matcher-compiled-private.h"
+
+
+/* fields resolved per match are kept on the stack up to this many paths. */
+#define MONGOC_MATCHER_COMPILED_STACK_FIELDS 16
+
+/* documents evaluated together by _mongoc_matcher_compiled_match_many, one
+ * bit each in a uint64_t. */
+#define MONGOC_MATCHER_COMPILED_BLOCK 64
+
+
+/* wraps bson_iter_t so that arrays of it are valid even when bson_iter_t is
+ * aligned beyond its size. */
+typedef struct {
+   bson_iter_t iter;
+} mongoc_matcher_value_t;
+
+
+typedef enum {
+   MONGOC_MATCHER_NODE_LOGICAL, /* $and, $or, $nor */
+   MONGOC_MATCHER_NODE_NOT,
+   MONGOC_MATCHER_NODE_EXISTS,
+   MONGOC_MATCHER_NODE_TYPE,
+   MONGOC_MATCHER_NODE_NUMBER,  /* $eq, $ne, $gt, $gte, $lt, $lte with a number */
+   MONGOC_MATCHER_NODE_UTF8,    /* $eq, $ne with a string */
+   MONGOC_MATCHER_NODE_NULL,    /* $eq, $ne with null */
+   MONGOC_MATCHER_NODE_IN,      /* $in, $nin with an array */
+   MONGOC_MATCHER_NODE_GENERIC, /* any other comparison */
+} mongoc_matcher_node_kind_t;
+
+
+typedef struct {
+   uint64_t hash;
+   bool used;
+   bson_iter_t iter;
+} mongoc_matcher_in_entry_t;
+
+
+/* the values of an $in array. numbers and strings are hashed, then confirmed
+ * with the interpreter's equality, so the results are identical. */
+typedef struct {
+   mongoc_matcher_in_entry_t *entries;
+   size_t mask;
+   bool has_null;
+   mongoc_matcher_value_t *others; /* arrays and documents */
+   size_t n_others;
+} mongoc_matcher_in_set_t;
+
+
+typedef struct {
+   mongoc_matcher_node_kind_t kind;
+   mongoc_matcher_opcode_t opcode;
+   mongoc_matcher_op_compare_t *compare; /* the interpreted comparison */
+   int32_t field;
+   int32_t left;
+   int32_t right;
+   union {
+      struct {
+         bool is_double;
+         double d;
+         int64_t i;
+      } number;
+      struct {
+         const char *str;
+         uint32_t len;
+      } utf8;
+      bool exists;
+      bson_type_t type;
+      mongoc_matcher_in_set_t in;
+   } u;
+} mongoc_matcher_node_t;
+
+
+/* one segment of a dotted path. field 0 is the document itself. */
+typedef struct {
+   const char *name;
+   uint32_t len;
+   int32_t first_child;
+   int32_t next_sibling;
+   uint32_t n_children;
+} mongoc_matcher_field_t;
+
+
+struct _mongoc_matcher_compiled_t {
+   mongoc_matcher_node_t *nodes;
+   size_t n_nodes;
+   size_t nodes_cap;
+   mongoc_matcher_field_t *fields;
+   size_t n_fields;
+   size_t fields_cap;
+   int32_t root;
+};
+
+
+typedef struct {
+   mongoc_matcher_value_t *values;
+   bool *found;
+} mongoc_matcher_state_t;
+
+
+/* the fields of up to MONGOC_MATCHER_COMPILED_BLOCK documents, one row of
+ * n_fields per document, and scratch columns for numeric comparisons. */
+typedef struct {
+   mongoc_matcher_value_t *values;
+   bool *found;
+   size_t n_fields;
+   double d[MONGOC_MATCHER_COMPILED_BLOCK];
+   int64_t i[MONGOC_MATCHER_COMPILED_BLOCK];
+} mongoc_matcher_block_t;
+
+
+static uint64_t
+_mix64 (uint64_t h)
+{
+   h ^= h >> 33;
+   h *= UINT64_C (0xff51afd7ed558ccd);
+   h ^= h >> 33;
+   h *= UINT64_C (0xc4ceb9fe1a85ec53);
+   h ^= h >> 33;
+   return h;
+}
+
+
+/* equal numbers of any type must hash equally, so hash them as doubles. */
+static uint64_t
+_hash_number (double d)
+{
+   uint64_t bits;
+
+   if (d == 0.0) {
+      d = 0.0; /* -0.0 == 0.0 */
+   }
+
+   memcpy (&bits, &d, sizeof bits);
+   return _mix64 (bits);
+}
+
+
+static uint64_t
+_hash_utf8 (const char *str, uint32_t len)
+{
+   uint64_t h = UINT64_C (0xcbf29ce484222325);
+   uint32_t i;
+
+   for (i = 0; i < len; i++) {
+      h ^= (uint8_t) str[i];
+      h *= UINT64_C (0x100000001b3);
+   }
+
+   return _mix64 (h);
+}
+
+
+/* the hash of a document value, false if it cannot equal a hashed value. */
+static bool
+_hash_iter (const bson_iter_t *iter, uint64_t *hash)
+{
+   uint32_t len;
+   const char *str;
+
+   switch (bson_iter_type (iter)) {
+   case BSON_TYPE_DOUBLE:
+      *hash = _hash_number (bson_iter_double (iter));
+      return true;
+   case BSON_TYPE_INT32:
+      *hash = _hash_number ((double) bson_iter_int32 (iter));
+      return true;
+   case BSON_TYPE_INT64:
+      *hash = _hash_number ((double) bson_iter_int64 (iter));
+      return true;
+   case BSON_TYPE_BOOL:
+      *hash = _hash_number (bson_iter_bool (iter) ? 1.0 : 0.0);
+      return true;
+   case BSON_TYPE_UTF8:
+      str = bson_iter_utf8 (iter, &len);
+      *hash = _hash_utf8 (str, len);
+      return true;
+   case BSON_TYPE_EOD:
+   case BSON_TYPE_DOCUMENT:
+   case BSON_TYPE_ARRAY:
+   case BSON_TYPE_BINARY:
+   case BSON_TYPE_UNDEFINED:
+   case BSON_TYPE_OID:
+   case BSON_TYPE_DATE_TIME:
+   case BSON_TYPE_NULL:
+   case BSON_TYPE_REGEX:
+   case BSON_TYPE_DBPOINTER:
+   case BSON_TYPE_CODE:
+   case BSON_TYPE_SYMBOL:
+   case BSON_TYPE_CODEWSCOPE:
+   case BSON_TYPE_TIMESTAMP:
+   case BSON_TYPE_DECIMAL128:
+   case BSON_TYPE_MAXKEY:
+   case BSON_TYPE_MINKEY:
+   default:
+      return false;
+   }
+}
+
+
+static void
+_in_set_init (mongoc_matcher_in_set_t *set, const bson_iter_t *array)
+{
+   bson_iter_t iter;
+   size_t n = 0;
+   size_t cap = 8;
+   uint64_t hash;
+   size_t i;
+
+   BSON_ASSERT (bson_iter_recurse (array, &iter));
+   while (bson_iter_next (&iter)) {
+      n++;
+   }
+
+   while (cap < 2u * n) {
+      cap *= 2u;
+   }
+
+   set->entries =
+      bson_aligned_alloc0 (BSON_ALIGNOF (mongoc_matcher_in_entry_t), cap * sizeof (mongoc_matcher_in_entry_t));
+   set->mask = cap - 1u;
+   set->others = bson_aligned_alloc0 (BSON_ALIGNOF (mongoc_matcher_value_t),
+                                      BSON_MAX (n, 1u) * sizeof (mongoc_matcher_value_t));
+
+   BSON_ASSERT (bson_iter_recurse (array, &iter));
+   while (bson_iter_next (&iter)) {
+      switch (bson_iter_type (&iter)) {
+      case BSON_TYPE_DOUBLE:
+      case BSON_TYPE_INT32:
+      case BSON_TYPE_INT64:
+      case BSON_TYPE_UTF8:
+         BSON_ASSERT (_hash_iter (&iter, &hash));
+         for (i = hash & set->mask; set->entries[i].used; i = (i + 1u) & set->mask) {
+         }
+         set->entries[i].used = true;
+         set->entries[i].hash = hash;
+         set->entries[i].iter = iter;
+         break;
+      case BSON_TYPE_NULL:
+         set->has_null = true;
+         break;
+      case BSON_TYPE_DOCUMENT:
+      case BSON_TYPE_ARRAY:
+         set->others[set->n_others++].iter = iter;
+         break;
+      case BSON_TYPE_EOD:
+      case BSON_TYPE_BINARY:
+      case BSON_TYPE_UNDEFINED:
+      case BSON_TYPE_OID:
+      case BSON_TYPE_BOOL:
+      case BSON_TYPE_DATE_TIME:
+      case BSON_TYPE_REGEX:
+      case BSON_TYPE_DBPOINTER:
+      case BSON_TYPE_CODE:
+      case BSON_TYPE_SYMBOL:
+      case BSON_TYPE_CODEWSCOPE:
+      case BSON_TYPE_TIMESTAMP:
+      case BSON_TYPE_DECIMAL128:
+      case BSON_TYPE_MAXKEY:
+      case BSON_TYPE_MINKEY:
+      default:
+         /* never equal to anything. */
+         break;
+      }
+   }
+}
+
+
+static bool
+_in_set_contains (const mongoc_matcher_in_set_t *set, const bson_iter_t *iter)
+{
+   uint64_t hash;
+   size_t i;
+
+   switch (bson_iter_type (iter)) {
+   case BSON_TYPE_NULL:
+   case BSON_TYPE_UNDEFINED:
+      return set->has_null;
+   case BSON_TYPE_DOCUMENT:
+   case BSON_TYPE_ARRAY:
+      for (i = 0; i < set->n_others; i++) {
+         if (_mongoc_matcher_iter_eq_match (&set->others[i].iter, iter)) {
+            return true;
+         }
+      }
+      return false;
+   case BSON_TYPE_EOD:
+   case BSON_TYPE_DOUBLE:
+   case BSON_TYPE_UTF8:
+   case BSON_TYPE_BINARY:
+   case BSON_TYPE_OID:
+   case BSON_TYPE_BOOL:
+   case BSON_TYPE_DATE_TIME:
+   case BSON_TYPE_REGEX:
+   case BSON_TYPE_DBPOINTER:
+   case BSON_TYPE_CODE:
+   case BSON_TYPE_SYMBOL:
+   case BSON_TYPE_CODEWSCOPE:
+   case BSON_TYPE_INT32:
+   case BSON_TYPE_TIMESTAMP:
+   case BSON_TYPE_INT64:
+   case BSON_TYPE_DECIMAL128:
+   case BSON_TYPE_MAXKEY:
+   case BSON_TYPE_MINKEY:
+   default:
+      break;
+   }
+
+   if (!_hash_iter (iter, &hash)) {
+      return false;
+   }
+
+   for (i = hash & set->mask; set->entries[i].used; i = (i + 1u) & set->mask) {
+      if (set->entries[i].hash == hash && _mongoc_matcher_iter_eq_match (&set->entries[i].iter, iter)) {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+
+/* the field for the dotted @path, sharing segments with previous paths. */
+static int32_t
+_add_field (mongoc_matcher_compiled_t *compiled, const char *path)
+{
+   mongoc_matcher_field_t *field;
+   int32_t parent = 0;
+   const char *dot;
+   uint32_t len;
+   int32_t f;
+
+   for (;;) {
+      dot = strchr (path, '.');
+      len = dot ? (uint32_t) (dot - path) : (uint32_t) strlen (path);
+
+      for (f = compiled->fields[parent].first_child; f >= 0; f = compiled->fields[f].next_sibling) {
+         if (compiled->fields[f].len == len && 0 == memcmp (compiled->fields[f].name, path, len)) {
+            break;
+         }
+      }
+
+      if (f < 0) {
+         if (compiled->n_fields == compiled->fields_cap) {
+            compiled->fields_cap *= 2u;
+            compiled->fields =
+               bson_realloc (compiled->fields, compiled->fields_cap * sizeof (mongoc_matcher_field_t));
+         }
+
+         f = (int32_t) compiled->n_fields++;
+         field = &compiled->fields[f];
+         field->name = path;
+         field->len = len;
+         field->first_child = -1;
+         field->next_sibling = compiled->fields[parent].first_child;
+         field->n_children = 0;
+         compiled->fields[parent].first_child = f;
+         compiled->fields[parent].n_children++;
+      }
+
+      if (!dot) {
+         return f;
+      }
+
+      parent = f;
+      path = dot + 1;
+   }
+}
+
+
+static int32_t
+_add_node (mongoc_matcher_compiled_t *compiled)
+{
+   if (compiled->n_nodes == compiled->nodes_cap) {
+      compiled->nodes_cap *= 2u;
+      compiled->nodes = bson_realloc (compiled->nodes, compiled->nodes_cap * sizeof (mongoc_matcher_node_t));
+   }
+
+   memset (&compiled->nodes[compiled->n_nodes], 0, sizeof (mongoc_matcher_node_t));
+   compiled->nodes[compiled->n_nodes].field = -1;
+   compiled->nodes[compiled->n_nodes].left = -1;
+   compiled->nodes[compiled->n_nodes].right = -1;
+
+   return (int32_t) compiled->n_nodes++;
+}
+
+
+static void
+_compile_compare (mongoc_matcher_node_t *node, mongoc_matcher_op_compare_t *compare)
+{
+   node->kind = MONGOC_MATCHER_NODE_GENERIC;
+   node->compare = compare;
+
+   switch ((int) compare->base.opcode) {
+   case MONGOC_MATCHER_OPCODE_EQ:
+   case MONGOC_MATCHER_OPCODE_NE:
+   case MONGOC_MATCHER_OPCODE_GT:
+   case MONGOC_MATCHER_OPCODE_GTE:
+   case MONGOC_MATCHER_OPCODE_LT:
+   case MONGOC_MATCHER_OPCODE_LTE: {
+      const bool eq_or_ne =
+         compare->base.opcode == MONGOC_MATCHER_OPCODE_EQ || compare->base.opcode == MONGOC_MATCHER_OPCODE_NE;
+
+      if (BSON_ITER_HOLDS_DOUBLE (&compare->iter)) {
+         node->kind = MONGOC_MATCHER_NODE_NUMBER;
+         node->u.number.is_double = true;
+         node->u.number.d = bson_iter_double (&compare->iter);
+      } else if (BSON_ITER_HOLDS_INT32 (&compare->iter) || BSON_ITER_HOLDS_INT64 (&compare->iter)) {
+         node->kind = MONGOC_MATCHER_NODE_NUMBER;
+         node->u.number.i = bson_iter_as_int64 (&compare->iter);
+      } else if (eq_or_ne && BSON_ITER_HOLDS_UTF8 (&compare->iter)) {
+         node->kind = MONGOC_MATCHER_NODE_UTF8;
+         node->u.utf8.str = bson_iter_utf8 (&compare->iter, &node->u.utf8.len);
+      } else if (eq_or_ne && BSON_ITER_HOLDS_NULL (&compare->iter)) {
+         node->kind = MONGOC_MATCHER_NODE_NULL;
+      }
+      break;
+   }
+   case MONGOC_MATCHER_OPCODE_IN:
+   case MONGOC_MATCHER_OPCODE_NIN:
+      if (BSON_ITER_HOLDS_ARRAY (&compare->iter)) {
+         node->kind = MONGOC_MATCHER_NODE_IN;
+         _in_set_init (&node->u.in, &compare->iter);
+      }
+      break;
+   default:
+      break;
+   }
+}
+
+
+static int32_t
+_compile (mongoc_matcher_compiled_t *compiled, mongoc_matcher_op_t *op)
+{
+   mongoc_matcher_node_t *node;
+   int32_t n;
+   int32_t left;
+   int32_t right;
+   int32_t field;
+
+   BSON_ASSERT (op);
+
+   switch (op->base.opcode) {
+   case MONGOC_MATCHER_OPCODE_OR:
+   case MONGOC_MATCHER_OPCODE_AND:
+   case MONGOC_MATCHER_OPCODE_NOR:
+      left = _compile (compiled, op->logical.left);
+      right = op->logical.right ? _compile (compiled, op->logical.right) : -1;
+      n = _add_node (compiled);
+      node = &compiled->nodes[n];
+      node->kind = MONGOC_MATCHER_NODE_LOGICAL;
+      node->left = left;
+      node->right = right;
+      break;
+   case MONGOC_MATCHER_OPCODE_NOT:
+      left = _compile (compiled, op->not_.child);
+      n = _add_node (compiled);
+      node = &compiled->nodes[n];
+      node->kind = MONGOC_MATCHER_NODE_NOT;
+      node->left = left;
+      break;
+   case MONGOC_MATCHER_OPCODE_EXISTS:
+      field = _add_field (compiled, op->exists.path);
+      n = _add_node (compiled);
+      node = &compiled->nodes[n];
+      node->kind = MONGOC_MATCHER_NODE_EXISTS;
+      node->field = field;
+      node->u.exists = op->exists.exists;
+      break;
+   case MONGOC_MATCHER_OPCODE_TYPE:
+      field = _add_field (compiled, op->type.path);
+      n = _add_node (compiled);
+      node = &compiled->nodes[n];
+      node->kind = MONGOC_MATCHER_NODE_TYPE;
+      node->field = field;
+      node->u.type = op->type.type;
+      break;
+   case MONGOC_MATCHER_OPCODE_EQ:
+   case MONGOC_MATCHER_OPCODE_GT:
+   case MONGOC_MATCHER_OPCODE_GTE:
+   case MONGOC_MATCHER_OPCODE_IN:
+   case MONGOC_MATCHER_OPCODE_LT:
+   case MONGOC_MATCHER_OPCODE_LTE:
+   case MONGOC_MATCHER_OPCODE_NE:
+   case MONGOC_MATCHER_OPCODE_NIN:
+   default:
+      field = _add_field (compiled, op->compare.path);
+      n = _add_node (compiled);
+      node = &compiled->nodes[n];
+      node->field = field;
+      _compile_compare (node, &op->compare);
+      break;
+   }
+
+   node->opcode = op->base.opcode;
+
+   return n;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_matcher_compiled_new --
+ *
+ *       Compile @optree. The result refers to paths and values owned by
+ *       @optree, which must outlive it.
+ *
+ * Returns:
+ *       A newly allocated mongoc_matcher_compiled_t that should be freed
+ *       with _mongoc_matcher_compiled_destroy().
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_matcher_compiled_t *
+_mongoc_matcher_compiled_new (mongoc_matcher_op_t *optree)
+{
+   mongoc_matcher_compiled_t *compiled;
+
+   BSON_ASSERT (optree);
+
+   compiled = BSON_ALIGNED_ALLOC0 (mongoc_matcher_compiled_t);
+   compiled->nodes_cap = 8;
+   compiled->nodes = bson_malloc (compiled->nodes_cap * sizeof (mongoc_matcher_node_t));
+   compiled->fields_cap = 8;
+   compiled->fields = bson_malloc (compiled->fields_cap * sizeof (mongoc_matcher_field_t));
+
+   /* the document itself. */
+   compiled->n_fields = 1;
+   compiled->fields[0].name = NULL;
+   compiled->fields[0].len = 0;
+   compiled->fields[0].first_child = -1;
+   compiled->fields[0].next_sibling = -1;
+   compiled->fields[0].n_children = 0;
+
+   compiled->root = _compile (compiled, optree);
+
+   return compiled;
+}
+
+
+/* resolve every field below @parent in one pass over @iter. like
+ * bson_iter_find_descendant, only the first occurrence of a key is used. */
+static void
+_extract (const mongoc_matcher_compiled_t *compiled,
+          int32_t parent,
+          bson_iter_t *iter,
+          const mongoc_matcher_state_t *state)
+{
+   const mongoc_matcher_field_t *field;
+   uint32_t remaining = compiled->fields[parent].n_children;
+   bson_iter_t child;
+   const char *key;
+   uint32_t key_len;
+   int32_t f;
+
+   while (remaining && bson_iter_next (iter)) {
+      key = bson_iter_key (iter);
+      key_len = bson_iter_key_len (iter);
+
+      for (f = compiled->fields[parent].first_child; f >= 0; f = field->next_sibling) {
+         field = &compiled->fields[f];
+         if (state->found[f] || field->len != key_len || 0 != memcmp (field->name, key, key_len)) {
+            continue;
+         }
+
+         state->found[f] = true;
+         state->values[f].iter = *iter;
+         remaining--;
+
+         if (field->first_child >= 0 && (BSON_ITER_HOLDS_DOCUMENT (iter) || BSON_ITER_HOLDS_ARRAY (iter)) &&
+             bson_iter_recurse (iter, &child)) {
+            _extract (compiled, f, &child, state);
+         }
+         break;
+      }
+   }
+}
+
+
+static bool
+_compare_double (mongoc_matcher_opcode_t opcode, double value, double query)
+{
+   switch ((int) opcode) {
+   case MONGOC_MATCHER_OPCODE_EQ:
+      return value == query;
+   case MONGOC_MATCHER_OPCODE_NE:
+      return !(value == query);
+   case MONGOC_MATCHER_OPCODE_GT:
+      return value > query;
+   case MONGOC_MATCHER_OPCODE_GTE:
+      return value >= query;
+   case MONGOC_MATCHER_OPCODE_LT:
+      return value < query;
+   case MONGOC_MATCHER_OPCODE_LTE:
+      return value <= query;
+   default:
+      BSON_ASSERT (false);
+      return false;
+   }
+}
+
+
+static bool
+_compare_int64 (mongoc_matcher_opcode_t opcode, int64_t value, int64_t query)
+{
+   switch ((int) opcode) {
+   case MONGOC_MATCHER_OPCODE_EQ:
+      return value == query;
+   case MONGOC_MATCHER_OPCODE_NE:
+      return value != query;
+   case MONGOC_MATCHER_OPCODE_GT:
+      return value > query;
+   case MONGOC_MATCHER_OPCODE_GTE:
+      return value >= query;
+   case MONGOC_MATCHER_OPCODE_LT:
+      return value < query;
+   case MONGOC_MATCHER_OPCODE_LTE:
+      return value <= query;
+   default:
+      BSON_ASSERT (false);
+      return false;
+   }
+}
+
+
+/* compare a number in the document with a numeric query value, converting
+ * types as the interpreter's native C comparisons do. */
+static bool
+_number_match (const mongoc_matcher_node_t *node, bson_iter_t *iter)
+{
+   int64_t value;
+
+   switch (bson_iter_type (iter)) {
+   case BSON_TYPE_DOUBLE:
+      return _compare_double (node->opcode,
+                              bson_iter_double (iter),
+                              node->u.number.is_double ? node->u.number.d : (double) node->u.number.i);
+   case BSON_TYPE_INT32:
+      value = bson_iter_int32 (iter);
+      break;
+   case BSON_TYPE_INT64:
+      value = bson_iter_int64 (iter);
+      break;
+   case BSON_TYPE_BOOL:
+      value = bson_iter_bool (iter);
+      break;
+   case BSON_TYPE_EOD:
+   case BSON_TYPE_UTF8:
+   case BSON_TYPE_DOCUMENT:
+   case BSON_TYPE_ARRAY:
+   case BSON_TYPE_BINARY:
+   case BSON_TYPE_UNDEFINED:
+   case BSON_TYPE_OID:
+   case BSON_TYPE_DATE_TIME:
+   case BSON_TYPE_NULL:
+   case BSON_TYPE_REGEX:
+   case BSON_TYPE_DBPOINTER:
+   case BSON_TYPE_CODE:
+   case BSON_TYPE_SYMBOL:
+   case BSON_TYPE_CODEWSCOPE:
+   case BSON_TYPE_TIMESTAMP:
+   case BSON_TYPE_DECIMAL128:
+   case BSON_TYPE_MAXKEY:
+   case BSON_TYPE_MINKEY:
+   default:
+      return _mongoc_matcher_op_compare_iter_match (node->compare, iter);
+   }
+
+   if (node->u.number.is_double) {
+      return _compare_double (node->opcode, (double) value, node->u.number.d);
+   }
+
+   return _compare_int64 (node->opcode, value, node->u.number.i);
+}
+
+
+static bool
+_eval (const mongoc_matcher_compiled_t *compiled, int32_t n, const mongoc_matcher_state_t *state)
+{
+   const mongoc_matcher_node_t *node = &compiled->nodes[n];
+   bson_iter_t *iter;
+   bool eq;
+
+   switch (node->kind) {
+   case MONGOC_MATCHER_NODE_LOGICAL:
+      switch ((int) node->opcode) {
+      case MONGOC_MATCHER_OPCODE_OR:
+         return _eval (compiled, node->left, state) || (node->right >= 0 && _eval (compiled, node->right, state));
+      case MONGOC_MATCHER_OPCODE_AND:
+         return _eval (compiled, node->left, state) && (node->right < 0 || _eval (compiled, node->right, state));
+      case MONGOC_MATCHER_OPCODE_NOR:
+         return !(_eval (compiled, node->left, state) || (node->right >= 0 && _eval (compiled, node->right, state)));
+      default:
+         BSON_ASSERT (false);
+         return false;
+      }
+   case MONGOC_MATCHER_NODE_NOT:
+      return !_eval (compiled, node->left, state);
+   case MONGOC_MATCHER_NODE_EXISTS:
+      return state->found[node->field] == node->u.exists;
+   case MONGOC_MATCHER_NODE_TYPE:
+      return state->found[node->field] && bson_iter_type (&state->values[node->field].iter) == node->u.type;
+   case MONGOC_MATCHER_NODE_NUMBER:
+   case MONGOC_MATCHER_NODE_UTF8:
+   case MONGOC_MATCHER_NODE_NULL:
+   case MONGOC_MATCHER_NODE_IN:
+   case MONGOC_MATCHER_NODE_GENERIC:
+   default:
+      break;
+   }
+
+   /* comparisons never match a missing field. */
+   if (!state->found[node->field]) {
+      return false;
+   }
+
+   iter = &state->values[node->field].iter;
+
+   switch (node->kind) {
+   case MONGOC_MATCHER_NODE_NUMBER:
+      return _number_match (node, iter);
+   case MONGOC_MATCHER_NODE_UTF8: {
+      uint32_t len = 0;
+      const char *str = BSON_ITER_HOLDS_UTF8 (iter) ? bson_iter_utf8 (iter, &len) : NULL;
+
+      eq = str && len == node->u.utf8.len && 0 == memcmp (str, node->u.utf8.str, len);
+      return node->opcode == MONGOC_MATCHER_OPCODE_NE ? !eq : eq;
+   }
+   case MONGOC_MATCHER_NODE_NULL:
+      eq = BSON_ITER_HOLDS_NULL (iter) || BSON_ITER_HOLDS_UNDEFINED (iter);
+      return node->opcode == MONGOC_MATCHER_OPCODE_NE ? !eq : eq;
+   case MONGOC_MATCHER_NODE_IN:
+      eq = _in_set_contains (&node->u.in, iter);
+      return node->opcode == MONGOC_MATCHER_OPCODE_NIN ? !eq : eq;
+   case MONGOC_MATCHER_NODE_GENERIC:
+      return _mongoc_matcher_op_compare_iter_match (node->compare, iter);
+   case MONGOC_MATCHER_NODE_LOGICAL:
+   case MONGOC_MATCHER_NODE_NOT:
+   case MONGOC_MATCHER_NODE_EXISTS:
+   case MONGOC_MATCHER_NODE_TYPE:
+   default:
+      BSON_ASSERT (false);
+      return false;
+   }
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_matcher_compiled_match --
+ *
+ *       Checks to see if @bson matches the compiled query. Gives the same
+ *       result as _mongoc_matcher_op_match() on the source optree.
+ *
+ * Returns:
+ *       true if @bson matched the query, otherwise false.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+_mongoc_matcher_compiled_match (const mongoc_matcher_compiled_t *compiled, const bson_t *bson)
+{
+   mongoc_matcher_value_t stack_values[MONGOC_MATCHER_COMPILED_STACK_FIELDS];
+   bool stack_found[MONGOC_MATCHER_COMPILED_STACK_FIELDS];
+   mongoc_matcher_state_t state;
+   bson_iter_t iter;
+   bool ret;
+
+   BSON_ASSERT (compiled);
+   BSON_ASSERT (bson);
+
+   if (compiled->n_fields <= MONGOC_MATCHER_COMPILED_STACK_FIELDS) {
+      state.values = stack_values;
+      state.found = stack_found;
+   } else {
+      state.values = bson_aligned_alloc (BSON_ALIGNOF (mongoc_matcher_value_t),
+                                         compiled->n_fields * sizeof (mongoc_matcher_value_t));
+      state.found = bson_malloc (compiled->n_fields * sizeof (bool));
+   }
+
+   memset (state.found, 0, compiled->n_fields * sizeof (bool));
+
+   if (bson_iter_init (&iter, bson)) {
+      _extract (compiled, 0, &iter, &state);
+   }
+
+   ret = _eval (compiled, compiled->root, &state);
+
+   if (state.values != stack_values) {
+      bson_free (state.values);
+      bson_free (state.found);
+   }
+
+   return ret;
+}
+
+
+static void
+_block_state (const mongoc_matcher_block_t *block, size_t j, mongoc_matcher_state_t *state)
+{
+   state->values = block->values + j * block->n_fields;
+   state->found = block->found + j * block->n_fields;
+}
+
+
+/* each comparison is written as a loop over the whole column without
+ * branches so the compiler can vectorize it. lanes that do not hold a number
+ * are masked off by the caller. */
+#define COMPARE_COLUMN(_bits, _col, _op, _query)                                    \
+   do {                                                                             \
+      size_t _j;                                                                    \
+      for (_j = 0; _j < MONGOC_MATCHER_COMPILED_BLOCK; _j++) {                      \
+         (_bits) |= (uint64_t) ((_col)[_j] _op (_query)) << _j;                     \
+      }                                                                             \
+   } while (0)
+
+
+static uint64_t
+_compare_double_column (mongoc_matcher_opcode_t opcode, const double *col, double query)
+{
+   uint64_t bits = 0;
+
+   switch ((int) opcode) {
+   case MONGOC_MATCHER_OPCODE_EQ:
+      COMPARE_COLUMN (bits, col, ==, query);
+      return bits;
+   case MONGOC_MATCHER_OPCODE_NE:
+      COMPARE_COLUMN (bits, col, ==, query);
+      return ~bits;
+   case MONGOC_MATCHER_OPCODE_GT:
+      COMPARE_COLUMN (bits, col, >, query);
+      return bits;
+   case MONGOC_MATCHER_OPCODE_GTE:
+      COMPARE_COLUMN (bits, col, >=, query);
+      return bits;
+   case MONGOC_MATCHER_OPCODE_LT:
+      COMPARE_COLUMN (bits, col, <, query);
+      return bits;
+   case MONGOC_MATCHER_OPCODE_LTE:
+      COMPARE_COLUMN (bits, col, <=, query);
+      return bits;
+   default:
+      BSON_ASSERT (false);
+      return 0;
+   }
+}
+
+
+static uint64_t
+_compare_int64_column (mongoc_matcher_opcode_t opcode, const int64_t *col, int64_t query)
+{
+   uint64_t bits = 0;
+
+   switch ((int) opcode) {
+   case MONGOC_MATCHER_OPCODE_EQ:
+      COMPARE_COLUMN (bits, col, ==, query);
+      return bits;
+   case MONGOC_MATCHER_OPCODE_NE:
+      COMPARE_COLUMN (bits, col, ==, query);
+      return ~bits;
+   case MONGOC_MATCHER_OPCODE_GT:
+      COMPARE_COLUMN (bits, col, >, query);
+      return bits;
+   case MONGOC_MATCHER_OPCODE_GTE:
+      COMPARE_COLUMN (bits, col, >=, query);
+      return bits;
+   case MONGOC_MATCHER_OPCODE_LT:
+      COMPARE_COLUMN (bits, col, <, query);
+      return bits;
+   case MONGOC_MATCHER_OPCODE_LTE:
+      COMPARE_COLUMN (bits, col, <=, query);
+      return bits;
+   default:
+      BSON_ASSERT (false);
+      return 0;
+   }
+}
+
+
+#undef COMPARE_COLUMN
+
+
+/* gather the field of a numeric comparison into columns, compare them all at
+ * once, and evaluate the remaining non-numeric values one at a time. */
+static uint64_t
+_number_match_block (const mongoc_matcher_node_t *node, mongoc_matcher_block_t *block, uint64_t active)
+{
+   mongoc_matcher_state_t state;
+   uint64_t is_double = 0;
+   uint64_t is_int = 0;
+   uint64_t other = 0;
+   uint64_t result;
+   bson_iter_t *iter;
+   size_t j;
+
+   memset (block->d, 0, sizeof block->d);
+   memset (block->i, 0, sizeof block->i);
+
+   for (j = 0; j < MONGOC_MATCHER_COMPILED_BLOCK; j++) {
+      if (!(active & (UINT64_C (1) << j))) {
+         continue;
+      }
+
+      _block_state (block, j, &state);
+      if (!state.found[node->field]) {
+         continue;
+      }
+
+      iter = &state.values[node->field].iter;
+      switch (bson_iter_type (iter)) {
+      case BSON_TYPE_DOUBLE:
+         block->d[j] = bson_iter_double (iter);
+         is_double |= UINT64_C (1) << j;
+         break;
+      case BSON_TYPE_INT32:
+      case BSON_TYPE_INT64:
+      case BSON_TYPE_BOOL:
+         block->i[j] = bson_iter_as_int64 (iter);
+         block->d[j] = (double) block->i[j];
+         is_int |= UINT64_C (1) << j;
+         break;
+      case BSON_TYPE_EOD:
+      case BSON_TYPE_UTF8:
+      case BSON_TYPE_DOCUMENT:
+      case BSON_TYPE_ARRAY:
+      case BSON_TYPE_BINARY:
+      case BSON_TYPE_UNDEFINED:
+      case BSON_TYPE_OID:
+      case BSON_TYPE_DATE_TIME:
+      case BSON_TYPE_NULL:
+      case BSON_TYPE_REGEX:
+      case BSON_TYPE_DBPOINTER:
+      case BSON_TYPE_CODE:
+      case BSON_TYPE_SYMBOL:
+      case BSON_TYPE_CODEWSCOPE:
+      case BSON_TYPE_TIMESTAMP:
+      case BSON_TYPE_DECIMAL128:
+      case BSON_TYPE_MAXKEY:
+      case BSON_TYPE_MINKEY:
+      default:
+         other |= UINT64_C (1) << j;
+         break;
+      }
+   }
+
+   /* the same conversions as _number_match. */
+   if (node->u.number.is_double) {
+      result = _compare_double_column (node->opcode, block->d, node->u.number.d) & (is_double | is_int);
+   } else {
+      result = (_compare_double_column (node->opcode, block->d, (double) node->u.number.i) & is_double) |
+               (_compare_int64_column (node->opcode, block->i, node->u.number.i) & is_int);
+   }
+
+   for (j = 0; other && j < MONGOC_MATCHER_COMPILED_BLOCK; j++) {
+      if (other & (UINT64_C (1) << j)) {
+         _block_state (block, j, &state);
+         if (_number_match (node, &state.values[node->field].iter)) {
+            result |= UINT64_C (1) << j;
+         }
+         other &= ~(UINT64_C (1) << j);
+      }
+   }
+
+   return result;
+}
+
+
+/* evaluate node @n for the documents in @active. like _eval's short circuit,
+ * a branch is only evaluated for documents whose result it can change. */
+static uint64_t
+_eval_block (const mongoc_matcher_compiled_t *compiled, int32_t n, mongoc_matcher_block_t *block, uint64_t active)
+{
+   const mongoc_matcher_node_t *node = &compiled->nodes[n];
+   mongoc_matcher_state_t state;
+   uint64_t result = 0;
+   size_t j;
+
+   if (!active) {
+      return 0;
+   }
+
+   switch (node->kind) {
+   case MONGOC_MATCHER_NODE_LOGICAL:
+      result = _eval_block (compiled, node->left, block, active);
+      switch ((int) node->opcode) {
+      case MONGOC_MATCHER_OPCODE_OR:
+      case MONGOC_MATCHER_OPCODE_NOR:
+         if (node->right >= 0) {
+            result |= _eval_block (compiled, node->right, block, active & ~result);
+         }
+         return node->opcode == MONGOC_MATCHER_OPCODE_NOR ? active & ~result : result;
+      case MONGOC_MATCHER_OPCODE_AND:
+         return node->right >= 0 ? _eval_block (compiled, node->right, block, result) : result;
+      default:
+         BSON_ASSERT (false);
+         return 0;
+      }
+   case MONGOC_MATCHER_NODE_NOT:
+      return active & ~_eval_block (compiled, node->left, block, active);
+   case MONGOC_MATCHER_NODE_NUMBER:
+      return _number_match_block (node, block, active);
+   case MONGOC_MATCHER_NODE_EXISTS:
+   case MONGOC_MATCHER_NODE_TYPE:
+   case MONGOC_MATCHER_NODE_UTF8:
+   case MONGOC_MATCHER_NODE_NULL:
+   case MONGOC_MATCHER_NODE_IN:
+   case MONGOC_MATCHER_NODE_GENERIC:
+   default:
+      for (j = 0; j < MONGOC_MATCHER_COMPILED_BLOCK; j++) {
+         if (active & (UINT64_C (1) << j)) {
+            _block_state (block, j, &state);
+            if (_eval (compiled, n, &state)) {
+               result |= UINT64_C (1) << j;
+            }
+         }
+      }
+      return result;
+   }
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_matcher_compiled_match_many --
+ *
+ *       Match @n_documents documents against the compiled query, setting
+ *       bit i of @bitmap (bitmap[i / 8] & (1 << (i % 8))) if documents[i]
+ *       matched and clearing it otherwise. Documents are evaluated in
+ *       blocks: the fields of a block are extracted first, then each
+ *       comparison runs over the whole block.
+ *
+ * Returns:
+ *       The number of matching documents.
+ *
+ * Side effects:
+ *       The first (@n_documents + 7) / 8 bytes of @bitmap are written.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+size_t
+_mongoc_matcher_compiled_match_many (const mongoc_matcher_compiled_t *compiled,
+                                     const bson_t *const *documents,
+                                     size_t n_documents,
+                                     uint8_t *bitmap)
+{
+   mongoc_matcher_block_t *block;
+   mongoc_matcher_state_t state;
+   bson_iter_t iter;
+   uint64_t active;
+   uint64_t result;
+   size_t n_matched = 0;
+   size_t count;
+   size_t base;
+   size_t j;
+
+   BSON_ASSERT (compiled);
+   BSON_ASSERT (documents || n_documents == 0);
+   BSON_ASSERT (bitmap || n_documents == 0);
+
+   if (n_documents == 0) {
+      return 0;
+   }
+
+   block = BSON_ALIGNED_ALLOC0 (mongoc_matcher_block_t);
+   block->n_fields = compiled->n_fields;
+   block->values = bson_aligned_alloc (BSON_ALIGNOF (mongoc_matcher_value_t),
+                                       MONGOC_MATCHER_COMPILED_BLOCK * compiled->n_fields *
+                                          sizeof (mongoc_matcher_value_t));
+   block->found = bson_malloc (MONGOC_MATCHER_COMPILED_BLOCK * compiled->n_fields * sizeof (bool));
+
+   for (base = 0; base < n_documents; base += MONGOC_MATCHER_COMPILED_BLOCK) {
+      count = BSON_MIN (n_documents - base, (size_t) MONGOC_MATCHER_COMPILED_BLOCK);
+      active = count == MONGOC_MATCHER_COMPILED_BLOCK ? UINT64_MAX : (UINT64_C (1) << count) - 1u;
+
+      memset (block->found, 0, count * compiled->n_fields * sizeof (bool));
+      for (j = 0; j < count; j++) {
+         BSON_ASSERT (documents[base + j]);
+         _block_state (block, j, &state);
+         if (bson_iter_init (&iter, documents[base + j])) {
+            _extract (compiled, 0, &iter, &state);
+         }
+      }
+
+      result = _eval_block (compiled, compiled->root, block, active) & active;
+
+      for (j = 0; j < (count + 7u) / 8u; j++) {
+         bitmap[base / 8u + j] = (uint8_t) (result >> (8u * j));
+      }
+
+      for (; result; result &= result - 1u) {
+         n_matched++;
+      }
+   }
+
+   bson_free (block->values);
+   bson_free (block->found);
+   bson_free (block);
+
+   return n_matched;
+}
+
+
+void
+_mongoc_matcher_compiled_destroy (mongoc_matcher_compiled_t *compiled)
+{
+   size_t i;
+
+   if (!compiled) {
+      return;
+   }
+
+   for (i = 0; i < compiled->n_nodes; i++) {
+      if (compiled->nodes[i].kind == MONGOC_MATCHER_NODE_IN) {
+         bson_free (compiled->nodes[i].u.in.entries);
+         bson_free (compiled->nodes[i].u.in.others);
+      }
+   }
+
+   bson_free (compiled->nodes);
+   bson_free (compiled->fields);
+   bson_free (compiled);
+}
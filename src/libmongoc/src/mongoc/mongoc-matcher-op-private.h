@@ -114,6 +114,10 @@ mongoc_matcher_op_t *
 _mongoc_matcher_op_not_new (const char *path, mongoc_matcher_op_t *child);
 bool
 _mongoc_matcher_op_match (mongoc_matcher_op_t *op, const bson_t *bson);
+bool
+_mongoc_matcher_op_compare_iter_match (mongoc_matcher_op_compare_t *compare, bson_iter_t *iter);
+bool
+_mongoc_matcher_iter_eq_match (const bson_iter_t *compare_iter, const bson_iter_t *iter);
 void
 _mongoc_matcher_op_destroy (mongoc_matcher_op_t *op);
 void
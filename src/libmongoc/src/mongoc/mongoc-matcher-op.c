@@ -331,7 +331,7 @@ _mongoc_matcher_op_type_match (mongoc_matcher_op_type_t *type, /* IN */
    BSON_ASSERT (bson);
 
    if (bson_iter_init (&iter, bson) && bson_iter_find_descendant (&iter, type->path, &desc)) {
-      return (bson_iter_type (&iter) == type->type);
+      return (bson_iter_type (&desc) == type->type);
    }
 
    return false;
@@ -406,9 +406,9 @@ _mongoc_matcher_op_not_match (mongoc_matcher_op_not_t *not_, /* IN */
  *--------------------------------------------------------------------------
  */
 
-static bool
-_mongoc_matcher_iter_eq_match (bson_iter_t *compare_iter, /* IN */
-                               bson_iter_t *iter)         /* IN */
+bool
+_mongoc_matcher_iter_eq_match (const bson_iter_t *compare_iter, /* IN */
+                               const bson_iter_t *iter)         /* IN */
 {
    int code;
 
@@ -906,10 +906,10 @@ _mongoc_matcher_op_nin_match (mongoc_matcher_op_compare_t *compare, /* IN */
 /*
  *--------------------------------------------------------------------------
  *
- * _mongoc_matcher_op_compare_match --
+ * _mongoc_matcher_op_compare_iter_match --
  *
  *       Dispatch function for mongoc_matcher_op_compare_t operations
- *       to perform a match.
+ *       to perform a match against the field found at @iter.
  *
  * Returns:
  *       Opcode dependent.
@@ -920,41 +920,30 @@ _mongoc_matcher_op_nin_match (mongoc_matcher_op_compare_t *compare, /* IN */
  *--------------------------------------------------------------------------
  */
 
-static bool
-_mongoc_matcher_op_compare_match (mongoc_matcher_op_compare_t *compare, /* IN */
-                                  const bson_t *bson)                   /* IN */
+bool
+_mongoc_matcher_op_compare_iter_match (mongoc_matcher_op_compare_t *compare, /* IN */
+                                       bson_iter_t *iter)                    /* IN */
 {
-   bson_iter_t tmp;
-   bson_iter_t iter;
-
    BSON_ASSERT (compare);
-   BSON_ASSERT (bson);
-
-   if (strchr (compare->path, '.')) {
-      if (!bson_iter_init (&tmp, bson) || !bson_iter_find_descendant (&tmp, compare->path, &iter)) {
-         return false;
-      }
-   } else if (!bson_iter_init_find (&iter, bson, compare->path)) {
-      return false;
-   }
+   BSON_ASSERT (iter);
 
    switch ((int) compare->base.opcode) {
    case MONGOC_MATCHER_OPCODE_EQ:
-      return _mongoc_matcher_op_eq_match (compare, &iter);
+      return _mongoc_matcher_op_eq_match (compare, iter);
    case MONGOC_MATCHER_OPCODE_GT:
-      return _mongoc_matcher_op_gt_match (compare, &iter);
+      return _mongoc_matcher_op_gt_match (compare, iter);
    case MONGOC_MATCHER_OPCODE_GTE:
-      return _mongoc_matcher_op_gte_match (compare, &iter);
+      return _mongoc_matcher_op_gte_match (compare, iter);
    case MONGOC_MATCHER_OPCODE_IN:
-      return _mongoc_matcher_op_in_match (compare, &iter);
+      return _mongoc_matcher_op_in_match (compare, iter);
    case MONGOC_MATCHER_OPCODE_LT:
-      return _mongoc_matcher_op_lt_match (compare, &iter);
+      return _mongoc_matcher_op_lt_match (compare, iter);
    case MONGOC_MATCHER_OPCODE_LTE:
-      return _mongoc_matcher_op_lte_match (compare, &iter);
+      return _mongoc_matcher_op_lte_match (compare, iter);
    case MONGOC_MATCHER_OPCODE_NE:
-      return _mongoc_matcher_op_ne_match (compare, &iter);
+      return _mongoc_matcher_op_ne_match (compare, iter);
    case MONGOC_MATCHER_OPCODE_NIN:
-      return _mongoc_matcher_op_nin_match (compare, &iter);
+      return _mongoc_matcher_op_nin_match (compare, iter);
    default:
       BSON_ASSERT (false);
       break;
@@ -964,6 +953,45 @@ _mongoc_matcher_op_compare_match (mongoc_matcher_op_compare_t *compare, /* IN */
 }
 
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_matcher_op_compare_match --
+ *
+ *       Finds the field at the op's path in @bson and performs the
+ *       comparison.
+ *
+ * Returns:
+ *       Opcode dependent, false if the field is not found.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static bool
+_mongoc_matcher_op_compare_match (mongoc_matcher_op_compare_t *compare, /* IN */
+                                  const bson_t *bson)                   /* IN */
+{
+   bson_iter_t tmp;
+   bson_iter_t iter;
+
+   BSON_ASSERT (compare);
+   BSON_ASSERT (bson);
+
+   if (strchr (compare->path, '.')) {
+      if (!bson_iter_init (&tmp, bson) || !bson_iter_find_descendant (&tmp, compare->path, &iter)) {
+         return false;
+      }
+   } else if (!bson_iter_init_find (&iter, bson, compare->path)) {
+      return false;
+   }
+
+   return _mongoc_matcher_op_compare_iter_match (compare, &iter);
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
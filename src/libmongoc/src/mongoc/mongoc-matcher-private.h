@@ -21,6 +21,7 @@
 
 #include <bson/bson.h>
 
+#include "mongoc-matcher-compiled-private.h"
 #include "mongoc-matcher-op-private.h"
 
 
@@ -30,6 +31,7 @@ BSON_BEGIN_DECLS
 struct _mongoc_matcher_t {
    bson_t query;
    mongoc_matcher_op_t *optree;
+   mongoc_matcher_compiled_t *compiled;
 };
 
 
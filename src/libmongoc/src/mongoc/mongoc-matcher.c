@@ -23,6 +23,11 @@
 #include "mongoc-matcher-op-private.h"
 
 
+/* documents of a buffer matched at once by mongoc_matcher_match_buffer. a
+ * multiple of 8, so each chunk starts on a byte of the bitmap. */
+#define MONGOC_MATCHER_BUFFER_CHUNK 64
+
+
 static mongoc_matcher_op_t *
 _mongoc_matcher_parse_logical (mongoc_matcher_opcode_t opcode, bson_iter_t *iter, bool is_root, bson_error_t *error);
 
@@ -278,7 +283,8 @@ _mongoc_matcher_parse_logical (mongoc_matcher_opcode_t opcode, /* IN */
  *       provided in @query.
  *
  *       This will build an operation tree that can be applied to arbitrary
- *       bson documents using mongoc_matcher_match().
+ *       bson documents using mongoc_matcher_match(), and compile it so
+ *       that each match resolves all paths in a single pass.
  *
  * Returns:
  *       A newly allocated mongoc_matcher_t if successful; otherwise NULL
@@ -315,6 +321,7 @@ mongoc_matcher_new (const bson_t *query, /* IN */
    }
 
    matcher->optree = op;
+   matcher->compiled = _mongoc_matcher_compiled_new (op);
 
    return matcher;
 
@@ -350,7 +357,137 @@ mongoc_matcher_match (const mongoc_matcher_t *matcher, /* IN */
    BSON_ASSERT (matcher->optree);
    BSON_ASSERT (document);
 
-   return _mongoc_matcher_op_match (matcher->optree, document);
+   return _mongoc_matcher_compiled_match (matcher->compiled, document);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_matcher_match_many --
+ *
+ *       Checks each of @documents against the query specified when
+ *       creating @matcher. Bit i of @bitmap, bitmap[i / 8] & (1 << (i % 8)),
+ *       is set if documents[i] matched and cleared otherwise. @bitmap must
+ *       hold at least (@n_documents + 7) / 8 bytes.
+ *
+ *       The result is the same as calling mongoc_matcher_match() on each
+ *       document, but the documents are evaluated in blocks, so each
+ *       comparison runs over many documents at once.
+ *
+ * Returns:
+ *       The number of documents that matched.
+ *
+ * Side effects:
+ *       @bitmap is written.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+size_t
+mongoc_matcher_match_many (const mongoc_matcher_t *matcher, /* IN */
+                           const bson_t *const *documents,  /* IN */
+                           size_t n_documents,              /* IN */
+                           uint8_t *bitmap)                 /* OUT */
+{
+   BSON_ASSERT (matcher);
+   BSON_ASSERT (documents || n_documents == 0);
+   BSON_ASSERT (bitmap || n_documents == 0);
+
+   return _mongoc_matcher_compiled_match_many (matcher->compiled, documents, n_documents, bitmap);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_matcher_match_buffer --
+ *
+ *       Like mongoc_matcher_match_many(), for a buffer of concatenated BSON
+ *       documents such as a raw batch read from a stream. @bitmap must
+ *       hold at least (@max_documents + 7) / 8 bytes.
+ *
+ * Returns:
+ *       true if @buffer held at most @max_documents valid documents and
+ *       @n_documents is set to their number, otherwise false and @error
+ *       is set.
+ *
+ * Side effects:
+ *       @bitmap, @n_documents and @error may be written.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_matcher_match_buffer (const mongoc_matcher_t *matcher, /* IN */
+                             const uint8_t *buffer,           /* IN */
+                             size_t buffer_len,               /* IN */
+                             uint8_t *bitmap,                 /* OUT */
+                             size_t max_documents,            /* IN */
+                             size_t *n_documents,             /* OUT */
+                             bson_error_t *error)             /* OUT */
+{
+   const bson_t *ptrs[MONGOC_MATCHER_BUFFER_CHUNK];
+   bson_t *chunk;
+   size_t offset = 0;
+   size_t n = 0;
+   size_t count = 0;
+   int32_t len;
+   bool ret = false;
+
+   BSON_ASSERT (matcher);
+   BSON_ASSERT (buffer || buffer_len == 0);
+   BSON_ASSERT (bitmap || max_documents == 0);
+   BSON_ASSERT (n_documents);
+
+   chunk = bson_aligned_alloc (BSON_ALIGNOF (bson_t), MONGOC_MATCHER_BUFFER_CHUNK * sizeof (bson_t));
+
+   while (offset < buffer_len) {
+      if (buffer_len - offset < 5u) {
+         bson_set_error (
+            error, MONGOC_ERROR_BSON, MONGOC_ERROR_BSON_INVALID, "Truncated document at offset %zu", offset);
+         goto done;
+      }
+
+      memcpy (&len, buffer + offset, sizeof (len));
+      len = BSON_UINT32_FROM_LE (len);
+
+      if (len < 5 || (size_t) len > buffer_len - offset ||
+          !bson_init_static (&chunk[count], buffer + offset, (size_t) len)) {
+         bson_set_error (
+            error, MONGOC_ERROR_BSON, MONGOC_ERROR_BSON_INVALID, "Invalid document at offset %zu", offset);
+         goto done;
+      }
+
+      if (n + count == max_documents) {
+         bson_set_error (error,
+                         MONGOC_ERROR_BSON,
+                         MONGOC_ERROR_BSON_INVALID,
+                         "Buffer holds more than %zu documents",
+                         max_documents);
+         goto done;
+      }
+
+      ptrs[count] = &chunk[count];
+      offset += (size_t) len;
+
+      if (++count == MONGOC_MATCHER_BUFFER_CHUNK) {
+         _mongoc_matcher_compiled_match_many (matcher->compiled, ptrs, count, bitmap + n / 8u);
+         n += count;
+         count = 0;
+      }
+   }
+
+   _mongoc_matcher_compiled_match_many (matcher->compiled, ptrs, count, bitmap + n / 8u);
+   n += count;
+
+   *n_documents = n;
+   ret = true;
+
+done:
+   bson_free (chunk);
+
+   return ret;
 }
 
 
@@ -375,6 +512,7 @@ mongoc_matcher_destroy (mongoc_matcher_t *matcher) /* IN */
 {
    BSON_ASSERT (matcher);
 
+   _mongoc_matcher_compiled_destroy (matcher->compiled);
    _mongoc_matcher_op_destroy (matcher->optree);
    bson_destroy (&matcher->query);
    bson_free (matcher);
@@ -33,6 +33,19 @@ MONGOC_EXPORT (mongoc_matcher_t *)
 mongoc_matcher_new (const bson_t *query, bson_error_t *error) BSON_GNUC_WARN_UNUSED_RESULT BSON_GNUC_DEPRECATED;
 MONGOC_EXPORT (bool)
 mongoc_matcher_match (const mongoc_matcher_t *matcher, const bson_t *document) BSON_GNUC_DEPRECATED;
+MONGOC_EXPORT (size_t)
+mongoc_matcher_match_many (const mongoc_matcher_t *matcher,
+                           const bson_t *const *documents,
+                           size_t n_documents,
+                           uint8_t *bitmap) BSON_GNUC_DEPRECATED;
+MONGOC_EXPORT (bool)
+mongoc_matcher_match_buffer (const mongoc_matcher_t *matcher,
+                             const uint8_t *buffer,
+                             size_t buffer_len,
+                             uint8_t *bitmap,
+                             size_t max_documents,
+                             size_t *n_documents,
+                             bson_error_t *error) BSON_GNUC_DEPRECATED;
 MONGOC_EXPORT (void)
 mongoc_matcher_destroy (mongoc_matcher_t *matcher) BSON_GNUC_DEPRECATED;
 
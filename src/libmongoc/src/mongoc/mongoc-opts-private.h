@@ -171,6 +171,9 @@ typedef struct _mongoc_read_write_opts_t {
 typedef struct _mongoc_gridfs_bucket_opts_t {
    const char *bucketName;
    int32_t chunkSizeBytes;
+   int32_t chunkBatchSize;
+   const char *chunkCompressor;
+   int32_t chunkCacheSize;
    mongoc_write_concern_t *writeConcern;
    bool write_concern_owned;
    mongoc_read_concern_t *readConcern;
@@ -179,6 +182,7 @@ typedef struct _mongoc_gridfs_bucket_opts_t {
 
 typedef struct _mongoc_gridfs_bucket_upload_opts_t {
    int32_t chunkSizeBytes;
+   int32_t chunkBatchSize;
    bson_t metadata;
    bson_t extra;
 } mongoc_gridfs_bucket_upload_opts_t;
@@ -221,6 +225,11 @@ typedef struct _mongoc_count_document_opts_t {
    bson_t extra;
 } mongoc_count_document_opts_t;
 
+typedef struct _mongoc_parallel_scan_opts_t {
+   int32_t partitions;
+   bson_t extra;
+} mongoc_parallel_scan_opts_t;
+
 bool
 _mongoc_insert_one_opts_parse (
    mongoc_client_t *client,
@@ -441,4 +450,14 @@ _mongoc_count_document_opts_parse (
 void
 _mongoc_count_document_opts_cleanup (mongoc_count_document_opts_t *mongoc_count_document_opts);
 
+bool
+_mongoc_parallel_scan_opts_parse (
+   mongoc_client_t *client,
+   const bson_t *opts,
+   mongoc_parallel_scan_opts_t *mongoc_parallel_scan_opts,
+   bson_error_t *error);
+
+void
+_mongoc_parallel_scan_opts_cleanup (mongoc_parallel_scan_opts_t *mongoc_parallel_scan_opts);
+
 #endif /* MONGOC_OPTS_H */
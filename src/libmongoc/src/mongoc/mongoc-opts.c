@@ -1935,6 +1935,9 @@ _mongoc_gridfs_bucket_opts_parse (
 
    mongoc_gridfs_bucket_opts->bucketName = "fs";
    mongoc_gridfs_bucket_opts->chunkSizeBytes = 261120;
+   mongoc_gridfs_bucket_opts->chunkBatchSize = 1;
+   mongoc_gridfs_bucket_opts->chunkCompressor = "";
+   mongoc_gridfs_bucket_opts->chunkCacheSize = 0;
    mongoc_gridfs_bucket_opts->writeConcern = NULL;
    mongoc_gridfs_bucket_opts->write_concern_owned = false;
    mongoc_gridfs_bucket_opts->readConcern = NULL;
@@ -1971,6 +1974,33 @@ _mongoc_gridfs_bucket_opts_parse (
             return false;
          }
       }
+      else if (!strcmp (bson_iter_key (&iter), "chunkBatchSize")) {
+         if (!_mongoc_convert_int32_positive (
+               client,
+               &iter,
+               &mongoc_gridfs_bucket_opts->chunkBatchSize,
+               error)) {
+            return false;
+         }
+      }
+      else if (!strcmp (bson_iter_key (&iter), "chunkCompressor")) {
+         if (!_mongoc_convert_utf8 (
+               client,
+               &iter,
+               &mongoc_gridfs_bucket_opts->chunkCompressor,
+               error)) {
+            return false;
+         }
+      }
+      else if (!strcmp (bson_iter_key (&iter), "chunkCacheSize")) {
+         if (!_mongoc_convert_int32_positive (
+               client,
+               &iter,
+               &mongoc_gridfs_bucket_opts->chunkCacheSize,
+               error)) {
+            return false;
+         }
+      }
       else if (!strcmp (bson_iter_key (&iter), "writeConcern")) {
          if (!_mongoc_convert_write_concern (
                client,
@@ -2031,6 +2061,7 @@ _mongoc_gridfs_bucket_upload_opts_parse (
    BSON_ASSERT (client || true); // client may be NULL.
 
    mongoc_gridfs_bucket_upload_opts->chunkSizeBytes = 0;
+   mongoc_gridfs_bucket_upload_opts->chunkBatchSize = 0;
    bson_init (&mongoc_gridfs_bucket_upload_opts->metadata);
    bson_init (&mongoc_gridfs_bucket_upload_opts->extra);
 
@@ -2056,6 +2087,15 @@ _mongoc_gridfs_bucket_upload_opts_parse (
             return false;
          }
       }
+      else if (!strcmp (bson_iter_key (&iter), "chunkBatchSize")) {
+         if (!_mongoc_convert_int32_positive (
+               client,
+               &iter,
+               &mongoc_gridfs_bucket_upload_opts->chunkBatchSize,
+               error)) {
+            return false;
+         }
+      }
       else if (!strcmp (bson_iter_key (&iter), "metadata")) {
          if (!_mongoc_convert_document (
                client,
@@ -2498,3 +2538,63 @@ _mongoc_count_document_opts_cleanup (mongoc_count_document_opts_t *mongoc_count_
    bson_value_destroy (&mongoc_count_document_opts->hint);
    bson_destroy (&mongoc_count_document_opts->extra);
 }
+
+bool
+_mongoc_parallel_scan_opts_parse (
+   mongoc_client_t *client,
+   const bson_t *opts,
+   mongoc_parallel_scan_opts_t *mongoc_parallel_scan_opts,
+   bson_error_t *error)
+{
+   bson_iter_t iter;
+
+   BSON_ASSERT (client || true); // client may be NULL.
+
+   mongoc_parallel_scan_opts->partitions = 4;
+   bson_init (&mongoc_parallel_scan_opts->extra);
+
+   if (!opts) {
+      return true;
+   }
+
+   if (!bson_iter_init (&iter, opts)) {
+      bson_set_error (error,
+                      MONGOC_ERROR_BSON,
+                      MONGOC_ERROR_BSON_INVALID,
+                      "Invalid 'opts' parameter.");
+      return false;
+   }
+
+   while (bson_iter_next (&iter)) {
+      if (!strcmp (bson_iter_key (&iter), "partitions")) {
+         if (!_mongoc_convert_int32_positive (
+               client,
+               &iter,
+               &mongoc_parallel_scan_opts->partitions,
+               error)) {
+            return false;
+         }
+      }
+      else {
+         /* unrecognized values are copied to "extra" */
+         if (!BSON_APPEND_VALUE (
+               &mongoc_parallel_scan_opts->extra,
+               bson_iter_key (&iter),
+               bson_iter_value (&iter))) {
+            bson_set_error (error,
+                            MONGOC_ERROR_BSON,
+                            MONGOC_ERROR_BSON_INVALID,
+                            "Invalid 'opts' parameter.");
+            return false;
+         }
+      }
+   }
+
+   return true;
+}
+
+void
+_mongoc_parallel_scan_opts_cleanup (mongoc_parallel_scan_opts_t *mongoc_parallel_scan_opts)
+{
+   bson_destroy (&mongoc_parallel_scan_opts->extra);
+}
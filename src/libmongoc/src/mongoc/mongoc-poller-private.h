@@ -0,0 +1,64 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mongoc-prelude.h"
+
+#ifndef MONGOC_POLLER_PRIVATE_H
+#define MONGOC_POLLER_PRIVATE_H
+
+#include <bson/bson.h>
+
+#include "mongoc-stream.h"
+
+
+BSON_BEGIN_DECLS
+
+
+/* A set of streams that is waited on repeatedly. Streams are registered once
+ * and their events changed in place, so a wait does not rebuild a poll set.
+ * Socket streams are waited on with epoll where it is available; if any other
+ * kind of stream is added, or epoll is not available, the poller falls back to
+ * mongoc_stream_poll () over the registered streams. */
+typedef struct _mongoc_poller_t mongoc_poller_t;
+
+typedef struct {
+   void *ctx;
+   int revents;
+} mongoc_poller_event_t;
+
+
+mongoc_poller_t *
+_mongoc_poller_new (void);
+void
+_mongoc_poller_destroy (mongoc_poller_t *poller);
+size_t
+_mongoc_poller_add (mongoc_poller_t *poller, mongoc_stream_t *stream, int events, void *ctx);
+void
+_mongoc_poller_modify (mongoc_poller_t *poller, size_t slot, int events);
+void
+_mongoc_poller_remove (mongoc_poller_t *poller, size_t slot);
+size_t
+_mongoc_poller_count (const mongoc_poller_t *poller);
+bool
+_mongoc_poller_uses_epoll (const mongoc_poller_t *poller);
+ssize_t
+_mongoc_poller_wait (mongoc_poller_t *poller, mongoc_poller_event_t *events, size_t max_events, int32_t timeout_msec);
+
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_POLLER_PRIVATE_H */
@@ -0,0 +1,374 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "mongoc-config.h"
+#include "mongoc-poller-private.h"
+
+#ifdef MONGOC_HAVE_EPOLL
+#include <errno.h>
+#include <limits.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+#include "mongoc-array-private.h"
+#include "mongoc-socket-private.h"
+#include "mongoc-stream-private.h"
+#include "mongoc-trace-private.h"
+
+#undef MONGOC_LOG_DOMAIN
+#define MONGOC_LOG_DOMAIN "poller"
+
+
+typedef struct {
+   mongoc_stream_t *stream; /* NULL if the slot is free */
+   void *ctx;
+   int events;
+} mongoc_poller_entry_t;
+
+
+struct _mongoc_poller_t {
+   mongoc_array_t entries;    /* mongoc_poller_entry_t, indexed by slot */
+   mongoc_array_t free_slots; /* size_t */
+   size_t count;
+#ifdef MONGOC_HAVE_EPOLL
+   int epfd; /* -1 once the poller has fallen back to mongoc_stream_poll */
+   struct epoll_event *ready;
+   size_t ready_size;
+#endif
+   mongoc_array_t polled;       /* mongoc_stream_poll_t */
+   mongoc_array_t polled_slots; /* size_t */
+};
+
+
+#ifdef MONGOC_HAVE_EPOLL
+static uint32_t
+_mongoc_poller_to_epoll (int events)
+{
+   uint32_t epoll_events = 0;
+
+   if (events & POLLIN) {
+      epoll_events |= EPOLLIN;
+   }
+
+   if (events & POLLOUT) {
+      epoll_events |= EPOLLOUT;
+   }
+
+   if (events & POLLPRI) {
+      epoll_events |= EPOLLPRI;
+   }
+
+   return epoll_events;
+}
+
+
+static int
+_mongoc_poller_from_epoll (uint32_t epoll_events)
+{
+   int revents = 0;
+
+   if (epoll_events & EPOLLIN) {
+      revents |= POLLIN;
+   }
+
+   if (epoll_events & EPOLLOUT) {
+      revents |= POLLOUT;
+   }
+
+   if (epoll_events & EPOLLPRI) {
+      revents |= POLLPRI;
+   }
+
+   if (epoll_events & EPOLLERR) {
+      revents |= POLLERR;
+   }
+
+   if (epoll_events & EPOLLHUP) {
+      revents |= POLLHUP;
+   }
+
+   return revents;
+}
+
+
+static bool
+_mongoc_poller_epoll_ctl (mongoc_poller_t *poller, int op, size_t slot)
+{
+   mongoc_poller_entry_t *entry = &_mongoc_array_index (&poller->entries, mongoc_poller_entry_t, slot);
+   mongoc_socket_t *sock = _mongoc_stream_socket_get_pollable (mongoc_stream_get_root_stream (entry->stream));
+   struct epoll_event ev = {0};
+
+   if (!sock) {
+      return false;
+   }
+
+   ev.events = _mongoc_poller_to_epoll (entry->events);
+   ev.data.u64 = slot;
+
+   if (epoll_ctl (poller->epfd, op, sock->sd, &ev) != 0) {
+      TRACE ("epoll_ctl failed: %d", errno);
+      return false;
+   }
+
+   return true;
+}
+
+
+/* closing the epoll instance drops every registration; from now on each wait
+ * goes through mongoc_stream_poll (). */
+static void
+_mongoc_poller_epoll_disable (mongoc_poller_t *poller)
+{
+   if (poller->epfd != -1) {
+      close (poller->epfd);
+      poller->epfd = -1;
+   }
+}
+#endif
+
+
+mongoc_poller_t *
+_mongoc_poller_new (void)
+{
+   mongoc_poller_t *poller = (mongoc_poller_t *) bson_malloc0 (sizeof *poller);
+
+   _mongoc_array_init (&poller->entries, sizeof (mongoc_poller_entry_t));
+   _mongoc_array_init (&poller->free_slots, sizeof (size_t));
+   _mongoc_array_init (&poller->polled, sizeof (mongoc_stream_poll_t));
+   _mongoc_array_init (&poller->polled_slots, sizeof (size_t));
+
+#ifdef MONGOC_HAVE_EPOLL
+   poller->epfd = epoll_create1 (EPOLL_CLOEXEC);
+   if (poller->epfd == -1) {
+      TRACE ("epoll_create1 failed: %d", errno);
+   }
+#endif
+
+   return poller;
+}
+
+
+void
+_mongoc_poller_destroy (mongoc_poller_t *poller)
+{
+   if (!poller) {
+      return;
+   }
+
+#ifdef MONGOC_HAVE_EPOLL
+   _mongoc_poller_epoll_disable (poller);
+   bson_free (poller->ready);
+#endif
+
+   _mongoc_array_destroy (&poller->polled_slots);
+   _mongoc_array_destroy (&poller->polled);
+   _mongoc_array_destroy (&poller->free_slots);
+   _mongoc_array_destroy (&poller->entries);
+   bson_free (poller);
+}
+
+
+size_t
+_mongoc_poller_add (mongoc_poller_t *poller, mongoc_stream_t *stream, int events, void *ctx)
+{
+   mongoc_poller_entry_t entry;
+   size_t slot;
+
+   BSON_ASSERT_PARAM (poller);
+   BSON_ASSERT_PARAM (stream);
+
+   entry.stream = stream;
+   entry.ctx = ctx;
+   entry.events = events;
+
+   if (poller->free_slots.len) {
+      slot = _mongoc_array_index (&poller->free_slots, size_t, --poller->free_slots.len);
+      _mongoc_array_index (&poller->entries, mongoc_poller_entry_t, slot) = entry;
+   } else {
+      slot = poller->entries.len;
+      _mongoc_array_append_val (&poller->entries, entry);
+   }
+
+   poller->count++;
+
+#ifdef MONGOC_HAVE_EPOLL
+   if (poller->epfd != -1 && !_mongoc_poller_epoll_ctl (poller, EPOLL_CTL_ADD, slot)) {
+      _mongoc_poller_epoll_disable (poller);
+   }
+#endif
+
+   return slot;
+}
+
+
+void
+_mongoc_poller_modify (mongoc_poller_t *poller, size_t slot, int events)
+{
+   mongoc_poller_entry_t *entry;
+
+   BSON_ASSERT_PARAM (poller);
+   BSON_ASSERT (slot < poller->entries.len);
+
+   entry = &_mongoc_array_index (&poller->entries, mongoc_poller_entry_t, slot);
+   BSON_ASSERT (entry->stream);
+
+   if (entry->events == events) {
+      return;
+   }
+
+   entry->events = events;
+
+#ifdef MONGOC_HAVE_EPOLL
+   if (poller->epfd != -1 && !_mongoc_poller_epoll_ctl (poller, EPOLL_CTL_MOD, slot)) {
+      _mongoc_poller_epoll_disable (poller);
+   }
+#endif
+}
+
+
+void
+_mongoc_poller_remove (mongoc_poller_t *poller, size_t slot)
+{
+   mongoc_poller_entry_t *entry;
+
+   BSON_ASSERT_PARAM (poller);
+   BSON_ASSERT (slot < poller->entries.len);
+
+   entry = &_mongoc_array_index (&poller->entries, mongoc_poller_entry_t, slot);
+   BSON_ASSERT (entry->stream);
+
+#ifdef MONGOC_HAVE_EPOLL
+   if (poller->epfd != -1) {
+      /* the stream must still be open: a closed descriptor number may already
+       * have been reused by another socket. */
+      (void) _mongoc_poller_epoll_ctl (poller, EPOLL_CTL_DEL, slot);
+   }
+#endif
+
+   entry->stream = NULL;
+   entry->ctx = NULL;
+   _mongoc_array_append_val (&poller->free_slots, slot);
+   poller->count--;
+}
+
+
+size_t
+_mongoc_poller_count (const mongoc_poller_t *poller)
+{
+   BSON_ASSERT_PARAM (poller);
+
+   return poller->count;
+}
+
+
+bool
+_mongoc_poller_uses_epoll (const mongoc_poller_t *poller)
+{
+   BSON_ASSERT_PARAM (poller);
+
+#ifdef MONGOC_HAVE_EPOLL
+   return poller->epfd != -1;
+#else
+   return false;
+#endif
+}
+
+
+static ssize_t
+_mongoc_poller_wait_streams (mongoc_poller_t *poller,
+                             mongoc_poller_event_t *events,
+                             size_t max_events,
+                             int32_t timeout_msec)
+{
+   mongoc_stream_poll_t *polled;
+   size_t n_events = 0;
+   ssize_t ret;
+
+   _mongoc_array_clear (&poller->polled);
+   _mongoc_array_clear (&poller->polled_slots);
+
+   for (size_t slot = 0u; slot < poller->entries.len; slot++) {
+      const mongoc_poller_entry_t *entry = &_mongoc_array_index (&poller->entries, mongoc_poller_entry_t, slot);
+      mongoc_stream_poll_t poll_entry;
+
+      if (!entry->stream) {
+         continue;
+      }
+
+      poll_entry.stream = entry->stream;
+      poll_entry.events = entry->events;
+      poll_entry.revents = 0;
+      _mongoc_array_append_val (&poller->polled, poll_entry);
+      _mongoc_array_append_val (&poller->polled_slots, slot);
+   }
+
+   ret = mongoc_stream_poll ((mongoc_stream_poll_t *) poller->polled.data, poller->polled.len, timeout_msec);
+   if (ret <= 0) {
+      return ret;
+   }
+
+   polled = (mongoc_stream_poll_t *) poller->polled.data;
+   for (size_t i = 0u; i < poller->polled.len && n_events < max_events; i++) {
+      const size_t slot = _mongoc_array_index (&poller->polled_slots, size_t, i);
+
+      if (polled[i].revents) {
+         events[n_events].ctx = _mongoc_array_index (&poller->entries, mongoc_poller_entry_t, slot).ctx;
+         events[n_events].revents = polled[i].revents;
+         n_events++;
+      }
+   }
+
+   return (ssize_t) n_events;
+}
+
+
+ssize_t
+_mongoc_poller_wait (mongoc_poller_t *poller, mongoc_poller_event_t *events, size_t max_events, int32_t timeout_msec)
+{
+   BSON_ASSERT_PARAM (poller);
+   BSON_ASSERT (events || max_events == 0);
+
+   if (poller->count == 0 || max_events == 0) {
+      return 0;
+   }
+
+#ifdef MONGOC_HAVE_EPOLL
+   if (poller->epfd != -1) {
+      const int max = (int) BSON_MIN (max_events, (size_t) INT_MAX);
+      int ret;
+
+      if (poller->ready_size < (size_t) max) {
+         poller->ready_size = (size_t) max;
+         poller->ready =
+            (struct epoll_event *) bson_realloc (poller->ready, sizeof (struct epoll_event) * poller->ready_size);
+      }
+
+      ret = epoll_wait (poller->epfd, poller->ready, max, timeout_msec);
+      for (int i = 0; i < ret; i++) {
+         const size_t slot = (size_t) poller->ready[i].data.u64;
+
+         events[i].ctx = _mongoc_array_index (&poller->entries, mongoc_poller_entry_t, slot).ctx;
+         events[i].revents = _mongoc_poller_from_epoll (poller->ready[i].events);
+      }
+
+      return ret;
+   }
+#endif
+
+   return _mongoc_poller_wait_streams (poller, events, max_events, timeout_msec);
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mongoc-prelude.h"
+
+#ifndef MONGOC_RR_CACHE_PRIVATE_H
+#define MONGOC_RR_CACHE_PRIVATE_H
+
+#include <bson/bson.h>
+
+#include "mongoc-topology-private.h"
+
+
+BSON_BEGIN_DECLS
+
+
+/* A process-wide cache of SRV and TXT answers, keyed by the queried name and
+ * kept for the lowest TTL of the answer. A missing TXT record is kept as long
+ * as the cached SRV answer for the same name. Failed lookups, SRV answers
+ * without hosts, and answers with a zero TTL are not cached. */
+
+void
+_mongoc_rr_cache_init (void);
+void
+_mongoc_rr_cache_cleanup (void);
+
+/* A _mongoc_rr_resolver_fn: answers from the cache while the entry is fresh,
+ * with @rr_data->min_ttl set to the time the entry has left. Otherwise queries
+ * DNS and caches the answer. */
+bool
+_mongoc_rr_cache_get_rr (const char *hostname,
+                         mongoc_rr_type_t rr_type,
+                         mongoc_rr_data_t *rr_data,
+                         size_t initial_buffer_size,
+                         bson_error_t *error);
+
+/* Replace the resolver that answers cache misses, defaulting to
+ * _mongoc_client_get_rr if @resolver is NULL. Returns the previous resolver.
+ * Called by tests to answer DNS queries locally. */
+_mongoc_rr_resolver_fn
+_mongoc_rr_cache_set_resolver (_mongoc_rr_resolver_fn resolver);
+
+void
+_mongoc_rr_cache_clear (void);
+
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_RR_CACHE_PRIVATE_H */
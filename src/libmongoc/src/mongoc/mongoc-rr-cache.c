@@ -0,0 +1,272 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "mongoc-rr-cache-private.h"
+
+#include "mongoc-client-private.h"
+#include "mongoc-host-list-private.h"
+#include "mongoc-trace-private.h"
+#include "utlist.h"
+
+#include <common-thread-private.h>
+
+#undef MONGOC_LOG_DOMAIN
+#define MONGOC_LOG_DOMAIN "rr-cache"
+
+
+typedef struct _rr_cache_entry_t {
+   struct _rr_cache_entry_t *next;
+   char *hostname;
+   mongoc_rr_type_t rr_type;
+   uint32_t count;
+   mongoc_host_list_t *hosts;
+   char *txt_record_opts;
+   int64_t expires_at; /* monotonic microseconds */
+} rr_cache_entry_t;
+
+static rr_cache_entry_t *rr_cache;
+static _mongoc_rr_resolver_fn rr_cache_resolver = _mongoc_client_get_rr;
+static bson_mutex_t rr_cache_mutex;
+
+
+static void
+_rr_cache_entry_destroy (rr_cache_entry_t *entry)
+{
+   bson_free (entry->hostname);
+   _mongoc_host_list_destroy_all (entry->hosts);
+   bson_free (entry->txt_record_opts);
+   bson_free (entry);
+}
+
+
+/* requires rr_cache_mutex. */
+static rr_cache_entry_t *
+_rr_cache_find (const char *hostname, mongoc_rr_type_t rr_type)
+{
+   rr_cache_entry_t *iter;
+
+   LL_FOREACH (rr_cache, iter)
+   {
+      if (iter->rr_type == rr_type && strcasecmp (iter->hostname, hostname) == 0) {
+         return iter;
+      }
+   }
+
+   return NULL;
+}
+
+
+/* requires rr_cache_mutex. Returns the live SRV entry for
+ * "_<service>._tcp.@hostname", which a TXT answer for @hostname accompanies. */
+static rr_cache_entry_t *
+_rr_cache_find_srv (const char *hostname, int64_t now)
+{
+   static const char tcp[] = "._tcp.";
+   const size_t len = strlen (hostname) + sizeof tcp - 1u;
+   rr_cache_entry_t *iter;
+
+   LL_FOREACH (rr_cache, iter)
+   {
+      const size_t iter_len = strlen (iter->hostname);
+      const char *suffix;
+
+      if (iter->rr_type != MONGOC_RR_SRV || iter_len <= len || now >= iter->expires_at) {
+         continue;
+      }
+
+      suffix = iter->hostname + iter_len - len;
+      if (strncasecmp (suffix, tcp, sizeof tcp - 1u) == 0 && strcasecmp (suffix + sizeof tcp - 1u, hostname) == 0) {
+         return iter;
+      }
+   }
+
+   return NULL;
+}
+
+
+static bool
+_rr_cache_lookup (const char *hostname, mongoc_rr_type_t rr_type, mongoc_rr_data_t *rr_data)
+{
+   rr_cache_entry_t *entry;
+   const int64_t now = bson_get_monotonic_time ();
+   bool found = false;
+
+   bson_mutex_lock (&rr_cache_mutex);
+   entry = _rr_cache_find (hostname, rr_type);
+   if (!entry) {
+      GOTO (done);
+   }
+
+   if (now >= entry->expires_at) {
+      LL_DELETE (rr_cache, entry);
+      _rr_cache_entry_destroy (entry);
+      GOTO (done);
+   }
+
+   rr_data->count = entry->count;
+   /* round up, so a fresh entry never reports a zero TTL. */
+   rr_data->min_ttl = (uint32_t) ((entry->expires_at - now + 999999) / 1000000);
+
+   if (rr_type == MONGOC_RR_SRV) {
+      const mongoc_host_list_t *host;
+
+      LL_FOREACH (entry->hosts, host)
+      {
+         _mongoc_host_list_upsert (&rr_data->hosts, host);
+      }
+   } else {
+      bson_free (rr_data->txt_record_opts);
+      rr_data->txt_record_opts = bson_strdup (entry->txt_record_opts);
+   }
+
+   found = true;
+
+done:
+   bson_mutex_unlock (&rr_cache_mutex);
+   return found;
+}
+
+
+static void
+_rr_cache_store (const char *hostname, mongoc_rr_type_t rr_type, const mongoc_rr_data_t *rr_data)
+{
+   const int64_t now = bson_get_monotonic_time ();
+   rr_cache_entry_t *entry;
+   rr_cache_entry_t *srv;
+   int64_t expires_at;
+
+   if (rr_type == MONGOC_RR_SRV && !rr_data->hosts) {
+      return;
+   }
+
+   bson_mutex_lock (&rr_cache_mutex);
+   if (rr_type == MONGOC_RR_TXT && !rr_data->txt_record_opts) {
+      /* a missing TXT record has no TTL of its own. Remember it as long as
+       * the SRV answer it accompanies, so new clients skip the query. */
+      srv = _rr_cache_find_srv (hostname, now);
+      if (!srv) {
+         GOTO (done);
+      }
+
+      expires_at = srv->expires_at;
+   } else {
+      if (rr_data->min_ttl == 0) {
+         GOTO (done);
+      }
+
+      expires_at = now + (int64_t) rr_data->min_ttl * 1000000;
+   }
+
+   entry = _rr_cache_find (hostname, rr_type);
+   if (entry) {
+      _mongoc_host_list_destroy_all (entry->hosts);
+      bson_free (entry->txt_record_opts);
+   } else {
+      entry = (rr_cache_entry_t *) bson_malloc0 (sizeof *entry);
+      entry->hostname = bson_strdup (hostname);
+      entry->rr_type = rr_type;
+      LL_PREPEND (rr_cache, entry);
+   }
+
+   entry->count = rr_data->count;
+   entry->hosts = _mongoc_host_list_copy_all (rr_data->hosts);
+   entry->txt_record_opts = bson_strdup (rr_data->txt_record_opts);
+   entry->expires_at = expires_at;
+
+done:
+   bson_mutex_unlock (&rr_cache_mutex);
+}
+
+
+void
+_mongoc_rr_cache_init (void)
+{
+   bson_mutex_init (&rr_cache_mutex);
+}
+
+
+void
+_mongoc_rr_cache_cleanup (void)
+{
+   _mongoc_rr_cache_clear ();
+   bson_mutex_destroy (&rr_cache_mutex);
+}
+
+
+bool
+_mongoc_rr_cache_get_rr (const char *hostname,
+                         mongoc_rr_type_t rr_type,
+                         mongoc_rr_data_t *rr_data,
+                         size_t initial_buffer_size,
+                         bson_error_t *error)
+{
+   _mongoc_rr_resolver_fn resolver;
+
+   ENTRY;
+
+   BSON_ASSERT_PARAM (hostname);
+   BSON_ASSERT_PARAM (rr_data);
+
+   if (_rr_cache_lookup (hostname, rr_type, rr_data)) {
+      TRACE ("cached %s answer for \"%s\"", rr_type == MONGOC_RR_SRV ? "SRV" : "TXT", hostname);
+      RETURN (true);
+   }
+
+   bson_mutex_lock (&rr_cache_mutex);
+   resolver = rr_cache_resolver;
+   bson_mutex_unlock (&rr_cache_mutex);
+
+   /* the lock is not held while querying DNS; concurrent misses for the same
+    * name each query, and the last answer is kept. */
+   if (!resolver (hostname, rr_type, rr_data, initial_buffer_size, error)) {
+      RETURN (false);
+   }
+
+   _rr_cache_store (hostname, rr_type, rr_data);
+
+   RETURN (true);
+}
+
+
+_mongoc_rr_resolver_fn
+_mongoc_rr_cache_set_resolver (_mongoc_rr_resolver_fn resolver)
+{
+   _mongoc_rr_resolver_fn prev;
+
+   bson_mutex_lock (&rr_cache_mutex);
+   prev = rr_cache_resolver;
+   rr_cache_resolver = resolver ? resolver : _mongoc_client_get_rr;
+   bson_mutex_unlock (&rr_cache_mutex);
+
+   return prev;
+}
+
+
+void
+_mongoc_rr_cache_clear (void)
+{
+   rr_cache_entry_t *iter;
+   rr_cache_entry_t *tmp;
+
+   bson_mutex_lock (&rr_cache_mutex);
+   LL_FOREACH_SAFE (rr_cache, iter, tmp)
+   {
+      LL_DELETE (rr_cache, iter);
+      _rr_cache_entry_destroy (iter);
+   }
+   bson_mutex_unlock (&rr_cache_mutex);
+}
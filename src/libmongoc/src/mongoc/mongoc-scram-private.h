@@ -37,19 +37,29 @@ BSON_BEGIN_DECLS
 
 #define MONGOC_SCRAM_B64_HASH_MAX_SIZE MONGOC_SCRAM_B64_ENCODED_SIZE (MONGOC_SCRAM_HASH_MAX_SIZE)
 
+/* Cache keys are a SHA-256 digest of the user, password, salt, and iteration
+ * count, so the password itself is never stored in the cache. */
+#define MONGOC_SCRAM_CACHE_KEY_SIZE MONGOC_SCRAM_SHA_256_HASH_SIZE
+
 enum {
-   /* It is unlikely that there will be more than 64 different user accounts
-    * used in a single process */
-   MONGOC_SCRAM_CACHE_SIZE = 64,
+   /* The cache is set-associative: a key maps to one set, and the least
+    * recently used entry in the set is replaced when the set is full. */
+   MONGOC_SCRAM_CACHE_SIZE = 1024,
+   MONGOC_SCRAM_CACHE_WAYS = 8,
 };
 
+/* The secrets derived from a salted password. */
+typedef struct _mongoc_scram_cache_entry_t {
+   uint8_t client_key[MONGOC_SCRAM_HASH_MAX_SIZE];
+   uint8_t server_key[MONGOC_SCRAM_HASH_MAX_SIZE];
+   uint8_t salted_password[MONGOC_SCRAM_HASH_MAX_SIZE];
+} mongoc_scram_cache_entry_t;
+
 typedef struct _mongoc_scram_t {
    int step;
    char *user;
    char *pass;
-   char hashed_password[MONGOC_SCRAM_HASH_MAX_SIZE];
-   uint8_t decoded_salt[MONGOC_SCRAM_B64_HASH_MAX_SIZE];
-   uint32_t iterations;
+   uint8_t cache_key[MONGOC_SCRAM_CACHE_KEY_SIZE];
    uint8_t client_key[MONGOC_SCRAM_HASH_MAX_SIZE];
    uint8_t server_key[MONGOC_SCRAM_HASH_MAX_SIZE];
    uint8_t salted_password[MONGOC_SCRAM_HASH_MAX_SIZE];
@@ -83,6 +93,15 @@ _mongoc_scram_set_salted_password (mongoc_scram_t *scram, const uint8_t *salted_
 void
 _mongoc_scram_destroy (mongoc_scram_t *scram);
 
+/* Lookups do not take a lock, and may run concurrently with insertions.
+ * _mongoc_scram_cache_lookup and _mongoc_scram_cache_insert are exposed for
+ * testing. */
+bool
+_mongoc_scram_cache_lookup (const uint8_t key[MONGOC_SCRAM_CACHE_KEY_SIZE], mongoc_scram_cache_entry_t *entry /* OUT */);
+
+void
+_mongoc_scram_cache_insert (const uint8_t key[MONGOC_SCRAM_CACHE_KEY_SIZE], const mongoc_scram_cache_entry_t *entry);
+
 bool
 _mongoc_scram_step (mongoc_scram_t *scram,
                     const uint8_t *inbuf,
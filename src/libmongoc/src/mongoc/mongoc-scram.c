@@ -32,19 +32,6 @@
 #include "common-thread-private.h"
 #include <utf8proc.h>
 
-typedef struct _mongoc_scram_cache_entry_t {
-   /* book keeping */
-   bool taken;
-   /* pre-secrets */
-   char hashed_password[MONGOC_SCRAM_HASH_MAX_SIZE];
-   uint8_t decoded_salt[MONGOC_SCRAM_B64_HASH_MAX_SIZE];
-   uint32_t iterations;
-   /* secrets */
-   uint8_t client_key[MONGOC_SCRAM_HASH_MAX_SIZE];
-   uint8_t server_key[MONGOC_SCRAM_HASH_MAX_SIZE];
-   uint8_t salted_password[MONGOC_SCRAM_HASH_MAX_SIZE];
-} mongoc_scram_cache_entry_t;
-
 #define MONGOC_SCRAM_SERVER_KEY "Server Key"
 #define MONGOC_SCRAM_CLIENT_KEY "Client Key"
 
@@ -74,34 +61,40 @@ _mongoc_utf8_code_point_length (uint32_t c);
 ssize_t
 _mongoc_utf8_code_point_to_str (uint32_t c, char *out);
 
-static bson_shared_mutex_t g_scram_cache_rwlock;
+enum {
+   MONGOC_SCRAM_CACHE_SETS = MONGOC_SCRAM_CACHE_SIZE / MONGOC_SCRAM_CACHE_WAYS,
+   MONGOC_SCRAM_CACHE_KEY_WORDS = MONGOC_SCRAM_CACHE_KEY_SIZE / sizeof (int64_t),
+   MONGOC_SCRAM_CACHE_ENTRY_WORDS = sizeof (mongoc_scram_cache_entry_t) / sizeof (int64_t),
+};
 
-static bson_once_t init_cache_once_control = BSON_ONCE_INIT;
-static bson_mutex_t clear_cache_lock;
+BSON_STATIC_ASSERT2 (scram_cache_sets_pow2, (MONGOC_SCRAM_CACHE_SETS & (MONGOC_SCRAM_CACHE_SETS - 1)) == 0);
+BSON_STATIC_ASSERT2 (scram_cache_key_words, MONGOC_SCRAM_CACHE_KEY_SIZE % sizeof (int64_t) == 0);
+BSON_STATIC_ASSERT2 (scram_cache_entry_words, sizeof (mongoc_scram_cache_entry_t) % sizeof (int64_t) == 0);
 
 /*
- * Cache lookups are a linear search through this table. This table is a
- * constant size, which is small enough that lookup cost is insignificant.
- *
- * This can be refactored into a hashmap if the cache size needs to grow larger
- * in the future, but a linear lookup is currently fast enough and is much
- * simpler logic to reason about.
+ * A cache slot is guarded by a sequence lock. Writers are serialized by
+ * g_scram_cache_write_lock, and make `seq` odd while writing. Readers do not
+ * lock: they copy the slot and discard the copy if `seq` was odd or changed
+ * while copying. Every field is accessed atomically, one word at a time.
  */
-static mongoc_scram_cache_entry_t g_scram_cache[MONGOC_SCRAM_CACHE_SIZE];
+typedef struct _mongoc_scram_cache_slot_t {
+   /* Zero if the slot was never written. */
+   int64_t seq;
+   /* Value of g_scram_cache_clock when the slot was last inserted or found. */
+   int64_t last_used;
+   int64_t key[MONGOC_SCRAM_CACHE_KEY_WORDS];
+   int64_t entry[MONGOC_SCRAM_CACHE_ENTRY_WORDS];
+} mongoc_scram_cache_slot_t;
+
+static mongoc_scram_cache_slot_t g_scram_cache[MONGOC_SCRAM_CACHE_SIZE];
+static int64_t g_scram_cache_clock;
 
-static void
-_mongoc_scram_cache_clear (void)
-{
-   bson_mutex_lock (&clear_cache_lock);
-   memset (g_scram_cache, 0, sizeof (g_scram_cache));
-   bson_mutex_unlock (&clear_cache_lock);
-}
+static bson_once_t init_cache_once_control = BSON_ONCE_INIT;
+static bson_mutex_t g_scram_cache_write_lock;
 
 static BSON_ONCE_FUN (_mongoc_scram_cache_init)
 {
-   bson_shared_mutex_init (&g_scram_cache_rwlock);
-   bson_mutex_init (&clear_cache_lock);
-   _mongoc_scram_cache_clear ();
+   bson_mutex_init (&g_scram_cache_write_lock);
 
    BSON_ONCE_RETURN;
 }
@@ -136,56 +129,199 @@ _mongoc_scram_cache_apply_secrets (mongoc_scram_cache_entry_t *cache, mongoc_scr
 }
 
 
-void
-_mongoc_scram_cache_destroy (mongoc_scram_cache_entry_t *cache)
+static mongoc_scram_cache_slot_t *
+_mongoc_scram_cache_set (const uint8_t key[MONGOC_SCRAM_CACHE_KEY_SIZE])
 {
-   BSON_ASSERT (cache);
-   bson_free (cache);
+   uint32_t hash;
+
+   /* The key is a digest, so any of its bits are uniformly distributed. */
+   memcpy (&hash, key, sizeof (hash));
+
+   return &g_scram_cache[(hash & (MONGOC_SCRAM_CACHE_SETS - 1u)) * MONGOC_SCRAM_CACHE_WAYS];
 }
 
 
 /*
- * Checks whether the cache contains scram's pre-secrets.
- * Populate `cache` with the values found in the global cache if found.
+ * Copies a slot's entry into `entry` if the slot holds `key`. Does not lock.
+ * Returns false if the slot is empty, holds another key, or is being written.
  */
 static bool
-_mongoc_scram_cache_has_presecrets (mongoc_scram_cache_entry_t *cache /* out */, const mongoc_scram_t *scram)
+_mongoc_scram_cache_slot_read (mongoc_scram_cache_slot_t *slot,
+                               const uint8_t key[MONGOC_SCRAM_CACHE_KEY_SIZE],
+                               mongoc_scram_cache_entry_t *entry /* OUT */)
 {
-   bool cache_hit = false;
+   int64_t key_words[MONGOC_SCRAM_CACHE_KEY_WORDS];
+   int64_t entry_words[MONGOC_SCRAM_CACHE_ENTRY_WORDS];
+   const int64_t seq = bson_atomic_int64_fetch (&slot->seq, bson_memory_order_acquire);
 
-   BSON_ASSERT (cache);
-   BSON_ASSERT (scram);
+   if (seq == 0 || (seq & 1) != 0) {
+      return false;
+   }
+
+   for (size_t i = 0u; i < MONGOC_SCRAM_CACHE_KEY_WORDS; i++) {
+      key_words[i] = bson_atomic_int64_fetch (&slot->key[i], bson_memory_order_relaxed);
+   }
+
+   for (size_t i = 0u; i < MONGOC_SCRAM_CACHE_ENTRY_WORDS; i++) {
+      entry_words[i] = bson_atomic_int64_fetch (&slot->entry[i], bson_memory_order_relaxed);
+   }
+
+   /* Order the copy before re-reading the sequence. */
+   bson_atomic_thread_fence ();
+
+   if (bson_atomic_int64_fetch (&slot->seq, bson_memory_order_relaxed) != seq) {
+      /* Overwritten while copying. */
+      return false;
+   }
+
+   if (mongoc_memcmp (key_words, key, MONGOC_SCRAM_CACHE_KEY_SIZE) != 0) {
+      return false;
+   }
+
+   memcpy (entry, entry_words, sizeof (*entry));
+   return true;
+}
+
+
+/*
+ * Overwrites a slot with `key` and `entry`. Caller must hold
+ * g_scram_cache_write_lock.
+ */
+static void
+_mongoc_scram_cache_slot_write (mongoc_scram_cache_slot_t *slot,
+                                const uint8_t key[MONGOC_SCRAM_CACHE_KEY_SIZE],
+                                const mongoc_scram_cache_entry_t *entry)
+{
+   int64_t key_words[MONGOC_SCRAM_CACHE_KEY_WORDS];
+   int64_t entry_words[MONGOC_SCRAM_CACHE_ENTRY_WORDS];
+   const int64_t seq = bson_atomic_int64_fetch (&slot->seq, bson_memory_order_relaxed);
+
+   memcpy (key_words, key, sizeof (key_words));
+   memcpy (entry_words, entry, sizeof (entry_words));
+
+   bson_atomic_int64_exchange (&slot->seq, seq + 1, bson_memory_order_relaxed);
+   /* Order marking the slot as being written before the writes. */
+   bson_atomic_thread_fence ();
+
+   for (size_t i = 0u; i < MONGOC_SCRAM_CACHE_KEY_WORDS; i++) {
+      bson_atomic_int64_exchange (&slot->key[i], key_words[i], bson_memory_order_relaxed);
+   }
+
+   for (size_t i = 0u; i < MONGOC_SCRAM_CACHE_ENTRY_WORDS; i++) {
+      bson_atomic_int64_exchange (&slot->entry[i], entry_words[i], bson_memory_order_relaxed);
+   }
+
+   bson_atomic_int64_exchange (&slot->seq, seq + 2, bson_memory_order_release);
+   bson_atomic_int64_exchange (&slot->last_used,
+                               bson_atomic_int64_fetch_add (&g_scram_cache_clock, 1, bson_memory_order_relaxed),
+                               bson_memory_order_relaxed);
+
+   memset (key_words, 0, sizeof (key_words));
+   memset (entry_words, 0, sizeof (entry_words));
+}
+
+
+bool
+_mongoc_scram_cache_lookup (const uint8_t key[MONGOC_SCRAM_CACHE_KEY_SIZE], mongoc_scram_cache_entry_t *entry /* OUT */)
+{
+   mongoc_scram_cache_slot_t *set;
+
+   BSON_ASSERT_PARAM (key);
+   BSON_ASSERT_PARAM (entry);
+
+   set = _mongoc_scram_cache_set (key);
+
+   for (size_t i = 0u; i < MONGOC_SCRAM_CACHE_WAYS; i++) {
+      if (_mongoc_scram_cache_slot_read (&set[i], key, entry)) {
+         bson_atomic_int64_exchange (&set[i].last_used,
+                                     bson_atomic_int64_fetch_add (&g_scram_cache_clock, 1, bson_memory_order_relaxed),
+                                     bson_memory_order_relaxed);
+         return true;
+      }
+   }
+
+   return false;
+}
+
+
+void
+_mongoc_scram_cache_insert (const uint8_t key[MONGOC_SCRAM_CACHE_KEY_SIZE], const mongoc_scram_cache_entry_t *entry)
+{
+   mongoc_scram_cache_slot_t *set;
+   mongoc_scram_cache_slot_t *victim = NULL;
+   mongoc_scram_cache_entry_t existing;
+
+   BSON_ASSERT_PARAM (key);
+   BSON_ASSERT_PARAM (entry);
+
+   set = _mongoc_scram_cache_set (key);
 
    _mongoc_scram_cache_init_once ();
 
-   /*
-    * - Take a read lock
-    * - Search through g_scram_cache if the hashed_password, decoded_salt, and
-    *   iterations match an entry.
-    * - If so, then return true
-    * - Otherwise return false
-    */
-   bson_shared_mutex_lock_shared (&g_scram_cache_rwlock);
-
-   for (size_t i = 0; i < MONGOC_SCRAM_CACHE_SIZE; i++) {
-      if (g_scram_cache[i].taken) {
-         mongoc_scram_cache_entry_t *cache_entry = &g_scram_cache[i];
-         cache_hit = !strcmp (cache_entry->hashed_password, scram->hashed_password) &&
-                     cache_entry->iterations == scram->iterations &&
-                     !memcmp (cache_entry->decoded_salt, scram->decoded_salt, sizeof (cache_entry->decoded_salt));
-         if (cache_hit) {
-            /* copy the found cache items into the 'cache' output parameter */
-            memcpy (cache->client_key, cache_entry->client_key, sizeof (cache->client_key));
-            memcpy (cache->server_key, cache_entry->server_key, sizeof (cache->server_key));
-            memcpy (cache->salted_password, cache_entry->salted_password, sizeof (cache->salted_password));
-            goto done;
-         }
+   bson_mutex_lock (&g_scram_cache_write_lock);
+
+   for (size_t i = 0u; i < MONGOC_SCRAM_CACHE_WAYS; i++) {
+      mongoc_scram_cache_slot_t *const slot = &set[i];
+
+      if (_mongoc_scram_cache_slot_read (slot, key, &existing)) {
+         /* Inserted by another thread since this thread's lookup. */
+         goto done;
+      }
+
+      if (bson_atomic_int64_fetch (&slot->seq, bson_memory_order_relaxed) == 0) {
+         /* Slots are filled in order, so this and later slots are empty. */
+         victim = slot;
+         break;
+      }
+
+      if (!victim || bson_atomic_int64_fetch (&slot->last_used, bson_memory_order_relaxed) <
+                        bson_atomic_int64_fetch (&victim->last_used, bson_memory_order_relaxed)) {
+         victim = slot;
       }
    }
 
+   _mongoc_scram_cache_slot_write (victim, key, entry);
+
 done:
-   bson_shared_mutex_unlock_shared (&g_scram_cache_rwlock);
-   return cache_hit;
+   bson_mutex_unlock (&g_scram_cache_write_lock);
+   memset (&existing, 0, sizeof (existing));
+}
+
+
+/* Computes the cache key for the pre-secrets: the user, the (hashed) password,
+ * the salt, and the iteration count. */
+static void
+_mongoc_scram_cache_key (mongoc_scram_t *scram,
+                         const char *hashed_password,
+                         const uint8_t *decoded_salt,
+                         size_t decoded_salt_len,
+                         uint32_t iterations)
+{
+   mongoc_crypto_t crypto;
+   const char *const user = scram->user ? scram->user : "";
+   const size_t user_len = strlen (user) + 1u;
+   const size_t hashed_password_len = strlen (hashed_password) + 1u;
+   const uint32_t algorithm = (uint32_t) scram->crypto.algorithm;
+   size_t len = 0u;
+   uint8_t *buf;
+
+   buf = bson_malloc (sizeof (algorithm) + sizeof (iterations) + user_len + hashed_password_len + decoded_salt_len);
+
+   memcpy (buf + len, &algorithm, sizeof (algorithm));
+   len += sizeof (algorithm);
+   memcpy (buf + len, &iterations, sizeof (iterations));
+   len += sizeof (iterations);
+   memcpy (buf + len, user, user_len);
+   len += user_len;
+   memcpy (buf + len, hashed_password, hashed_password_len);
+   len += hashed_password_len;
+   memcpy (buf + len, decoded_salt, decoded_salt_len);
+   len += decoded_salt_len;
+
+   mongoc_crypto_init (&crypto, MONGOC_CRYPTO_ALGORITHM_SHA_256);
+   BSON_ASSERT (mongoc_crypto_hash (&crypto, buf, len, scram->cache_key));
+
+   bson_zero_free (buf, len);
 }
 
 
@@ -234,67 +370,24 @@ _mongoc_scram_destroy (mongoc_scram_t *scram)
       bson_zero_free (scram->pass, strlen (scram->pass));
    }
 
-   memset (scram->hashed_password, 0, sizeof (scram->hashed_password));
-
    bson_free (scram->auth_message);
 
    memset (scram, 0, sizeof *scram);
 }
 
-static void
-_mongoc_scram_cache_insert (const mongoc_scram_t *scram)
-{
-   bson_shared_mutex_lock (&g_scram_cache_rwlock);
-
-again:
-   for (size_t i = 0; i < MONGOC_SCRAM_CACHE_SIZE; i++) {
-      mongoc_scram_cache_entry_t *cache_entry = &g_scram_cache[i];
-      bool already_exists =
-         !strcmp (cache_entry->hashed_password, scram->hashed_password) &&
-         cache_entry->iterations == scram->iterations &&
-         !memcmp (cache_entry->decoded_salt, scram->decoded_salt, sizeof (cache_entry->decoded_salt)) &&
-         !memcmp (cache_entry->client_key, scram->client_key, sizeof (cache_entry->client_key)) &&
-         !memcmp (cache_entry->server_key, scram->server_key, sizeof (cache_entry->server_key)) &&
-         !memcmp (cache_entry->salted_password, scram->salted_password, sizeof (cache_entry->salted_password));
-
-      if (already_exists) {
-         /* cache entry already populated between read and write lock
-          * acquisition, skipping */
-         break;
-      }
-
-      if (!cache_entry->taken) {
-         /* found an empty slot */
-         memcpy (cache_entry->client_key, scram->client_key, sizeof (cache_entry->client_key));
-         memcpy (cache_entry->server_key, scram->server_key, sizeof (cache_entry->server_key));
-         memcpy (cache_entry->salted_password, scram->salted_password, sizeof (cache_entry->salted_password));
-         memcpy (cache_entry->decoded_salt, scram->decoded_salt, sizeof (cache_entry->decoded_salt));
-         memcpy (cache_entry->hashed_password, scram->hashed_password, sizeof (cache_entry->hashed_password));
-         cache_entry->iterations = scram->iterations;
-         cache_entry->taken = true;
-         break;
-      }
-
-      /* if cache is full, then invalidate the cache and insert again */
-      if (i == (MONGOC_SCRAM_CACHE_SIZE - 1)) {
-         _mongoc_scram_cache_clear ();
-         goto again;
-      }
-   }
-
-   bson_shared_mutex_unlock (&g_scram_cache_rwlock);
-}
-
 /* Updates the cache with scram's last-used pre-secrets and secrets */
 static void
 _mongoc_scram_update_cache (const mongoc_scram_t *scram)
 {
    mongoc_scram_cache_entry_t cache;
-   bool found = _mongoc_scram_cache_has_presecrets (&cache, scram);
-   if (!found) {
-      /* cache miss, insert this as a new cache entry */
-      _mongoc_scram_cache_insert (scram);
-   }
+
+   memcpy (cache.client_key, scram->client_key, sizeof (cache.client_key));
+   memcpy (cache.server_key, scram->server_key, sizeof (cache.server_key));
+   memcpy (cache.salted_password, scram->salted_password, sizeof (cache.salted_password));
+
+   _mongoc_scram_cache_insert (scram->cache_key, &cache);
+
+   memset (&cache, 0, sizeof (cache));
 }
 
 
@@ -759,16 +852,12 @@ _mongoc_scram_step2 (mongoc_scram_t *scram,
    }
 
    /* Save the presecrets for caching */
-   if (hashed_password) {
-      bson_strncpy (scram->hashed_password, hashed_password, sizeof (scram->hashed_password));
-   }
-
-   scram->iterations = iterations;
-   memcpy (scram->decoded_salt, decoded_salt, sizeof (scram->decoded_salt));
+   _mongoc_scram_cache_key (scram, hashed_password, decoded_salt, (size_t) decoded_salt_len, (uint32_t) iterations);
 
    mongoc_scram_cache_entry_t cache;
-   if (_mongoc_scram_cache_has_presecrets (&cache, scram)) {
+   if (_mongoc_scram_cache_lookup (scram->cache_key, &cache)) {
       _mongoc_scram_cache_apply_secrets (&cache, scram);
+      memset (&cache, 0, sizeof (cache));
    }
 
    if (!*scram->salted_password) {
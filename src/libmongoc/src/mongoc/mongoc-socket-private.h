@@ -23,6 +23,9 @@
 
 BSON_BEGIN_DECLS
 
+/* Sends copy up to this many iovecs on the stack instead of the heap. */
+#define MONGOC_SOCKET_SENDV_STACK_IOVCNT 16
+
 struct _mongoc_socket_t {
 #ifdef _WIN32
    SOCKET sd;
@@ -32,11 +35,20 @@ struct _mongoc_socket_t {
    int errno_;
    int domain;
    int pid;
+   /* sends of at least zerocopy_threshold bytes use MSG_ZEROCOPY, 0 if
+    * disabled. The kernel numbers these sends, and reports the highest number
+    * whose buffers it has released on the socket error queue. */
+   size_t zerocopy_threshold;
+   uint32_t zerocopy_sent;
+   uint32_t zerocopy_completed;
 };
 
 mongoc_socket_t *
 mongoc_socket_accept_ex (mongoc_socket_t *sock, int64_t expire_at, uint16_t *port);
 
+bool
+_mongoc_socket_set_zerocopy (mongoc_socket_t *sock, size_t threshold);
+
 BSON_END_DECLS
 
 #endif /* MONGOC_SOCKET_PRIVATE_H */
@@ -28,6 +28,9 @@
 #include <Mstcpip.h>
 #include <process.h>
 #endif
+#ifdef __linux__
+#include <linux/errqueue.h>
+#endif
 
 #undef MONGOC_LOG_DOMAIN
 #define MONGOC_LOG_DOMAIN "socket"
@@ -40,6 +43,11 @@
 typedef MONGOC_SOCKET_ARG2 mongoc_sockaddr_t;
 
 
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define MONGOC_SOCKET_HAVE_ZEROCOPY
+#endif
+
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -1237,7 +1245,8 @@ _mongoc_socket_try_sendv_slow (mongoc_socket_t *sock, /* IN */
 static ssize_t
 _mongoc_socket_try_sendv (mongoc_socket_t *sock, /* IN */
                           mongoc_iovec_t *iov,   /* IN */
-                          size_t iovcnt)         /* IN */
+                          size_t iovcnt,         /* IN */
+                          bool zerocopy)         /* IN */
 {
 #ifdef _WIN32
    DWORD dwNumberofBytesSent = 0;
@@ -1256,6 +1265,7 @@ _mongoc_socket_try_sendv (mongoc_socket_t *sock, /* IN */
    DUMP_IOVEC (sendbuf, iov, iovcnt);
 
 #ifdef _WIN32
+   BSON_UNUSED (zerocopy);
    BSON_ASSERT (bson_in_range_unsigned (unsigned_long, iovcnt));
    ret = WSASend (sock->sd, (LPWSABUF) iov, (DWORD) iovcnt, &dwNumberofBytesSent, 0, NULL, NULL);
    TRACE ("WSASend sent: %ld (out of: %zu), ret: %d", dwNumberofBytesSent, iov->iov_len, ret);
@@ -1263,13 +1273,29 @@ _mongoc_socket_try_sendv (mongoc_socket_t *sock, /* IN */
    memset (&msg, 0, sizeof msg);
    msg.msg_iov = iov;
    msg.msg_iovlen = iovcnt;
-   ret = sendmsg (sock->sd,
-                  &msg,
+#ifdef MONGOC_SOCKET_HAVE_ZEROCOPY
+   if (zerocopy) {
+      ret = sendmsg (sock->sd, &msg, MSG_NOSIGNAL | MSG_ZEROCOPY);
+      if (ret >= 0) {
+         sock->zerocopy_sent++;
+      } else if (errno == ENOBUFS) {
+         /* the pages could not be pinned, copy them instead. */
+         TRACE ("%s", "MSG_ZEROCOPY failed with ENOBUFS, copying");
+         ret = sendmsg (sock->sd, &msg, MSG_NOSIGNAL);
+      }
+   } else
+#else
+   BSON_UNUSED (zerocopy);
+#endif
+   {
+      ret = sendmsg (sock->sd,
+                     &msg,
 #ifdef MSG_NOSIGNAL
-                  MSG_NOSIGNAL);
+                     MSG_NOSIGNAL);
 #else
-                  0);
+                     0);
 #endif
+   }
    TRACE ("Send %zu out of %zu bytes", ret, iov->iov_len);
 #endif
 
@@ -1305,6 +1331,159 @@ _mongoc_socket_try_sendv (mongoc_socket_t *sock, /* IN */
 }
 
 
+#ifdef MONGOC_SOCKET_HAVE_ZEROCOPY
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_socket_zerocopy_reap --
+ *
+ *       Read one batch of MSG_ZEROCOPY completions from the socket error
+ *       queue. If the kernel had to copy the data anyway, as it does on
+ *       loopback, zero-copy sends are disabled for this socket.
+ *
+ * Returns:
+ *       true if the error queue was read, otherwise false and errno is
+ *       captured; EAGAIN if it was empty.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static bool
+_mongoc_socket_zerocopy_reap (mongoc_socket_t *sock) /* IN */
+{
+   /* a sock_extended_err followed by the address of the offender. */
+   char control[CMSG_SPACE (sizeof (struct sock_extended_err) + sizeof (struct sockaddr_in6))];
+   struct msghdr msg;
+   struct cmsghdr *cm;
+
+   memset (&msg, 0, sizeof msg);
+   msg.msg_control = control;
+   msg.msg_controllen = sizeof control;
+
+   if (recvmsg (sock->sd, &msg, MSG_ERRQUEUE) == -1) {
+      _mongoc_socket_capture_errno (sock);
+      return false;
+   }
+
+   for (cm = CMSG_FIRSTHDR (&msg); cm; cm = CMSG_NXTHDR (&msg, cm)) {
+      struct sock_extended_err serr;
+
+      if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+          !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
+         continue;
+      }
+
+      memcpy (&serr, CMSG_DATA (cm), sizeof serr);
+      if (serr.ee_errno != 0 || serr.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+         continue;
+      }
+
+      /* sends ee_info through ee_data are complete. */
+      sock->zerocopy_completed += serr.ee_data - serr.ee_info + 1u;
+
+      if (serr.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+         TRACE ("%s", "MSG_ZEROCOPY data was copied, disabling zero-copy sends");
+         sock->zerocopy_threshold = 0;
+      }
+   }
+
+   return true;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_socket_zerocopy_wait --
+ *
+ *       Wait until the kernel has released the buffers of every
+ *       MSG_ZEROCOPY send on @sock, so that callers may reuse their
+ *       buffers once mongoc_socket_sendv() returns.
+ *
+ * Returns:
+ *       true if all sends are complete, otherwise false and errno is
+ *       captured.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static bool
+_mongoc_socket_zerocopy_wait (mongoc_socket_t *sock, /* IN */
+                              int64_t expire_at)     /* IN */
+{
+   while (sock->zerocopy_completed != sock->zerocopy_sent) {
+      if (_mongoc_socket_zerocopy_reap (sock)) {
+         continue;
+      }
+
+      if (!_mongoc_socket_errno_is_again (sock)) {
+         return false;
+      }
+
+      /* completions are signaled with POLLERR. */
+      if (!_mongoc_socket_wait (sock, POLLERR, expire_at)) {
+         return false;
+      }
+   }
+
+   return true;
+}
+#endif
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_socket_set_zerocopy --
+ *
+ *       Send writes of at least @threshold bytes on @sock with
+ *       MSG_ZEROCOPY: the kernel transmits straight from the caller's
+ *       pages instead of copying them into the socket buffer.
+ *       mongoc_socket_sendv() then waits for the kernel to release the
+ *       pages before returning. Only worthwhile for large writes, on
+ *       the order of tens of kilobytes.
+ *
+ * Returns:
+ *       true if zero-copy sends are enabled, false if they are not
+ *       supported by the platform or the socket.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+_mongoc_socket_set_zerocopy (mongoc_socket_t *sock, /* IN */
+                             size_t threshold)      /* IN */
+{
+   BSON_ASSERT_PARAM (sock);
+   BSON_ASSERT (threshold > 0u);
+
+#ifdef MONGOC_SOCKET_HAVE_ZEROCOPY
+   {
+      int on = 1;
+
+      if (setsockopt (sock->sd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof on) != 0) {
+         _mongoc_socket_capture_errno (sock);
+         return false;
+      }
+   }
+
+   sock->zerocopy_threshold = threshold;
+   return true;
+#else
+   return false;
+#endif
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -1337,7 +1516,9 @@ mongoc_socket_sendv (mongoc_socket_t *sock,  /* IN */
    ssize_t ret = 0;
    ssize_t sent;
    size_t cur = 0;
+   mongoc_iovec_t stack_iov[MONGOC_SOCKET_SENDV_STACK_IOVCNT];
    mongoc_iovec_t *iov;
+   bool zerocopy = false;
 
    ENTRY;
 
@@ -1345,11 +1526,23 @@ mongoc_socket_sendv (mongoc_socket_t *sock,  /* IN */
    BSON_ASSERT (in_iov);
    BSON_ASSERT (iovcnt);
 
-   iov = bson_malloc (sizeof (*iov) * iovcnt);
+   /* a zero-copy send must wait for the kernel, so not if @expire_at is 0. */
+   if (sock->zerocopy_threshold && expire_at != 0) {
+      size_t total = 0u;
+
+      for (size_t i = 0u; i < iovcnt; i++) {
+         total += in_iov[i].iov_len;
+      }
+
+      zerocopy = total >= sock->zerocopy_threshold;
+   }
+
+   /* the copy is adjusted as bytes are sent; OP_MSG requests fit on the stack. */
+   iov = iovcnt <= MONGOC_SOCKET_SENDV_STACK_IOVCNT ? stack_iov : bson_malloc (sizeof (*iov) * iovcnt);
    memcpy (iov, in_iov, sizeof (*iov) * iovcnt);
 
    for (;;) {
-      sent = _mongoc_socket_try_sendv (sock, &iov[cur], iovcnt - cur);
+      sent = _mongoc_socket_try_sendv (sock, &iov[cur], iovcnt - cur, zerocopy);
       TRACE ("Sent %zd (of %zu) out of iovcnt=%zu", sent, iov[cur].iov_len, iovcnt);
 
       /*
@@ -1416,7 +1609,24 @@ mongoc_socket_sendv (mongoc_socket_t *sock,  /* IN */
    }
 
 CLEANUP:
-   bson_free (iov);
+#ifdef MONGOC_SOCKET_HAVE_ZEROCOPY
+   /* the caller may reuse its buffers once we return, even after an error. */
+   if (zerocopy && sock->zerocopy_sent != sock->zerocopy_completed) {
+      const int send_errno = sock->errno_;
+      const bool released = _mongoc_socket_zerocopy_wait (sock, expire_at);
+
+      if (cur != iovcnt) {
+         /* report why the send failed rather than how the wait ended. */
+         sock->errno_ = send_errno;
+      } else if (!released) {
+         ret = -1;
+      }
+   }
+#endif
+
+   if (iov != stack_iov) {
+      bson_free (iov);
+   }
 
    RETURN (ret);
 }
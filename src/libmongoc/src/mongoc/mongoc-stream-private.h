@@ -44,6 +44,12 @@ _mongoc_stream_writev_full (
 mongoc_stream_t *
 mongoc_stream_get_root_stream (mongoc_stream_t *stream);
 
+bool
+_mongoc_stream_socket_use_uring (mongoc_stream_t *stream);
+
+mongoc_socket_t *
+_mongoc_stream_socket_get_pollable (mongoc_stream_t *stream);
+
 BSON_END_DECLS
 
 
@@ -21,6 +21,7 @@
 #include "mongoc-socket-private.h"
 #include "mongoc-errno-private.h"
 #include "mongoc-counters-private.h"
+#include "mongoc-uring-private.h"
 
 #undef MONGOC_LOG_DOMAIN
 #define MONGOC_LOG_DOMAIN "stream"
@@ -29,6 +30,7 @@
 struct _mongoc_stream_socket_t {
    mongoc_stream_t vtable;
    mongoc_socket_t *sock;
+   mongoc_uring_t *uring; /* set by _mongoc_stream_socket_use_uring () */
 };
 
 
@@ -78,6 +80,7 @@ _mongoc_stream_socket_destroy (mongoc_stream_t *stream)
       ss->sock = NULL;
    }
 
+   _mongoc_uring_destroy (ss->uring);
    bson_free (ss);
 
    mongoc_counter_streams_active_dec ();
@@ -149,7 +152,11 @@ _mongoc_stream_socket_readv (
     */
 
    for (;;) {
-      nread = mongoc_socket_recv (ss->sock, iov[cur].iov_base, iov[cur].iov_len, 0, expire_at);
+      if (ss->uring && expire_at != 0) {
+         nread = _mongoc_uring_recv (ss->uring, ss->sock, &iov[cur], iovcnt - cur, expire_at);
+      } else {
+         nread = mongoc_socket_recv (ss->sock, iov[cur].iov_base, iov[cur].iov_len, 0, expire_at);
+      }
 
       if (nread <= 0) {
          if (ret >= (ssize_t) min_bytes) {
@@ -195,7 +202,11 @@ _mongoc_stream_socket_writev (mongoc_stream_t *stream, mongoc_iovec_t *iov, size
 
    if (ss->sock) {
       expire_at = get_expiration (timeout_msec);
-      ret = mongoc_socket_sendv (ss->sock, iov, iovcnt, expire_at);
+      if (ss->uring && expire_at != 0) {
+         ret = _mongoc_uring_sendv (ss->uring, ss->sock, iov, iovcnt, expire_at);
+      } else {
+         ret = mongoc_socket_sendv (ss->sock, iov, iovcnt, expire_at);
+      }
       errno = mongoc_socket_errno (ss->sock);
       RETURN (ret);
    }
@@ -338,3 +349,65 @@ mongoc_stream_socket_new (mongoc_socket_t *sock) /* IN */
    mongoc_counter_streams_active_inc ();
    return (mongoc_stream_t *) stream;
 }
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_stream_socket_use_uring --
+ *
+ *       Sends and receives on @stream, a socket stream, through an
+ *       io_uring instance from now on. Non-blocking calls still use the
+ *       socket directly.
+ *
+ * Returns:
+ *       true if io_uring is available; otherwise false and @stream is
+ *       unchanged.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+_mongoc_stream_socket_use_uring (mongoc_stream_t *stream)
+{
+   mongoc_stream_socket_t *ss = (mongoc_stream_socket_t *) stream;
+
+   ENTRY;
+
+   BSON_ASSERT (stream);
+   BSON_ASSERT (stream->type == MONGOC_STREAM_SOCKET);
+
+   if (!ss->uring) {
+      ss->uring = _mongoc_uring_new ();
+   }
+
+   RETURN (ss->uring != NULL);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_stream_socket_get_pollable --
+ *
+ *       Get the socket of @stream if it is a socket stream whose poll ()
+ *       has not been replaced, so that waiting on the socket directly is
+ *       equivalent to mongoc_stream_poll ().
+ *
+ * Returns:
+ *       A mongoc_socket_t owned by @stream, or NULL.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_socket_t *
+_mongoc_stream_socket_get_pollable (mongoc_stream_t *stream)
+{
+   BSON_ASSERT (stream);
+
+   if (stream->type != MONGOC_STREAM_SOCKET || stream->poll != _mongoc_stream_socket_poll) {
+      return NULL;
+   }
+
+   return ((mongoc_stream_socket_t *) stream)->sock;
+}
@@ -40,4 +40,12 @@ _mongoc_topology_background_monitoring_stop (mongoc_topology_t *topology);
 void
 _mongoc_topology_background_monitoring_cancel_check (mongoc_topology_t *topology, uint32_t server_id);
 
+void
+_mongoc_topology_background_monitoring_set_establisher (mongoc_topology_t *topology,
+                                                        _mongoc_topology_establish_fn establish_fn,
+                                                        void *establish_ctx);
+
+void
+_mongoc_topology_background_monitoring_request_establish (mongoc_topology_t *topology);
+
 #endif /* MONGOC_TOPOLOGY_BACKGROUND_MONITORING_PRIVATE_H */
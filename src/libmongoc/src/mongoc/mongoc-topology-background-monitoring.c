@@ -77,6 +77,99 @@ static BSON_THREAD_FUN (srv_polling_run, topology_void)
    BSON_THREAD_RETURN;
 }
 
+static BSON_THREAD_FUN (establisher_run, topology_void)
+{
+   mongoc_topology_t *topology;
+
+   topology = topology_void;
+   bson_mutex_lock (&topology->establisher_mtx);
+   while (!topology->establisher_shutdown) {
+      _mongoc_topology_establish_fn establish_fn = topology->establish_fn;
+      void *establish_ctx = topology->establish_ctx;
+      int64_t heartbeat_ms;
+      mc_shared_tpld td;
+
+      topology->establisher_requested = false;
+      bson_mutex_unlock (&topology->establisher_mtx);
+
+      /* Establish connections without holding the lock. The establish
+       * function may take as long as a handshake to each server. */
+      if (establish_fn) {
+         establish_fn (establish_ctx);
+      }
+
+      td = mc_tpld_take_ref (topology);
+      heartbeat_ms = td.ptr->heartbeat_msec;
+      mc_tpld_drop_ref (&td);
+
+      /* Sleep until the next heartbeat, or until the topology changes or
+       * shutdown is signalled. */
+      bson_mutex_lock (&topology->establisher_mtx);
+      if (!topology->establisher_shutdown && !topology->establisher_requested) {
+         TRACE ("connection establisher sleeping for %" PRId64 "ms", heartbeat_ms);
+         mongoc_cond_timedwait (&topology->establisher_cond, &topology->establisher_mtx, heartbeat_ms);
+      }
+   }
+   bson_mutex_unlock (&topology->establisher_mtx);
+   BSON_THREAD_RETURN;
+}
+
+/* Start the connection establisher thread if an establish function is set and
+ * the thread is not already running.
+ *
+ * Caller must hold establisher_mtx.
+ */
+static void
+_establisher_start_if_needed (mongoc_topology_t *topology)
+{
+   int ret;
+
+   if (!topology->establish_fn || topology->is_establishing) {
+      return;
+   }
+
+   if (bson_atomic_int_fetch (&topology->scanner_state, bson_memory_order_relaxed) !=
+       MONGOC_TOPOLOGY_SCANNER_BG_RUNNING) {
+      return;
+   }
+
+   topology->establisher_shutdown = false;
+   topology->establisher_requested = false;
+   ret = mcommon_thread_create (&topology->establisher_thread, establisher_run, topology);
+   if (ret == 0) {
+      topology->is_establishing = true;
+   } else {
+      char errmsg_buf[BSON_ERROR_BUFFER_SIZE];
+      char *errmsg = bson_strerror_r (ret, errmsg_buf, sizeof errmsg_buf);
+      MONGOC_ERROR ("Failed to start connection establisher thread. Connections "
+                    "will be established on first use. Error: %s",
+                    errmsg);
+   }
+}
+
+/* Signal the connection establisher thread to stop and wait for it to exit.
+ *
+ * Caller must not hold establisher_mtx.
+ */
+static void
+_establisher_stop (mongoc_topology_t *topology)
+{
+   bson_mutex_lock (&topology->establisher_mtx);
+   if (!topology->is_establishing) {
+      bson_mutex_unlock (&topology->establisher_mtx);
+      return;
+   }
+   topology->establisher_shutdown = true;
+   mongoc_cond_signal (&topology->establisher_cond);
+   bson_mutex_unlock (&topology->establisher_mtx);
+
+   mcommon_thread_join (topology->establisher_thread);
+
+   bson_mutex_lock (&topology->establisher_mtx);
+   topology->is_establishing = false;
+   bson_mutex_unlock (&topology->establisher_mtx);
+}
+
 /* Create a server monitor if necessary.
  *
  * Called by monitor threads and application threads when reconciling the
@@ -165,6 +258,10 @@ _mongoc_topology_background_monitoring_start (mongoc_topology_t *topology)
                           errmsg);
          }
       }
+      /* Start connection establisher thread. */
+      bson_mutex_lock (&topology->establisher_mtx);
+      _establisher_start_if_needed (topology);
+      bson_mutex_unlock (&topology->establisher_mtx);
    }
 
    mc_tpld_modify_commit (tdmod);
@@ -236,6 +333,10 @@ _mongoc_topology_background_monitoring_reconcile (mongoc_topology_t *topology, m
 
    _remove_orphaned_server_monitors (topology->server_monitors, server_descriptions);
    _remove_orphaned_server_monitors (topology->rtt_monitors, server_descriptions);
+
+   /* Servers may have been discovered, recovered, or had their pools cleared.
+    */
+   _mongoc_topology_background_monitoring_request_establish (topology);
 }
 
 /* Request all server monitors to scan.
@@ -334,6 +435,9 @@ _mongoc_topology_background_monitoring_stop (mongoc_topology_t *topology)
       mcommon_thread_join (topology->srv_polling_thread);
    }
 
+   /* Stop the connection establisher thread. */
+   _establisher_stop (topology);
+
    /* Signal clients that are waiting on server selection to stop immediately,
     * as there will be no servers available.
     * This uses the tpld_modification_mtx as that is the mutex used with the
@@ -365,3 +469,54 @@ _mongoc_topology_background_monitoring_cancel_check (mongoc_topology_t *topology
    }
    mongoc_server_monitor_request_cancel (server_monitor);
 }
+
+/* Set the function used to establish connections ahead of use, or unset it
+ * with a NULL @establish_fn.
+ *
+ * Called by application threads configuring a client pool. If background
+ * monitoring is running, the establisher thread is started (or stopped and
+ * joined) before returning. After unsetting, @establish_ctx is no longer
+ * referenced by the topology.
+ */
+void
+_mongoc_topology_background_monitoring_set_establisher (mongoc_topology_t *topology,
+                                                        _mongoc_topology_establish_fn establish_fn,
+                                                        void *establish_ctx)
+{
+   BSON_ASSERT (!topology->single_threaded);
+
+   if (!establish_fn) {
+      _establisher_stop (topology);
+   }
+
+   bson_mutex_lock (&topology->establisher_mtx);
+   topology->establish_fn = establish_fn;
+   topology->establish_ctx = establish_ctx;
+   if (topology->is_establishing) {
+      /* Establish again with the new settings. */
+      topology->establisher_requested = true;
+      mongoc_cond_signal (&topology->establisher_cond);
+   } else {
+      _establisher_start_if_needed (topology);
+   }
+   bson_mutex_unlock (&topology->establisher_mtx);
+}
+
+/* Wake the connection establisher thread (if running) to replenish
+ * connections.
+ *
+ * Called when the topology description changes and may be called by server
+ * monitor threads or application threads.
+ */
+void
+_mongoc_topology_background_monitoring_request_establish (mongoc_topology_t *topology)
+{
+   BSON_ASSERT (!topology->single_threaded);
+
+   bson_mutex_lock (&topology->establisher_mtx);
+   if (topology->is_establishing) {
+      topology->establisher_requested = true;
+      mongoc_cond_signal (&topology->establisher_cond);
+   }
+   bson_mutex_unlock (&topology->establisher_mtx);
+}
@@ -87,6 +87,10 @@ typedef bool (*_mongoc_rr_resolver_fn) (const char *hostname,
                                         size_t initial_buffer_size,
                                         bson_error_t *error);
 
+/* Called by the connection establisher thread to pre-establish application
+ * connections. See _mongoc_topology_background_monitoring_set_establisher. */
+typedef void (*_mongoc_topology_establish_fn) (void *ctx);
+
 /**
  * @brief A reference-counted reference to a topology description.
  *
@@ -135,6 +139,18 @@ typedef struct _mongoc_topology_t {
    bson_mutex_t srv_polling_mtx;
    mongoc_cond_t srv_polling_cond;
 
+   /* For multi-threaded, connections for a client pool may be established
+    * ahead of use in a separate thread. establisher_mtx protects the
+    * establish_fn, establish_ctx, and establisher_* flags. */
+   _mongoc_topology_establish_fn establish_fn;
+   void *establish_ctx;
+   bson_thread_t establisher_thread;
+   bson_mutex_t establisher_mtx;
+   mongoc_cond_t establisher_cond;
+   bool is_establishing;
+   bool establisher_requested;
+   bool establisher_shutdown;
+
    /**
     * @brief Signal for background monitoring threads to signal stop/shutdown.
     *
@@ -22,6 +22,7 @@
 /* TODO: rename to TOPOLOGY scanner */
 
 #include <bson/bson.h>
+#include "mongoc-addrinfo-cache-private.h"
 #include "mongoc-async-private.h"
 #include "mongoc-async-cmd-private.h"
 #include "mongoc-handshake-private.h"
@@ -66,10 +67,11 @@ typedef struct mongoc_topology_scanner_node {
    bson_error_t last_error;
 
    /* the hostname for a node may resolve to multiple DNS results.
-    * dns_results has the full list of DNS results, ordered by host preference.
+    * dns_results has the full list of DNS results, ordered by host preference,
+    * shared with other connections to the host through the addrinfo cache.
     * successful_dns_result is the most recent successful DNS result.
     */
-   struct addrinfo *dns_results;
+   mongoc_addrinfo_t *dns_results;
    struct addrinfo *successful_dns_result;
    int64_t last_dns_cache;
 
@@ -21,6 +21,7 @@
 #include "mongoc-trace-private.h"
 #include "mongoc-topology-scanner-private.h"
 #include "mongoc-stream-private.h"
+#include "mongoc-socket-private.h"
 #include "mongoc-stream-socket.h"
 
 #include "mongoc-handshake.h"
@@ -555,9 +556,7 @@ mongoc_topology_scanner_node_destroy (mongoc_topology_scanner_node_t *node, bool
 {
    DL_DELETE (node->ts->nodes, node);
    mongoc_topology_scanner_node_disconnect (node, failed);
-   if (node->dns_results) {
-      freeaddrinfo (node->dns_results);
-   }
+   _mongoc_addrinfo_release (node->dns_results);
 
    bson_destroy (&node->speculative_auth_response);
 
@@ -627,6 +626,10 @@ _async_connected (mongoc_async_cmd_t *acmd)
    /* this cmd connected successfully, cancel other cmds on this node. */
    _cancel_commands_excluding (node, acmd);
    node->successful_dns_result = acmd->dns_result;
+   if (node->dns_results && acmd->dns_result) {
+      /* let the next connection to this host skip happy eyeballs. */
+      _mongoc_addrinfo_set_preferred (node->dns_results, acmd->dns_result);
+   }
 }
 
 static void
@@ -708,7 +711,8 @@ _async_error_or_timeout (mongoc_async_cmd_t *acmd, int64_t duration_usec, const
 
       /* invalidate any cached DNS results. */
       if (node->dns_results) {
-         freeaddrinfo (node->dns_results);
+         _mongoc_addrinfo_release (node->dns_results);
+         _mongoc_addrinfo_cache_invalidate (&node->host);
          node->dns_results = NULL;
          node->successful_dns_result = NULL;
       }
@@ -812,6 +816,13 @@ _mongoc_topology_scanner_tcp_initiate (mongoc_async_cmd_t *acmd)
 
    (void) mongoc_socket_connect (sock, res->ai_addr, (mongoc_socklen_t) res->ai_addrlen, 0);
 
+   /* single-threaded clients send their commands on this stream. */
+   const int32_t zerocopy_threshold =
+      node->ts->uri ? mongoc_uri_get_option_as_int32 (node->ts->uri, MONGOC_URI_ZEROCOPYTHRESHOLD, 0) : 0;
+   if (zerocopy_threshold > 0 && !_mongoc_socket_set_zerocopy (sock, (size_t) zerocopy_threshold)) {
+      MONGOC_DEBUG ("MSG_ZEROCOPY is unavailable, copying sends to %s", node->host.host_and_port);
+   }
+
    return _mongoc_topology_scanner_node_setup_stream_for_tls (node, mongoc_stream_socket_new (sock));
 }
 /*
@@ -830,11 +841,8 @@ _mongoc_topology_scanner_tcp_initiate (mongoc_async_cmd_t *acmd)
 bool
 mongoc_topology_scanner_node_setup_tcp (mongoc_topology_scanner_node_t *node, bson_error_t *error)
 {
-   struct addrinfo hints;
    struct addrinfo *iter;
-   char portstr[8];
    mongoc_host_list_t *host;
-   int s;
    int64_t delay = 0;
    int64_t now = bson_get_monotonic_time ();
 
@@ -844,30 +852,22 @@ mongoc_topology_scanner_node_setup_tcp (mongoc_topology_scanner_node_t *node, bs
 
    /* if cached dns results are expired, flush. */
    if (node->dns_results && (now - node->last_dns_cache) > node->ts->dns_cache_timeout_ms * 1000) {
-      freeaddrinfo (node->dns_results);
+      _mongoc_addrinfo_release (node->dns_results);
       node->dns_results = NULL;
       node->successful_dns_result = NULL;
    }
 
    if (!node->dns_results) {
-      bson_snprintf (portstr, sizeof portstr, "%hu", host->port);
-
-      memset (&hints, 0, sizeof hints);
-      hints.ai_family = host->family;
-      hints.ai_socktype = SOCK_STREAM;
-      hints.ai_flags = 0;
-      hints.ai_protocol = 0;
-
-      s = getaddrinfo (host->host, portstr, &hints, &node->dns_results);
+      node->dns_results = _mongoc_addrinfo_cache_get (host, node->ts->dns_cache_timeout_ms);
 
-      if (s != 0) {
-         mongoc_counter_dns_failure_inc ();
+      if (!node->dns_results) {
          bson_set_error (
             error, MONGOC_ERROR_STREAM, MONGOC_ERROR_STREAM_NAME_RESOLUTION, "Failed to resolve '%s'", host->host);
          RETURN (false);
       }
 
-      mongoc_counter_dns_success_inc ();
+      /* start with the address another connection to this host used. */
+      node->successful_dns_result = _mongoc_addrinfo_preferred (node->dns_results);
       node->last_dns_cache = now;
    }
 
@@ -879,7 +879,7 @@ mongoc_topology_scanner_node_setup_tcp (mongoc_topology_scanner_node_t *node, bs
                         0 /* initiate_delay_ms */,
                         true /* use_handshake */);
    } else {
-      LL_FOREACH2 (node->dns_results, iter, ai_next)
+      LL_FOREACH2 (_mongoc_addrinfo_results (node->dns_results), iter, ai_next)
       {
          _begin_hello_cmd (node, NULL /* stream */, false /* is_setup_done */, iter, delay, true /* use_handshake */);
          /* each subsequent DNS result will have an additional 250ms delay. */
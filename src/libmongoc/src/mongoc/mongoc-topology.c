@@ -23,6 +23,7 @@
 #include "mongoc-host-list-private.h"
 #include "mongoc-log.h"
 #include "mongoc-topology-private.h"
+#include "mongoc-counters-private.h"
 #include "mongoc-topology-description-apm-private.h"
 #include "mongoc-client-private.h"
 #include "mongoc-cmd-private.h"
@@ -32,6 +33,7 @@
 #include "mongoc-error-private.h"
 #include "mongoc-topology-background-monitoring-private.h"
 #include "mongoc-read-prefs-private.h"
+#include "mongoc-rr-cache-private.h"
 
 #include "utlist.h"
 
@@ -465,8 +467,10 @@ mongoc_topology_new (const mongoc_uri_t *uri, bool single_threaded)
       char *prefixed_hostname;
 
       memset (&rr_data, 0, sizeof (mongoc_rr_data_t));
-      /* Set the default resource record resolver */
-      topology->rr_resolver = _mongoc_client_get_rr;
+      /* Set the default resource record resolver. Answers are cached for
+       * their TTL, so a client for the same SRV hostname does not query DNS
+       * again, and SRV polling from the background thread refreshes them. */
+      topology->rr_resolver = _mongoc_rr_cache_get_rr;
 
       /* Initialize the last scan time and interval. Even if the initial DNS
        * lookup fails, SRV polling will still start when background monitoring
@@ -585,6 +589,8 @@ mongoc_topology_new (const mongoc_uri_t *uri, bool single_threaded)
       bson_mutex_init (&topology->apm_mutex);
       bson_mutex_init (&topology->srv_polling_mtx);
       mongoc_cond_init (&topology->srv_polling_cond);
+      bson_mutex_init (&topology->establisher_mtx);
+      mongoc_cond_init (&topology->establisher_cond);
    }
 
    if (!topology->valid) {
@@ -679,6 +685,8 @@ mongoc_topology_destroy (mongoc_topology_t *topology)
       bson_mutex_destroy (&topology->apm_mutex);
       bson_mutex_destroy (&topology->srv_polling_mtx);
       mongoc_cond_destroy (&topology->srv_polling_cond);
+      bson_mutex_destroy (&topology->establisher_mtx);
+      mongoc_cond_destroy (&topology->establisher_cond);
    }
 
    if (topology->valid) {
@@ -1097,6 +1105,7 @@ mongoc_topology_select_server_id (mongoc_topology_t *topology,
    int64_t heartbeat_msec;
    uint32_t server_id;
    mc_shared_tpld td = mc_tpld_take_ref (topology);
+   const int64_t selection_started = bson_get_monotonic_time ();
 
    /* These names come from the Server Selection Spec pseudocode */
    int64_t loop_start;  /* when we entered this function */
@@ -1301,6 +1310,7 @@ mongoc_topology_select_server_id (mongoc_topology_t *topology,
    }
 
 done:
+   mongoc_histogram_server_selection_record (bson_get_monotonic_time () - selection_started);
    mc_tpld_drop_ref (&td);
    return server_id;
 }
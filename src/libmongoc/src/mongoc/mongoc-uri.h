@@ -43,6 +43,7 @@
 #define MONGOC_URI_DIRECTCONNECTION "directconnection"
 #define MONGOC_URI_GSSAPISERVICENAME "gssapiservicename"
 #define MONGOC_URI_HEARTBEATFREQUENCYMS "heartbeatfrequencyms"
+#define MONGOC_URI_IOURING "iouring"
 #define MONGOC_URI_JOURNAL "journal"
 #define MONGOC_URI_LOADBALANCED "loadbalanced"
 #define MONGOC_URI_LOCALTHRESHOLDMS "localthresholdms"
@@ -77,6 +78,7 @@
 #define MONGOC_URI_WAITQUEUEMULTIPLE "waitqueuemultiple"
 #define MONGOC_URI_WAITQUEUETIMEOUTMS "waitqueuetimeoutms"
 #define MONGOC_URI_WTIMEOUTMS "wtimeoutms"
+#define MONGOC_URI_ZEROCOPYTHRESHOLD "zerocopythreshold"
 #define MONGOC_URI_ZLIBCOMPRESSIONLEVEL "zlibcompressionlevel"
 
 /* Deprecated in MongoDB 4.2, use "tls" variants instead. */
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mongoc-prelude.h"
+
+#ifndef MONGOC_URING_PRIVATE_H
+#define MONGOC_URING_PRIVATE_H
+
+#include <bson/bson.h>
+
+#include "mongoc-iovec.h"
+#include "mongoc-socket.h"
+
+
+BSON_BEGIN_DECLS
+
+
+/* An io_uring instance for the socket of one stream. Each receive or send is
+ * submitted together with a linked timeout for its deadline, and both are
+ * waited for in the same io_uring_enter () call, where the poll () based path
+ * makes a poll () call and a recv () or sendmsg () call. Small receives are
+ * read into a buffer registered with the ring. */
+typedef struct _mongoc_uring_t mongoc_uring_t;
+
+
+mongoc_uring_t *
+_mongoc_uring_new (void);
+void
+_mongoc_uring_destroy (mongoc_uring_t *uring);
+ssize_t
+_mongoc_uring_recv (
+   mongoc_uring_t *uring, mongoc_socket_t *sock, mongoc_iovec_t *iov, size_t iovcnt, int64_t expire_at);
+ssize_t
+_mongoc_uring_sendv (
+   mongoc_uring_t *uring, mongoc_socket_t *sock, mongoc_iovec_t *iov, size_t iovcnt, int64_t expire_at);
+
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_URING_PRIVATE_H */
@@ -0,0 +1,612 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "mongoc-config.h"
+#include "mongoc-uring-private.h"
+
+#ifdef MONGOC_HAVE_IO_URING
+
+#include <errno.h>
+#include <string.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "mongoc-counters-private.h"
+#include "mongoc-errno-private.h"
+#include "mongoc-socket-private.h"
+#include "mongoc-trace-private.h"
+
+#undef MONGOC_LOG_DOMAIN
+#define MONGOC_LOG_DOMAIN "socket"
+
+
+/* an operation and the timeout linked to it. */
+#define MONGOC_URING_ENTRIES 2
+
+/* receives of up to this many bytes are read into the registered buffer. */
+#define MONGOC_URING_BUFFER_SIZE 16384
+
+#define MONGOC_URING_OP 1u
+#define MONGOC_URING_TIMEOUT 2u
+#define MONGOC_URING_CANCEL 3u
+
+/* bounds the io_uring_enter () calls that reap an operation still in flight
+ * after io_uring_enter () failed. */
+#define MONGOC_URING_DRAIN_ATTEMPTS 8
+
+/* sockets are polled by the kernel instead of blocking a worker thread. */
+#define MONGOC_URING_FEATURES (IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_FAST_POLL)
+
+
+struct _mongoc_uring_t {
+   int fd;
+   void *ring;
+   size_t ring_size;
+   struct io_uring_sqe *sqes;
+   size_t sqes_size;
+   uint32_t *sq_tail;
+   uint32_t sq_mask;
+   uint32_t *cq_head;
+   uint32_t *cq_tail;
+   uint32_t cq_mask;
+   struct io_uring_cqe *cqes;
+   uint32_t pending;
+   uint8_t *buffer; /* registered with the ring, or NULL */
+   bool failed;     /* an operation may still be in flight */
+};
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_uring_new --
+ *
+ *       Creates an io_uring instance for one socket, with a registered
+ *       buffer if the kernel allows locking its memory.
+ *
+ * Returns:
+ *       A mongoc_uring_t, or NULL if io_uring is unavailable, e.g. in
+ *       kernels before 5.7 or where a seccomp policy denies it.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_uring_t *
+_mongoc_uring_new (void)
+{
+   struct io_uring_params params;
+   mongoc_uring_t *uring;
+   struct iovec registered;
+   uint32_t *sq_array;
+   char *ring;
+   uint32_t i;
+   int fd;
+
+   ENTRY;
+
+   memset (&params, 0, sizeof params);
+   fd = (int) syscall (__NR_io_uring_setup, MONGOC_URING_ENTRIES, &params);
+   if (fd < 0) {
+      TRACE ("io_uring_setup failed: %d", errno);
+      RETURN (NULL);
+   }
+
+   if ((params.features & MONGOC_URING_FEATURES) != MONGOC_URING_FEATURES) {
+      TRACE ("io_uring features 0x%x are missing", MONGOC_URING_FEATURES & ~params.features);
+      close (fd);
+      RETURN (NULL);
+   }
+
+   uring = (mongoc_uring_t *) bson_malloc0 (sizeof *uring);
+   uring->fd = fd;
+
+   uring->ring_size = BSON_MAX (params.sq_off.array + params.sq_entries * sizeof (uint32_t),
+                                params.cq_off.cqes + params.cq_entries * sizeof (struct io_uring_cqe));
+   uring->ring =
+      mmap (NULL, uring->ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+   if (uring->ring == MAP_FAILED) {
+      uring->ring = NULL;
+      GOTO (fail);
+   }
+
+   uring->sqes_size = params.sq_entries * sizeof (struct io_uring_sqe);
+   uring->sqes = (struct io_uring_sqe *) mmap (
+      NULL, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+   if (uring->sqes == MAP_FAILED) {
+      uring->sqes = NULL;
+      GOTO (fail);
+   }
+
+   ring = (char *) uring->ring;
+   uring->sq_tail = (uint32_t *) (ring + params.sq_off.tail);
+   uring->sq_mask = *(uint32_t *) (ring + params.sq_off.ring_mask);
+   uring->cq_head = (uint32_t *) (ring + params.cq_off.head);
+   uring->cq_tail = (uint32_t *) (ring + params.cq_off.tail);
+   uring->cq_mask = *(uint32_t *) (ring + params.cq_off.ring_mask);
+   uring->cqes = (struct io_uring_cqe *) (ring + params.cq_off.cqes);
+
+   /* every submission is waited for, so entry i is always in slot i. */
+   sq_array = (uint32_t *) (ring + params.sq_off.array);
+   for (i = 0; i < params.sq_entries; i++) {
+      sq_array[i] = i;
+   }
+
+   /* the registered buffer's pages are locked, which kernels before 5.12
+    * limit by RLIMIT_MEMLOCK. Without it, receives use the caller's buffers. */
+   registered.iov_base = bson_aligned_alloc (4096, MONGOC_URING_BUFFER_SIZE);
+   registered.iov_len = MONGOC_URING_BUFFER_SIZE;
+   if (0 == syscall (__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, &registered, 1)) {
+      uring->buffer = (uint8_t *) registered.iov_base;
+   } else {
+      TRACE ("Failed to register io_uring buffer: %d", errno);
+      bson_free (registered.iov_base);
+   }
+
+   RETURN (uring);
+
+fail:
+   _mongoc_uring_destroy (uring);
+   RETURN (NULL);
+}
+
+
+void
+_mongoc_uring_destroy (mongoc_uring_t *uring)
+{
+   if (!uring) {
+      return;
+   }
+
+   if (uring->sqes) {
+      munmap (uring->sqes, uring->sqes_size);
+   }
+
+   if (uring->ring) {
+      munmap (uring->ring, uring->ring_size);
+   }
+
+   /* closing the ring unregisters the buffer. */
+   close (uring->fd);
+   bson_free (uring->buffer);
+   bson_free (uring);
+}
+
+
+/* returns a cleared submission queue entry, submitted by _mongoc_uring_run. */
+static struct io_uring_sqe *
+_mongoc_uring_get_sqe (mongoc_uring_t *uring, uint8_t opcode, uint64_t user_data)
+{
+   struct io_uring_sqe *sqe;
+
+   BSON_ASSERT (uring->pending < MONGOC_URING_ENTRIES);
+
+   sqe = &uring->sqes[(*uring->sq_tail + uring->pending++) & uring->sq_mask];
+   memset (sqe, 0, sizeof *sqe);
+   sqe->opcode = opcode;
+   sqe->user_data = user_data;
+
+   return sqe;
+}
+
+
+/* moves the sq tail by @n entries, which may be negative to withdraw
+ * entries the kernel has not consumed. */
+static void
+_mongoc_uring_advance_sq (mongoc_uring_t *uring, int32_t n)
+{
+   bson_atomic_int32_exchange (
+      (int32_t *) uring->sq_tail, (int32_t) (*uring->sq_tail + (uint32_t) n), bson_memory_order_release);
+}
+
+
+/* consumes the posted completions and returns how many there were. */
+static uint32_t
+_mongoc_uring_reap (mongoc_uring_t *uring, int *res, int *timeout_res)
+{
+   uint32_t head;
+   uint32_t tail;
+   uint32_t reaped = 0;
+
+   head = *uring->cq_head;
+   tail = (uint32_t) bson_atomic_int32_fetch ((int32_t *) uring->cq_tail, bson_memory_order_acquire);
+   for (; head != tail; head++, reaped++) {
+      const struct io_uring_cqe *cqe = &uring->cqes[head & uring->cq_mask];
+
+      if (cqe->user_data == MONGOC_URING_OP) {
+         *res = cqe->res;
+      } else if (cqe->user_data == MONGOC_URING_TIMEOUT) {
+         *timeout_res = cqe->res;
+      }
+   }
+
+   bson_atomic_int32_exchange ((int32_t *) uring->cq_head, (int32_t) head, bson_memory_order_release);
+
+   return reaped;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_uring_drain --
+ *
+ *       Cancels the operation left in flight when io_uring_enter () failed
+ *       and reaps the @in_flight completions owed for it, making at most
+ *       MONGOC_URING_DRAIN_ATTEMPTS calls.
+ *
+ * Returns:
+ *       true if nothing is in flight anymore, false if the kernel may still
+ *       complete the operation.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static bool
+_mongoc_uring_drain (mongoc_uring_t *uring, uint32_t in_flight)
+{
+   struct io_uring_sqe *cancel;
+   uint32_t to_submit = 1;
+   int timeout_res = 0;
+   int res = 0;
+   int ret;
+   int i;
+
+   cancel = _mongoc_uring_get_sqe (uring, IORING_OP_ASYNC_CANCEL, MONGOC_URING_CANCEL);
+   cancel->addr = MONGOC_URING_OP;
+   uring->pending = 0;
+   _mongoc_uring_advance_sq (uring, 1);
+   in_flight++;
+
+   for (i = 0; i < MONGOC_URING_DRAIN_ATTEMPTS && in_flight > 0; i++) {
+      ret = (int) syscall (__NR_io_uring_enter, uring->fd, to_submit, in_flight, IORING_ENTER_GETEVENTS, NULL, 0);
+      if (ret > 0) {
+         to_submit -= (uint32_t) ret;
+      }
+
+      in_flight -= _mongoc_uring_reap (uring, &res, &timeout_res);
+
+      if (to_submit && in_flight == 1) {
+         /* the operation completed, so the unsubmitted cancellation is moot. */
+         break;
+      }
+   }
+
+   if (to_submit) {
+      _mongoc_uring_advance_sq (uring, -1);
+      in_flight--;
+   }
+
+   return in_flight == 0;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_uring_run --
+ *
+ *       Links a timeout for @expire_at to the prepared operation, submits
+ *       both, and waits for their completions with io_uring_enter ().
+ *
+ *       @expire_at is 0 for no blocking, -1 for infinite blocking,
+ *       or a time using the monotonic clock to expire.
+ *
+ *       io_uring_enter () is retried after EINTR, EAGAIN, and EBUSY. Other
+ *       errors cancel the operation if the kernel already consumed it.
+ *
+ * Returns:
+ *       The result of the operation, or -1 with sock->errno_ set.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static int
+_mongoc_uring_run (mongoc_uring_t *uring, mongoc_socket_t *sock, struct io_uring_sqe *sqe, int64_t expire_at)
+{
+   struct __kernel_timespec ts;
+   struct io_uring_sqe *timeout;
+   uint32_t to_submit;
+   uint32_t n_complete;
+   uint32_t reaped = 0;
+   int timeout_res = 0;
+   int res = 0;
+   int64_t remaining;
+   int err;
+   int ret;
+
+   if (uring->failed) {
+      /* completions of an abandoned operation could be mistaken for ours. */
+      uring->pending = 0;
+      sock->errno_ = EIO;
+      return -1;
+   }
+
+   if (expire_at >= 0) {
+      remaining = expire_at == 0 ? 0 : BSON_MAX (expire_at - bson_get_monotonic_time (), 0);
+      ts.tv_sec = remaining / 1000000;
+      ts.tv_nsec = (remaining % 1000000) * 1000;
+
+      sqe->flags |= IOSQE_IO_LINK;
+      timeout = _mongoc_uring_get_sqe (uring, IORING_OP_LINK_TIMEOUT, MONGOC_URING_TIMEOUT);
+      timeout->addr = (uint64_t) (uintptr_t) &ts;
+      timeout->len = 1;
+   }
+
+   to_submit = n_complete = uring->pending;
+   uring->pending = 0;
+   _mongoc_uring_advance_sq (uring, (int32_t) to_submit);
+
+   while (reaped < n_complete) {
+      ret = (int) syscall (
+         __NR_io_uring_enter, uring->fd, to_submit, n_complete - reaped, IORING_ENTER_GETEVENTS, NULL, 0);
+      err = errno;
+      if (ret > 0) {
+         to_submit -= (uint32_t) ret;
+      }
+
+      /* EBUSY means the completion queue is full, so reap before retrying. */
+      reaped += _mongoc_uring_reap (uring, &res, &timeout_res);
+
+      if (ret < 0 && err != EINTR && err != EAGAIN && err != EBUSY) {
+         /* withdraw the entries the kernel did not consume rather than leave
+          * them in the ring pointing at the caller's stack. */
+         _mongoc_uring_advance_sq (uring, -(int32_t) to_submit);
+         n_complete -= to_submit;
+
+         /* what was consumed must complete before the caller's buffers go
+          * out of scope. */
+         if (reaped < n_complete && !_mongoc_uring_drain (uring, n_complete - reaped)) {
+            MONGOC_WARNING ("Abandoning an io_uring operation after error %d", err);
+            uring->failed = true;
+         }
+
+         sock->errno_ = err;
+         TRACE ("setting errno: %d %s", sock->errno_, strerror (sock->errno_));
+         return -1;
+      }
+   }
+
+   if (res >= 0) {
+      sock->errno_ = 0;
+      return res;
+   }
+
+   if (res == -ECANCELED && timeout_res == -ETIME) {
+      if (expire_at > 0) {
+         mongoc_counter_streams_timeout_inc ();
+      }
+
+      sock->errno_ = expire_at ? ETIMEDOUT : EAGAIN;
+   } else {
+      sock->errno_ = -res;
+   }
+
+   TRACE ("setting errno: %d %s", sock->errno_, strerror (sock->errno_));
+
+   return -1;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_uring_recv --
+ *
+ *       Receives into @iov like mongoc_socket_recv (), waiting until
+ *       @expire_at for data.
+ *
+ * Returns:
+ *       The number of bytes received, 0 if the peer closed the
+ *       connection, or -1 with sock->errno_ set.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+ssize_t
+_mongoc_uring_recv (
+   mongoc_uring_t *uring, mongoc_socket_t *sock, mongoc_iovec_t *iov, size_t iovcnt, int64_t expire_at)
+{
+   struct io_uring_sqe *sqe;
+   struct msghdr msg;
+   size_t buflen = 0;
+   size_t copied;
+   bool fixed;
+   size_t i;
+   int ret;
+
+   ENTRY;
+
+   BSON_ASSERT (uring);
+   BSON_ASSERT (sock);
+   BSON_ASSERT (iov);
+   BSON_ASSERT (iovcnt);
+
+   for (i = 0; i < iovcnt; i++) {
+      buflen += iov[i].iov_len;
+   }
+
+   fixed = uring->buffer && buflen <= MONGOC_URING_BUFFER_SIZE;
+   if (fixed) {
+      sqe = _mongoc_uring_get_sqe (uring, IORING_OP_READ_FIXED, MONGOC_URING_OP);
+      sqe->fd = sock->sd;
+      sqe->addr = (uint64_t) (uintptr_t) uring->buffer;
+      sqe->len = (uint32_t) buflen;
+      sqe->buf_index = 0;
+   } else {
+      memset (&msg, 0, sizeof msg);
+      msg.msg_iov = iov;
+      msg.msg_iovlen = iovcnt;
+
+      sqe = _mongoc_uring_get_sqe (uring, IORING_OP_RECVMSG, MONGOC_URING_OP);
+      sqe->fd = sock->sd;
+      sqe->addr = (uint64_t) (uintptr_t) &msg;
+      sqe->len = 1;
+   }
+
+   ret = _mongoc_uring_run (uring, sock, sqe, expire_at);
+   if (ret < 0) {
+      RETURN (-1);
+   }
+
+   if (fixed) {
+      for (i = 0, copied = 0; copied < (size_t) ret; i++) {
+         size_t n = BSON_MIN (iov[i].iov_len, (size_t) ret - copied);
+
+         memcpy (iov[i].iov_base, uring->buffer + copied, n);
+         copied += n;
+      }
+   }
+
+   mongoc_counter_streams_ingress_add (ret);
+
+   RETURN (ret);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_uring_sendv --
+ *
+ *       Sends all of @in_iov like mongoc_socket_sendv (), waiting until
+ *       @expire_at for the socket to accept it.
+ *
+ * Returns:
+ *       The number of bytes sent, which is less than requested if
+ *       @expire_at passed, or -1 on failure with sock->errno_ set.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+ssize_t
+_mongoc_uring_sendv (
+   mongoc_uring_t *uring, mongoc_socket_t *sock, mongoc_iovec_t *in_iov, size_t iovcnt, int64_t expire_at)
+{
+   struct io_uring_sqe *sqe;
+   mongoc_iovec_t stack_iov[MONGOC_SOCKET_SENDV_STACK_IOVCNT];
+   mongoc_iovec_t *iov;
+   struct msghdr msg;
+   ssize_t ret = 0;
+   size_t cur = 0;
+   int sent;
+
+   ENTRY;
+
+   BSON_ASSERT (uring);
+   BSON_ASSERT (sock);
+   BSON_ASSERT (in_iov);
+   BSON_ASSERT (iovcnt);
+
+   /* as in mongoc_socket_sendv (), small iovec arrays are copied on the stack. */
+   iov = iovcnt <= MONGOC_SOCKET_SENDV_STACK_IOVCNT ? stack_iov : bson_malloc (sizeof (*iov) * iovcnt);
+   memcpy (iov, in_iov, sizeof (*iov) * iovcnt);
+
+   DUMP_IOVEC (sendbuf, iov, iovcnt);
+
+   for (;;) {
+      memset (&msg, 0, sizeof msg);
+      msg.msg_iov = &iov[cur];
+      msg.msg_iovlen = iovcnt - cur;
+
+      sqe = _mongoc_uring_get_sqe (uring, IORING_OP_SENDMSG, MONGOC_URING_OP);
+      sqe->fd = sock->sd;
+      sqe->addr = (uint64_t) (uintptr_t) &msg;
+      sqe->len = 1;
+      sqe->msg_flags = MSG_NOSIGNAL;
+
+      sent = _mongoc_uring_run (uring, sock, sqe, expire_at);
+      if (sent < 0) {
+         /* like mongoc_socket_sendv (), report what was sent before a timeout. */
+         if (!MONGOC_ERRNO_IS_TIMEDOUT (sock->errno_) && !MONGOC_ERRNO_IS_AGAIN (sock->errno_)) {
+            ret = -1;
+         }
+
+         GOTO (CLEANUP);
+      }
+
+      ret += sent;
+      mongoc_counter_streams_egress_add (sent);
+
+      while ((cur < iovcnt) && (sent >= (int) iov[cur].iov_len)) {
+         sent -= (int) iov[cur++].iov_len;
+      }
+
+      if (cur == iovcnt) {
+         break;
+      }
+
+      iov[cur].iov_base = ((char *) iov[cur].iov_base) + sent;
+      iov[cur].iov_len -= (size_t) sent;
+   }
+
+CLEANUP:
+   if (iov != stack_iov) {
+      bson_free (iov);
+   }
+
+   RETURN (ret);
+}
+
+#else
+
+mongoc_uring_t *
+_mongoc_uring_new (void)
+{
+   return NULL;
+}
+
+
+void
+_mongoc_uring_destroy (mongoc_uring_t *uring)
+{
+   BSON_ASSERT (!uring);
+}
+
+
+ssize_t
+_mongoc_uring_recv (
+   mongoc_uring_t *uring, mongoc_socket_t *sock, mongoc_iovec_t *iov, size_t iovcnt, int64_t expire_at)
+{
+   BSON_UNUSED (uring);
+   BSON_UNUSED (sock);
+   BSON_UNUSED (iov);
+   BSON_UNUSED (iovcnt);
+   BSON_UNUSED (expire_at);
+
+   BSON_ASSERT (false && "io_uring is not available");
+   return -1;
+}
+
+
+ssize_t
+_mongoc_uring_sendv (
+   mongoc_uring_t *uring, mongoc_socket_t *sock, mongoc_iovec_t *iov, size_t iovcnt, int64_t expire_at)
+{
+   BSON_UNUSED (uring);
+   BSON_UNUSED (sock);
+   BSON_UNUSED (iov);
+   BSON_UNUSED (iovcnt);
+   BSON_UNUSED (expire_at);
+
+   BSON_ASSERT (false && "io_uring is not available");
+   return -1;
+}
+
+#endif
@@ -231,6 +231,12 @@ TestSuite_CheckLive (void)
    return test_framework_getenv_bool ("MONGOC_TEST_SKIP_LIVE") ? 0 : 1;
 }
 
+int
+TestSuite_CheckSlow (void)
+{
+   return test_framework_getenv_bool ("MONGOC_TEST_SKIP_SLOW") ? 0 : 1;
+}
+
 static int
 TestSuite_CheckDummy (void)
 {
@@ -638,6 +638,8 @@ void
 TestSuite_Add (TestSuite *suite, const char *name, TestFunc func);
 int
 TestSuite_CheckLive (void);
+int
+TestSuite_CheckSlow (void);
 void
 TestSuite_AddLive (TestSuite *suite, const char *name, TestFunc func);
 int
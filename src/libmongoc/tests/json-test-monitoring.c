@@ -80,6 +80,7 @@ static void
 started_cb (const mongoc_apm_command_started_t *event)
 {
    json_test_ctx_t *ctx = (json_test_ctx_t *) mongoc_apm_command_started_get_context (event);
+   const bson_t *command = mongoc_apm_command_started_get_command (event);
    bson_t *events = &ctx->events;
    char str[16];
    const char *key;
@@ -88,7 +89,7 @@ started_cb (const mongoc_apm_command_started_t *event)
    if (ctx->verbose) {
       char *cmd_json;
 
-      cmd_json = bson_as_canonical_extended_json (event->command, NULL);
+      cmd_json = bson_as_canonical_extended_json (command, NULL);
       printf ("%s\n", cmd_json);
       fflush (stdout);
       bson_free (cmd_json);
@@ -97,13 +98,13 @@ started_cb (const mongoc_apm_command_started_t *event)
    bson_mutex_lock (&ctx->mutex);
 
    /* Track the last two lsid's */
-   if (bson_has_field (event->command, "lsid")) {
+   if (bson_has_field (command, "lsid")) {
       bson_t lsid;
 
       /* Push on the circular queue */
       bson_destroy (ctx->sent_lsids[0]);
       ctx->sent_lsids[0] = ctx->sent_lsids[1];
-      bson_lookup_doc (event->command, "lsid", &lsid);
+      bson_lookup_doc (command, "lsid", &lsid);
       ctx->sent_lsids[1] = bson_copy (&lsid);
       bson_destroy (&lsid);
    }
@@ -115,7 +116,7 @@ started_cb (const mongoc_apm_command_started_t *event)
    new_event = BCON_NEW ("command_started_event",
                          "{",
                          "command",
-                         BCON_DOCUMENT (event->command),
+                         BCON_DOCUMENT (command),
                          "command_name",
                          BCON_UTF8 (event->command_name),
                          "database_name",
@@ -138,6 +139,7 @@ static void
 succeeded_cb (const mongoc_apm_command_succeeded_t *event)
 {
    json_test_ctx_t *ctx = (json_test_ctx_t *) mongoc_apm_command_succeeded_get_context (event);
+   const bson_t *reply = mongoc_apm_command_succeeded_get_reply (event);
    char str[16];
    const char *key;
    bson_t *new_event;
@@ -145,7 +147,7 @@ succeeded_cb (const mongoc_apm_command_succeeded_t *event)
    if (ctx->verbose) {
       char *reply_json;
 
-      reply_json = bson_as_canonical_extended_json (event->reply, NULL);
+      reply_json = bson_as_canonical_extended_json (reply, NULL);
       MONGOC_DEBUG ("<-- COMMAND SUCCEEDED: %s\n", reply_json);
       bson_free (reply_json);
    }
@@ -160,7 +162,7 @@ succeeded_cb (const mongoc_apm_command_succeeded_t *event)
    new_event = BCON_NEW ("command_succeeded_event",
                          "{",
                          "reply",
-                         BCON_DOCUMENT (event->reply),
+                         BCON_DOCUMENT (reply),
                          "command_name",
                          BCON_UTF8 (event->command_name),
                          "operation_id",
@@ -182,6 +184,7 @@ static void
 failed_cb (const mongoc_apm_command_failed_t *event)
 {
    json_test_ctx_t *ctx = (json_test_ctx_t *) mongoc_apm_command_failed_get_context (event);
+   const bson_t *reply = mongoc_apm_command_failed_get_reply (event);
    char str[16];
    const char *key;
    bson_t *new_event;
@@ -189,7 +192,7 @@ failed_cb (const mongoc_apm_command_failed_t *event)
    if (ctx->verbose) {
       char *reply_json;
 
-      reply_json = bson_as_canonical_extended_json (event->reply, NULL);
+      reply_json = bson_as_canonical_extended_json (reply, NULL);
       MONGOC_DEBUG ("<-- %s COMMAND FAILED: %s\nREPLY: %s\n", event->command_name, event->error->message, reply_json);
       bson_free (reply_json);
    }
@@ -1,4 +1,5 @@
 #include <mongoc/mongoc.h>
+#include <mongoc/mongoc-addrinfo-cache-private.h>
 #include <mongoc/mongoc-socket-private.h>
 #include <mongoc/mongoc-host-list-private.h>
 #include <mongoc/mongoc-util-private.h>
@@ -246,6 +247,9 @@ _testcase_setup (he_testcase_t *testcase)
 
    _init_host (&testcase->state.host, mock_server_get_port (mock_server), testcase->client.type);
 
+   /* start from a fresh DNS lookup, not the address a previous test used. */
+   _mongoc_addrinfo_cache_clear ();
+
    testcase->state.ts = mongoc_topology_scanner_new (NULL, NULL, &_test_scanner_callback, testcase, TIMEOUT);
 
    testcase->state.mock_server = mock_server;
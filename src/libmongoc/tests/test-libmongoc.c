@@ -1928,7 +1928,7 @@ test_framework_skip_if_offline (void)
 int
 test_framework_skip_if_slow (void)
 {
-   return test_framework_getenv_bool ("MONGOC_TEST_SKIP_SLOW") ? 0 : 1;
+   return TestSuite_CheckSlow ();
 }
 
 
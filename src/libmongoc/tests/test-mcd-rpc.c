@@ -2828,6 +2828,121 @@ test_rpc_message_from_data_in_place (void)
 }
 
 
+static size_t _test_rpc_message_allocations = 0u;
+
+static void *
+_test_rpc_message_counting_malloc (size_t num_bytes)
+{
+   _test_rpc_message_allocations++;
+   return malloc (num_bytes);
+}
+
+static void *
+_test_rpc_message_counting_calloc (size_t n_members, size_t num_bytes)
+{
+   _test_rpc_message_allocations++;
+   return calloc (n_members, num_bytes);
+}
+
+static void *
+_test_rpc_message_counting_realloc (void *mem, size_t num_bytes)
+{
+   _test_rpc_message_allocations++;
+   return realloc (mem, num_bytes);
+}
+
+static void
+test_rpc_message_recycle_op_msg (void)
+{
+   const uint8_t data[] = {TEST_DATA_OP_MSG_KIND_1_MULTIPLE};
+
+   const bson_mem_vtable_t vtable = {
+      .malloc = _test_rpc_message_counting_malloc,
+      .calloc = _test_rpc_message_counting_calloc,
+      .realloc = _test_rpc_message_counting_realloc,
+      .free = free,
+   };
+
+   mcd_rpc_message *const expected_rpc = mcd_rpc_message_from_data (data, sizeof (data), NULL);
+   ASSERT (expected_rpc);
+
+   size_t expected_num_iovecs;
+   mongoc_iovec_t *const expected_iovecs = mcd_rpc_message_to_iovecs (expected_rpc, &expected_num_iovecs);
+   ASSERT (expected_iovecs);
+
+   mcd_rpc_message *const rpc = mcd_rpc_message_new ();
+   void *iovecs_buf = NULL;
+   size_t capacity = 0u;
+
+   // Only the first message allocates the sections and iovecs arrays.
+   for (int i = 0; i < 3; ++i) {
+      _test_rpc_message_allocations = 0u;
+      bson_mem_set_vtable (&vtable);
+
+      // clang-format off
+      mcd_rpc_header_set_message_length (rpc, 110);
+      mcd_rpc_header_set_request_id (rpc, 16909060);
+      mcd_rpc_header_set_response_to (rpc, 84281096);
+      mcd_rpc_header_set_op_code (rpc, MONGOC_OP_CODE_MSG);
+      mcd_rpc_op_msg_set_sections_count (rpc, 3u);
+      mcd_rpc_op_msg_set_flag_bits (rpc, MONGOC_OP_MSG_FLAG_CHECKSUM_PRESENT);
+      mcd_rpc_op_msg_section_set_kind (rpc, 0u, 0);
+      mcd_rpc_op_msg_section_set_body (rpc, 0u, data + 21);
+      mcd_rpc_op_msg_section_set_kind (rpc, 1u, 1);
+      mcd_rpc_op_msg_section_set_length (rpc, 1u, 25u);
+      mcd_rpc_op_msg_section_set_identifier (rpc, 1u, (const char *) (data + 41));
+      mcd_rpc_op_msg_section_set_document_sequence (rpc, 1u, data + 47, 15u);
+      mcd_rpc_op_msg_section_set_kind (rpc, 2u, 1);
+      mcd_rpc_op_msg_section_set_length (rpc, 2u, 43u);
+      mcd_rpc_op_msg_section_set_identifier (rpc, 2u, (const char *) (data + 67));
+      mcd_rpc_op_msg_section_set_document_sequence (rpc, 2u, data + 74, 32u);
+      mcd_rpc_op_msg_set_checksum (rpc, 287454020);
+      // clang-format on
+
+      size_t num_iovecs;
+      const bool res = mcd_rpc_message_to_iovecs_reuse (rpc, &iovecs_buf, &capacity, &num_iovecs);
+
+      bson_mem_restore_vtable ();
+
+      ASSERT (res);
+      ASSERT_CMPSIZE_T (_test_rpc_message_allocations, ==, i == 0 ? 2u : 0u);
+      ASSERT_CMPSIZE_T (capacity, ==, 16u);
+
+      const mongoc_iovec_t *const iovecs = iovecs_buf;
+
+      ASSERT_CMPSIZE_T (num_iovecs, ==, expected_num_iovecs);
+      ASSERT_CMPIOVEC_INT32 (0);   // messageLength
+      ASSERT_CMPIOVEC_INT32 (1);   // requestID
+      ASSERT_CMPIOVEC_INT32 (2);   // responseTo
+      ASSERT_CMPIOVEC_INT32 (3);   // opCode
+      ASSERT_CMPIOVEC_INT32 (4);   // flagBits
+      ASSERT_CMPIOVEC_UINT8 (5);   // Section 0 Kind
+      ASSERT_CMPIOVEC_BYTES (6);   // Section 0 Body
+      ASSERT_CMPIOVEC_UINT8 (7);   // Section 1 Kind
+      ASSERT_CMPIOVEC_INT32 (8);   // Section 1 Length
+      ASSERT_CMPIOVEC_BYTES (9);   // Section 1 Identifier
+      ASSERT_CMPIOVEC_BYTES (10);  // Section 1 Documents
+      ASSERT_CMPIOVEC_UINT8 (11);  // Section 2 Kind
+      ASSERT_CMPIOVEC_INT32 (12);  // Section 2 Length
+      ASSERT_CMPIOVEC_BYTES (13);  // Section 2 Identifier
+      ASSERT_CMPIOVEC_BYTES (14);  // Section 2 Documents
+      ASSERT_CMPIOVEC_UINT32 (15); // Checksum
+
+      mcd_rpc_message_recycle (rpc);
+   }
+
+   // A recycled message still owns its sections array.
+   mcd_rpc_message_reset (rpc);
+   ASSERT_CMPINT32 (mcd_rpc_header_get_op_code (rpc), ==, 0);
+
+   bson_free (iovecs_buf);
+   mcd_rpc_message_destroy (rpc);
+
+   bson_free (expected_iovecs);
+   mcd_rpc_message_destroy (expected_rpc);
+}
+
+
 void
 test_mcd_rpc_install (TestSuite *suite)
 {
@@ -2876,4 +2991,6 @@ test_mcd_rpc_install (TestSuite *suite)
 
 
    TestSuite_Add (suite, "/rpc_message/from_data/in_place", test_rpc_message_from_data_in_place);
+
+   TestSuite_Add (suite, "/rpc_message/recycle/op_msg", test_rpc_message_recycle_op_msg);
 }
@@ -4,6 +4,7 @@
 #include "mongoc/mongoc-util-private.h"
 #include "mongoc/mongoc-async-private.h"
 #include "mongoc/mongoc-async-cmd-private.h"
+#include "mongoc/mongoc-poller-private.h"
 #include "TestSuite.h"
 #include "mock_server/mock-server.h"
 #include "mock_server/future-functions.h"
@@ -366,6 +367,146 @@ test_hello_delay (void)
    mock_server_destroy (server);
 }
 
+
+typedef struct {
+   mongoc_socket_t *listen_sock;
+   mongoc_stream_t *client;
+   mongoc_stream_t *server;
+} poller_streams_t;
+
+
+static void
+poller_streams_init (poller_streams_t *streams)
+{
+   struct sockaddr_in server_addr = {0};
+   mongoc_socklen_t addr_len = sizeof (server_addr);
+   mongoc_socket_t *server_sock;
+
+   streams->listen_sock = mongoc_socket_new (AF_INET, SOCK_STREAM, 0);
+   BSON_ASSERT (streams->listen_sock);
+
+   server_addr.sin_family = AF_INET;
+   server_addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+   ASSERT_CMPINT (
+      mongoc_socket_bind (streams->listen_sock, (struct sockaddr *) &server_addr, sizeof (server_addr)), ==, 0);
+   ASSERT_CMPINT (mongoc_socket_getsockname (streams->listen_sock, (struct sockaddr *) &server_addr, &addr_len), ==, 0);
+   ASSERT_CMPINT (mongoc_socket_listen (streams->listen_sock, 10), ==, 0);
+
+   streams->client = get_localhost_stream (ntohs (server_addr.sin_port));
+   server_sock = mongoc_socket_accept (streams->listen_sock, bson_get_monotonic_time () + TIMEOUT * 1000);
+   BSON_ASSERT (server_sock);
+   streams->server = mongoc_stream_socket_new (server_sock);
+}
+
+
+static void
+poller_streams_cleanup (poller_streams_t *streams)
+{
+   mongoc_stream_destroy (streams->server);
+   mongoc_stream_destroy (streams->client);
+   mongoc_socket_destroy (streams->listen_sock);
+}
+
+
+static void
+_test_poller (mongoc_poller_t *poller, poller_streams_t *streams)
+{
+   mongoc_poller_event_t events[2];
+   int client_ctx, server_ctx;
+   size_t client_slot, server_slot;
+
+   client_slot = _mongoc_poller_add (poller, streams->client, POLLIN, &client_ctx);
+   ASSERT_CMPSIZE_T (_mongoc_poller_count (poller), ==, (size_t) 1);
+
+   /* nothing to read yet. */
+   ASSERT_CMPSSIZE_T (_mongoc_poller_wait (poller, events, 2, 0), ==, (ssize_t) 0);
+
+   ASSERT_CMPSSIZE_T (mongoc_stream_write (streams->server, "x", 1, TIMEOUT), ==, (ssize_t) 1);
+   ASSERT_CMPSSIZE_T (_mongoc_poller_wait (poller, events, 2, TIMEOUT), ==, (ssize_t) 1);
+   BSON_ASSERT (events[0].ctx == &client_ctx);
+   BSON_ASSERT (events[0].revents & POLLIN);
+
+   /* waits are level-triggered: unread data is reported again. */
+   ASSERT_CMPSSIZE_T (_mongoc_poller_wait (poller, events, 2, TIMEOUT), ==, (ssize_t) 1);
+   BSON_ASSERT (events[0].ctx == &client_ctx);
+
+   _mongoc_poller_modify (poller, client_slot, POLLOUT);
+   server_slot = _mongoc_poller_add (poller, streams->server, POLLIN, &server_ctx);
+   ASSERT_CMPSIZE_T (_mongoc_poller_count (poller), ==, (size_t) 2);
+   ASSERT_CMPSSIZE_T (_mongoc_poller_wait (poller, events, 2, TIMEOUT), ==, (ssize_t) 1);
+   BSON_ASSERT (events[0].ctx == &client_ctx);
+   BSON_ASSERT (events[0].revents & POLLOUT);
+
+   /* a removed stream's slot is reused. */
+   _mongoc_poller_remove (poller, client_slot);
+   ASSERT_CMPSIZE_T (_mongoc_poller_count (poller), ==, (size_t) 1);
+   ASSERT_CMPSSIZE_T (_mongoc_poller_wait (poller, events, 2, 0), ==, (ssize_t) 0);
+   ASSERT_CMPSIZE_T (_mongoc_poller_add (poller, streams->client, POLLIN, &client_ctx), ==, client_slot);
+
+   ASSERT_CMPSSIZE_T (mongoc_stream_write (streams->client, "y", 1, TIMEOUT), ==, (ssize_t) 1);
+   ASSERT_CMPSSIZE_T (_mongoc_poller_wait (poller, events, 2, TIMEOUT), ==, (ssize_t) 2);
+   BSON_ASSERT (events[0].ctx != events[1].ctx);
+
+   /* no more events than requested. */
+   ASSERT_CMPSSIZE_T (_mongoc_poller_wait (poller, events, 1, TIMEOUT), ==, (ssize_t) 1);
+
+   _mongoc_poller_remove (poller, server_slot);
+   _mongoc_poller_remove (poller, client_slot);
+   ASSERT_CMPSIZE_T (_mongoc_poller_count (poller), ==, (size_t) 0);
+}
+
+
+static void
+test_poller (void)
+{
+   mongoc_poller_t *poller = _mongoc_poller_new ();
+   poller_streams_t streams;
+
+   poller_streams_init (&streams);
+
+   _test_poller (poller, &streams);
+#ifdef MONGOC_HAVE_EPOLL
+   BSON_ASSERT (_mongoc_poller_uses_epoll (poller));
+#endif
+
+   _mongoc_poller_destroy (poller);
+   poller_streams_cleanup (&streams);
+}
+
+
+static ssize_t (*gOriginalPoll) (mongoc_stream_poll_t *streams, size_t nstreams, int32_t timeout);
+static int gPollCalls;
+
+static ssize_t
+_counting_poll (mongoc_stream_poll_t *streams, size_t nstreams, int32_t timeout)
+{
+   gPollCalls++;
+   return gOriginalPoll (streams, nstreams, timeout);
+}
+
+
+static void
+test_poller_fallback (void)
+{
+   mongoc_poller_t *poller = _mongoc_poller_new ();
+   poller_streams_t streams;
+
+   poller_streams_init (&streams);
+
+   /* a stream with its own poll () must be waited on through it. */
+   gOriginalPoll = streams.client->poll;
+   gPollCalls = 0;
+   streams.client->poll = _counting_poll;
+   streams.server->poll = _counting_poll;
+
+   _test_poller (poller, &streams);
+   BSON_ASSERT (!_mongoc_poller_uses_epoll (poller));
+   ASSERT_CMPINT (gPollCalls, >, 0);
+
+   _mongoc_poller_destroy (poller);
+   poller_streams_cleanup (&streams);
+}
+
 void
 test_async_install (TestSuite *suite)
 {
@@ -384,4 +525,6 @@ test_async_install (TestSuite *suite)
                       test_framework_skip_if_windows);
 #endif
    TestSuite_AddMockServerTest (suite, "/Async/delay", test_hello_delay);
+   TestSuite_Add (suite, "/Async/poller", test_poller);
+   TestSuite_Add (suite, "/Async/poller/fallback", test_poller_fallback);
 }
@@ -1501,6 +1501,85 @@ _test_resume (const char *opts,
 }
 
 
+static bool
+_next_batch_responder (request_t *request, void *data)
+{
+   int *getmores = (int *) data;
+
+   if (!strcmp (request->command_name, "aggregate")) {
+      reply_to_request_simple (request,
+                               "{'ok': 1, 'cursor': {'id': 123, 'ns': 'db.coll', 'firstBatch': ["
+                               "  {'_id': {'r': 1}}, {'_id': {'r': 2}}, {'_id': {'r': 3}}]}}");
+   } else if (!strcmp (request->command_name, "getMore") && (*getmores)++ == 0) {
+      reply_to_request_simple (request,
+                               "{'ok': 1, 'cursor': {'id': 123, 'ns': 'db.coll', 'nextBatch': ["
+                               "  {'_id': {'r': 4}}, {'_id': {'r': 5}}],"
+                               "  'postBatchResumeToken': {'r': 'pbr'}}}");
+   } else if (!strcmp (request->command_name, "getMore")) {
+      reply_to_request_simple (request,
+                               "{'ok': 1, 'cursor': {'id': 0, 'ns': 'db.coll', 'nextBatch': [],"
+                               "  'postBatchResumeToken': {'r': 'end'}}}");
+   } else {
+      return false;
+   }
+
+   request_destroy (request);
+   return true;
+}
+
+
+/* next_batch returns the rest of the current batch, and the resume token is
+ * that of the last event returned or the batch's postBatchResumeToken. */
+static void
+test_change_stream_next_batch (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *coll;
+   mongoc_change_stream_t *stream;
+   const bson_t *doc;
+   const bson_t *docs;
+   size_t n_docs;
+   bson_error_t error;
+   int getmores = 0;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_autoresponds (server, _next_batch_responder, &getmores, NULL);
+   mock_server_run (server);
+
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   coll = mongoc_client_get_collection (client, "db", "coll");
+   stream = mongoc_collection_watch (coll, tmp_bson ("{}"), NULL);
+
+   ASSERT (mongoc_change_stream_next (stream, &doc));
+   ASSERT_MATCH (mongoc_change_stream_get_resume_token (stream), "{'r': 1}");
+
+   ASSERT (mongoc_change_stream_next_batch (stream, &docs, &n_docs));
+   ASSERT_CMPSIZE_T (n_docs, ==, 2);
+   ASSERT_MATCH (&docs[0], "{'_id': {'r': 2}}");
+   ASSERT_MATCH (&docs[1], "{'_id': {'r': 3}}");
+   ASSERT_MATCH (mongoc_change_stream_get_resume_token (stream), "{'r': 3}");
+   ASSERT_CMPINT (getmores, ==, 0);
+
+   ASSERT (mongoc_change_stream_next_batch (stream, &docs, &n_docs));
+   ASSERT_CMPSIZE_T (n_docs, ==, 2);
+   ASSERT_MATCH (&docs[0], "{'_id': {'r': 4}}");
+   ASSERT_MATCH (&docs[1], "{'_id': {'r': 5}}");
+   ASSERT_MATCH (mongoc_change_stream_get_resume_token (stream), "{'r': 'pbr'}");
+
+   ASSERT (!mongoc_change_stream_next_batch (stream, &docs, &n_docs));
+   ASSERT (!docs);
+   ASSERT_CMPSIZE_T (n_docs, ==, 0);
+   ASSERT_OR_PRINT (!mongoc_change_stream_error_document (stream, &error, NULL), error);
+   ASSERT_MATCH (mongoc_change_stream_get_resume_token (stream), "{'r': 'end'}");
+
+   mongoc_change_stream_destroy (stream);
+   mongoc_collection_destroy (coll);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
 /* test resume behavior before and after the first document is received. */
 static void
 test_resume_cases (void)
@@ -2232,6 +2311,7 @@ test_change_stream_install (TestSuite *suite)
    TestSuite_AddFull (
       suite, "/change_stream/client", test_change_stream_client_watch, NULL, NULL, _skip_if_no_client_watch);
    TestSuite_AddMockServerTest (suite, "/change_stream/resume_with_first_doc", test_resume_cases);
+   TestSuite_AddMockServerTest (suite, "/change_stream/next_batch", test_change_stream_next_batch);
    TestSuite_AddMockServerTest (suite,
                                 "/change_stream/resume_with_first_doc/post_batch_resume_token",
                                 test_resume_cases_with_post_batch_resume_token);
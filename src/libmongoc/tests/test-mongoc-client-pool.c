@@ -2,6 +2,8 @@
 #include "mongoc/mongoc-client-pool-private.h"
 #include <mongoc/mongoc-client-private.h>
 #include "mongoc/mongoc-util-private.h"
+#include "mongoc/mongoc-topology-background-monitoring-private.h"
+#include "mock_server/mock-server.h"
 
 
 #include "TestSuite.h"
@@ -481,6 +483,83 @@ test_client_pool_can_override_sockettimeoutms (void)
    mongoc_uri_destroy (uri);
 }
 
+/* Returns true if every one of the @n idle clients in @pool has a connection
+ * to server 1 from connection pool generation @generation. */
+static bool
+_clients_ready (mongoc_client_pool_t *pool, size_t n, uint32_t generation)
+{
+   mongoc_client_t *clients[8] = {0};
+   size_t n_ready = 0u;
+
+   BSON_ASSERT (n <= sizeof clients / sizeof clients[0]);
+
+   for (size_t i = 0u; i < n; i++) {
+      mongoc_cluster_node_t *node;
+
+      clients[i] = mongoc_client_pool_try_pop (pool);
+      if (!clients[i]) {
+         /* The establisher thread is using it. */
+         continue;
+      }
+
+      node = mongoc_set_get (clients[i]->cluster.nodes, 1);
+      if (node && node->handshake_sd->generation == generation) {
+         n_ready++;
+      }
+   }
+
+   for (size_t i = 0u; i < n; i++) {
+      if (clients[i]) {
+         mongoc_client_pool_push (pool, clients[i]);
+      }
+   }
+
+   return n_ready == n;
+}
+
+static void
+test_client_pool_min_ready_size (void)
+{
+   mock_server_t *server;
+   mongoc_uri_t *uri;
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+   mongoc_topology_t *topology;
+   mc_tpld_modification tdmod;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_run (server);
+   uri = mongoc_uri_copy (mock_server_get_uri (server));
+   mongoc_uri_set_option_as_int32 (uri, MONGOC_URI_MAXPOOLSIZE, 3);
+   /* Idle clients popped by _clients_ready are skipped until the next
+    * heartbeat. */
+   mongoc_uri_set_option_as_int32 (uri, MONGOC_URI_HEARTBEATFREQUENCYMS, 500);
+   pool = test_framework_client_pool_new_from_uri (uri, NULL);
+   topology = _mongoc_client_pool_get_topology (pool);
+   mongoc_client_pool_set_min_ready_size (pool, 2);
+
+   /* Popping a client starts background monitoring. The pool grows to keep two
+    * idle clients connected. */
+   client = mongoc_client_pool_pop (pool);
+   WAIT_UNTIL (mongoc_client_pool_get_size (pool) == 3);
+   WAIT_UNTIL (_clients_ready (pool, 2, 0));
+
+   /* Clear the connection pool. Idle clients reconnect. */
+   tdmod = mc_tpld_modify_begin (topology);
+   _mongoc_topology_description_clear_connection_pool (tdmod.new_td, 1, &kZeroServiceId);
+   _mongoc_topology_background_monitoring_reconcile (topology, tdmod.new_td);
+   mc_tpld_modify_commit (tdmod);
+   WAIT_UNTIL (_clients_ready (pool, 2, 1));
+
+   /* The popped client was not used, so it was never connected. */
+   BSON_ASSERT (!mongoc_set_get (client->cluster.nodes, 1));
+   mongoc_client_pool_push (pool, client);
+
+   mongoc_client_pool_destroy (pool);
+   mongoc_uri_destroy (uri);
+   mock_server_destroy (server);
+}
+
 void
 test_client_pool_install (TestSuite *suite)
 {
@@ -506,4 +585,5 @@ test_client_pool_install (TestSuite *suite)
    TestSuite_AddLive (suite, "/ClientPool/destroy_without_push", test_client_pool_destroy_without_pushing);
    TestSuite_AddLive (suite, "/ClientPool/max_pool_size_exceeded", test_client_pool_max_pool_size_exceeded);
    TestSuite_Add (suite, "/ClientPool/can_override_sockettimeoutms", test_client_pool_can_override_sockettimeoutms);
+   TestSuite_AddMockServerTest (suite, "/ClientPool/min_ready_size", test_client_pool_min_ready_size);
 }
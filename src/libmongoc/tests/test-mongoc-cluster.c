@@ -3,6 +3,7 @@
 
 #include "mongoc/mongoc-client-private.h"
 #include "mongoc/mongoc-client-pool-private.h"
+#include "mongoc/mongoc-compression-private.h"
 #include "mongoc/mongoc-topology-background-monitoring-private.h"
 #include "mongoc/mongoc-uri-private.h"
 
@@ -440,7 +441,7 @@ test_cluster_time_cmd_started_cb (const mongoc_apm_command_started_t *event)
          bson_destroy (&client_cluster_time);
       }
    } else {
-      BSON_ASSERT (!bson_has_field (event->command, "$clusterTime"));
+      BSON_ASSERT (!bson_has_field (cmd, "$clusterTime"));
    }
 }
 
@@ -1396,6 +1397,179 @@ test_cluster_command_error (void)
    mongoc_client_destroy (client);
 }
 
+static void
+_ping_with_reply (mock_server_t *server, mongoc_client_t *client, const bson_t *reply)
+{
+   bson_error_t error;
+   future_t *future;
+   request_t *request;
+
+   future = future_client_command_simple (client, "db", tmp_bson ("{'ping': 1}"), NULL, NULL, &error);
+   request = mock_server_receives_msg (server, MONGOC_QUERY_NONE, tmp_bson ("{'$db': 'db', 'ping': 1}"));
+   reply_to_op_msg_request (request, MONGOC_MSG_NONE, reply);
+   ASSERT_OR_PRINT (future_get_bool (future), error);
+   future_destroy (future);
+   request_destroy (request);
+}
+
+static bson_t *
+_reply_with_data (size_t data_len)
+{
+   bson_t *reply = bson_new ();
+   char *data = bson_malloc (data_len + 1u);
+
+   memset (data, 'x', data_len);
+   data[data_len] = '\0';
+   BSON_APPEND_INT32 (reply, "ok", 1);
+   BSON_APPEND_UTF8 (reply, "data", data);
+   bson_free (data);
+
+   return reply;
+}
+
+static void
+test_cluster_recv_buffer_reuse (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_buffer_t *recv_buffer;
+   uint8_t *data;
+   bson_t *reply;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_run (server);
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   recv_buffer = &client->cluster.recv_buffer;
+
+   _ping_with_reply (server, client, tmp_bson ("{'ok': 1}"));
+   data = recv_buffer->data;
+   ASSERT_CMPSIZE_T (recv_buffer->datalen, ==, (size_t) 16384);
+
+   /* later replies that fit are read into the same buffer. */
+   _ping_with_reply (server, client, tmp_bson ("{'ok': 1}"));
+   BSON_ASSERT (recv_buffer->data == data);
+   ASSERT_CMPSIZE_T (recv_buffer->datalen, ==, (size_t) 16384);
+
+   /* a larger reply grows the buffer to exactly its length: a 16-byte header,
+    * the flag bits, and a kind 0 section. */
+   reply = _reply_with_data (100000);
+   _ping_with_reply (server, client, reply);
+   ASSERT_CMPSIZE_T (recv_buffer->datalen, ==, (size_t) 21 + reply->len);
+   bson_destroy (reply);
+
+   data = recv_buffer->data;
+   _ping_with_reply (server, client, tmp_bson ("{'ok': 1}"));
+   BSON_ASSERT (recv_buffer->data == data);
+
+   /* a buffer grown for a very large reply is not kept. */
+   reply = _reply_with_data (5 * 1024 * 1024);
+   _ping_with_reply (server, client, reply);
+   ASSERT_CMPSIZE_T (recv_buffer->datalen, ==, (size_t) 16384);
+   bson_destroy (reply);
+
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+static void
+test_cluster_send_rpc_reuse (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_cluster_t *cluster;
+   mcd_rpc_message *send_rpc;
+   mcd_rpc_message *recv_rpc;
+   void *send_iovecs;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_run (server);
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   cluster = &client->cluster;
+
+   _ping_with_reply (server, client, tmp_bson ("{'ok': 1}"));
+   send_rpc = cluster->send_rpc;
+   recv_rpc = cluster->recv_rpc;
+   send_iovecs = cluster->send_iovecs;
+   BSON_ASSERT (send_rpc);
+   BSON_ASSERT (recv_rpc);
+   BSON_ASSERT (send_iovecs);
+
+   /* a recycled request keeps its OP_MSG sections. */
+   ASSERT_CMPINT32 (mcd_rpc_header_get_op_code (send_rpc), ==, MONGOC_OP_CODE_MSG);
+
+   /* later commands are sent and received with the same objects. */
+   _ping_with_reply (server, client, tmp_bson ("{'ok': 1}"));
+   BSON_ASSERT (cluster->send_rpc == send_rpc);
+   BSON_ASSERT (cluster->recv_rpc == recv_rpc);
+   BSON_ASSERT (cluster->send_iovecs == send_iovecs);
+
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+#ifdef MONGOC_ENABLE_COMPRESSION_ZLIB
+static void
+_compress_msg (mcd_rpc_message *rpc, const bson_t *doc, void **compressed_data)
+{
+   bson_error_t error;
+   size_t compressed_data_len;
+   int32_t message_length = 0;
+
+   mcd_rpc_message_reset (rpc);
+   message_length += mcd_rpc_header_set_message_length (rpc, 0);
+   message_length += mcd_rpc_header_set_request_id (rpc, 1);
+   message_length += mcd_rpc_header_set_response_to (rpc, 0);
+   message_length += mcd_rpc_header_set_op_code (rpc, MONGOC_OP_CODE_MSG);
+   mcd_rpc_op_msg_set_sections_count (rpc, 1u);
+   message_length += mcd_rpc_op_msg_set_flag_bits (rpc, MONGOC_OP_MSG_FLAG_NONE);
+   message_length += mcd_rpc_op_msg_section_set_kind (rpc, 0u, 0);
+   message_length += mcd_rpc_op_msg_section_set_body (rpc, 0u, bson_get_data (doc));
+   mcd_rpc_message_set_length (rpc, message_length);
+
+   ASSERT_OR_PRINT (
+      mcd_rpc_message_compress (rpc, MONGOC_COMPRESSOR_ZLIB_ID, -1, compressed_data, &compressed_data_len, &error),
+      error);
+   ASSERT_CMPINT32 (mcd_rpc_header_get_op_code (rpc), ==, MONGOC_OP_CODE_COMPRESSED);
+}
+
+static void
+test_cluster_decompress_to_buffer (void)
+{
+   mcd_rpc_message *rpc = mcd_rpc_message_new ();
+   bson_t *doc = _reply_with_data (10000);
+   mongoc_buffer_t buffer;
+   void *compressed_data;
+   uint8_t *data;
+   bson_t body;
+
+   _mongoc_buffer_init (&buffer, NULL, 0, NULL, NULL);
+
+   _compress_msg (rpc, doc, &compressed_data);
+   BSON_ASSERT (mcd_rpc_message_decompress_to_buffer (rpc, &buffer));
+   bson_free (compressed_data);
+   ASSERT_CMPINT32 (mcd_rpc_header_get_op_code (rpc), ==, MONGOC_OP_CODE_MSG);
+   ASSERT_CMPSIZE_T (buffer.len, ==, (size_t) mcd_rpc_header_get_message_length (rpc));
+   ASSERT_CMPSIZE_T (buffer.datalen, ==, buffer.len);
+   BSON_ASSERT (mcd_rpc_message_get_body (rpc, &body));
+   BSON_ASSERT (bson_equal (doc, &body));
+   bson_destroy (&body);
+
+   /* the buffer is reused for the next message. */
+   data = buffer.data;
+   _compress_msg (rpc, doc, &compressed_data);
+   BSON_ASSERT (mcd_rpc_message_decompress_to_buffer (rpc, &buffer));
+   bson_free (compressed_data);
+   BSON_ASSERT (buffer.data == data);
+   BSON_ASSERT (mcd_rpc_message_get_body (rpc, &body));
+   BSON_ASSERT (bson_equal (doc, &body));
+   bson_destroy (&body);
+
+   _mongoc_buffer_destroy (&buffer);
+   bson_destroy (doc);
+   mcd_rpc_message_destroy (rpc);
+}
+#endif
+
 static void
 test_advanced_cluster_time_not_sent_to_standalone (void)
 {
@@ -1813,6 +1987,11 @@ test_cluster_install (TestSuite *suite)
    TestSuite_AddMockServerTest (suite, "/Cluster/hello_fails", test_cluster_hello_fails);
    TestSuite_AddMockServerTest (suite, "/Cluster/hello_hangup", test_cluster_hello_hangup);
    TestSuite_AddMockServerTest (suite, "/Cluster/command_error/op_msg", test_cluster_command_error);
+   TestSuite_AddMockServerTest (suite, "/Cluster/recv_buffer/reuse", test_cluster_recv_buffer_reuse);
+   TestSuite_AddMockServerTest (suite, "/Cluster/send_rpc/reuse", test_cluster_send_rpc_reuse);
+#ifdef MONGOC_ENABLE_COMPRESSION_ZLIB
+   TestSuite_Add (suite, "/Cluster/decompress_to_buffer", test_cluster_decompress_to_buffer);
+#endif
    TestSuite_AddMockServerTest (suite, "/Cluster/hello_on_unknown/mock", test_hello_on_unknown);
    /* These tests exhibit some mysterious behavior after the new feature
    changes-- see: "https://jira.mongodb.org/browse/CDRIVER-4293".
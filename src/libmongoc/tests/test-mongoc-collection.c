@@ -5632,6 +5632,414 @@ test_create_indexes_with_opts_commitQuorum_post44 (void *unused)
 
 #undef ASSERT_INDEX_EXISTS
 
+typedef struct {
+   bson_mutex_t mutex;
+   int32_t partition_docs[3];
+   int32_t total_docs;
+   bson_t ids;
+} parallel_scan_test_t;
+
+typedef struct {
+   const char *ids;     /* JSON array of the _id of each document, in _id order */
+   const char *buckets; /* JSON array of the $bucketAuto results */
+} parallel_scan_collection_t;
+
+
+/* the BSON comparison order of the _id types in these tests. */
+static int
+_parallel_scan_type_order (bson_type_t type)
+{
+   if (type == BSON_TYPE_NULL) {
+      return 0;
+   }
+   if (type == BSON_TYPE_INT32) {
+      return 1;
+   }
+   if (type == BSON_TYPE_UTF8) {
+      return 2;
+   }
+   if (type == BSON_TYPE_OID) {
+      return 3;
+   }
+
+   test_error ("unexpected _id type: %s", _mongoc_bson_type_to_str (type));
+}
+
+
+/* compares @a and @b like the aggregation comparison operators do. */
+static int
+_parallel_scan_compare (const bson_value_t *a, const bson_value_t *b)
+{
+   const int a_order = _parallel_scan_type_order (a->value_type);
+   const int b_order = _parallel_scan_type_order (b->value_type);
+
+   if (a_order != b_order) {
+      return a_order < b_order ? -1 : 1;
+   }
+
+   if (a->value_type == BSON_TYPE_INT32) {
+      return a->value.v_int32 == b->value.v_int32 ? 0 : (a->value.v_int32 < b->value.v_int32 ? -1 : 1);
+   }
+   if (a->value_type == BSON_TYPE_UTF8) {
+      return strcmp (a->value.v_utf8.str, b->value.v_utf8.str);
+   }
+   if (a->value_type == BSON_TYPE_OID) {
+      return bson_oid_compare (&a->value.v_oid, &b->value.v_oid);
+   }
+
+   /* null */
+   return 0;
+}
+
+
+/* true if @id matches the {$expr: {$and: [...]}} range of a partition. */
+static bool
+_parallel_scan_in_range (const bson_value_t *id, bson_iter_t *expr)
+{
+   bson_iter_t and;
+   bson_iter_t cmp;
+   bson_iter_t bound;
+
+   ASSERT (bson_iter_find_descendant (expr, "$and", &and) && bson_iter_recurse (&and, &and));
+
+   while (bson_iter_next (&and)) {
+      ASSERT (bson_iter_recurse (&and, &cmp) && bson_iter_next (&cmp));
+      ASSERT (bson_iter_recurse (&cmp, &bound) && bson_iter_next (&bound));
+      ASSERT_CMPSTR (bson_iter_utf8 (&bound, NULL), "$_id");
+      ASSERT (bson_iter_next (&bound) && bson_iter_recurse (&bound, &bound));
+      ASSERT (bson_iter_find (&bound, "$literal"));
+
+      if (!strcmp (bson_iter_key (&cmp), "$gte")) {
+         if (_parallel_scan_compare (id, bson_iter_value (&bound)) < 0) {
+            return false;
+         }
+      } else {
+         ASSERT_CMPSTR (bson_iter_key (&cmp), "$lt");
+         if (_parallel_scan_compare (id, bson_iter_value (&bound)) >= 0) {
+            return false;
+         }
+      }
+   }
+
+   return true;
+}
+
+
+static bool
+_parallel_scan_responder (request_t *request, void *data)
+{
+   const parallel_scan_collection_t *coll = (const parallel_scan_collection_t *) data;
+   const bson_t *cmd = request_get_doc (request, 0);
+   bson_iter_t iter;
+   bson_iter_t expr;
+   bool has_range;
+   bson_string_t *batch;
+   bool first = true;
+
+   if (!strcmp (request->command_name, "aggregate")) {
+      ASSERT (match_bson (cmd,
+                          tmp_bson ("{'pipeline': [{'$match': {'x': 1}},"
+                                    "              {'$sample': {'size': {'$numberLong': '300'}}},"
+                                    "              {'$bucketAuto': {'groupBy': '$_id', 'buckets': 3}}]}"),
+                          false));
+      reply_to_request_simple (
+         request, tmp_str ("{'ok': 1, 'cursor': {'id': 0, 'ns': 'db.coll', 'firstBatch': %s}}", coll->buckets));
+      request_destroy (request);
+      return true;
+   }
+
+   if (strcmp (request->command_name, "find")) {
+      return false;
+   }
+
+   /* the partitions option is not sent, other options are. */
+   ASSERT (match_bson (cmd, tmp_bson ("{'partitions': {'$exists': false}, 'projection': {'_id': 1}}"), false));
+
+   /* {$and: [{x: 1}, {$expr: {$and: [{$gte: ["$_id", {$literal: lower}]},
+    *                                  {$lt: ["$_id", {$literal: upper}]}]}}]},
+    * either bound optional. */
+   ASSERT (bson_iter_init (&iter, cmd) && bson_iter_find_descendant (&iter, "filter.$and.0.x", &iter));
+   has_range = bson_iter_init (&expr, cmd) && bson_iter_find_descendant (&expr, "filter.$and.1.$expr", &expr) &&
+               bson_iter_recurse (&expr, &expr);
+
+   batch = bson_string_new (NULL);
+   ASSERT (bson_iter_init (&iter, tmp_bson ("{'ids': %s}", coll->ids)) && bson_iter_find (&iter, "ids") &&
+           bson_iter_recurse (&iter, &iter));
+   while (bson_iter_next (&iter)) {
+      bson_iter_t range = expr;
+      bson_t doc = BSON_INITIALIZER;
+      char *json;
+
+      if (has_range && !_parallel_scan_in_range (bson_iter_value (&iter), &range)) {
+         bson_destroy (&doc);
+         continue;
+      }
+
+      BSON_APPEND_VALUE (&doc, "_id", bson_iter_value (&iter));
+      json = bson_as_canonical_extended_json (&doc, NULL);
+      bson_string_append_printf (batch, "%s%s", first ? "" : ", ", json);
+      first = false;
+      bson_free (json);
+      bson_destroy (&doc);
+   }
+
+   reply_to_request_simple (
+      request, tmp_str ("{'ok': 1, 'cursor': {'id': 0, 'ns': 'db.coll', 'firstBatch': [%s]}}", batch->str));
+   request_destroy (request);
+   bson_string_free (batch, true);
+   return true;
+}
+
+
+static void
+_parallel_scan_record (parallel_scan_test_t *test, uint32_t partition, const bson_t *doc)
+{
+   bson_iter_t iter;
+   char key[16];
+
+   ASSERT_CMPUINT32 (partition, <, 3u);
+   ASSERT (bson_iter_init_find (&iter, doc, "_id"));
+
+   bson_mutex_lock (&test->mutex);
+   bson_snprintf (key, sizeof key, "%" PRId32, test->total_docs);
+   BSON_APPEND_VALUE (&test->ids, key, bson_iter_value (&iter));
+   test->partition_docs[partition]++;
+   test->total_docs++;
+   bson_mutex_unlock (&test->mutex);
+}
+
+
+static bool
+_parallel_scan_cb (uint32_t partition, const bson_t *doc, void *ctx)
+{
+   parallel_scan_test_t *test = (parallel_scan_test_t *) ctx;
+   const int32_t id = bson_lookup_int32 (doc, "_id");
+
+   /* partition 0 is _id < 4, partition 1 is 4 <= _id < 7, partition 2 is 7 <= _id. */
+   ASSERT_CMPINT32 ((id - 1) / 3, ==, (int32_t) partition);
+   _parallel_scan_record (test, partition, doc);
+
+   return true;
+}
+
+
+static bool
+_parallel_scan_any_cb (uint32_t partition, const bson_t *doc, void *ctx)
+{
+   _parallel_scan_record ((parallel_scan_test_t *) ctx, partition, doc);
+
+   return true;
+}
+
+
+static void
+test_parallel_scan (void)
+{
+   const parallel_scan_collection_t coll = {"[1, 2, 3, 4, 5, 6, 7, 8, 9]",
+                                            "[{'_id': {'min': 1, 'max': 3}, 'count': 3},"
+                                            " {'_id': {'min': 4, 'max': 6}, 'count': 3},"
+                                            " {'_id': {'min': 7, 'max': 9}, 'count': 3}]"};
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   parallel_scan_test_t test = {0};
+   bson_error_t error;
+   bool r;
+
+   bson_mutex_init (&test.mutex);
+   bson_init (&test.ids);
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_autoresponds (server, _parallel_scan_responder, (void *) &coll, NULL);
+   mock_server_run (server);
+
+   pool = test_framework_client_pool_new_from_uri (mock_server_get_uri (server), NULL);
+   client = mongoc_client_pool_pop (pool);
+   collection = mongoc_client_get_collection (client, "db", "coll");
+
+   r = mongoc_collection_parallel_scan (collection,
+                                        pool,
+                                        tmp_bson ("{'x': 1}"),
+                                        tmp_bson ("{'partitions': 3, 'projection': {'_id': 1}}"),
+                                        _parallel_scan_cb,
+                                        &test,
+                                        &error);
+   ASSERT_OR_PRINT (r, error);
+   ASSERT_CMPINT32 (test.partition_docs[0], ==, 3);
+   ASSERT_CMPINT32 (test.partition_docs[1], ==, 3);
+   ASSERT_CMPINT32 (test.partition_docs[2], ==, 3);
+   ASSERT_CMPINT32 (test.total_docs, ==, 9);
+
+   /* sessions are bound to a single client. */
+   r = mongoc_collection_parallel_scan (
+      collection, pool, NULL, tmp_bson ("{'sessionId': 1}"), _parallel_scan_cb, &test, &error);
+   ASSERT (!r);
+   ASSERT_ERROR_CONTAINS (
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Cannot use a session with");
+
+   mongoc_collection_destroy (collection);
+   mongoc_client_pool_push (pool, client);
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+   bson_destroy (&test.ids);
+   bson_mutex_destroy (&test.mutex);
+}
+
+
+/* the split points have different BSON types from each other and from other
+ * _id values. The partitions together still return every document once. */
+static void
+test_parallel_scan_mixed_id_types (void)
+{
+   const parallel_scan_collection_t coll = {
+      "[null, 1, 2, 3, 'a', 'b', 'c',"
+      " {'$oid': '000000000000000000000001'},"
+      " {'$oid': '000000000000000000000002'},"
+      " {'$oid': '000000000000000000000003'}]",
+      "[{'_id': {'min': null, 'max': 3}, 'count': 4},"
+      " {'_id': {'min': 3, 'max': 'b'}, 'count': 2},"
+      " {'_id': {'min': 'b', 'max': {'$oid': '000000000000000000000003'}}, 'count': 4}]"};
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   parallel_scan_test_t test = {0};
+   bson_error_t error;
+   bool r;
+
+   bson_mutex_init (&test.mutex);
+   bson_init (&test.ids);
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_autoresponds (server, _parallel_scan_responder, (void *) &coll, NULL);
+   mock_server_run (server);
+
+   pool = test_framework_client_pool_new_from_uri (mock_server_get_uri (server), NULL);
+   client = mongoc_client_pool_pop (pool);
+   collection = mongoc_client_get_collection (client, "db", "coll");
+
+   r = mongoc_collection_parallel_scan (collection,
+                                        pool,
+                                        tmp_bson ("{'x': 1}"),
+                                        tmp_bson ("{'partitions': 3, 'projection': {'_id': 1}}"),
+                                        _parallel_scan_any_cb,
+                                        &test,
+                                        &error);
+   ASSERT_OR_PRINT (r, error);
+
+   /* null, 1 and 2; then 3 and 'a'; then 'b', 'c' and every ObjectId. */
+   ASSERT_CMPINT32 (test.partition_docs[0], ==, 3);
+   ASSERT_CMPINT32 (test.partition_docs[1], ==, 2);
+   ASSERT_CMPINT32 (test.partition_docs[2], ==, 5);
+
+   /* the union of the partitions is the full scan. */
+   ASSERT_CMPINT32 (test.total_docs, ==, 10);
+   {
+      bson_iter_t expected;
+      bson_iter_t iter;
+      int32_t n = 0;
+
+      ASSERT (bson_iter_init (&expected, tmp_bson ("{'ids': %s}", coll.ids)) && bson_iter_find (&expected, "ids") &&
+              bson_iter_recurse (&expected, &expected));
+      while (bson_iter_next (&expected)) {
+         int32_t found = 0;
+
+         ASSERT (bson_iter_init (&iter, &test.ids));
+         while (bson_iter_next (&iter)) {
+            if (_parallel_scan_compare (bson_iter_value (&iter), bson_iter_value (&expected)) == 0) {
+               found++;
+            }
+         }
+
+         ASSERT_CMPINT32 (found, ==, 1);
+         n++;
+      }
+      ASSERT_CMPINT32 (n, ==, 10);
+   }
+
+   mongoc_collection_destroy (collection);
+   mongoc_client_pool_push (pool, client);
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+   bson_destroy (&test.ids);
+   bson_mutex_destroy (&test.mutex);
+}
+
+
+static void
+test_parallel_scan_mixed_id_types_live (void)
+{
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   parallel_scan_test_t test = {0};
+   const bson_t *doc;
+   bson_error_t error;
+   int32_t n_docs = 0;
+   bool r;
+
+   bson_mutex_init (&test.mutex);
+   bson_init (&test.ids);
+
+   pool = test_framework_new_default_client_pool ();
+   client = mongoc_client_pool_pop (pool);
+   collection = get_test_collection (client, "test_parallel_scan_mixed_id_types");
+
+   for (int32_t i = 0; i < 100; i++) {
+      bson_oid_t oid;
+      char oid_str[25];
+
+      bson_oid_init (&oid, NULL);
+      bson_oid_to_string (&oid, oid_str);
+      r = mongoc_collection_insert_one (collection, tmp_bson ("{'_id': %d, 'x': 1}", i), NULL, NULL, &error);
+      ASSERT_OR_PRINT (r, error);
+      r = mongoc_collection_insert_one (collection, tmp_bson ("{'_id': 'str%d', 'x': 1}", i), NULL, NULL, &error);
+      ASSERT_OR_PRINT (r, error);
+      r = mongoc_collection_insert_one (
+         collection, tmp_bson ("{'_id': {'$oid': '%s'}, 'x': 1}", oid_str), NULL, NULL, &error);
+      ASSERT_OR_PRINT (r, error);
+   }
+   r = mongoc_collection_insert_one (collection, tmp_bson ("{'_id': null, 'x': 1}"), NULL, NULL, &error);
+   ASSERT_OR_PRINT (r, error);
+
+   r = mongoc_collection_parallel_scan (
+      collection, pool, tmp_bson ("{'x': 1}"), tmp_bson ("{'partitions': 3}"), _parallel_scan_any_cb, &test, &error);
+   ASSERT_OR_PRINT (r, error);
+
+   /* the union of the partitions is the full scan, with no duplicates. */
+   cursor = mongoc_collection_find_with_opts (collection, tmp_bson ("{'x': 1}"), NULL, NULL);
+   while (mongoc_cursor_next (cursor, &doc)) {
+      bson_iter_t expected;
+      bson_iter_t iter;
+      int32_t found = 0;
+
+      ASSERT (bson_iter_init_find (&expected, doc, "_id"));
+      ASSERT (bson_iter_init (&iter, &test.ids));
+      while (bson_iter_next (&iter)) {
+         if (_parallel_scan_compare (bson_iter_value (&iter), bson_iter_value (&expected)) == 0) {
+            found++;
+         }
+      }
+
+      ASSERT_CMPINT32 (found, ==, 1);
+      n_docs++;
+   }
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+   ASSERT_CMPINT32 (n_docs, ==, 301);
+   ASSERT_CMPINT32 (test.total_docs, ==, n_docs);
+
+   mongoc_cursor_destroy (cursor);
+   ASSERT_OR_PRINT (mongoc_collection_drop (collection, &error), error);
+   mongoc_collection_destroy (collection);
+   mongoc_client_pool_push (pool, client);
+   mongoc_client_pool_destroy (pool);
+   bson_destroy (&test.ids);
+   bson_mutex_destroy (&test.mutex);
+}
+
+
 void
 test_collection_install (TestSuite *suite)
 {
@@ -5755,6 +6163,9 @@ test_collection_install (TestSuite *suite)
    TestSuite_AddLive (suite, "/Collection/estimated_document_count_live", test_estimated_document_count_live);
    TestSuite_AddLive (suite, "/Collection/insert_bulk_validate", test_insert_bulk_validate);
    TestSuite_AddMockServerTest (suite, "/Collection/aggregate_with_batch_size", test_aggregate_with_batch_size);
+   TestSuite_AddMockServerTest (suite, "/Collection/parallel_scan", test_parallel_scan);
+   TestSuite_AddMockServerTest (suite, "/Collection/parallel_scan/mixed_id_types", test_parallel_scan_mixed_id_types);
+   TestSuite_AddLive (suite, "/Collection/parallel_scan/mixed_id_types/live", test_parallel_scan_mixed_id_types_live);
    TestSuite_AddFull (suite,
                       "/Collection/fam/no_error_on_retry",
                       test_fam_no_error_on_retry,
@@ -1,4 +1,5 @@
 #include <mongoc/mongoc.h>
+#include <mongoc/mongoc-apm-private.h>
 #include <mongoc/mongoc-bulk-operation-private.h>
 #include <mongoc/mongoc-collection-private.h>
 
@@ -1283,6 +1284,119 @@ test_service_id_not_loadbalanced (void)
 }
 
 
+typedef struct {
+   int started_calls;
+   int succeeded_calls;
+   bool materialized_early;
+   size_t command_size;
+   size_t reply_size;
+   bson_t command;
+   bson_t reply;
+} lazy_events_test_t;
+
+
+static void
+lazy_events_started_cb (const mongoc_apm_command_started_t *event)
+{
+   lazy_events_test_t *test = (lazy_events_test_t *) mongoc_apm_command_started_get_context (event);
+
+   test->started_calls++;
+   /* a callback that has not asked for the command has not paid for it. */
+   test->materialized_early |= event->command != NULL;
+   test->command_size = mongoc_apm_command_started_get_command_size (event);
+   test->materialized_early |= event->command != NULL;
+
+   bson_destroy (&test->command);
+   bson_copy_to (mongoc_apm_command_started_get_command (event), &test->command);
+}
+
+
+static void
+lazy_events_succeeded_cb (const mongoc_apm_command_succeeded_t *event)
+{
+   lazy_events_test_t *test = (lazy_events_test_t *) mongoc_apm_command_succeeded_get_context (event);
+
+   test->succeeded_calls++;
+   test->materialized_early |= event->reply != NULL;
+   test->reply_size = mongoc_apm_command_succeeded_get_reply_size (event);
+   test->materialized_early |= event->reply != NULL;
+
+   bson_destroy (&test->reply);
+   bson_copy_to (mongoc_apm_command_succeeded_get_reply (event), &test->reply);
+}
+
+
+/* command and reply documents are only built when a callback asks for them,
+ * and their sizes are available without building them. */
+static void
+test_lazy_events (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_apm_callbacks_t *callbacks;
+   mongoc_collection_t *collection;
+   lazy_events_test_t test = {0};
+   bson_t *docs[3];
+   bson_t body = BSON_INITIALIZER;
+   size_t docs_size = 0;
+   bson_error_t error;
+   future_t *future;
+   request_t *request;
+   const char *reply = "{'ok': 1, 'n': 3}";
+   int i;
+
+   bson_init (&test.command);
+   bson_init (&test.reply);
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MIN);
+   mock_server_run (server);
+
+   callbacks = mongoc_apm_callbacks_new ();
+   mongoc_apm_set_command_started_cb (callbacks, lazy_events_started_cb);
+   mongoc_apm_set_command_succeeded_cb (callbacks, lazy_events_succeeded_cb);
+
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   ASSERT (mongoc_client_set_apm_callbacks (client, callbacks, (void *) &test));
+   collection = mongoc_client_get_collection (client, "db", "collection");
+
+   for (i = 0; i < 3; i++) {
+      docs[i] = BCON_NEW ("_id", BCON_INT32 (i), "x", BCON_UTF8 ("abc"));
+      docs_size += docs[i]->len;
+   }
+
+   future = future_collection_insert_many (collection, (const bson_t **) docs, 3, NULL, NULL, &error);
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'insert': 'collection'}"), docs[0], docs[1], docs[2]);
+   reply_to_request_simple (request, reply);
+   ASSERT_OR_PRINT (future_get_bool (future), error);
+
+   ASSERT_CMPINT (test.started_calls, ==, 1);
+   ASSERT_CMPINT (test.succeeded_calls, ==, 1);
+   ASSERT (!test.materialized_early);
+
+   /* the document sequence is still appended as "documents" when asked for. */
+   ASSERT_MATCH (&test.command, "{'insert': 'collection', 'documents': [{'_id': 0}, {'_id': 1}, {'_id': 2}]}");
+   bson_copy_to_excluding_noinit (&test.command, &body, "documents", NULL);
+   ASSERT_CMPSIZE_T (test.command_size, ==, body.len + docs_size);
+
+   ASSERT_MATCH (&test.reply, reply);
+   ASSERT_CMPSIZE_T (test.reply_size, ==, tmp_bson (reply)->len);
+
+   future_destroy (future);
+   request_destroy (request);
+   for (i = 0; i < 3; i++) {
+      bson_destroy (docs[i]);
+   }
+   bson_destroy (&body);
+   bson_destroy (&test.command);
+   bson_destroy (&test.reply);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mongoc_apm_callbacks_destroy (callbacks);
+   mock_server_destroy (server);
+}
+
+
 void
 test_command_monitoring_install (TestSuite *suite)
 {
@@ -1316,4 +1430,5 @@ test_command_monitoring_install (TestSuite *suite)
    TestSuite_AddMockServerTest (suite, "/command_monitoring/service_id/loadbalanced", test_service_id_loadbalanced);
    TestSuite_AddMockServerTest (
       suite, "/command_monitoring/service_id/not_loadbalanced", test_service_id_not_loadbalanced);
+   TestSuite_AddMockServerTest (suite, "/command_monitoring/lazy_events", test_lazy_events);
 }
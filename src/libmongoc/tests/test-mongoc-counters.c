@@ -15,6 +15,7 @@
  */
 
 #include <mongoc/mongoc-util-private.h>
+#include "mongoc/mongoc-addrinfo-cache-private.h"
 #include "mongoc/mongoc-counters-private.h"
 #include "mock_server/mock-server.h"
 #include "test-conveniences.h"
@@ -22,6 +23,8 @@
 #include "TestSuite.h"
 #include "mock_server/future-functions.h"
 
+#include "common-thread-private.h"
+
 /* test statistics counters excluding OP_INSERT, OP_UPDATE, and OP_DELETE since
  * those were superseded by write commands in 2.6. */
 #ifdef MONGOC_ENABLE_SHM_COUNTERS
@@ -411,6 +414,8 @@ test_counters_dns (void)
    mongoc_client_t *client;
    mongoc_server_description_t *sd;
    bson_error_t err;
+   /* count lookups, not addresses reused from an earlier connection. */
+   _mongoc_addrinfo_cache_clear ();
    reset_all_counters ();
    client = test_framework_new_default_client ();
    sd = mongoc_client_select_server (client, false, NULL, &err);
@@ -1228,6 +1233,149 @@ test_counters_rpc_op_egress_mock_server_op_msg (void)
 }
 
 
+static void
+test_counters_histogram_buckets (void)
+{
+   int64_t value;
+   uint32_t bucket;
+   uint32_t prev_bucket = 0;
+
+   for (bucket = 0; bucket < MONGOC_HISTOGRAM_BUCKETS; bucket++) {
+      ASSERT_CMPUINT32 (_mongoc_histogram_bucket (_mongoc_histogram_bucket_max (bucket)), ==, bucket);
+   }
+
+   ASSERT_CMPUINT32 (_mongoc_histogram_bucket (-1), ==, 0u);
+   ASSERT_CMPUINT32 (_mongoc_histogram_bucket (INT64_MAX), ==, MONGOC_HISTOGRAM_BUCKETS - 1u);
+
+   /* buckets are monotonic and each is within 1/8 of the values it holds. */
+   for (value = 0; value < 1000000; value += 1 + value / 64) {
+      bucket = _mongoc_histogram_bucket (value);
+      ASSERT_CMPUINT32 (bucket, >=, prev_bucket);
+      ASSERT_CMPINT64 (value, <=, _mongoc_histogram_bucket_max (bucket));
+      ASSERT_CMPINT64 (_mongoc_histogram_bucket_max (bucket) - value, <=, value / MONGOC_HISTOGRAM_SUB_BUCKETS);
+      prev_bucket = bucket;
+   }
+}
+
+
+static void
+test_counters_histogram_command (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   future_t *future;
+   request_t *request;
+   int64_t other;
+   int64_t find;
+   int64_t send;
+   int64_t recv;
+   int64_t selection;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_run (server);
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+
+   other = mongoc_histogram_command_other_count ();
+   find = mongoc_histogram_command_find_count ();
+   send = mongoc_histogram_op_msg_send_count ();
+   recv = mongoc_histogram_op_msg_recv_count ();
+   selection = mongoc_histogram_server_selection_count ();
+
+   future = future_client_command_simple (client, "admin", tmp_bson ("{'ping': 1}"), NULL, NULL, NULL);
+   request = mock_server_receives_msg (server, MONGOC_MSG_NONE, tmp_bson ("{'ping': 1}"));
+   reply_to_request_with_ok_and_destroy (request);
+   ASSERT (future_get_bool (future));
+   future_destroy (future);
+
+   ASSERT_CMPINT64 (mongoc_histogram_command_other_count () - other, ==, 1);
+   ASSERT_CMPINT64 (mongoc_histogram_command_find_count () - find, ==, 0);
+   ASSERT_CMPINT64 (mongoc_histogram_op_msg_send_count () - send, ==, 1);
+   ASSERT_CMPINT64 (mongoc_histogram_op_msg_recv_count () - recv, ==, 1);
+   ASSERT_CMPINT64 (mongoc_histogram_server_selection_count () - selection, >=, 1);
+
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+static BSON_THREAD_FUN (counters_thread_run, ctx)
+{
+   int64_t iterations = *(int64_t *) ctx;
+   int64_t i;
+
+   for (i = 0; i < iterations; i++) {
+      mongoc_counter_auth_failure_inc ();
+   }
+
+   BSON_THREAD_RETURN;
+}
+
+
+/* runs @n_threads threads that each increment a counter @iterations times.
+ * Returns the CPU time per increment in nanoseconds, taking the wall time
+ * as spent on every CPU the threads could use. */
+static double
+_run_counters_threads (size_t n_threads, int64_t iterations)
+{
+   bson_thread_t *threads = bson_malloc0 (n_threads * sizeof (bson_thread_t));
+   int32_t before = mongoc_counter_auth_failure_count ();
+   int64_t start = bson_get_monotonic_time ();
+   int64_t elapsed;
+   size_t i;
+
+   for (i = 0; i < n_threads; i++) {
+      ASSERT_CMPINT (0, ==, mcommon_thread_create (&threads[i], counters_thread_run, &iterations));
+   }
+
+   for (i = 0; i < n_threads; i++) {
+      ASSERT_CMPINT (0, ==, mcommon_thread_join (threads[i]));
+   }
+
+   elapsed = bson_get_monotonic_time () - start;
+
+   ASSERT_CMPINT64 ((int64_t) (mongoc_counter_auth_failure_count () - before), ==, (int64_t) n_threads * iterations);
+
+   bson_free (threads);
+
+   return (double) elapsed * 1000.0 * (double) BSON_MIN (n_threads, _mongoc_get_cpu_count ()) /
+          ((double) n_threads * (double) iterations);
+}
+
+
+static void
+test_counters_threads (void)
+{
+   /* the second and third rounds run in columns left by the first. */
+   _run_counters_threads (16, 10000);
+   _run_counters_threads (16, 10000);
+   _run_counters_threads (4, 10000);
+
+   /* more threads than thread-local columns, any that find none free use the
+    * per-CPU slots. */
+   _run_counters_threads (200, 1000);
+}
+
+
+/* times counter increments from 1 and from 64 threads. Run with -d to print
+ * the results. */
+static void
+test_counters_threads_benchmark (void *ctx)
+{
+   double one;
+   double many;
+
+   BSON_UNUSED (ctx);
+
+   one = _run_counters_threads (1, 10 * 1000 * 1000);
+   many = _run_counters_threads (64, 1000 * 1000);
+
+   if (test_suite_debug_output ()) {
+      printf ("      counters: 1 thread %.2f ns/inc, 64 threads %.2f ns/inc\n", one, many);
+      fflush (stdout);
+   }
+}
+
+
 #if defined(MONGOC_ENABLE_SSL)
 static void
 wait_for_background_threads (rpc_op_egress_counters expected)
@@ -1527,6 +1675,12 @@ test_counters_install (TestSuite *suite)
    TestSuite_AddMockServerTest (
       suite, "/counters/rpc/op_egress/mock_server/op_msg", test_counters_rpc_op_egress_mock_server_op_msg);
 
+   TestSuite_Add (suite, "/counters/histograms/buckets", test_counters_histogram_buckets);
+   TestSuite_AddMockServerTest (suite, "/counters/histograms/command", test_counters_histogram_command);
+   TestSuite_Add (suite, "/counters/threads", test_counters_threads);
+   TestSuite_AddFull (
+      suite, "/counters/threads/benchmark", test_counters_threads_benchmark, NULL, NULL, test_framework_skip_if_slow);
+
 #if defined(MONGOC_ENABLE_SSL)
    TestSuite_AddFull (suite,
                       "/counters/rpc/op_egress/auth/single/op_query",
@@ -2066,6 +2066,413 @@ test_empty_final_batch (void)
 }
 
 
+/* a cursor with "prefetch" sends its next getMore halfway through the batch,
+ * and other operations on the client first receive the getMore reply. */
+static void
+test_cursor_prefetch (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+   request_t *getmore;
+   bson_error_t error;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_run (server);
+
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   collection = mongoc_client_get_collection (client, "db", "coll");
+   cursor = mongoc_collection_find_with_opts (
+      collection, tmp_bson ("{}"), tmp_bson ("{'batchSize': 4, 'prefetch': true}"), NULL);
+
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'$db': 'db', 'find': 'coll', 'prefetch': {'$exists': false}}"));
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '1234'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'firstBatch': [{'a': 1}, {'a': 2}, {'a': 3}, {'a': 4}]}}"));
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 1}");
+   future_destroy (future);
+   request_destroy (request);
+
+   /* reading the second document sends the getMore without waiting. */
+   ASSERT (mongoc_cursor_next (cursor, &doc));
+   ASSERT_MATCH (doc, "{'a': 2}");
+   getmore = mock_server_receives_msg (server,
+                                       MONGOC_MSG_NONE,
+                                       tmp_bson ("{'$db': 'db',"
+                                                 " 'getMore': {'$numberLong': '1234'},"
+                                                 " 'collection': 'coll',"
+                                                 " 'batchSize': {'$numberLong': '4'}}"));
+
+   ASSERT (mongoc_cursor_next (cursor, &doc));
+   ASSERT_MATCH (doc, "{'a': 3}");
+
+   /* another command receives the getMore reply before using the connection. */
+   future = future_client_command_simple (client, "admin", tmp_bson ("{'ping': 1}"), NULL, NULL, &error);
+   reply_to_op_msg_request (getmore,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '0'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'nextBatch': [{'a': 5}]}}"));
+   request = mock_server_receives_msg (server, MONGOC_MSG_NONE, tmp_bson ("{'ping': 1}"));
+   reply_to_request_with_ok_and_destroy (request);
+   ASSERT_OR_PRINT (future_get_bool (future), error);
+   future_destroy (future);
+   request_destroy (getmore);
+
+   ASSERT (mongoc_cursor_next (cursor, &doc));
+   ASSERT_MATCH (doc, "{'a': 4}");
+   ASSERT (mongoc_cursor_next (cursor, &doc));
+   ASSERT_MATCH (doc, "{'a': 5}");
+   ASSERT (!mongoc_cursor_next (cursor, &doc));
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+/* a single-threaded client receives a prefetched getMore reply before server
+ * selection would check the connection with a ping. */
+static void
+test_cursor_prefetch_select_server (void)
+{
+   mock_server_t *server;
+   mongoc_uri_t *uri;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   mongoc_server_description_t *sd;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+   request_t *getmore;
+   bson_error_t error;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_run (server);
+
+   uri = mongoc_uri_copy (mock_server_get_uri (server));
+   mongoc_uri_set_option_as_int32 (uri, "socketCheckIntervalMS", 50);
+   client = test_framework_client_new_from_uri (uri, NULL);
+   collection = mongoc_client_get_collection (client, "db", "coll");
+   cursor = mongoc_collection_find_with_opts (
+      collection, tmp_bson ("{}"), tmp_bson ("{'batchSize': 4, 'prefetch': true}"), NULL);
+
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (server, MONGOC_MSG_NONE, tmp_bson ("{'$db': 'db', 'find': 'coll'}"));
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '1234'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'firstBatch': [{'a': 1}, {'a': 2}, {'a': 3}, {'a': 4}]}}"));
+   ASSERT (future_get_bool (future));
+   future_destroy (future);
+   request_destroy (request);
+
+   ASSERT (mongoc_cursor_next (cursor, &doc));
+   getmore = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'$db': 'db', 'getMore': {'$numberLong': '1234'}}"));
+
+   /* let socketCheckIntervalMS pass, so that selection would ping the server. */
+   _mongoc_usleep (100 * 1000);
+
+   future = future_client_select_server (client, false, NULL, &error);
+   reply_to_op_msg_request (getmore,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '0'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'nextBatch': [{'a': 5}]}}"));
+   /* receiving the reply used the connection, so it needs no ping. */
+   sd = future_get_mongoc_server_description_ptr (future);
+   ASSERT_OR_PRINT (sd, error);
+   mongoc_server_description_destroy (sd);
+   future_destroy (future);
+   request_destroy (getmore);
+
+   for (int i = 3; i <= 5; i++) {
+      ASSERT (mongoc_cursor_next (cursor, &doc));
+      ASSERT_MATCH (doc, tmp_str ("{'a': %d}", i));
+   }
+   ASSERT (!mongoc_cursor_next (cursor, &doc));
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mongoc_uri_destroy (uri);
+   mock_server_destroy (server);
+}
+
+/* with "adaptiveBatchSize", a fast consumer of small documents gets larger
+ * batches, and a slow consumer gets smaller ones. */
+static void
+test_cursor_adaptive_batch_size (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+   bson_error_t error;
+   int64_t batch_size;
+   int i;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_run (server);
+
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   collection = mongoc_client_get_collection (client, "db", "coll");
+   cursor =
+      mongoc_collection_find_with_opts (collection, tmp_bson ("{}"), tmp_bson ("{'adaptiveBatchSize': true}"), NULL);
+
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (server,
+                                       MONGOC_MSG_NONE,
+                                       tmp_bson ("{'$db': 'db',"
+                                                 " 'find': 'coll',"
+                                                 " 'batchSize': {'$exists': false},"
+                                                 " 'adaptiveBatchSize': {'$exists': false}}"));
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '1234'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'firstBatch': [{'a': 1}, {'a': 2}]}}"));
+   ASSERT (future_get_bool (future));
+   future_destroy (future);
+   request_destroy (request);
+   ASSERT (mongoc_cursor_next (cursor, &doc));
+
+   /* the first batch was read right away. */
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'$db': 'db', 'getMore': {'$numberLong': '1234'}}"));
+   batch_size = bson_lookup_int64 (request_get_doc (request, 0), "batchSize");
+   ASSERT_CMPINT64 (batch_size, >, (int64_t) 2);
+   /* the chosen size is not the user's batchSize option. */
+   ASSERT_CMPUINT32 (mongoc_cursor_get_batch_size (cursor), ==, 0u);
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '1234'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'nextBatch': [{'a': 3}, {'a': 4}, {'a': 5}, {'a': 6}, {'a': 7},"
+                                      "                  {'a': 8}, {'a': 9}, {'a': 10}, {'a': 11}, {'a': 12}]}}"));
+   ASSERT (future_get_bool (future));
+   future_destroy (future);
+   request_destroy (request);
+
+   /* the second batch takes over 100ms to read: the next is smaller. */
+   for (i = 0; i < 9; i++) {
+      _mongoc_usleep (20 * 1000);
+      ASSERT (mongoc_cursor_next (cursor, &doc));
+   }
+
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'$db': 'db', 'getMore': {'$numberLong': '1234'}}"));
+   batch_size = bson_lookup_int64 (request_get_doc (request, 0), "batchSize");
+   ASSERT_CMPINT64 (batch_size, >=, (int64_t) 1);
+   ASSERT_CMPINT64 (batch_size, <, (int64_t) 10);
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '0'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'nextBatch': []}}"));
+   ASSERT (!future_get_bool (future));
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+   future_destroy (future);
+   request_destroy (request);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+/* with "adaptiveBatchSize", the user's batchSize is an upper bound for each
+ * getMore and is not overwritten. */
+static void
+test_cursor_adaptive_batch_size_upper_bound (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+   bson_error_t error;
+   int64_t batch_size;
+   int i;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_run (server);
+
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   collection = mongoc_client_get_collection (client, "db", "coll");
+   cursor = mongoc_collection_find_with_opts (
+      collection, tmp_bson ("{}"), tmp_bson ("{'batchSize': 5, 'adaptiveBatchSize': true}"), NULL);
+
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'$db': 'db', 'find': 'coll', 'batchSize': 5}"));
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '1234'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'firstBatch': [{'a': 1}, {'a': 2}, {'a': 3}, {'a': 4}, {'a': 5}]}}"));
+   ASSERT (future_get_bool (future));
+   future_destroy (future);
+   request_destroy (request);
+   for (i = 0; i < 4; i++) {
+      ASSERT (mongoc_cursor_next (cursor, &doc));
+   }
+
+   /* a fast consumer would get larger batches, but not above batchSize. */
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'$db': 'db', 'getMore': {'$numberLong': '1234'}}"));
+   batch_size = bson_lookup_int64 (request_get_doc (request, 0), "batchSize");
+   ASSERT_CMPINT64 (batch_size, ==, (int64_t) 5);
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '1234'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'nextBatch': [{'a': 6}, {'a': 7}, {'a': 8}, {'a': 9}, {'a': 10}]}}"));
+   ASSERT (future_get_bool (future));
+   future_destroy (future);
+   request_destroy (request);
+   ASSERT_CMPUINT32 (mongoc_cursor_get_batch_size (cursor), ==, 5u);
+
+   /* the batch takes over 100ms to read: the next is smaller. */
+   for (i = 0; i < 4; i++) {
+      _mongoc_usleep (40 * 1000);
+      ASSERT (mongoc_cursor_next (cursor, &doc));
+   }
+
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'$db': 'db', 'getMore': {'$numberLong': '1234'}}"));
+   batch_size = bson_lookup_int64 (request_get_doc (request, 0), "batchSize");
+   ASSERT_CMPINT64 (batch_size, >=, (int64_t) 1);
+   ASSERT_CMPINT64 (batch_size, <, (int64_t) 5);
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '0'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'nextBatch': []}}"));
+   ASSERT (!future_get_bool (future));
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+   future_destroy (future);
+   request_destroy (request);
+   ASSERT_CMPUINT32 (mongoc_cursor_get_batch_size (cursor), ==, 5u);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+/* "adaptiveBatchSize" alone counts the batch, but does not prefetch. */
+static void
+test_cursor_adaptive_batch_size_no_prefetch (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+   bson_error_t error;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_run (server);
+
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   collection = mongoc_client_get_collection (client, "db", "coll");
+   cursor = mongoc_collection_find_with_opts (
+      collection, tmp_bson ("{}"), tmp_bson ("{'batchSize': 4, 'adaptiveBatchSize': true}"), NULL);
+
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (server, MONGOC_MSG_NONE, tmp_bson ("{'$db': 'db', 'find': 'coll'}"));
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '1234'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'firstBatch': [{'a': 1}, {'a': 2}, {'a': 3}, {'a': 4}]}}"));
+   ASSERT (future_get_bool (future));
+   future_destroy (future);
+   request_destroy (request);
+
+   for (int i = 2; i <= 4; i++) {
+      ASSERT (mongoc_cursor_next (cursor, &doc));
+      ASSERT_MATCH (doc, tmp_str ("{'a': %d}", i));
+   }
+
+   /* no getMore is sent until the application asks for the next batch. */
+   mock_server_set_request_timeout_msec (server, 100);
+   request = mock_server_receives_request (server);
+   ASSERT (!request);
+   mock_server_set_request_timeout_msec (server, get_future_timeout_ms ());
+
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'$db': 'db', 'getMore': {'$numberLong': '1234'}}"));
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '0'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'nextBatch': [{'a': 5}]}}"));
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 5}");
+   future_destroy (future);
+   request_destroy (request);
+
+   ASSERT (!mongoc_cursor_next (cursor, &doc));
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
 static void
 test_error_document_query (void)
 {
@@ -2577,6 +2984,13 @@ test_cursor_install (TestSuite *suite)
    TestSuite_AddMockServerTest (suite, "/Cursor/n_return/find_cmd/with_opts", test_n_return_find_cmd_with_opts);
    TestSuite_AddLive (suite, "/Cursor/empty_final_batch_live", test_empty_final_batch_live);
    TestSuite_AddMockServerTest (suite, "/Cursor/empty_final_batch", test_empty_final_batch);
+   TestSuite_AddMockServerTest (suite, "/Cursor/prefetch", test_cursor_prefetch);
+   TestSuite_AddMockServerTest (suite, "/Cursor/prefetch/select_server", test_cursor_prefetch_select_server);
+   TestSuite_AddMockServerTest (suite, "/Cursor/adaptive_batch_size", test_cursor_adaptive_batch_size);
+   TestSuite_AddMockServerTest (
+      suite, "/Cursor/adaptive_batch_size/upper_bound", test_cursor_adaptive_batch_size_upper_bound);
+   TestSuite_AddMockServerTest (
+      suite, "/Cursor/adaptive_batch_size/no_prefetch", test_cursor_adaptive_batch_size_no_prefetch);
    TestSuite_AddLive (suite, "/Cursor/error_document/query", test_error_document_query);
    TestSuite_AddLive (suite, "/Cursor/error_document/getmore", test_error_document_getmore);
    TestSuite_AddLive (suite, "/Cursor/error_document/command", test_error_document_command);
@@ -2,6 +2,7 @@
 #include "mongoc/mongoc-client-pool-private.h"
 #include "mongoc/mongoc.h"
 #include "mongoc/mongoc-host-list-private.h"
+#include "mongoc/mongoc-rr-cache-private.h"
 #include "mongoc/mongoc-thread-private.h"
 #include "mongoc/mongoc-uri-private.h"
 #include "mongoc/utlist.h"
@@ -1185,12 +1186,146 @@ prose_test_12_pooled (void *unused)
    _prose_test_12 (&_prose_test_pooled_fns);
 }
 
+static int rr_cache_test_queries;
+static uint32_t rr_cache_test_ttl;
+static bool rr_cache_test_txt;
+
+static bool
+_rr_cache_test_resolver (const char *hostname,
+                         mongoc_rr_type_t rr_type,
+                         mongoc_rr_data_t *rr_data,
+                         size_t initial_buffer_size,
+                         bson_error_t *error)
+{
+   BSON_UNUSED (initial_buffer_size);
+   BSON_UNUSED (error);
+
+   rr_cache_test_queries++;
+
+   if (rr_type == MONGOC_RR_SRV) {
+      ASSERT_CMPSTR (hostname, "_mongodb._tcp.server.test.com");
+      rr_data->count = 2;
+      rr_data->min_ttl = rr_cache_test_ttl;
+      rr_data->hosts = MAKE_HOSTS ("a.test.com", "b.test.com");
+   } else {
+      /* like _mongoc_client_get_rr, leave @rr_data alone without a record. */
+      ASSERT_CMPSTR (hostname, "server.test.com");
+      if (rr_cache_test_txt) {
+         rr_data->count = 1;
+         rr_data->min_ttl = rr_cache_test_ttl;
+         rr_data->txt_record_opts = bson_strdup ("replicaSet=rs0");
+      }
+   }
+
+   return true;
+}
+
+static void
+_rr_cache_test_new_topology (const mongoc_uri_t *uri)
+{
+   mongoc_topology_t *topology = mongoc_topology_new (uri, true);
+   const mongoc_host_list_t *hosts;
+
+   ASSERT_OR_PRINT (topology->valid, topology->scanner->error);
+
+   hosts = mongoc_uri_get_hosts (topology->uri);
+   ASSERT_CMPSIZE_T (_mongoc_host_list_length (hosts), ==, 2u);
+   ASSERT (host_list_contains (hosts, "a.test.com:27017"));
+   ASSERT (host_list_contains (hosts, "b.test.com:27017"));
+   if (rr_cache_test_txt) {
+      ASSERT_CMPSTR (mongoc_uri_get_replica_set (topology->uri), "rs0");
+   } else {
+      ASSERT (!mongoc_uri_get_replica_set (topology->uri));
+   }
+
+   mongoc_topology_destroy (topology);
+}
+
+static void
+test_rr_cache (void *unused)
+{
+   mongoc_uri_t *uri;
+   mongoc_rr_data_t rr_data = {0};
+   _mongoc_rr_resolver_fn prev;
+   bson_error_t error;
+
+   BSON_UNUSED (unused);
+
+   _mongoc_rr_cache_clear ();
+   prev = _mongoc_rr_cache_set_resolver (_rr_cache_test_resolver);
+   uri = mongoc_uri_new ("mongodb+srv://server.test.com/");
+
+   /* the first topology queries SRV and TXT, the second is answered from the
+    * cache. */
+   rr_cache_test_queries = 0;
+   rr_cache_test_ttl = 60;
+   rr_cache_test_txt = true;
+   _rr_cache_test_new_topology (uri);
+   ASSERT_CMPINT (rr_cache_test_queries, ==, 2);
+   _rr_cache_test_new_topology (uri);
+   ASSERT_CMPINT (rr_cache_test_queries, ==, 2);
+
+   /* a cached answer reports the TTL it has left. */
+   ASSERT_OR_PRINT (_mongoc_rr_cache_get_rr (
+                       "_mongodb._tcp.server.test.com", MONGOC_RR_SRV, &rr_data, MONGOC_RR_DEFAULT_BUFFER_SIZE, &error),
+                    error);
+   ASSERT_CMPINT (rr_cache_test_queries, ==, 2);
+   ASSERT_CMPUINT32 (rr_data.min_ttl, >, 0u);
+   ASSERT_CMPUINT32 (rr_data.min_ttl, <=, 60u);
+   ASSERT_CMPSIZE_T (_mongoc_host_list_length (rr_data.hosts), ==, 2u);
+   _mongoc_host_list_destroy_all (rr_data.hosts);
+
+   /* answers with a zero TTL are not cached. */
+   _mongoc_rr_cache_clear ();
+   rr_cache_test_queries = 0;
+   rr_cache_test_ttl = 0;
+   _rr_cache_test_new_topology (uri);
+   ASSERT_CMPINT (rr_cache_test_queries, ==, 2);
+   _rr_cache_test_new_topology (uri);
+   ASSERT_CMPINT (rr_cache_test_queries, ==, 4);
+
+   /* a missing TXT record is cached as long as the SRV answer. */
+   _mongoc_rr_cache_clear ();
+   rr_cache_test_queries = 0;
+   rr_cache_test_ttl = 60;
+   rr_cache_test_txt = false;
+   _rr_cache_test_new_topology (uri);
+   ASSERT_CMPINT (rr_cache_test_queries, ==, 2);
+   _rr_cache_test_new_topology (uri);
+   ASSERT_CMPINT (rr_cache_test_queries, ==, 2);
+
+   ASSERT_OR_PRINT (
+      _mongoc_rr_cache_get_rr ("server.test.com", MONGOC_RR_TXT, &rr_data, MONGOC_RR_DEFAULT_BUFFER_SIZE, &error),
+      error);
+   ASSERT_CMPINT (rr_cache_test_queries, ==, 2);
+   ASSERT (!rr_data.txt_record_opts);
+   ASSERT_CMPUINT32 (rr_data.min_ttl, >, 0u);
+   ASSERT_CMPUINT32 (rr_data.min_ttl, <=, 60u);
+
+   /* without a cached SRV answer, a missing TXT record is queried again. */
+   _mongoc_rr_cache_clear ();
+   rr_cache_test_queries = 0;
+   memset (&rr_data, 0, sizeof rr_data);
+   ASSERT_OR_PRINT (
+      _mongoc_rr_cache_get_rr ("server.test.com", MONGOC_RR_TXT, &rr_data, MONGOC_RR_DEFAULT_BUFFER_SIZE, &error),
+      error);
+   ASSERT_OR_PRINT (
+      _mongoc_rr_cache_get_rr ("server.test.com", MONGOC_RR_TXT, &rr_data, MONGOC_RR_DEFAULT_BUFFER_SIZE, &error),
+      error);
+   ASSERT_CMPINT (rr_cache_test_queries, ==, 2);
+
+   mongoc_uri_destroy (uri);
+   _mongoc_rr_cache_set_resolver (prev);
+   _mongoc_rr_cache_clear ();
+}
+
 void
 test_dns_install (TestSuite *suite)
 {
    test_all_spec_tests (suite);
    TestSuite_AddFull (
       suite, "/initial_dns_seedlist_discovery/srv_polling/mocked", test_srv_polling_mocked, NULL, NULL, NULL);
+   TestSuite_AddFull (suite, "/initial_dns_seedlist_discovery/rr_cache", test_rr_cache, NULL, NULL, NULL);
    TestSuite_AddFull (suite,
                       "/initial_dns_seedlist_discovery/small_initial_buffer",
                       test_small_initial_buffer,
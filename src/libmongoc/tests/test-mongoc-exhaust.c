@@ -665,6 +665,88 @@ test_exhaust_server_err_2nd_batch_pooled (void)
    _mock_test_exhaust (true, SECOND_BATCH, SERVER_ERROR);
 }
 
+static void
+_exhaust_started_cb (const mongoc_apm_command_started_t *event)
+{
+   if (!strcmp (mongoc_apm_command_started_get_command_name (event), "getMore")) {
+      (*(int *) mongoc_apm_command_started_get_context (event))++;
+   }
+}
+
+/* After the first getMore of an OP_MSG exhaust cursor, the server streams each
+ * batch with moreToCome and the client receives it without sending anything. */
+static void
+test_exhaust_op_msg_streaming (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_apm_callbacks_t *callbacks;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+   bson_error_t error;
+   int getmores = 0;
+   int i;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_run (server);
+
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   callbacks = mongoc_apm_callbacks_new ();
+   mongoc_apm_set_command_started_cb (callbacks, _exhaust_started_cb);
+   mongoc_client_set_apm_callbacks (client, callbacks, &getmores);
+
+   collection = mongoc_client_get_collection (client, "db", "coll");
+   cursor = mongoc_collection_find_with_opts (collection, tmp_bson ("{}"), tmp_bson ("{'exhaust': true}"), NULL);
+
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (server, MONGOC_MSG_EXHAUST_ALLOWED, tmp_bson ("{'find': 'coll'}"));
+   reply_to_op_msg_request (
+      request, MONGOC_MSG_NONE, tmp_bson ("{'ok': 1, 'cursor': {'id': 123, 'ns': 'db.coll', 'firstBatch': [{'i': 0}]}}"));
+   ASSERT (future_get_bool (future));
+   assert_match_bson (doc, tmp_bson ("{'i': 0}"), false);
+   future_destroy (future);
+   request_destroy (request);
+
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (server, MONGOC_MSG_EXHAUST_ALLOWED, tmp_bson ("{'getMore': {'$numberLong': '123'}}"));
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_MORE_TO_COME,
+                            tmp_bson ("{'ok': 1, 'cursor': {'id': 123, 'ns': 'db.coll', 'nextBatch': [{'i': 1}]}}"));
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_MORE_TO_COME,
+                            tmp_bson ("{'ok': 1, 'cursor': {'id': 123, 'ns': 'db.coll', 'nextBatch': [{'i': 2}]}}"));
+   reply_to_op_msg_request (
+      request, MONGOC_MSG_NONE, tmp_bson ("{'ok': 1, 'cursor': {'id': 0, 'ns': 'db.coll', 'nextBatch': [{'i': 3}]}}"));
+   ASSERT (future_get_bool (future));
+   assert_match_bson (doc, tmp_bson ("{'i': 1}"), false);
+   future_destroy (future);
+   request_destroy (request);
+   ASSERT (client->in_exhaust);
+
+   /* the remaining batches arrive without another getMore request. */
+   for (i = 2; i <= 3; i++) {
+      ASSERT_OR_PRINT (mongoc_cursor_next (cursor, &doc), cursor->error);
+      ASSERT_CMPINT32 (bson_lookup_int32 (doc, "i"), ==, i);
+   }
+
+   ASSERT (!mongoc_cursor_next (cursor, &doc));
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+   ASSERT (!client->in_exhaust);
+   ASSERT (!cursor->exhaust);
+
+   /* each streamed batch is still reported to command monitoring. */
+   ASSERT_CMPINT (getmores, ==, 3);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_apm_callbacks_destroy (callbacks);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
 #ifndef _WIN32
 #include <sys/wait.h>
 /* Test that calling mongoc_client_reset on a client that has an exhaust cursor
@@ -778,6 +860,7 @@ test_exhaust_install (TestSuite *suite)
       suite, "/Client/exhaust_cursor/err/server/2nd_batch/single", test_exhaust_server_err_2nd_batch_single);
    TestSuite_AddMockServerTest (
       suite, "/Client/exhaust_cursor/err/server/2nd_batch/pooled", test_exhaust_server_err_2nd_batch_pooled);
+   TestSuite_AddMockServerTest (suite, "/Client/exhaust_cursor/op_msg_streaming", test_exhaust_op_msg_streaming);
 #ifndef _WIN32
    /* Skip on Windows, since "fork" is not available and this test is not
     * particularly platform dependent. */
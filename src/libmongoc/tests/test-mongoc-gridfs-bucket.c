@@ -198,6 +198,385 @@ test_upload_and_download (void)
                                         "fs.chunks"));
 }
 
+typedef struct {
+   int chunk_inserts;
+   int chunk_finds;
+   int32_t chunks_batch_size;
+   int32_t chunks_gte;
+   int32_t chunks_lte;
+   bson_t chunks;
+   bson_t *file;
+} batched_chunks_test_t;
+
+/* Stores inserted chunks and files, and serves them back on find. */
+static bool
+_batched_chunks_responder (request_t *request, void *data)
+{
+   batched_chunks_test_t *test = (batched_chunks_test_t *) data;
+   const bson_t *cmd = request_get_doc (request, 0);
+   bson_iter_t iter;
+   bson_iter_t child;
+   bson_t reply;
+   bson_t cursor;
+   bson_t batch;
+   const char *coll;
+
+   if (!strcmp (request->command_name, "listIndexes")) {
+      reply_to_request_simple (request, "{'ok': 0, 'code': 26, 'errmsg': 'ns does not exist'}");
+      request_destroy (request);
+      return true;
+   }
+
+   if (!strcmp (request->command_name, "createIndexes")) {
+      reply_to_request_with_ok_and_destroy (request);
+      return true;
+   }
+
+   if (!strcmp (request->command_name, "delete")) {
+      reply_to_request_simple (request, "{'ok': 1, 'n': 0}");
+      request_destroy (request);
+      return true;
+   }
+
+   if (strcmp (request->command_name, "insert") && strcmp (request->command_name, "find")) {
+      return false;
+   }
+
+   BSON_ASSERT (bson_iter_init_find (&iter, cmd, request->command_name));
+   coll = bson_iter_utf8 (&iter, NULL);
+
+   if (!strcmp (request->command_name, "insert")) {
+      if (!strcmp (coll, "fs.chunks")) {
+         test->chunk_inserts++;
+         for (size_t i = 1u; i < request->docs.len; i++) {
+            const bson_t *chunk = request_get_doc (request, i);
+            bson_iter_init_find (&iter, chunk, "n");
+            BSON_APPEND_DOCUMENT (&test->chunks, tmp_str ("%d", bson_iter_int32 (&iter)), chunk);
+         }
+      } else {
+         test->file = bson_copy (request_get_doc (request, 1));
+      }
+      reply_to_request_simple (request, tmp_str ("{'ok': 1, 'n': %d}", (int) request->docs.len - 1));
+      request_destroy (request);
+      return true;
+   }
+
+   test->chunks_gte = 0;
+   test->chunks_lte = INT32_MAX;
+   if (!strcmp (coll, "fs.chunks")) {
+      test->chunk_finds++;
+      if (bson_iter_init_find (&iter, cmd, "batchSize")) {
+         test->chunks_batch_size = (int32_t) bson_iter_as_int64 (&iter);
+      }
+      if (bson_iter_init (&iter, cmd) && bson_iter_find_descendant (&iter, "filter.n.$gte", &child)) {
+         test->chunks_gte = bson_iter_int32 (&child);
+      }
+      if (bson_iter_init (&iter, cmd) && bson_iter_find_descendant (&iter, "filter.n.$lte", &child)) {
+         test->chunks_lte = bson_iter_int32 (&child);
+      }
+   }
+
+   bson_init (&reply);
+   BSON_APPEND_DOCUMENT_BEGIN (&reply, "cursor", &cursor);
+   BSON_APPEND_INT64 (&cursor, "id", 0);
+   BSON_APPEND_UTF8 (&cursor, "ns", tmp_str ("db.%s", coll));
+   BSON_APPEND_ARRAY_BEGIN (&cursor, "firstBatch", &batch);
+   if (!strcmp (coll, "fs.chunks")) {
+      int i = 0;
+
+      for (int32_t n = test->chunks_gte; n <= test->chunks_lte; n++) {
+         const uint8_t *chunk_data;
+         uint32_t len;
+         bson_t chunk;
+         const char *key;
+
+         if (!bson_iter_init_find (&iter, &test->chunks, tmp_str ("%d", n))) {
+            break;
+         }
+         bson_iter_document (&iter, &len, &chunk_data);
+         BSON_ASSERT (bson_init_static (&chunk, chunk_data, len));
+         key = tmp_str ("%d", i);
+         BSON_APPEND_DOCUMENT (&batch, key, &chunk);
+         i++;
+      }
+   } else if (test->file) {
+      BSON_APPEND_DOCUMENT (&batch, "0", test->file);
+   }
+   bson_append_array_end (&cursor, &batch);
+   bson_append_document_end (&reply, &cursor);
+   BSON_APPEND_INT32 (&reply, "ok", 1);
+   reply_to_op_msg_request (request, MONGOC_MSG_NONE, &reply);
+   bson_destroy (&reply);
+   request_destroy (request);
+   return true;
+}
+
+static void
+test_upload_and_download_batched (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_database_t *db;
+   mongoc_gridfs_bucket_t *gridfs;
+   batched_chunks_test_t test = {0};
+   bson_value_t file_id;
+   bson_error_t error;
+   char buf[100] = {0};
+   /* 46 bytes in chunks of 4 is 12 chunks, sent as batches of 5, 5, and 2. */
+   const char *str = "This is a test sentence with multiple batches.";
+
+   bson_init (&test.chunks);
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_autoresponds (server, _batched_chunks_responder, &test, NULL);
+   mock_server_run (server);
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   db = mongoc_client_get_database (client, "db");
+
+   gridfs = mongoc_gridfs_bucket_new (db, tmp_bson ("{'chunkSizeBytes': 4, 'chunkBatchSize': 5}"), NULL, &error);
+   ASSERT_OR_PRINT (gridfs, error);
+
+   _upload_file_from_str (gridfs, "my-file", str, NULL, &file_id);
+   ASSERT_CMPINT (test.chunk_inserts, ==, 3);
+   ASSERT_CMPUINT32 (bson_count_keys (&test.chunks), ==, 12u);
+
+   _download_file_into_buf (gridfs, &file_id, buf, sizeof buf);
+   ASSERT_CMPSTR (buf, str);
+   ASSERT_CMPINT32 (test.chunks_batch_size, ==, 5);
+
+   /* the per-upload option overrides the bucket's. */
+   test.chunk_inserts = 0;
+   bson_reinit (&test.chunks);
+   bson_destroy (test.file);
+   test.file = NULL;
+   bson_value_destroy (&file_id);
+   _upload_file_from_str (gridfs, "my-file", str, tmp_bson ("{'chunkBatchSize': 1}"), &file_id);
+   ASSERT_CMPINT (test.chunk_inserts, ==, 12);
+   ASSERT_CMPUINT32 (bson_count_keys (&test.chunks), ==, 12u);
+
+   bson_value_destroy (&file_id);
+   mongoc_gridfs_bucket_destroy (gridfs);
+   mongoc_database_destroy (db);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   bson_destroy (test.file);
+   bson_destroy (&test.chunks);
+}
+
+/* Util that downloads a range of a file into the given buffer. Returns num
+ * bytes read. */
+static ssize_t
+_download_range_into_buf (
+   mongoc_gridfs_bucket_t *bucket, const bson_value_t *file_id, int64_t offset, int64_t length, char *buf, size_t len)
+{
+   bson_error_t error;
+   ssize_t nread;
+   mongoc_stream_t *down = mongoc_gridfs_bucket_open_download_stream_range (bucket, file_id, offset, length, &error);
+   ASSERT_OR_PRINT (down, error);
+   memset (buf, 0, len);
+   nread = mongoc_stream_read (down, buf, len, 0 /* min read */, 0 /* No timeout */);
+   mongoc_stream_destroy (down);
+   return nread;
+}
+
+static void
+test_download_range (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_database_t *db;
+   mongoc_gridfs_bucket_t *gridfs;
+   mongoc_stream_t *down;
+   batched_chunks_test_t test = {0};
+   bson_value_t file_id;
+   bson_error_t error;
+   char buf[100];
+   /* 46 bytes in 12 chunks of 4 */
+   const char *str = "This is a test sentence with multiple batches.";
+
+   bson_init (&test.chunks);
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_autoresponds (server, _batched_chunks_responder, &test, NULL);
+   mock_server_run (server);
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   db = mongoc_client_get_database (client, "db");
+
+   gridfs = mongoc_gridfs_bucket_new (db, tmp_bson ("{'chunkSizeBytes': 4, 'chunkCacheSize': 4}"), NULL, &error);
+   ASSERT_OR_PRINT (gridfs, error);
+   _upload_file_from_str (gridfs, "my-file", str, NULL, &file_id);
+
+   /* bytes 10 through 18 span chunks 2 through 4, fetched in one batch. */
+   ASSERT_CMPSSIZE_T (_download_range_into_buf (gridfs, &file_id, 10, 9, buf, sizeof buf), ==, 9);
+   ASSERT_CMPSTR (buf, "test sent");
+   ASSERT_CMPINT (test.chunk_finds, ==, 1);
+   ASSERT_CMPINT32 (test.chunks_gte, ==, 2);
+   ASSERT_CMPINT32 (test.chunks_lte, ==, 4);
+   ASSERT_CMPINT32 (test.chunks_batch_size, ==, 3);
+
+   /* the same range again is served from the cache. */
+   ASSERT_CMPSSIZE_T (_download_range_into_buf (gridfs, &file_id, 11, 7, buf, sizeof buf), ==, 7);
+   ASSERT_CMPSTR (buf, "est sen");
+   ASSERT_CMPINT (test.chunk_finds, ==, 1);
+
+   /* a partly cached range queries only the chunks after the cached ones. */
+   ASSERT_CMPSSIZE_T (_download_range_into_buf (gridfs, &file_id, 16, 6, buf, sizeof buf), ==, 6);
+   ASSERT_CMPSTR (buf, "entenc");
+   ASSERT_CMPINT (test.chunk_finds, ==, 2);
+   ASSERT_CMPINT32 (test.chunks_gte, ==, 5);
+   ASSERT_CMPINT32 (test.chunks_lte, ==, 5);
+
+   /* a range past the end of the file is truncated. */
+   ASSERT_CMPSSIZE_T (_download_range_into_buf (gridfs, &file_id, 40, 100, buf, sizeof buf), ==, 6);
+   ASSERT_CMPSTR (buf, "tches.");
+
+   /* an empty range at the end of the file reads nothing. */
+   ASSERT_CMPSSIZE_T (_download_range_into_buf (gridfs, &file_id, 46, 10, buf, sizeof buf), ==, 0);
+
+   down = mongoc_gridfs_bucket_open_download_stream_range (gridfs, &file_id, 47, 1, &error);
+   BSON_ASSERT (!down);
+   ASSERT_ERROR_CONTAINS (error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "past the end of the file");
+
+   down = mongoc_gridfs_bucket_open_download_stream_range (gridfs, &file_id, -1, 1, &error);
+   BSON_ASSERT (!down);
+   ASSERT_ERROR_CONTAINS (error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "must not be negative");
+
+   bson_value_destroy (&file_id);
+   mongoc_gridfs_bucket_destroy (gridfs);
+   mongoc_database_destroy (db);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   bson_destroy (test.file);
+   bson_destroy (&test.chunks);
+}
+
+
+static void
+test_download_cache_invalidation (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_database_t *db;
+   mongoc_gridfs_bucket_t *gridfs;
+   mongoc_gridfs_bucket_t *other;
+   mongoc_stream_t *up;
+   batched_chunks_test_t test = {0};
+   bson_value_t file_id;
+   bson_error_t error;
+   char buf[100];
+
+   bson_init (&test.chunks);
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_autoresponds (server, _batched_chunks_responder, &test, NULL);
+   mock_server_run (server);
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   db = mongoc_client_get_database (client, "db");
+
+   gridfs = mongoc_gridfs_bucket_new (db, tmp_bson ("{'chunkSizeBytes': 4, 'chunkCacheSize': 4}"), NULL, &error);
+   ASSERT_OR_PRINT (gridfs, error);
+   other = mongoc_gridfs_bucket_new (db, tmp_bson ("{'chunkSizeBytes': 4}"), NULL, &error);
+   ASSERT_OR_PRINT (other, error);
+
+   _upload_file_from_str (gridfs, "my-file", "old file", NULL, &file_id);
+   ASSERT_CMPSSIZE_T (_download_range_into_buf (gridfs, &file_id, 0, 8, buf, sizeof buf), ==, 8);
+   ASSERT_CMPSTR (buf, "old file");
+   ASSERT_CMPINT (test.chunk_finds, ==, 1);
+
+   /* another client replaces the file with one of the same length and id. */
+   bson_reinit (&test.chunks);
+   bson_destroy (test.file);
+   test.file = NULL;
+   _mongoc_usleep (2 * 1000);
+   up = mongoc_gridfs_bucket_open_upload_stream_with_id (other, &file_id, "my-file", NULL, &error);
+   ASSERT_OR_PRINT (up, error);
+   ASSERT_CMPSSIZE_T (mongoc_stream_write (up, (void *) "new file", 8, 0), ==, 8);
+   mongoc_stream_destroy (up);
+
+   /* the cached chunks belong to the old upload date and are not served. */
+   ASSERT_CMPSSIZE_T (_download_range_into_buf (gridfs, &file_id, 0, 8, buf, sizeof buf), ==, 8);
+   ASSERT_CMPSTR (buf, "new file");
+   ASSERT_CMPINT (test.chunk_finds, ==, 2);
+
+   ASSERT_CMPSSIZE_T (_download_range_into_buf (gridfs, &file_id, 0, 8, buf, sizeof buf), ==, 8);
+   ASSERT_CMPINT (test.chunk_finds, ==, 2);
+
+   /* starting and aborting an upload with the id drops the cached chunks. */
+   up = mongoc_gridfs_bucket_open_upload_stream_with_id (gridfs, &file_id, "my-file", NULL, &error);
+   ASSERT_OR_PRINT (up, error);
+   ASSERT (mongoc_gridfs_bucket_abort_upload (up));
+   mongoc_stream_destroy (up);
+
+   ASSERT_CMPSSIZE_T (_download_range_into_buf (gridfs, &file_id, 0, 8, buf, sizeof buf), ==, 8);
+   ASSERT_CMPSTR (buf, "new file");
+   ASSERT_CMPINT (test.chunk_finds, ==, 3);
+
+   bson_value_destroy (&file_id);
+   mongoc_gridfs_bucket_destroy (other);
+   mongoc_gridfs_bucket_destroy (gridfs);
+   mongoc_database_destroy (db);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   bson_destroy (test.file);
+   bson_destroy (&test.chunks);
+}
+
+static void
+test_compressed_chunks (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_database_t *db;
+   mongoc_gridfs_bucket_t *gridfs;
+   batched_chunks_test_t test = {0};
+   bson_value_t file_id;
+   bson_error_t error;
+   bson_iter_t iter;
+   char content[303];
+   char buf[400];
+
+   /* three compressible chunks, then a short chunk that does not shrink. */
+   for (size_t i = 0u; i < 300u; i++) {
+      content[i] = "abc"[i % 3u];
+   }
+   bson_strncpy (content + 300, "xy", 3);
+
+   bson_init (&test.chunks);
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_autoresponds (server, _batched_chunks_responder, &test, NULL);
+   mock_server_run (server);
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   db = mongoc_client_get_database (client, "db");
+
+   gridfs = mongoc_gridfs_bucket_new (db, tmp_bson ("{'chunkCompressor': 'unknown'}"), NULL, &error);
+   BSON_ASSERT (!gridfs);
+   ASSERT_ERROR_CONTAINS (error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Unsupported chunkCompressor");
+
+   gridfs = mongoc_gridfs_bucket_new (db, tmp_bson ("{'chunkSizeBytes': 100, 'chunkCompressor': 'zlib'}"), NULL, &error);
+   ASSERT_OR_PRINT (gridfs, error);
+   _upload_file_from_str (gridfs, "my-file", content, NULL, &file_id);
+
+   ASSERT_CMPUINT32 (bson_count_keys (&test.chunks), ==, 4u);
+   ASSERT_MATCH (&test.chunks,
+                 "{'0': {'n': 0, 'compressor': 'zlib', 'uncompressedSize': 100},"
+                 " '2': {'n': 2, 'compressor': 'zlib', 'uncompressedSize': 100},"
+                 " '3': {'n': 3, 'compressor': {'$exists': false}, 'uncompressedSize': {'$exists': false}}}");
+   BSON_ASSERT (bson_iter_init (&iter, &test.chunks) && bson_iter_find_descendant (&iter, "0.data", &iter));
+   ASSERT_CMPUINT32 (bson_iter_value (&iter)->value.v_binary.data_len, <, 100u);
+   ASSERT_MATCH (test.file, "{'length': {'$numberLong': '302'}, 'compressor': 'zlib'}");
+
+   _download_file_into_buf (gridfs, &file_id, buf, sizeof buf);
+   ASSERT_CMPSTR (buf, content);
+
+   ASSERT_CMPSSIZE_T (_download_range_into_buf (gridfs, &file_id, 199, 103, buf, sizeof buf), ==, 103);
+   ASSERT_CMPSTR (buf, content + 199);
+
+   bson_value_destroy (&file_id);
+   mongoc_gridfs_bucket_destroy (gridfs);
+   mongoc_database_destroy (db);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   bson_destroy (test.file);
+   bson_destroy (&test.chunks);
+}
+
 bool
 hex_to_bytes (const char *hex_str, size_t *size /* OUT */, uint8_t **bytes /* OUT */)
 {
@@ -1054,6 +1433,12 @@ test_gridfs_bucket_install (TestSuite *suite)
    test_all_spec_tests (suite);
    TestSuite_AddLive (suite, "/gridfs/create_bucket", test_create_bucket);
    TestSuite_AddLive (suite, "/gridfs/upload_and_download", test_upload_and_download);
+   TestSuite_AddMockServerTest (suite, "/gridfs/upload_and_download/batched", test_upload_and_download_batched);
+   TestSuite_AddMockServerTest (suite, "/gridfs/download_range", test_download_range);
+   TestSuite_AddMockServerTest (suite, "/gridfs/download_range/cache_invalidation", test_download_cache_invalidation);
+#ifdef MONGOC_ENABLE_COMPRESSION_ZLIB
+   TestSuite_AddMockServerTest (suite, "/gridfs/compressed_chunks", test_compressed_chunks);
+#endif
    TestSuite_AddFull (suite, "/gridfs/upload_error", test_upload_error, NULL, NULL, test_framework_skip_if_no_auth);
    TestSuite_AddFull (suite,
                       "/gridfs/find_w_session",
@@ -5,6 +5,8 @@
 #include <mongoc/mongoc-util-private.h>
 
 #include "TestSuite.h"
+#include "test-conveniences.h"
+#include "test-libmongoc.h"
 
 BEGIN_IGNORE_DEPRECATIONS
 
@@ -512,8 +514,262 @@ test_mongoc_matcher_in_basic (void)
    mongoc_matcher_destroy (matcher);
 }
 
+
+static const char *compiled_queries[] = {
+   "{'a': 1}",
+   "{'a': 1.5}",
+   "{'a': {'$ne': 1}}",
+   "{'a': {'$gt': 1}, 'b': {'$lte': 2.5}}",
+   "{'a': {'$gte': 2}, 'a': {'$lt': {'$numberLong': '4'}}}",
+   "{'a': 'x'}",
+   "{'a': {'$ne': 'x'}}",
+   "{'a': null}",
+   "{'a': {'$ne': null}}",
+   "{'a': {'b': 1}}",
+   "{'a': [1, 2]}",
+   "{'a.b': 1, 'a.c': {'$exists': true}}",
+   "{'a.b.c': {'$gt': 0}}",
+   "{'a.0': 1}",
+   "{'a': {'$exists': false}}",
+   "{'a': {'$not': {'$gt': 2}}}",
+   "{'a': {'$in': [1, 2.5, 'x', null, [1, 2], {'b': 1}, true]}}",
+   "{'a': {'$nin': [1, {'$numberLong': '3'}, 'y']}}",
+   "{'$or': [{'a': 1}, {'b': 'x'}, {'c.d': {'$exists': true}}]}",
+   "{'$and': [{'a': {'$gte': 1}}, {'a': {'$lte': 3}}]}",
+   "{'$nor': [{'a': 1}, {'b': 2}]}",
+   "{'a': 1, 'b': 2, 'c': 3, 'd.e': 4, 'd.f': {'$in': [5, 6]}}",
+};
+
+
+static const char *compiled_docs[] = {
+   "{}",
+   "{'a': 1}",
+   "{'a': {'$numberLong': '1'}}",
+   "{'a': 1.0}",
+   "{'a': 1.5}",
+   "{'a': true}",
+   "{'a': 2, 'b': 2.5}",
+   "{'a': 3, 'b': 3}",
+   "{'a': {'$numberLong': '4'}}",
+   "{'a': 'x'}",
+   "{'a': 'xy'}",
+   "{'a': null}",
+   "{'a': {'$undefined': true}}",
+   "{'a': {'b': 1}}",
+   "{'a': {'b': 1, 'c': 2}}",
+   "{'a': {'b': {'c': 1}}}",
+   "{'a': [1, 2]}",
+   "{'a': [2, 1]}",
+   "{'a': 1, 'a': 2}",
+   "{'a': 5, 'a': {'b': 1}}",
+   "{'b': 'x'}",
+   "{'c': {'d': null}}",
+   "{'a': 1, 'b': 2, 'c': 3, 'd': {'e': 4, 'f': 6}}",
+   "{'a': 1, 'b': 2, 'c': 3, 'd': {'e': 4, 'f': 7}}",
+};
+
+
+static void
+_check_compiled (const bson_t *query)
+{
+   mongoc_matcher_t *matcher;
+   bson_error_t error;
+   bson_t *doc;
+   size_t i;
+
+   matcher = mongoc_matcher_new (query, &error);
+   ASSERT_OR_PRINT (matcher, error);
+
+   for (i = 0; i < sizeof compiled_docs / sizeof compiled_docs[0]; i++) {
+      doc = tmp_bson (compiled_docs[i]);
+      if (mongoc_matcher_match (matcher, doc) != _mongoc_matcher_op_match (matcher->optree, doc)) {
+         test_error ("compiled matcher disagrees for query %s, document %s", tmp_json (query), compiled_docs[i]);
+      }
+   }
+
+   mongoc_matcher_destroy (matcher);
+}
+
+
+/* the compiled matcher agrees with the interpreter on every query and doc. */
+static void
+test_mongoc_matcher_compiled (void)
+{
+   mongoc_matcher_t *matcher;
+   bson_error_t error;
+   bson_t *query;
+   size_t i;
+
+   /* the interpreter warns about comparisons it does not implement. */
+   capture_logs (true);
+
+   for (i = 0; i < sizeof compiled_queries / sizeof compiled_queries[0]; i++) {
+      _check_compiled (tmp_bson (compiled_queries[i]));
+   }
+
+   /* $type checks the field at a dotted path, not its parent. */
+   query = BCON_NEW ("a.b", "{", "$type", BCON_INT32 (BSON_TYPE_INT32), "}");
+   _check_compiled (query);
+   matcher = mongoc_matcher_new (query, &error);
+   ASSERT_OR_PRINT (matcher, error);
+   ASSERT (mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': 1}}")));
+   ASSERT (!mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': 'x'}}")));
+   mongoc_matcher_destroy (matcher);
+   bson_destroy (query);
+}
+
+
+/* times the compiled matcher against the interpreter. Run with -d to print
+ * the results. */
+static void
+test_mongoc_matcher_compiled_benchmark (void *ctx)
+{
+   const char *query = "{'operationType': {'$in': ['insert', 'update', 'replace']},"
+                       " 'ns.coll': 'orders',"
+                       " 'fullDocument.total': {'$gte': 100, '$lt': 1000},"
+                       " 'fullDocument.status': {'$ne': 'cancelled'}}";
+   const int iterations = 1000 * 1000;
+   mongoc_matcher_t *matcher;
+   bson_error_t error;
+   bson_t *doc;
+   int64_t start;
+   int64_t interpreted;
+   int64_t compiled;
+   int matches = 0;
+   int i;
+
+   BSON_UNUSED (ctx);
+
+   matcher = mongoc_matcher_new (tmp_bson (query), &error);
+   ASSERT_OR_PRINT (matcher, error);
+
+   doc = tmp_bson ("{'_id': {'_data': '8263'}, 'operationType': 'update', 'clusterTime': {'$timestamp': {'t': 1, 'i': 1}},"
+                   " 'ns': {'db': 'shop', 'coll': 'orders'}, 'documentKey': {'_id': 1},"
+                   " 'fullDocument': {'_id': 1, 'customer': 'abc', 'items': [1, 2, 3], 'status': 'paid', 'total': 250}}");
+
+   start = bson_get_monotonic_time ();
+   for (i = 0; i < iterations; i++) {
+      matches += _mongoc_matcher_op_match (matcher->optree, doc);
+   }
+   interpreted = bson_get_monotonic_time () - start;
+
+   start = bson_get_monotonic_time ();
+   for (i = 0; i < iterations; i++) {
+      matches += mongoc_matcher_match (matcher, doc);
+   }
+   compiled = bson_get_monotonic_time () - start;
+
+   ASSERT_CMPINT (matches, ==, 2 * iterations);
+
+   if (test_suite_debug_output ()) {
+      printf ("      matcher: interpreted %.1f ns/doc, compiled %.1f ns/doc\n",
+              (double) interpreted * 1000.0 / iterations,
+              (double) compiled * 1000.0 / iterations);
+      fflush (stdout);
+   }
+
+   mongoc_matcher_destroy (matcher);
+}
+
+
+/* mongoc_matcher_match_many agrees with mongoc_matcher_match, across blocks. */
+static void
+test_mongoc_matcher_match_many (void)
+{
+   const size_t n_docs = 150;
+   const bson_t **docs;
+   mongoc_matcher_t *matcher;
+   bson_error_t error;
+   uint8_t bitmap[(150 + 7) / 8];
+   size_t n_matched;
+   size_t expected;
+   bool match;
+   size_t i;
+   size_t j;
+
+   capture_logs (true);
+
+   docs = bson_malloc (n_docs * sizeof (bson_t *));
+   for (j = 0; j < n_docs; j++) {
+      docs[j] = tmp_bson (compiled_docs[j % (sizeof compiled_docs / sizeof compiled_docs[0])]);
+   }
+
+   for (i = 0; i < sizeof compiled_queries / sizeof compiled_queries[0]; i++) {
+      matcher = mongoc_matcher_new (tmp_bson (compiled_queries[i]), &error);
+      ASSERT_OR_PRINT (matcher, error);
+
+      memset (bitmap, 0xff, sizeof bitmap);
+      n_matched = mongoc_matcher_match_many (matcher, docs, n_docs, bitmap);
+
+      expected = 0;
+      for (j = 0; j < n_docs; j++) {
+         match = mongoc_matcher_match (matcher, docs[j]);
+         if (match != ((bitmap[j / 8] & (1u << (j % 8))) != 0)) {
+            test_error ("match_many disagrees for query %s, document %s", compiled_queries[i], tmp_json (docs[j]));
+         }
+         expected += match;
+      }
+
+      ASSERT_CMPSIZE_T (n_matched, ==, expected);
+      /* bits past the last document are cleared. */
+      ASSERT_CMPUINT (bitmap[(n_docs - 1) / 8] >> (n_docs % 8), ==, 0);
+
+      mongoc_matcher_destroy (matcher);
+   }
+
+   bson_free (docs);
+}
+
+
+static void
+test_mongoc_matcher_match_buffer (void)
+{
+   mongoc_matcher_t *matcher;
+   bson_error_t error;
+   uint8_t *buffer;
+   size_t len = 0;
+   uint8_t bitmap[(100 + 7) / 8];
+   size_t n_documents;
+   bson_t *doc;
+   int i;
+
+   matcher = mongoc_matcher_new (tmp_bson ("{'a': {'$gte': 10}}"), &error);
+   ASSERT_OR_PRINT (matcher, error);
+
+   /* raw documents back to back, as in a batch read from a stream. */
+   buffer = bson_malloc (100 * 64);
+   for (i = 0; i < 100; i++) {
+      doc = BCON_NEW ("a", BCON_INT32 (i % 20));
+      memcpy (buffer + len, bson_get_data (doc), doc->len);
+      len += doc->len;
+      bson_destroy (doc);
+   }
+
+   ASSERT_OR_PRINT (mongoc_matcher_match_buffer (matcher, buffer, len, bitmap, 100, &n_documents, &error), error);
+   ASSERT_CMPSIZE_T (n_documents, ==, 100);
+   for (i = 0; i < 100; i++) {
+      ASSERT_CMPINT ((bitmap[i / 8] >> (i % 8)) & 1, ==, i % 20 >= 10);
+   }
+
+   /* more documents than the bitmap holds. */
+   ASSERT (!mongoc_matcher_match_buffer (matcher, buffer, len, bitmap, 99, &n_documents, &error));
+   ASSERT_ERROR_CONTAINS (error, MONGOC_ERROR_BSON, MONGOC_ERROR_BSON_INVALID, "more than 99 documents");
+
+   /* a truncated document. */
+   ASSERT (!mongoc_matcher_match_buffer (matcher, buffer, len - 1u, bitmap, 100, &n_documents, &error));
+   ASSERT_ERROR_CONTAINS (error, MONGOC_ERROR_BSON, MONGOC_ERROR_BSON_INVALID, "Invalid document");
+
+   /* an empty buffer. */
+   ASSERT_OR_PRINT (mongoc_matcher_match_buffer (matcher, NULL, 0, NULL, 0, &n_documents, &error), error);
+   ASSERT_CMPSIZE_T (n_documents, ==, 0);
+
+   bson_free (buffer);
+   mongoc_matcher_destroy (matcher);
+}
+
 END_IGNORE_DEPRECATIONS
 
+
 void
 test_matcher_install (TestSuite *suite)
 {
@@ -527,4 +783,13 @@ test_matcher_install (TestSuite *suite)
    TestSuite_Add (suite, "/Matcher/eq/int64", test_mongoc_matcher_eq_int64);
    TestSuite_Add (suite, "/Matcher/eq/doc", test_mongoc_matcher_eq_doc);
    TestSuite_Add (suite, "/Matcher/in/basic", test_mongoc_matcher_in_basic);
+   TestSuite_Add (suite, "/Matcher/compiled", test_mongoc_matcher_compiled);
+   TestSuite_AddFull (suite,
+                      "/Matcher/compiled/benchmark",
+                      test_mongoc_matcher_compiled_benchmark,
+                      NULL,
+                      NULL,
+                      test_framework_skip_if_slow);
+   TestSuite_Add (suite, "/Matcher/match_many", test_mongoc_matcher_match_many);
+   TestSuite_Add (suite, "/Matcher/match_buffer", test_mongoc_matcher_match_buffer);
 }
@@ -164,11 +164,149 @@ test_mongoc_utf8_to_unicode (void)
 
 #endif
 
+#ifdef MONGOC_ENABLE_CRYPTO
+/* Keys are chosen by tests so they map to a specific cache set. `run` keeps
+ * keys distinct across repeated runs in one process. */
+static void
+_scram_cache_test_key (uint8_t key[MONGOC_SCRAM_CACHE_KEY_SIZE], uint32_t set, uint32_t run, uint32_t n)
+{
+   memset (key, 0, MONGOC_SCRAM_CACHE_KEY_SIZE);
+   memcpy (key, &set, sizeof (set));
+   memcpy (key + 4, &run, sizeof (run));
+   memcpy (key + 8, &n, sizeof (n));
+}
+
+static void
+_scram_cache_test_entry (mongoc_scram_cache_entry_t *entry, uint32_t n)
+{
+   memset (entry, (int) (n & 0xffu), sizeof (*entry));
+}
+
+static bool
+_scram_cache_test_entry_is (const mongoc_scram_cache_entry_t *entry, uint32_t n)
+{
+   mongoc_scram_cache_entry_t expected;
+
+   _scram_cache_test_entry (&expected, n);
+   return 0 == memcmp (entry, &expected, sizeof (expected));
+}
+
+static void
+test_mongoc_scram_cache_lru (void)
+{
+   static uint32_t run = 0;
+   const uint32_t set = 5;
+   uint8_t key[MONGOC_SCRAM_CACHE_KEY_SIZE];
+   mongoc_scram_cache_entry_t entry;
+
+   run++;
+
+   /* Fill the set. */
+   for (uint32_t n = 0u; n < MONGOC_SCRAM_CACHE_WAYS; n++) {
+      _scram_cache_test_key (key, set, run, n);
+      ASSERT (!_mongoc_scram_cache_lookup (key, &entry));
+      _scram_cache_test_entry (&entry, n);
+      _mongoc_scram_cache_insert (key, &entry);
+   }
+
+   /* Use the first entry, so the second is now least recently used. */
+   _scram_cache_test_key (key, set, run, 0u);
+   ASSERT (_mongoc_scram_cache_lookup (key, &entry));
+   ASSERT (_scram_cache_test_entry_is (&entry, 0u));
+
+   /* Inserting an existing key does not evict anything. */
+   _mongoc_scram_cache_insert (key, &entry);
+
+   /* Inserting into the full set evicts the least recently used entry. */
+   _scram_cache_test_key (key, set, run, MONGOC_SCRAM_CACHE_WAYS);
+   _scram_cache_test_entry (&entry, MONGOC_SCRAM_CACHE_WAYS);
+   _mongoc_scram_cache_insert (key, &entry);
+
+   for (uint32_t n = 0u; n <= MONGOC_SCRAM_CACHE_WAYS; n++) {
+      _scram_cache_test_key (key, set, run, n);
+      if (n == 1u) {
+         ASSERT (!_mongoc_scram_cache_lookup (key, &entry));
+      } else {
+         ASSERT (_mongoc_scram_cache_lookup (key, &entry));
+         ASSERT (_scram_cache_test_entry_is (&entry, n));
+      }
+   }
+
+   /* Other sets are unaffected. */
+   _scram_cache_test_key (key, set + 1u, run, 0u);
+   ASSERT (!_mongoc_scram_cache_lookup (key, &entry));
+}
+
 enum {
-   // ensure there are more users than slots in cache to test cache invalidation
-   NUM_CACHE_TEST_USERS = 10 + MONGOC_SCRAM_CACHE_SIZE,
+   SCRAM_CACHE_TEST_READERS = 4,
+   SCRAM_CACHE_TEST_KEYS = 4 * MONGOC_SCRAM_CACHE_WAYS,
+   SCRAM_CACHE_TEST_INSERTS = 20000,
+};
 
-   // ensure that there are several times that the cache needs to be invalidated
+typedef struct {
+   uint32_t run;
+   int done;
+   int n_hits;
+} scram_cache_test_ctx_t;
+
+static BSON_THREAD_FUN (_scram_cache_reader_thread, ctx_void)
+{
+   scram_cache_test_ctx_t *ctx = ctx_void;
+   uint8_t key[MONGOC_SCRAM_CACHE_KEY_SIZE];
+   mongoc_scram_cache_entry_t entry;
+   uint32_t n = 0u;
+
+   while (!bson_atomic_int_fetch (&ctx->done, bson_memory_order_acquire)) {
+      n = (n + 1u) % SCRAM_CACHE_TEST_KEYS;
+      _scram_cache_test_key (key, 7u, ctx->run, n);
+      if (_mongoc_scram_cache_lookup (key, &entry)) {
+         /* A lookup never observes a partially written entry. */
+         ASSERT (_scram_cache_test_entry_is (&entry, n));
+         bson_atomic_int_fetch_add (&ctx->n_hits, 1, bson_memory_order_relaxed);
+      }
+   }
+
+   BSON_THREAD_RETURN;
+}
+
+static void
+test_mongoc_scram_cache_concurrent (void)
+{
+   static uint32_t run = 0;
+   scram_cache_test_ctx_t ctx = {0};
+   bson_thread_t readers[SCRAM_CACHE_TEST_READERS];
+   uint8_t key[MONGOC_SCRAM_CACHE_KEY_SIZE];
+   mongoc_scram_cache_entry_t entry;
+
+   ctx.run = ++run;
+
+   for (int i = 0; i < SCRAM_CACHE_TEST_READERS; i++) {
+      ASSERT_CMPINT (0, ==, mcommon_thread_create (&readers[i], _scram_cache_reader_thread, &ctx));
+   }
+
+   /* There are more keys than ways, so entries are constantly evicted and
+    * overwritten while the readers look them up. */
+   for (uint32_t i = 0u; i < SCRAM_CACHE_TEST_INSERTS; i++) {
+      const uint32_t n = i % SCRAM_CACHE_TEST_KEYS;
+
+      _scram_cache_test_key (key, 7u, ctx.run, n);
+      _scram_cache_test_entry (&entry, n);
+      _mongoc_scram_cache_insert (key, &entry);
+   }
+
+   bson_atomic_int_exchange (&ctx.done, 1, bson_memory_order_release);
+
+   for (int i = 0; i < SCRAM_CACHE_TEST_READERS; i++) {
+      ASSERT_CMPINT (0, ==, mcommon_thread_join (readers[i]));
+   }
+}
+#endif /* MONGOC_ENABLE_CRYPTO */
+
+enum {
+   // ensure many users authenticate concurrently, contending for cache slots
+   NUM_CACHE_TEST_USERS = 10 + MONGOC_SCRAM_CACHE_WAYS,
+
+   // ensure that each user's cache entry is looked up several times
    NUM_CACHE_TEST_THREADS = 3 * NUM_CACHE_TEST_USERS,
 };
 
@@ -747,6 +885,10 @@ test_scram_install (TestSuite *suite)
    TestSuite_Add (suite, "/scram/utf8_char_length", test_mongoc_utf8_char_length);
    TestSuite_Add (suite, "/scram/utf8_string_length", test_mongoc_utf8_string_length);
    TestSuite_Add (suite, "/scram/utf8_to_unicode", test_mongoc_utf8_to_unicode);
+#endif
+#ifdef MONGOC_ENABLE_CRYPTO
+   TestSuite_Add (suite, "/scram/cache/lru", test_mongoc_scram_cache_lru);
+   TestSuite_Add (suite, "/scram/cache/concurrent", test_mongoc_scram_cache_concurrent);
 #endif
    TestSuite_AddFull (suite,
                       "/scram/cache_invalidation",
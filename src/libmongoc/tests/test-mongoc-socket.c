@@ -2,12 +2,17 @@
 #include <mongoc/mongoc.h>
 #include <mongoc/mongoc-util-private.h>
 
+#include "mongoc/mongoc-client-private.h"
 #include "mongoc/mongoc-socket-private.h"
+#include "mongoc/mongoc-stream-private.h"
 #include "mongoc/mongoc-thread-private.h"
 #include "mongoc/mongoc-errno-private.h"
+#include "mongoc/mongoc-uring-private.h"
 #include "TestSuite.h"
 
+#include "mock_server/mock-server.h"
 #include "test-libmongoc.h"
+#include "test-conveniences.h"
 
 #undef MONGOC_LOG_DOMAIN
 #define MONGOC_LOG_DOMAIN "socket-test"
@@ -25,9 +30,23 @@ typedef struct {
    bool closed_socket;
    int amount;
    int32_t server_sleep_ms;
+   bool use_uring;
 } socket_test_data_t;
 
 
+static mongoc_stream_t *
+_socket_test_stream_new (socket_test_data_t *data, mongoc_socket_t *sock)
+{
+   mongoc_stream_t *stream = mongoc_stream_socket_new (sock);
+
+   if (data->use_uring) {
+      BSON_ASSERT (_mongoc_stream_socket_use_uring (stream));
+   }
+
+   return stream;
+}
+
+
 static BSON_THREAD_FUN (socket_test_server, data_)
 {
    socket_test_data_t *data = (socket_test_data_t *) data_;
@@ -68,7 +87,7 @@ static BSON_THREAD_FUN (socket_test_server, data_)
    conn_sock = mongoc_socket_accept (listen_sock, -1);
    BSON_ASSERT (conn_sock);
 
-   stream = mongoc_stream_socket_new (conn_sock);
+   stream = _socket_test_stream_new (data, conn_sock);
    BSON_ASSERT (stream);
 
    r = mongoc_stream_readv (stream, &iov, 1, 5, TIMEOUT);
@@ -129,7 +148,7 @@ static BSON_THREAD_FUN (socket_test_client, data_)
    r = mongoc_socket_connect (conn_sock, (struct sockaddr *) &server_addr, sizeof (server_addr), -1);
    BSON_ASSERT (r == 0);
 
-   stream = mongoc_stream_socket_new (conn_sock);
+   stream = _socket_test_stream_new (data, conn_sock);
 
    strcpy (buf, "ping");
 
@@ -217,7 +236,7 @@ static BSON_THREAD_FUN (sendv_test_server, data_)
    conn_sock = mongoc_socket_accept (listen_sock, -1);
    BSON_ASSERT (conn_sock);
 
-   stream = mongoc_stream_socket_new (conn_sock);
+   stream = _socket_test_stream_new (data, conn_sock);
    BSON_ASSERT (stream);
 
    /* Wait until the client has pushed so much data he can't write more */
@@ -302,7 +321,7 @@ static BSON_THREAD_FUN (sendv_test_client, data_)
       ASSERT_CMPSSIZE_T (r, ==, 0);
    }
 
-   mongoc_stream_t *const stream = mongoc_stream_socket_new (conn_sock);
+   mongoc_stream_t *const stream = _socket_test_stream_new (data, conn_sock);
 
    int amount = 0;
 
@@ -339,7 +358,7 @@ static BSON_THREAD_FUN (sendv_test_client, data_)
 
 
 static void
-_test_mongoc_socket_check_closed (int32_t server_sleep_ms)
+_test_mongoc_socket_check_closed (int32_t server_sleep_ms, bool use_uring)
 {
    socket_test_data_t data = {0};
    bson_thread_t threads[2];
@@ -348,6 +367,7 @@ _test_mongoc_socket_check_closed (int32_t server_sleep_ms)
    bson_mutex_init (&data.cond_mutex);
    mongoc_cond_init (&data.cond);
    data.server_sleep_ms = server_sleep_ms;
+   data.use_uring = use_uring;
 
    r = mcommon_thread_create (threads, &socket_test_server, &data);
    BSON_ASSERT (r == 0);
@@ -368,7 +388,16 @@ _test_mongoc_socket_check_closed (int32_t server_sleep_ms)
 static void
 test_mongoc_socket_check_closed (void)
 {
-   _test_mongoc_socket_check_closed (0);
+   _test_mongoc_socket_check_closed (0, false);
+}
+
+
+static void
+test_mongoc_socket_check_closed_uring (void *ctx)
+{
+   BSON_UNUSED (ctx);
+
+   _test_mongoc_socket_check_closed (0, true);
 }
 
 
@@ -377,21 +406,29 @@ test_mongoc_socket_timed_out (void *ctx)
 {
    BSON_UNUSED (ctx);
 
-   _test_mongoc_socket_check_closed (1000);
+   _test_mongoc_socket_check_closed (1000, false);
 }
 
 
 static void
-test_mongoc_socket_sendv (void *ctx)
+test_mongoc_socket_timed_out_uring (void *ctx)
+{
+   BSON_UNUSED (ctx);
+
+   _test_mongoc_socket_check_closed (1000, true);
+}
+
+
+static void
+_test_mongoc_socket_sendv (bool use_uring)
 {
    socket_test_data_t data = {0};
    bson_thread_t threads[2];
    int i, r;
 
-   BSON_UNUSED (ctx);
-
    bson_mutex_init (&data.cond_mutex);
    mongoc_cond_init (&data.cond);
+   data.use_uring = use_uring;
 
    r = mcommon_thread_create (threads, &sendv_test_server, &data);
    BSON_ASSERT (r == 0);
@@ -408,6 +445,253 @@ test_mongoc_socket_sendv (void *ctx)
    mongoc_cond_destroy (&data.cond);
 }
 
+
+static void
+test_mongoc_socket_sendv (void *ctx)
+{
+   BSON_UNUSED (ctx);
+
+   _test_mongoc_socket_sendv (false);
+}
+
+
+static void
+test_mongoc_socket_sendv_uring (void *ctx)
+{
+   BSON_UNUSED (ctx);
+
+   _test_mongoc_socket_sendv (true);
+}
+
+
+static int
+skip_if_no_io_uring (void)
+{
+   mongoc_uring_t *uring = _mongoc_uring_new ();
+
+   if (!uring) {
+      return 0;
+   }
+
+   _mongoc_uring_destroy (uring);
+   return 1;
+}
+
+
+static bool
+auto_ping (request_t *request, void *data)
+{
+   BSON_UNUSED (data);
+
+   if (!request->is_command || strcasecmp (request->command_name, "ping") != 0) {
+      return false;
+   }
+
+   reply_to_request_with_ok_and_destroy (request);
+   return true;
+}
+
+
+/* returns the microseconds taken by @n pings to @server, after one to
+ * connect. */
+static int64_t
+_ping_mock_server (mock_server_t *server, bool use_uring, int n)
+{
+   mongoc_uri_t *uri;
+   mongoc_client_t *client;
+   bson_error_t error;
+   int64_t start;
+   int i;
+
+   uri = mongoc_uri_copy (mock_server_get_uri (server));
+   mongoc_uri_set_option_as_bool (uri, MONGOC_URI_IOURING, use_uring);
+   client = test_framework_client_new_from_uri (uri, NULL);
+
+   ASSERT_OR_PRINT (mongoc_client_command_simple (client, "admin", tmp_bson ("{'ping': 1}"), NULL, NULL, &error),
+                    error);
+
+   start = bson_get_monotonic_time ();
+   for (i = 0; i < n; i++) {
+      ASSERT_OR_PRINT (mongoc_client_command_simple (client, "admin", tmp_bson ("{'ping': 1}"), NULL, NULL, &error),
+                       error);
+   }
+
+   start = bson_get_monotonic_time () - start;
+
+   mongoc_client_destroy (client);
+   mongoc_uri_destroy (uri);
+
+   return start;
+}
+
+
+/* times round trips to a mock server over loopback with the poll () based
+ * stream and the io_uring one. Run with -d to print the results. */
+static void
+test_mongoc_socket_uring_benchmark (void *ctx)
+{
+   const int n = 5000;
+   mock_server_t *server;
+   int64_t polled;
+   int64_t uring;
+
+   BSON_UNUSED (ctx);
+
+   server = mock_server_new ();
+   mock_server_auto_hello (server, "{'isWritablePrimary': true, 'maxWireVersion': %d}", WIRE_VERSION_MAX);
+   mock_server_autoresponds (server, auto_ping, NULL, NULL);
+   mock_server_run (server);
+
+   polled = _ping_mock_server (server, false, n);
+   uring = _ping_mock_server (server, true, n);
+
+   if (test_suite_debug_output ()) {
+      printf ("      %d pings: poll %.1f us, io_uring %.1f us per round trip\n",
+              n,
+              (double) polled / n,
+              (double) uring / n);
+      fflush (stdout);
+   }
+
+   mock_server_destroy (server);
+}
+
+typedef struct {
+   mongoc_socket_t *sock;
+   size_t len;
+   size_t period; /* byte i of the stream is (i % period) % 251 */
+   bool matched;
+} zerocopy_test_reader_t;
+
+
+static BSON_THREAD_FUN (zerocopy_test_reader, data_)
+{
+   zerocopy_test_reader_t *data = (zerocopy_test_reader_t *) data_;
+   uint8_t *buf = bson_malloc (data->len);
+   size_t received = 0u;
+
+   while (received < data->len) {
+      const ssize_t r = mongoc_socket_recv (
+         data->sock, buf + received, data->len - received, 0, bson_get_monotonic_time () + TIMEOUT * 1000);
+      ASSERT_CMPSSIZE_T (r, >, 0);
+      received += (size_t) r;
+   }
+
+   data->matched = true;
+   for (size_t i = 0u; i < data->len; i++) {
+      data->matched &= buf[i] == (uint8_t) (i % data->period % 251u);
+   }
+
+   bson_free (buf);
+
+   BSON_THREAD_RETURN;
+}
+
+
+/* connects two loopback sockets, the client side with MSG_ZEROCOPY enabled. */
+static bool
+_zerocopy_test_connect (mongoc_socket_t **client, mongoc_socket_t **server, size_t threshold)
+{
+   struct sockaddr_in server_addr = {0};
+   mongoc_socklen_t sock_len = sizeof server_addr;
+   mongoc_socket_t *listen_sock = mongoc_socket_new (AF_INET, SOCK_STREAM, 0);
+   BSON_ASSERT (listen_sock);
+
+   server_addr.sin_family = AF_INET;
+   server_addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+   BSON_ASSERT (mongoc_socket_bind (listen_sock, (struct sockaddr *) &server_addr, sizeof server_addr) == 0);
+   BSON_ASSERT (mongoc_socket_getsockname (listen_sock, (struct sockaddr *) &server_addr, &sock_len) == 0);
+   BSON_ASSERT (mongoc_socket_listen (listen_sock, 10) == 0);
+
+   *client = mongoc_socket_new (AF_INET, SOCK_STREAM, 0);
+   BSON_ASSERT (*client);
+
+   if (!_mongoc_socket_set_zerocopy (*client, threshold)) {
+      mongoc_socket_destroy (*client);
+      mongoc_socket_destroy (listen_sock);
+      return false;
+   }
+
+   BSON_ASSERT (mongoc_socket_connect (*client, (struct sockaddr *) &server_addr, sizeof server_addr, -1) == 0);
+   *server = mongoc_socket_accept (listen_sock, -1);
+   BSON_ASSERT (*server);
+
+   mongoc_socket_destroy (listen_sock);
+   return true;
+}
+
+
+static int
+skip_if_no_zerocopy (void)
+{
+   mongoc_socket_t *client;
+   mongoc_socket_t *server;
+
+   if (!_zerocopy_test_connect (&client, &server, 1u)) {
+      return 0;
+   }
+
+   mongoc_socket_destroy (client);
+   mongoc_socket_destroy (server);
+   return 1;
+}
+
+
+static void
+test_mongoc_socket_zerocopy_sendv (void *ctx)
+{
+   const size_t len = 1024u * 1024u;
+   zerocopy_test_reader_t reader = {0};
+   mongoc_socket_t *client;
+   bson_thread_t thread;
+   uint8_t *buf = bson_malloc (len);
+   mongoc_iovec_t iov[2];
+
+   BSON_UNUSED (ctx);
+
+   for (size_t i = 0u; i < len; i++) {
+      buf[i] = (uint8_t) (i % 251u);
+   }
+
+   BSON_ASSERT (_zerocopy_test_connect (&client, &reader.sock, 64u * 1024u));
+
+   reader.len = len + 1000u;
+   reader.period = len;
+   BSON_ASSERT (mcommon_thread_create (&thread, &zerocopy_test_reader, &reader) == 0);
+
+   /* below the threshold, the data is copied. */
+   iov[0].iov_base = buf;
+   iov[0].iov_len = 1000u;
+   ASSERT_CMPSSIZE_T (mongoc_socket_sendv (client, iov, 1, bson_get_monotonic_time () + TIMEOUT * 1000), ==, 1000);
+   ASSERT_CMPUINT32 (client->zerocopy_sent, ==, 0u);
+
+   /* the rest is sent with MSG_ZEROCOPY, and every send is complete when
+    * mongoc_socket_sendv () returns. */
+   iov[0].iov_base = buf + 1000u;
+   iov[0].iov_len = len / 2u - 1000u;
+   iov[1].iov_base = buf + len / 2u;
+   iov[1].iov_len = len / 2u;
+   ASSERT_CMPSSIZE_T (
+      mongoc_socket_sendv (client, iov, 2, bson_get_monotonic_time () + TIMEOUT * 1000), ==, (ssize_t) len - 1000);
+   ASSERT_CMPUINT32 (client->zerocopy_sent, >, 0u);
+   ASSERT_CMPUINT32 (client->zerocopy_completed, ==, client->zerocopy_sent);
+
+   /* the kernel copies loopback data anyway and says so: stop asking. */
+   ASSERT_CMPSIZE_T (client->zerocopy_threshold, ==, (size_t) 0);
+
+   iov[0].iov_base = buf;
+   iov[0].iov_len = 1000u;
+   ASSERT_CMPSSIZE_T (mongoc_socket_sendv (client, iov, 1, bson_get_monotonic_time () + TIMEOUT * 1000), ==, 1000);
+
+   BSON_ASSERT (mcommon_thread_join (thread) == 0);
+   BSON_ASSERT (reader.matched);
+
+   mongoc_socket_destroy (client);
+   mongoc_socket_destroy (reader.sock);
+   bson_free (buf);
+}
+
+
 static void
 test_mongoc_socket_poll_refusal (void *ctx)
 {
@@ -463,4 +747,29 @@ test_socket_install (TestSuite *suite)
    TestSuite_AddFull (suite, "/Socket/sendv", test_mongoc_socket_sendv, NULL, NULL, test_framework_skip_if_slow);
    TestSuite_AddFull (
       suite, "/Socket/connect_refusal", test_mongoc_socket_poll_refusal, NULL, NULL, test_framework_skip_if_slow);
+   TestSuite_AddFull (
+      suite, "/Socket/uring/check_closed", test_mongoc_socket_check_closed_uring, NULL, NULL, skip_if_no_io_uring);
+   TestSuite_AddFull (suite,
+                      "/Socket/uring/timed_out",
+                      test_mongoc_socket_timed_out_uring,
+                      NULL,
+                      NULL,
+                      skip_if_no_io_uring,
+                      test_framework_skip_if_slow);
+   TestSuite_AddFull (suite,
+                      "/Socket/uring/sendv",
+                      test_mongoc_socket_sendv_uring,
+                      NULL,
+                      NULL,
+                      skip_if_no_io_uring,
+                      test_framework_skip_if_slow);
+   TestSuite_AddFull (suite,
+                      "/Socket/uring/benchmark",
+                      test_mongoc_socket_uring_benchmark,
+                      NULL,
+                      NULL,
+                      skip_if_no_io_uring,
+                      test_framework_skip_if_slow);
+   TestSuite_AddFull (
+      suite, "/Socket/zerocopy/sendv", test_mongoc_socket_zerocopy_sendv, NULL, NULL, skip_if_no_zerocopy);
 }
@@ -1,4 +1,5 @@
 #include <mongoc/mongoc.h>
+#include <mongoc/mongoc-addrinfo-cache-private.h>
 #include <mongoc/mongoc-stream-private.h>
 #include <mongoc/mongoc-socket-private.h>
 #include <mongoc/mongoc-host-list-private.h>
@@ -676,6 +677,69 @@ test_topology_scanner_does_not_renegotiate_pooled (void *ctx)
    _test_topology_scanner_does_not_renegotiate (true);
 }
 
+
+/* a connection from a client and the topology scanner share one DNS result,
+ * and the scanner starts with the address the client connected to. */
+static void
+test_topology_scanner_shares_addrinfo (void)
+{
+   mock_server_t *server;
+   const mongoc_host_list_t *host;
+   mongoc_stream_t *stream;
+   mongoc_addrinfo_t *addrinfo;
+   mongoc_addrinfo_t *other;
+   mongoc_topology_scanner_t *ts;
+   mongoc_topology_scanner_node_t *node;
+   bson_error_t error;
+   int finished = 1;
+
+   _mongoc_addrinfo_cache_clear ();
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MIN);
+   mock_server_run (server);
+   host = mongoc_uri_get_hosts (mock_server_get_uri (server));
+
+   stream = mongoc_client_connect_tcp (TIMEOUT, host, &error);
+   ASSERT_OR_PRINT (stream, error);
+   mongoc_stream_destroy (stream);
+
+   addrinfo = _mongoc_addrinfo_cache_get (host, MONGOC_ADDRINFO_CACHE_TIMEOUT_MS);
+   ASSERT (addrinfo);
+   ASSERT (_mongoc_addrinfo_preferred (addrinfo));
+
+   ts = mongoc_topology_scanner_new (NULL, NULL, &test_topology_scanner_helper, &finished, TIMEOUT);
+   mongoc_topology_scanner_add (ts, host, 0, false);
+   mongoc_topology_scanner_start (ts, false);
+
+   node = mongoc_topology_scanner_get_node (ts, 0);
+   ASSERT (node->dns_results == addrinfo);
+   ASSERT (node->successful_dns_result == _mongoc_addrinfo_preferred (addrinfo));
+   ASSERT_CMPSIZE_T (ts->async->ncmds, ==, 1u);
+
+   mongoc_topology_scanner_work (ts);
+   ASSERT_CMPINT (finished, ==, 0);
+   mongoc_topology_scanner_destroy (ts);
+
+   /* a result older than the maximum age is resolved again. */
+   other = _mongoc_addrinfo_cache_get (host, 0);
+   ASSERT (other);
+   ASSERT (other != addrinfo);
+   ASSERT (!_mongoc_addrinfo_preferred (other));
+   _mongoc_addrinfo_release (other);
+
+   /* invalidating leaves held references usable. */
+   _mongoc_addrinfo_cache_invalidate (host);
+   ASSERT (_mongoc_addrinfo_results (addrinfo));
+   other = _mongoc_addrinfo_cache_get (host, MONGOC_ADDRINFO_CACHE_TIMEOUT_MS);
+   ASSERT (other);
+   ASSERT (other != addrinfo);
+   _mongoc_addrinfo_release (other);
+   _mongoc_addrinfo_release (addrinfo);
+
+   _mongoc_addrinfo_cache_clear ();
+   mock_server_destroy (server);
+}
+
 void
 test_topology_scanner_install (TestSuite *suite)
 {
@@ -691,6 +755,7 @@ test_topology_scanner_install (TestSuite *suite)
    TestSuite_AddMockServerTest (
       suite, "/TOPOLOGY/dns", test_topology_scanner_dns, test_framework_skip_if_no_dual_ip_hostname);
    TestSuite_AddMockServerTest (suite, "/TOPOLOGY/retired_fails_to_initiate", test_topology_retired_fails_to_initiate);
+   TestSuite_AddMockServerTest (suite, "/TOPOLOGY/scanner/shares_addrinfo", test_topology_scanner_shares_addrinfo);
    TestSuite_AddFull (suite,
                       "/TOPOLOGY/scanner/renegotiate/single",
                       test_topology_scanner_does_not_renegotiate_single,
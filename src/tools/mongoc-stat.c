@@ -25,6 +25,7 @@
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -52,7 +53,11 @@ typedef struct {
    uint32_t n_counters;
    uint32_t infos_offset;
    uint32_t values_offset;
-   uint8_t padding[44];
+   uint32_t n_histograms;
+   uint32_t histogram_infos_offset;
+   uint32_t histograms_offset;
+   uint32_t n_histogram_cpu;
+   uint8_t padding[28];
 } mongoc_counters_t;
 #pragma pack()
 
@@ -74,6 +79,22 @@ typedef struct {
 } mongoc_counter_t;
 
 
+/* see mongoc-counters-private.h for the bucket layout. */
+#define MONGOC_HISTOGRAM_SUB_BUCKETS 8
+#define MONGOC_HISTOGRAM_BUCKETS 192
+
+
+typedef struct {
+   int64_t buckets[MONGOC_HISTOGRAM_BUCKETS];
+   int64_t sum;
+   int64_t padding[7];
+} mongoc_histogram_slots_t;
+
+
+BSON_STATIC_ASSERT2 (sizeof_histogram_slots,
+                     sizeof (mongoc_histogram_slots_t) == 1600);
+
+
 static void
 mongoc_counters_destroy (mongoc_counters_t *counters)
 {
@@ -197,29 +218,154 @@ mongoc_counters_print_info (mongoc_counters_t *counters,
 }
 
 
+/* the largest value counted in @bucket. */
+static int64_t
+mongoc_histogram_bucket_max (uint32_t bucket)
+{
+   uint32_t shift;
+   uint32_t sub;
+
+   if (bucket < MONGOC_HISTOGRAM_SUB_BUCKETS) {
+      return (int64_t) bucket;
+   }
+
+   shift = bucket / MONGOC_HISTOGRAM_SUB_BUCKETS - 1u;
+   sub = bucket % MONGOC_HISTOGRAM_SUB_BUCKETS;
+
+   return (int64_t) (
+      (((uint64_t) MONGOC_HISTOGRAM_SUB_BUCKETS + sub + 1u) << shift) - 1u);
+}
+
+
+/* the value below which @fraction of the samples fall. */
+static int64_t
+mongoc_histogram_percentile (const int64_t *buckets,
+                             int64_t count,
+                             double fraction)
+{
+   int64_t rank;
+   int64_t seen = 0;
+   uint32_t i;
+
+   rank = (int64_t) (fraction * (double) count + 0.5);
+   if (rank < 1) {
+      rank = 1;
+   }
+
+   for (i = 0; i < MONGOC_HISTOGRAM_BUCKETS; i++) {
+      seen += buckets[i];
+      if (seen >= rank) {
+         return mongoc_histogram_bucket_max (i);
+      }
+   }
+
+   return mongoc_histogram_bucket_max (MONGOC_HISTOGRAM_BUCKETS - 1);
+}
+
+
+static void
+mongoc_histograms_print_info (mongoc_counters_t *counters,
+                              mongoc_counter_info_t *info,
+                              FILE *file)
+{
+   const mongoc_histogram_slots_t *cpus;
+   int64_t buckets[MONGOC_HISTOGRAM_BUCKETS] = {0};
+   int64_t count = 0;
+   int64_t sum = 0;
+   unsigned i;
+   uint32_t b;
+
+   BSON_ASSERT (info);
+   BSON_ASSERT (file);
+   BSON_ASSERT ((info->offset & 0x7) == 0);
+
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wcast-align"
+#endif
+   cpus = (const mongoc_histogram_slots_t *) (((char *) counters) +
+                                              info->offset);
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+   for (i = 0; i < counters->n_histogram_cpu; i++) {
+      for (b = 0; b < MONGOC_HISTOGRAM_BUCKETS; b++) {
+         buckets[b] += cpus[i].buckets[b];
+         count += cpus[i].buckets[b];
+      }
+      sum += cpus[i].sum;
+   }
+
+   if (!count) {
+      fprintf (file,
+               "%24s : %-24s : %10s : %10s : %10s : %10s : %10s\n",
+               info->category,
+               info->name,
+               "0",
+               "-",
+               "-",
+               "-",
+               "-");
+      return;
+   }
+
+   fprintf (file,
+            "%24s : %-24s : %10lld : %10lld : %10lld : %10lld : %10lld\n",
+            info->category,
+            info->name,
+            (long long) count,
+            (long long) (sum / count),
+            (long long) mongoc_histogram_percentile (buckets, count, 0.5),
+            (long long) mongoc_histogram_percentile (buckets, count, 0.99),
+            (long long) mongoc_histogram_percentile (buckets, count, 0.999));
+}
+
+
 int
 main (int argc, char *argv[])
 {
    mongoc_counter_info_t *infos;
    mongoc_counters_t *counters;
    uint32_t n_counters = 0;
+   bool histograms = false;
    unsigned i;
    int pid;
 
-   if (argc != 2) {
-      fprintf (stderr, "usage: %s PID\n", argv[0]);
+   if (argc == 3 && 0 == strcmp (argv[1], "--histograms")) {
+      histograms = true;
+   } else if (argc != 2) {
+      fprintf (stderr, "usage: %s [--histograms] PID\n", argv[0]);
       return 1;
    }
 
-   pid = strtol (argv[1], NULL, 10);
+   pid = strtol (argv[argc - 1], NULL, 10);
    if (!(counters = mongoc_counters_new_from_pid (pid))) {
       fprintf (stderr, "Failed to load shared memory for pid %u.\n", pid);
       return EXIT_FAILURE;
    }
 
-   infos = mongoc_counters_get_infos (counters, &n_counters);
-   for (i = 0; i < n_counters; i++) {
-      mongoc_counters_print_info (counters, &infos[i], stdout);
+   if (histograms) {
+      /* latencies are in microseconds. */
+      fprintf (stdout,
+               "%24s : %-24s : %10s : %10s : %10s : %10s : %10s\n",
+               "Category",
+               "Name",
+               "Count",
+               "Mean",
+               "p50",
+               "p99",
+               "p999");
+      infos = (mongoc_counter_info_t *) (((char *) counters) +
+                                         counters->histogram_infos_offset);
+      for (i = 0; i < counters->n_histograms; i++) {
+         mongoc_histograms_print_info (counters, &infos[i], stdout);
+      }
+   } else {
+      infos = mongoc_counters_get_infos (counters, &n_counters);
+      for (i = 0; i < n_counters; i++) {
+         mongoc_counters_print_info (counters, &infos[i], stdout);
+      }
    }
 
    mongoc_counters_destroy (counters);